@@ -0,0 +1,443 @@
+#include "ActuationJournal.h"
+#include "Logger.h"
+
+const char* const ActuationJournal::DEFAULT_PATH = "/journal.bin";
+
+// Cabecera del fichero; cambia si cambia el formato de los registros
+static const uint8_t MAGIC[4] = {'G', 'E', 'J', '1'};
+
+// Registro: tipo, estado, longitud del contenido y CRC-8, seguidos del contenido
+static const size_t HEADER_SIZE = 4;
+static const size_t MAX_RECORD_SIZE = HEADER_SIZE + UINT8_MAX;
+
+// Contenido de RECORD_COMMAND: "id\0tipo"
+// Un id recortado sería el de otro sensor: lo que no cabe no se guarda
+static bool encodeCommand(char* payload, size_t& length, const char* sensorId, const char* sensorType) {
+    size_t idLength = strlen(sensorId);
+    size_t typeLength = strlen(sensorType);
+    if (idLength >= sizeof(JournalCommand::sensorId) || typeLength >= sizeof(JournalCommand::sensorType)) {
+        return false;
+    }
+    memcpy(payload, sensorId, idLength);
+    payload[idLength] = '\0';
+    memcpy(payload + idLength + 1, sensorType, typeLength);
+    length = idLength + 1 + typeLength;
+    return true;
+}
+
+static void copyField(char* dest, size_t destSize, const char* source, size_t length) {
+    if (length >= destSize) {
+        length = destSize - 1;
+    }
+    memcpy(dest, source, length);
+    dest[length] = '\0';
+}
+
+ActuationJournal::ActuationJournal(const char* path)
+    : fs(nullptr), path(path), allPending(false), allState(false), allInFlight(false), buffered(0), fileSize(0) {
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    memset(commands, 0, sizeof(commands));
+    lastEventId[0] = '\0';
+}
+
+bool ActuationJournal::begin(fs::FS& fileSystem) {
+    fs = &fileSystem;
+    size_t loaded = load();
+
+    // Fichero nuevo, de otro formato o con la cola cortada (corte de
+    // corriente a media escritura): se reescribe con lo que sí se leyó
+    if (loaded == 0 || stats.discarded > 0) {
+        if (stats.discarded > 0) {
+            LOG_WARN(SENSORS, "⚠️ Diario: %lu B corruptos descartados al final", stats.discarded);
+        }
+        if (!compact()) {
+            fs = nullptr;
+            LOG_ERROR(SENSORS, "❌ No se pudo escribir el diario de actuaciones: sólo en RAM");
+            return false;
+        }
+    } else {
+        fileSize = loaded;
+    }
+
+    if (hasPending()) {
+        LOG_INFO(SENSORS, "📒 Diario: %d órdenes pendientes de antes del reinicio", getPendingCount());
+    }
+    return true;
+}
+
+bool ActuationJournal::isPersistent() const {
+    return fs != nullptr;
+}
+
+// ---------------------------------------------------------------- Estado vigente
+
+int ActuationJournal::find(const char* sensorId) const {
+    for (int i = 0; i < MAX_COMMANDS; i++) {
+        if (commands[i].used && strcmp(commands[i].command.sensorId, sensorId) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ActuationJournal::apply(uint8_t type, bool state, const char* payload, size_t length) {
+    switch (type) {
+        case RECORD_ALL:
+            // "Todos a state" deja sin efecto lo pendiente de cada sensor
+            for (int i = 0; i < MAX_COMMANDS; i++) {
+                if (commands[i].used) {
+                    commands[i].used = false;
+                    stats.coalesced++;
+                }
+            }
+            if (allPending) {
+                stats.coalesced++;
+            }
+            allPending = true;
+            allState = state;
+            allInFlight = false;
+            return true;
+
+        case RECORD_ALL_DONE:
+            allPending = false;
+            allInFlight = false;
+            return true;
+
+        case RECORD_COMMAND: {
+            const char* separator = (const char*)memchr(payload, '\0', length);
+            if (separator == nullptr) {
+                return false;
+            }
+            size_t idLength = separator - payload;
+            char sensorId[sizeof(JournalCommand::sensorId)];
+            copyField(sensorId, sizeof(sensorId), payload, idLength);
+
+            int index = find(sensorId);
+            if (index >= 0) {
+                stats.coalesced++;
+            } else {
+                for (int i = 0; i < MAX_COMMANDS && index < 0; i++) {
+                    if (!commands[i].used) {
+                        index = i;
+                    }
+                }
+                if (index < 0) {
+                    return false;
+                }
+            }
+
+            Entry& entry = commands[index];
+            memcpy(entry.command.sensorId, sensorId, sizeof(sensorId));
+            copyField(entry.command.sensorType, sizeof(entry.command.sensorType), separator + 1,
+                      length - idLength - 1);
+            entry.command.targetState = state;
+            entry.used = true;
+            entry.inFlight = false;
+            return true;
+        }
+
+        case RECORD_COMMAND_DONE: {
+            char sensorId[sizeof(JournalCommand::sensorId)];
+            copyField(sensorId, sizeof(sensorId), payload, length);
+            int index = find(sensorId);
+            if (index >= 0 && commands[index].command.targetState == state) {
+                commands[index].used = false;
+            }
+            return true;
+        }
+
+        case RECORD_EVENT:
+            copyField(lastEventId, sizeof(lastEventId), payload, length);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// ---------------------------------------------------------------- Registros
+
+uint8_t ActuationJournal::checksum(const uint8_t* header, const uint8_t* payload, size_t length) {
+    // CRC-8 (polinomio 0x07) de tipo, estado, longitud y contenido
+    uint8_t crc = 0;
+    for (size_t i = 0; i < HEADER_SIZE - 1 + length; i++) {
+        crc ^= i < HEADER_SIZE - 1 ? header[i] : payload[i - (HEADER_SIZE - 1)];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t ActuationJournal::encode(uint8_t* out, uint8_t type, bool state, const char* payload, size_t length) {
+    out[0] = type;
+    out[1] = state ? 1 : 0;
+    out[2] = (uint8_t)length;
+    memcpy(out + HEADER_SIZE, payload, length);
+    out[3] = checksum(out, out + HEADER_SIZE, length);
+    return HEADER_SIZE + length;
+}
+
+void ActuationJournal::append(uint8_t type, bool state, const char* payload, size_t length) {
+    if (!apply(type, state, payload, length)) {
+        LOG_WARN(SENSORS, "⚠️ Diario lleno: no se guardó la orden");
+        return;
+    }
+    stats.records++;
+    if (fs == nullptr) {
+        return;
+    }
+
+    // El estado en RAM ya incluye este registro: al llegar al tope basta
+    // con reescribir lo vigente y el buffer sobra
+    size_t size = HEADER_SIZE + length;
+    if (fileSize + buffered + size > MAX_FILE_SIZE) {
+        compact();
+        return;
+    }
+    if (buffered + size > WRITE_BUFFER_SIZE) {
+        flush();
+    }
+    buffered += encode(writeBuffer + buffered, type, state, payload, length);
+}
+
+void ActuationJournal::flush() {
+    if (fs == nullptr || buffered == 0) {
+        return;
+    }
+
+    File file = fs->open(path, FILE_APPEND);
+    size_t written = file ? file.write(writeBuffer, buffered) : 0;
+    file.close();
+
+    stats.flushes++;
+    stats.bytesWritten += written;
+    if (written == buffered) {
+        fileSize += written;
+        buffered = 0;
+        return;
+    }
+
+    // Escritura a medias: el final del fichero ya no es fiable
+    LOG_ERROR(SENSORS, "❌ Error escribiendo el diario (%lu de %lu B)", (unsigned long)written,
+              (unsigned long)buffered);
+    buffered = 0;
+    compact();
+}
+
+size_t ActuationJournal::load() {
+    File file = fs->open(path, FILE_READ);
+    if (!file) {
+        return 0;
+    }
+
+    size_t total = file.size();
+    uint8_t magic[sizeof(MAGIC)];
+    if (file.read(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        stats.discarded += total;
+        return 0;
+    }
+
+    size_t offset = sizeof(MAGIC);
+    uint8_t header[HEADER_SIZE];
+    uint8_t payload[UINT8_MAX];
+    while (file.read(header, HEADER_SIZE) == HEADER_SIZE) {
+        size_t length = header[2];
+        if (file.read(payload, length) != length || checksum(header, payload, length) != header[3]) {
+            break;
+        }
+        apply(header[0], header[1] != 0, (const char*)payload, length);
+        offset += HEADER_SIZE + length;
+    }
+    stats.discarded += total - offset;
+    return offset;
+}
+
+bool ActuationJournal::writeLiveState(File& file) {
+    uint8_t record[MAX_RECORD_SIZE];
+    size_t written = file.write(MAGIC, sizeof(MAGIC));
+    size_t expected = sizeof(MAGIC);
+
+    if (lastEventId[0] != '\0') {
+        size_t size = encode(record, RECORD_EVENT, false, lastEventId, strlen(lastEventId));
+        written += file.write(record, size);
+        expected += size;
+    }
+    if (allPending) {
+        size_t size = encode(record, RECORD_ALL, allState, "", 0);
+        written += file.write(record, size);
+        expected += size;
+    }
+    for (int i = 0; i < MAX_COMMANDS; i++) {
+        if (!commands[i].used) {
+            continue;
+        }
+        char payload[sizeof(JournalCommand::sensorId) + sizeof(JournalCommand::sensorType)];
+        const JournalCommand& command = commands[i].command;
+        size_t length = 0;
+        encodeCommand(payload, length, command.sensorId, command.sensorType);  // ya validada al guardarla
+        size_t size = encode(record, RECORD_COMMAND, command.targetState, payload, length);
+        written += file.write(record, size);
+        expected += size;
+    }
+
+    stats.bytesWritten += written;
+    return written == expected;
+}
+
+bool ActuationJournal::compact() {
+    if (fs == nullptr) {
+        return false;
+    }
+
+    // Se escribe aparte y se renombra encima: un corte a mitad deja el
+    // diario anterior intacto
+    File file = fs->open(tempPath, FILE_WRITE);
+    bool written = file && writeLiveState(file);
+    size_t size = file.size();
+    file.close();
+
+    stats.flushes++;
+    stats.compactions++;
+    if (!written || !fs->rename(tempPath, path)) {
+        fs->remove(tempPath);
+        LOG_ERROR(SENSORS, "❌ No se pudo compactar el diario de actuaciones");
+        return false;
+    }
+    fileSize = size;
+    buffered = 0;
+    return true;
+}
+
+// ---------------------------------------------------------------- Actuación
+
+void ActuationJournal::recordActuateAll(bool targetState) {
+    append(RECORD_ALL, targetState, "", 0);
+    allInFlight = true;
+    // Escritura adelantada: la intención llega a flash antes que el primer PATCH
+    flush();
+}
+
+void ActuationJournal::actuateAllSent(int count) {
+    if (!allPending) {
+        return;
+    }
+    if (count == 0) {
+        append(RECORD_ALL_DONE, allState, "", 0);
+    } else if (count < 0) {
+        allInFlight = false;
+    }
+}
+
+void ActuationJournal::completeBatch() {
+    if (allPending && allInFlight) {
+        append(RECORD_ALL_DONE, allState, "", 0);
+    }
+}
+
+void ActuationJournal::recordFailure(const char* sensorId, const char* sensorType, bool targetState) {
+    // Un "todos" posterior en sentido contrario ya sustituyó a esta orden
+    if (allPending && allState != targetState) {
+        return;
+    }
+
+    int index = find(sensorId);
+    if (index >= 0 && commands[index].command.targetState == targetState) {
+        // Reintento fallido de lo mismo: nada nuevo que escribir
+        commands[index].inFlight = false;
+        return;
+    }
+
+    char payload[sizeof(JournalCommand::sensorId) + sizeof(JournalCommand::sensorType)];
+    size_t length = 0;
+    if (!encodeCommand(payload, length, sensorId, sensorType)) {
+        LOG_ERROR(SENSORS, "❌ Diario: id o tipo de sensor demasiado largo, orden no guardada");
+        return;
+    }
+    append(RECORD_COMMAND, targetState, payload, length);
+}
+
+void ActuationJournal::recordSuccess(const char* sensorId, bool targetState) {
+    // Sólo se escribe si cierra una orden pendiente: un PATCH normal no toca la flash
+    int index = find(sensorId);
+    if (index >= 0 && commands[index].command.targetState == targetState) {
+        append(RECORD_COMMAND_DONE, targetState, sensorId, strlen(sensorId));
+    }
+}
+
+void ActuationJournal::recordEvent(const char* eventId) {
+    if (eventId[0] == '\0' || strncmp(eventId, lastEventId, sizeof(lastEventId) - 1) == 0) {
+        return;
+    }
+    size_t length = strlen(eventId);
+    append(RECORD_EVENT, false, eventId, length < MAX_EVENT_ID ? length : MAX_EVENT_ID - 1);
+}
+
+const char* ActuationJournal::getLastEventId() const {
+    return lastEventId;
+}
+
+// ---------------------------------------------------------------- Reenvío
+
+bool ActuationJournal::takeActuateAll(bool& targetState) {
+    if (!allPending || allInFlight) {
+        return false;
+    }
+    allInFlight = true;
+    targetState = allState;
+    stats.replayed++;
+    return true;
+}
+
+bool ActuationJournal::takeCommand(JournalCommand& command) {
+    // Con un "todos" pendiente, actuateAll() ya cubre cada sensor
+    if (allPending) {
+        return false;
+    }
+    for (int i = 0; i < MAX_COMMANDS; i++) {
+        if (commands[i].used && !commands[i].inFlight) {
+            commands[i].inFlight = true;
+            command = commands[i].command;
+            stats.replayed++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ActuationJournal::releaseCommand(const char* sensorId) {
+    int index = find(sensorId);
+    if (index >= 0) {
+        commands[index].inFlight = false;
+    }
+}
+
+bool ActuationJournal::hasPending() const {
+    return getPendingCount() > 0;
+}
+
+int ActuationJournal::getPendingCount() const {
+    int count = allPending ? 1 : 0;
+    for (int i = 0; i < MAX_COMMANDS; i++) {
+        if (commands[i].used) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t ActuationJournal::getFileSize() const {
+    return fileSize + buffered;
+}
+
+const JournalStats& ActuationJournal::getStats() const {
+    return stats;
+}
+
+void ActuationJournal::printStats() const {
+    LOG_INFO(STATS, "📒 Diario %s: %d pendientes, %lu B (combinadas: %lu, reenviadas: %lu)",
+             isPersistent() ? "en flash" : "en RAM", getPendingCount(), (unsigned long)getFileSize(), stats.coalesced,
+             stats.replayed);
+    LOG_INFO(STATS, "📒 Escrituras del diario: %lu registros en %lu escrituras, %lu B, %lu reescrituras completas",
+             stats.records, stats.flushes, stats.bytesWritten, stats.compactions);
+}
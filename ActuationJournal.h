@@ -0,0 +1,124 @@
+#ifndef ACTUATION_JOURNAL_H
+#define ACTUATION_JOURNAL_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "SensorCache.h"
+
+struct JournalStats {
+    unsigned long records;      // registros añadidos al diario
+    unsigned long flushes;      // escrituras en flash (una por vaciado del buffer)
+    unsigned long bytesWritten;
+    unsigned long compactions;
+    unsigned long coalesced;    // órdenes pendientes sustituidas por una posterior
+    unsigned long replayed;     // órdenes reenviadas desde el diario
+    unsigned long discarded;    // bytes de cola corrupta descartados al cargar
+
+    JournalStats()
+        : records(0), flushes(0), bytesWritten(0), compactions(0), coalesced(0), replayed(0), discarded(0) {}
+};
+
+// Orden de actuación pendiente de un sensor (la última que se pidió)
+struct JournalCommand {
+    char sensorId[40];
+    char sensorType[24];
+    bool targetState;
+};
+
+// Diario de actuaciones en flash, sólo de añadir. Guarda la intención de
+// cada enter/exit antes de mandarla, los PATCH que fallaron y el id del
+// último evento procesado, para que un corte de WiFi o del API (o un
+// reinicio) no deje sensores encendidos en el servidor. En memoria se
+// mantiene sólo lo vigente: una orden por sensor y una de "todos", de modo
+// que al reenviar se manda el último estado de cada sensor y nada más.
+//
+// Para no gastar la flash, los registros se acumulan en RAM y se escriben
+// de una vez en flush(); sólo la intención de enter/exit se escribe al
+// momento. Un reintento que vuelve a fallar no escribe nada. Al llegar a
+// MAX_FILE_SIZE el fichero se reescribe con lo vigente (compactación).
+// Sólo lo usa la tarea de red
+class ActuationJournal {
+public:
+    static const int MAX_COMMANDS = SensorCache::MAX_SENSORS;
+    static const size_t MAX_FILE_SIZE = 8192;  // lo vigente ocupa hasta unos 4,4 KB
+    static const size_t WRITE_BUFFER_SIZE = 256;
+    static const size_t MAX_EVENT_ID = 48;
+    static const char* const DEFAULT_PATH;
+
+private:
+    enum RecordType : uint8_t {
+        RECORD_ALL = 1,       // intención: todos los sensores a state
+        RECORD_ALL_DONE,      // el lote de "todos" terminó (los fallos van aparte)
+        RECORD_COMMAND,       // id\0tipo: PATCH fallido, pendiente de reenviar
+        RECORD_COMMAND_DONE,  // id: confirmado en el servidor
+        RECORD_EVENT          // id del último evento de proximidad procesado
+    };
+
+    struct Entry {
+        JournalCommand command;
+        bool used;
+        bool inFlight;
+    };
+
+    fs::FS* fs;
+    const char* path;
+    char tempPath[32];
+
+    Entry commands[MAX_COMMANDS];
+    bool allPending;
+    bool allState;
+    bool allInFlight;
+    char lastEventId[MAX_EVENT_ID];
+
+    uint8_t writeBuffer[WRITE_BUFFER_SIZE];
+    size_t buffered;
+    size_t fileSize;
+    JournalStats stats;
+
+    int find(const char* sensorId) const;
+    bool apply(uint8_t type, bool state, const char* payload, size_t length);
+    void append(uint8_t type, bool state, const char* payload, size_t length);
+    static size_t encode(uint8_t* out, uint8_t type, bool state, const char* payload, size_t length);
+    static uint8_t checksum(const uint8_t* header, const uint8_t* payload, size_t length);
+    size_t load();
+    bool writeLiveState(File& file);
+    bool compact();
+
+public:
+    explicit ActuationJournal(const char* path = DEFAULT_PATH);
+
+    // Carga el diario de un sistema de ficheros ya montado. Sin él el
+    // diario sigue funcionando sólo en RAM
+    bool begin(fs::FS& fileSystem);
+    bool isPersistent() const;
+
+    // Antes de actuateAll(): se escribe en flash enseguida y sustituye a
+    // las órdenes pendientes de cada sensor
+    void recordActuateAll(bool targetState);
+    // Resultado de actuateAll(): > 0 en vuelo hasta completeBatch(),
+    // 0 nada que cambiar, < 0 no se pudo (queda pendiente)
+    void actuateAllSent(int count);
+    // Fin de un lote de resultados: cierra el "todos" en vuelo
+    void completeBatch();
+
+    void recordFailure(const char* sensorId, const char* sensorType, bool targetState);
+    void recordSuccess(const char* sensorId, bool targetState);
+
+    void recordEvent(const char* eventId);
+    const char* getLastEventId() const;
+
+    // Reenvío: primero el "todos" pendiente y después, una a una, las
+    // órdenes por sensor que no estén ya en vuelo
+    bool takeActuateAll(bool& targetState);
+    bool takeCommand(JournalCommand& command);
+    void releaseCommand(const char* sensorId);  // no se pudo mandar
+    bool hasPending() const;
+    int getPendingCount() const;
+
+    void flush();
+    size_t getFileSize() const;
+    const JournalStats& getStats() const;
+    void printStats() const;
+};
+
+#endif
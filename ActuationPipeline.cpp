@@ -0,0 +1,200 @@
+#include "ActuationPipeline.h"
+#include <WiFi.h>
+#include "Logger.h"
+#include "Metrics.h"
+
+ActuationPipeline::Worker::Worker()
+    : owner(nullptr), pool(1), task(nullptr) {}
+
+ActuationPipeline::ActuationPipeline(const String& baseURL, int maxInFlight, unsigned long minIntervalMs)
+    : prefixValid(false), maxInFlight(maxInFlight), minIntervalMs(minIntervalMs),
+      jobs(nullptr), results(nullptr), rateLock(nullptr), nextDispatch(0), breaker("patch"),
+      outstanding(0), batchStart(0), lastBatchDurationMs(0), rejectedURLs(0) {
+    buildPrefix(baseURL.c_str());
+}
+
+ActuationPipeline::~ActuationPipeline() {
+    for (int i = 0; i < MAX_WORKERS; i++) {
+        if (workers[i].task != nullptr) {
+            vTaskDelete(workers[i].task);
+        }
+    }
+    if (jobs != nullptr) vQueueDelete(jobs);
+    if (results != nullptr) vQueueDelete(results);
+    if (rateLock != nullptr) vSemaphoreDelete(rateLock);
+}
+
+void ActuationPipeline::configure(int newMaxInFlight, unsigned long newMinIntervalMs) {
+    if (jobs != nullptr) {
+        return;  // Los trabajadores ya fueron creados
+    }
+    maxInFlight = newMaxInFlight;
+    minIntervalMs = newMinIntervalMs;
+}
+
+void ActuationPipeline::setBaseURL(const String& url) {
+    if (jobs != nullptr) {
+        return;  // Los trabajadores leen el prefijo sin sincronización
+    }
+    buildPrefix(url.c_str());
+}
+
+void ActuationPipeline::buildPrefix(const char* baseURL) {
+    int length = snprintf(sensorsPrefix, sizeof(sensorsPrefix), "%ssensors/", baseURL);
+    prefixValid = length >= 0 && (size_t)length < sizeof(sensorsPrefix);
+    if (!prefixValid) {
+        LOG_ERROR(SENSORS, "❌ URL base de actuación demasiado larga (%d de %u caracteres), no se enviarán PATCH",
+                  length, (unsigned)sizeof(sensorsPrefix) - 1);
+    }
+}
+
+void ActuationPipeline::begin() {
+    if (jobs != nullptr) {
+        return;
+    }
+
+    if (maxInFlight < 1) maxInFlight = 1;
+    if (maxInFlight > MAX_WORKERS) maxInFlight = MAX_WORKERS;
+
+    jobs = xQueueCreate(QUEUE_LENGTH, sizeof(Job));
+    results = xQueueCreate(QUEUE_LENGTH, sizeof(ActuationResult));
+    rateLock = xSemaphoreCreateMutex();
+
+    for (int i = 0; i < maxInFlight; i++) {
+        workers[i].owner = this;
+        // Núcleo 0: la tarea de Arduino (loop) corre en el núcleo 1
+        xTaskCreatePinnedToCore(workerTask, "actuation", 8192, &workers[i], 1, &workers[i].task, 0);
+    }
+}
+
+bool ActuationPipeline::enqueue(const char* sensorId, const char* sensorType, bool targetState) {
+    if (jobs == nullptr) {
+        return false;
+    }
+
+    // Recortado, el id sería el de otro sensor: se rechaza la orden
+    Job job;
+    size_t idLength = strlen(sensorId);
+    size_t typeLength = strlen(sensorType);
+    if (idLength >= sizeof(job.sensorId) || typeLength >= sizeof(job.sensorType)) {
+        LOG_ERROR(SENSORS, "❌ Id o tipo de sensor demasiado largo, actuación descartada");
+        return false;
+    }
+    memcpy(job.sensorId, sensorId, idLength + 1);
+    memcpy(job.sensorType, sensorType, typeLength + 1);
+    job.targetState = targetState;
+
+    if (xQueueSend(jobs, &job, 0) != pdTRUE) {
+        return false;
+    }
+
+    if (outstanding == 0) {
+        batchStart = millis();
+    }
+    outstanding++;
+    return true;
+}
+
+bool ActuationPipeline::poll(ActuationResult& result) {
+    if (results == nullptr || xQueueReceive(results, &result, 0) != pdTRUE) {
+        return false;
+    }
+
+    outstanding--;
+    result.batchComplete = outstanding == 0;
+    if (result.batchComplete) {
+        lastBatchDurationMs = millis() - batchStart;
+    }
+    return true;
+}
+
+bool ActuationPipeline::isIdle() const {
+    return outstanding == 0;
+}
+
+int ActuationPipeline::getOutstanding() const {
+    return outstanding;
+}
+
+unsigned long ActuationPipeline::getLastBatchDuration() const {
+    return lastBatchDurationMs;
+}
+
+unsigned long ActuationPipeline::getRejectedURLs() const {
+    return rejectedURLs;
+}
+
+CircuitBreaker& ActuationPipeline::getBreaker() {
+    return breaker;
+}
+
+void ActuationPipeline::workerTask(void* parameter) {
+    Worker* worker = static_cast<Worker*>(parameter);
+    ActuationPipeline* pipeline = worker->owner;
+
+    Job job;
+    ActuationResult result;
+    for (;;) {
+        if (xQueueReceive(pipeline->jobs, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        pipeline->waitForDispatchSlot();
+        pipeline->runJob(*worker, job, result);
+        xQueueSend(pipeline->results, &result, portMAX_DELAY);
+    }
+}
+
+void ActuationPipeline::waitForDispatchSlot() {
+    // Limitador de ritmo compartido: como mucho un PATCH cada minIntervalMs
+    xSemaphoreTake(rateLock, portMAX_DELAY);
+    unsigned long now = millis();
+    long wait = (long)(nextDispatch - now);
+    if (wait < 0) {
+        wait = 0;
+    }
+    nextDispatch = now + wait + minIntervalMs;
+    xSemaphoreGive(rateLock);
+
+    if (wait > 0) {
+        vTaskDelay(pdMS_TO_TICKS(wait));
+    }
+}
+
+void ActuationPipeline::runJob(Worker& worker, const Job& job, ActuationResult& result) {
+    unsigned long start = millis();
+
+    memcpy(result.sensorId, job.sensorId, sizeof(result.sensorId));
+    memcpy(result.sensorType, job.sensorType, sizeof(result.sensorType));
+    result.targetState = job.targetState;
+    result.batchComplete = false;
+    result.httpResponseCode = HTTPC_ERROR_CONNECTION_REFUSED;
+
+    // Con un prefijo entero el id y "/status" siempre caben detrás
+    static_assert(sizeof(job.sensorId) - 1 + sizeof("/status") - 1 <= HttpConnectionPool::MAX_URL_SUFFIX,
+                  "MAX_URL_SUFFIX no cubre el id de sensor");
+    char url[HttpConnectionPool::MAX_URL];
+    snprintf(url, sizeof(url), "%s%s/status", sensorsPrefix, job.sensorId);
+
+    if (!prefixValid) {
+        // Prefijo truncado: apuntaría a otro recurso. Orden fallida sin tocar la red ni el cortacircuitos
+        rejectedURLs++;
+        LOG_ERROR(SENSORS, "❌ URL de actuación demasiado larga para %s, PATCH descartado", job.sensorId);
+        result.httpResponseCode = ActuationResult::URL_TOO_LONG;
+    } else if (WiFi.status() == WL_CONNECTED && !breaker.allow(millis())) {
+        // API caída: se falla enseguida sin ocupar el trabajador en un timeout
+        result.httpResponseCode = CircuitBreaker::REJECTED;
+    } else if (WiFi.status() == WL_CONNECTED) {
+        unsigned long retryAfterMs = 0;
+        HTTPClient* http = worker.pool.acquire(url);
+        if (http != nullptr) {
+            METRIC_SCOPE(PATCH);
+            const char* jsonBody = job.targetState ? "{\"isActive\": true}" : "{\"isActive\": false}";
+            result.httpResponseCode = worker.pool.send(http, "PATCH", jsonBody);
+            retryAfterMs = CircuitBreaker::retryAfterMs(http, result.httpResponseCode);
+            worker.pool.release(http);
+        }
+        breaker.record(result.httpResponseCode, millis(), retryAfterMs);
+    }
+
+    result.durationMs = millis() - start;
+}
@@ -0,0 +1,81 @@
+#ifndef ACTUATION_PIPELINE_H
+#define ACTUATION_PIPELINE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "HttpConnectionPool.h"
+#include "CircuitBreaker.h"
+#include "Transport.h"
+
+// Pipeline de actuación: mantiene varios PATCH de sensores en vuelo a la vez
+// mediante tareas trabajadoras, con límite de concurrencia y de ritmo. Los
+// resultados se recogen desde loop() con poll() sin bloquear.
+class ActuationPipeline {
+public:
+    static const int MAX_WORKERS = 4;
+    static const int QUEUE_LENGTH = 32;
+
+private:
+    struct Job {
+        char sensorId[40];
+        char sensorType[24];
+        bool targetState;
+    };
+
+    struct Worker {
+        ActuationPipeline* owner;
+        HttpConnectionPool pool;  // una conexión keep-alive propia por trabajador
+        TaskHandle_t task;
+
+        Worker();
+    };
+
+    // "{baseURL}sensors/", calculado una vez; cada PATCH sólo añade el id
+    char sensorsPrefix[HttpConnectionPool::MAX_URL_PREFIX];
+    bool prefixValid;  // false si la base no cupo: todo PATCH falla sin red
+    int maxInFlight;
+    unsigned long minIntervalMs;
+
+    Worker workers[MAX_WORKERS];
+    QueueHandle_t jobs;
+    QueueHandle_t results;
+    SemaphoreHandle_t rateLock;
+    unsigned long nextDispatch;
+    CircuitBreaker breaker;  // compartido por todos los trabajadores
+
+    int outstanding;
+    unsigned long batchStart;
+    unsigned long lastBatchDurationMs;
+    std::atomic<unsigned long> rejectedURLs;  // lo incrementan los trabajadores
+
+    static void workerTask(void* parameter);
+    void waitForDispatchSlot();
+    void runJob(Worker& worker, const Job& job, ActuationResult& result);
+    void buildPrefix(const char* baseURL);
+
+public:
+    ActuationPipeline(const String& baseURL, int maxInFlight = 3, unsigned long minIntervalMs = 100);
+    ~ActuationPipeline();
+
+    // Debe llamarse antes de begin(); maxInFlight se limita a MAX_WORKERS
+    void configure(int maxInFlight, unsigned long minIntervalMs);
+    void setBaseURL(const String& url);
+    void begin();
+
+    // Copia los textos en el trabajo: no reserva memoria. Devuelve false
+    // con la cola llena o si el id o el tipo no caben enteros
+    bool enqueue(const char* sensorId, const char* sensorType, bool targetState);
+    bool poll(ActuationResult& result);
+
+    bool isIdle() const;
+    int getOutstanding() const;
+    unsigned long getLastBatchDuration() const;
+    unsigned long getRejectedURLs() const;
+    CircuitBreaker& getBreaker();
+};
+
+#endif
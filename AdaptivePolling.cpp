@@ -0,0 +1,104 @@
+#include "AdaptivePolling.h"
+
+AdaptivePolling::AdaptivePolling()
+    : interval(0), lastChange(0), retryUntil(0), lastDistance(0.0f), changedSincePoll(false), hasChange(false),
+      retryPending(false) {
+    configure(AdaptivePollingConfig());
+}
+
+void AdaptivePolling::configure(const AdaptivePollingConfig& newConfig) {
+    config = newConfig;
+    if (config.minIntervalMs == 0) {
+        config.minIntervalMs = 1;
+    }
+    if (config.maxIntervalMs < config.minIntervalMs) {
+        config.maxIntervalMs = config.minIntervalMs;
+    }
+    if (config.edgeIntervalMs < config.minIntervalMs) {
+        config.edgeIntervalMs = config.minIntervalMs;
+    }
+    if (config.edgeIntervalMs > config.maxIntervalMs) {
+        config.edgeIntervalMs = config.maxIntervalMs;
+    }
+    interval = config.minIntervalMs;
+}
+
+const AdaptivePollingConfig& AdaptivePolling::getConfig() const {
+    return config;
+}
+
+void AdaptivePolling::onStateChange(float distanceM, unsigned long now) {
+    lastDistance = distanceM;
+    lastChange = now;
+    hasChange = true;
+    changedSincePoll = true;
+    interval = config.minIntervalMs;
+}
+
+void AdaptivePolling::onRetryAfter(unsigned long delayMs, unsigned long now) {
+    if (delayMs > MAX_RETRY_AFTER_MS) {
+        delayMs = MAX_RETRY_AFTER_MS;
+    }
+    // Con varias respuestas seguidas manda la que pide esperar más
+    unsigned long until = now + delayMs;
+    if (!retryPending || (long)(until - retryUntil) > 0) {
+        retryUntil = until;
+    }
+    retryPending = true;
+}
+
+unsigned long AdaptivePolling::onPoll(unsigned long now) {
+    if (changedSincePoll) {
+        changedSincePoll = false;
+        interval = config.minIntervalMs;
+    } else {
+        // Sin novedades: retroceso exponencial
+        interval = interval > config.maxIntervalMs / 2 ? config.maxIntervalMs : interval * 2;
+    }
+
+    unsigned long limit = ceiling(now);
+    if (interval > limit) {
+        interval = limit;
+    }
+
+    unsigned long wait = retryRemaining(now);
+    return wait > interval ? wait : interval;
+}
+
+unsigned long AdaptivePolling::ceiling(unsigned long now) const {
+    if (!hasChange) {
+        return config.maxIntervalMs;
+    }
+    unsigned long sinceChange = now - lastChange;
+    if (sinceChange < config.settleMs) {
+        return config.minIntervalMs;
+    }
+    if (isNearEdge() && sinceChange < config.edgeHoldMs) {
+        return config.edgeIntervalMs;
+    }
+    return config.maxIntervalMs;
+}
+
+unsigned long AdaptivePolling::retryRemaining(unsigned long now) {
+    if (!retryPending) {
+        return 0;
+    }
+    long remaining = (long)(retryUntil - now);
+    if (remaining <= 0) {
+        retryPending = false;
+        return 0;
+    }
+    return (unsigned long)remaining;
+}
+
+unsigned long AdaptivePolling::getInterval() const {
+    return interval;
+}
+
+bool AdaptivePolling::isNearEdge() const {
+    float fromEdge = lastDistance - config.geofenceRadiusM;
+    if (fromEdge < 0.0f) {
+        fromEdge = -fromEdge;
+    }
+    return hasChange && fromEdge <= config.edgeBandM;
+}
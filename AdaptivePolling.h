@@ -0,0 +1,61 @@
+#ifndef ADAPTIVE_POLLING_H
+#define ADAPTIVE_POLLING_H
+
+#include <Arduino.h>
+
+struct AdaptivePollingConfig {
+    unsigned long minIntervalMs;   // tras un enter/exit, durante settleMs
+    unsigned long edgeIntervalMs;  // techo cerca del borde de la geovalla, durante edgeHoldMs
+    unsigned long maxIntervalMs;   // techo lejos del borde o en casa sin actividad
+    unsigned long settleMs;        // ventana tras un cambio de estado (rebotes en el borde)
+    unsigned long edgeHoldMs;      // pasado este tiempo la última distancia ya no se considera
+    float geofenceRadiusM;
+    float edgeBandM;               // |distancia - radio| <= edgeBandM: cerca del borde
+
+    AdaptivePollingConfig()
+        : minIntervalMs(2000), edgeIntervalMs(10000), maxIntervalMs(30000), settleMs(60000),
+          edgeHoldMs(600000), geofenceRadiusM(100.0f), edgeBandM(50.0f) {}
+};
+
+// Intervalo del sondeo de proximidad según lo que sabe el dispositivo: al
+// mínimo tras un enter/exit, con un techo bajo mientras la distancia del
+// último evento está cerca del borde, y duplicándose en cada sondeo sin
+// novedades hasta maxIntervalMs. Un Retry-After del servidor aplaza el
+// siguiente sondeo aunque supere los límites. Sólo lo usa la tarea de red
+class AdaptivePolling {
+public:
+    static const unsigned long MAX_RETRY_AFTER_MS = 3600000;  // tope ante cabeceras absurdas
+
+private:
+    AdaptivePollingConfig config;
+    unsigned long interval;
+    unsigned long lastChange;
+    unsigned long retryUntil;
+    float lastDistance;
+    bool changedSincePoll;
+    bool hasChange;
+    bool retryPending;
+
+    unsigned long ceiling(unsigned long now) const;
+
+public:
+    AdaptivePolling();
+
+    // Ajusta los límites (se corrigen para que min <= edge <= max)
+    void configure(const AdaptivePollingConfig& newConfig);
+    const AdaptivePollingConfig& getConfig() const;
+
+    void onStateChange(float distanceM, unsigned long now);
+    void onRetryAfter(unsigned long delayMs, unsigned long now);
+
+    // Tras cada sondeo: devuelve el retardo hasta el siguiente
+    unsigned long onPoll(unsigned long now);
+
+    // Tiempo que falta para poder volver a llamar al servidor (0 = ya)
+    unsigned long retryRemaining(unsigned long now);
+
+    unsigned long getInterval() const;
+    bool isNearEdge() const;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "CircuitBreaker.h"
+#include "Logger.h"
+#include <HTTPClient.h>
+#include <limits.h>
+
+static const char* const STATE_NAMES[] = {"cerrado", "abierto", "semiabierto"};
+
+CircuitBreaker::CircuitBreaker(const char* name)
+    : name(name), state(CIRCUIT_CLOSED), consecutiveFailures(0), failureThreshold(DEFAULT_FAILURE_THRESHOLD),
+      minBackoff(DEFAULT_MIN_BACKOFF), maxBackoff(DEFAULT_MAX_BACKOFF), backoff(DEFAULT_MIN_BACKOFF),
+      openUntil(0), probeStarted(0) {
+    // portMUX_INITIALIZER_UNLOCKED es un inicializador de llaves: no admite asignación directa
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    lock = unlocked;
+}
+
+void CircuitBreaker::configure(int newFailureThreshold, unsigned long minBackoffMs, unsigned long maxBackoffMs) {
+    portENTER_CRITICAL(&lock);
+    failureThreshold = newFailureThreshold > 0 ? newFailureThreshold : 1;
+    minBackoff = minBackoffMs > 0 ? minBackoffMs : 1;
+    maxBackoff = maxBackoffMs > minBackoff ? maxBackoffMs : minBackoff;
+    backoff = minBackoff;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool CircuitBreaker::allow(unsigned long now) {
+    bool allowed = true;
+    bool probe = false;
+
+    portENTER_CRITICAL(&lock);
+    if (state == CIRCUIT_OPEN && (long)(now - openUntil) >= 0) {
+        state = CIRCUIT_HALF_OPEN;
+        probeStarted = now;
+        probe = true;
+    } else if (state == CIRCUIT_HALF_OPEN && now - probeStarted >= PROBE_TIMEOUT) {
+        // La sonda anterior no llegó a informar (petición abandonada)
+        probeStarted = now;
+        probe = true;
+    } else if (state != CIRCUIT_CLOSED) {
+        allowed = false;
+        stats.rejected++;
+    }
+    if (probe) {
+        stats.probes++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (probe) {
+        LOG_INFO(NET, "🩺 Sonda al endpoint %s", name);
+    }
+    return allowed;
+}
+
+void CircuitBreaker::record(int httpResponseCode, unsigned long now, unsigned long retryAfterMs) {
+    bool failure = isFailure(httpResponseCode);
+    CircuitState previous;
+    unsigned long waitMs = 0;
+
+    // El jitter se sortea fuera de la sección crítica
+    unsigned long jitter = (unsigned long)random(0x7fffffff);
+
+    portENTER_CRITICAL(&lock);
+    previous = state;
+    if (!failure) {
+        state = CIRCUIT_CLOSED;
+        consecutiveFailures = 0;
+        backoff = minBackoff;
+    } else {
+        stats.failures++;
+        consecutiveFailures++;
+        bool reopen = state == CIRCUIT_HALF_OPEN;
+        bool tripped = consecutiveFailures >= failureThreshold || retryAfterMs > 0;
+        if (reopen || (state == CIRCUIT_CLOSED && tripped)) {
+            if (reopen) {
+                backoff = backoff > maxBackoff / 2 ? maxBackoff : backoff * 2;
+            }
+            // Jitter "igual": la mitad fija y la otra mitad aleatoria
+            waitMs = backoff / 2 + jitter % (backoff - backoff / 2 + 1);
+            if (retryAfterMs > waitMs) {
+                waitMs = retryAfterMs < MAX_RETRY_AFTER ? retryAfterMs : MAX_RETRY_AFTER;
+            }
+            state = CIRCUIT_OPEN;
+            openUntil = now + waitMs;
+            stats.opened++;
+        }
+    }
+    CircuitState current = state;
+    portEXIT_CRITICAL(&lock);
+
+    if (current == CIRCUIT_OPEN && waitMs > 0) {
+        LOG_WARN(NET, "⛔ Endpoint %s en pausa %lu ms (HTTP %d)", name, waitMs, httpResponseCode);
+    } else if (current == CIRCUIT_CLOSED && previous != CIRCUIT_CLOSED) {
+        LOG_INFO(NET, "✅ Endpoint %s recuperado", name);
+    }
+}
+
+bool CircuitBreaker::isFailure(int httpResponseCode) {
+    return httpResponseCode < 0 || httpResponseCode == HTTP_CODE_TOO_MANY_REQUESTS || httpResponseCode >= 500;
+}
+
+unsigned long CircuitBreaker::retryAfterMs(HTTPClient* http, int httpResponseCode) {
+    if (httpResponseCode != HTTP_CODE_TOO_MANY_REQUESTS && httpResponseCode != HTTP_CODE_SERVICE_UNAVAILABLE) {
+        return 0;
+    }
+
+    // Sólo la forma en segundos; una fecha HTTP necesitaría la hora del servidor
+    const String& value = http->header("Retry-After");
+    const char* text = value.c_str();
+    char* end;
+    unsigned long seconds = strtoul(text, &end, 10);
+    if (end == text || *end != '\0') {
+        return 0;
+    }
+    return seconds > ULONG_MAX / 1000 ? ULONG_MAX : seconds * 1000;
+}
+
+CircuitState CircuitBreaker::getState() const {
+    return state;
+}
+
+const char* CircuitBreaker::getName() const {
+    return name;
+}
+
+unsigned long CircuitBreaker::getRetryIn(unsigned long now) const {
+    portENTER_CRITICAL(&lock);
+    long remaining = state == CIRCUIT_OPEN ? (long)(openUntil - now) : 0;
+    portEXIT_CRITICAL(&lock);
+    return remaining > 0 ? (unsigned long)remaining : 0;
+}
+
+CircuitBreakerStats CircuitBreaker::getStats() const {
+    portENTER_CRITICAL(&lock);
+    CircuitBreakerStats copy = stats;
+    portEXIT_CRITICAL(&lock);
+    return copy;
+}
+
+void CircuitBreaker::printStats() const {
+    CircuitBreakerStats copy = getStats();
+    LOG_INFO(STATS, "Circuito %s: %s (fallos: %lu, rechazadas: %lu, aperturas: %lu, sondas: %lu)", name,
+             STATE_NAMES[getState()], copy.failures, copy.rejected, copy.opened, copy.probes);
+}
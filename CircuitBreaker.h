@@ -0,0 +1,76 @@
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+class HTTPClient;
+
+enum CircuitState : uint8_t {
+    CIRCUIT_CLOSED,     // peticiones normales
+    CIRCUIT_OPEN,       // se falla rápido sin tocar la red hasta que vence la espera
+    CIRCUIT_HALF_OPEN   // una sola petición de sonda decide si se cierra o se reabre
+};
+
+struct CircuitBreakerStats {
+    unsigned long failures;
+    unsigned long rejected;  // peticiones no enviadas por estar abierto
+    unsigned long opened;
+    unsigned long probes;
+
+    CircuitBreakerStats() : failures(0), rejected(0), opened(0), probes(0) {}
+};
+
+// Cortacircuitos de un endpoint del API. Tras failureThreshold fallos
+// seguidos (error de conexión, 429 o 5xx) se abre durante una espera con
+// jitter que se duplica con cada sonda fallida, de modo que una flota no
+// vuelve a la vez cuando el servidor se recupera. Al vencer, la primera
+// petición pasa como sonda y el resto sigue rechazándose hasta conocer su
+// resultado. Seguro desde varias tareas (red y trabajadores de actuación)
+class CircuitBreaker {
+public:
+    static const int REJECTED = -100;  // httpResponseCode de una petición no enviada
+    static const int DEFAULT_FAILURE_THRESHOLD = 3;
+    static const unsigned long DEFAULT_MIN_BACKOFF = 2000;
+    static const unsigned long DEFAULT_MAX_BACKOFF = 300000;
+    static const unsigned long PROBE_TIMEOUT = 30000;  // sonda sin resultado: se permite otra
+    static const unsigned long MAX_RETRY_AFTER = 3600000;  // tope ante cabeceras absurdas
+
+private:
+    const char* name;
+    mutable portMUX_TYPE lock;
+    CircuitState state;
+    int consecutiveFailures;
+    int failureThreshold;
+    unsigned long minBackoff;
+    unsigned long maxBackoff;
+    unsigned long backoff;
+    unsigned long openUntil;
+    unsigned long probeStarted;
+    CircuitBreakerStats stats;
+
+public:
+    explicit CircuitBreaker(const char* name);
+
+    void configure(int failureThreshold, unsigned long minBackoffMs, unsigned long maxBackoffMs);
+
+    // false: no enviar la petición. true en HALF_OPEN: esta petición es la sonda
+    bool allow(unsigned long now);
+
+    // Resultado de una petición permitida. Un Retry-After abre el circuito
+    // aunque no se haya llegado al umbral, y la espera no baja de él
+    void record(int httpResponseCode, unsigned long now, unsigned long retryAfterMs = 0);
+
+    static bool isFailure(int httpResponseCode);
+    // Retry-After (sólo en segundos) de una respuesta 429/503, en ms; 0 si no hay
+    static unsigned long retryAfterMs(HTTPClient* http, int httpResponseCode);
+
+    CircuitState getState() const;
+    const char* getName() const;
+    // ms hasta la próxima sonda (0 si no está abierto)
+    unsigned long getRetryIn(unsigned long now) const;
+    CircuitBreakerStats getStats() const;
+    void printStats() const;
+};
+
+#endif
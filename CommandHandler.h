@@ -1,11 +1,16 @@
 #ifndef COMMAND_HANDLER_H
 #define COMMAND_HANDLER_H
 
+#include <type_traits>
+
 struct Command {
     int id;
 
-    explicit Command(int commandId) : id(commandId) {}
-    bool operator==(const Command& other) const { return id == other.id; }
+    constexpr explicit Command(int commandId) : id(commandId) {}
+    // Desde un enum de ids tipado (enum class)
+    template <typename Id, typename = typename std::enable_if<std::is_enum<Id>::value>::type>
+    constexpr explicit Command(Id commandId) : id(static_cast<int>(commandId)) {}
+    constexpr bool operator==(const Command& other) const { return id == other.id; }
 };
 
 class CommandHandler {
@@ -0,0 +1,45 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "EventHandler.h"
+#include "CommandHandler.h"
+
+// Rangos de ids por dominio: los Command de Led y de GeoEntryDevice no se
+// solapan, así que un comando reenviado por Actuator nunca se confunde
+namespace MessageDomains {
+    const int LED_COMMANDS = 0x100;
+    const int GEOENTRY_EVENTS = 0x200;
+    const int GEOENTRY_COMMANDS = 0x300;
+}
+
+// Tabla de despacho O(1): el id (relativo al primer valor del enum Id)
+// indexa directamente un array de métodos de Owner. Se construye con make(),
+// constexpr, así que queda inicializada en compilación (en flash, sin código
+// de arranque). Los huecos se marcan con nullptr.
+template <typename Owner, typename Id, Id First, Id End>
+struct DispatchTable {
+    typedef void (Owner::*Handler)();
+    static const int SIZE = static_cast<int>(End) - static_cast<int>(First);
+
+    Handler handlers[SIZE];
+
+    // Una entrada por id, en el orden del enum: con una de menos el
+    // agregado dejaría el último id a nullptr sin avisar
+    template <typename... Entries>
+    static constexpr DispatchTable make(Entries... entries) {
+        static_assert(sizeof...(Entries) == SIZE, "DispatchTable necesita una entrada (o nullptr) por id");
+        return DispatchTable{{entries...}};
+    }
+
+    // false si el id no pertenece a la tabla o no tiene manejador
+    bool dispatch(Owner& owner, int id) const {
+        unsigned index = static_cast<unsigned>(id - static_cast<int>(First));
+        if (index >= static_cast<unsigned>(SIZE) || handlers[index] == nullptr) {
+            return false;
+        }
+        (owner.*handlers[index])();
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "EventBus.h"
+#include "Logger.h"
+
+EventBus::EventBus() : delivered(0), highWater(0) {}
+
+bool EventBus::post(EventHandler* handler, Event event) {
+    if (handler == nullptr) {
+        return false;
+    }
+    Entry entry = {handler, event.id};
+    return queue.push(entry);
+}
+
+int EventBus::dispatch(int maxEvents) {
+    size_t pending = queue.size();
+    if (pending > highWater) {
+        highWater = pending;
+    }
+
+    int count = 0;
+    Entry entry;
+    while (count < maxEvents && queue.pop(entry)) {
+        entry.handler->on(Event(entry.eventId));
+        count++;
+    }
+    delivered += count;
+    return count;
+}
+
+size_t EventBus::getPending() const {
+    return queue.size();
+}
+
+uint32_t EventBus::getOverflows() const {
+    return queue.getOverflows();
+}
+
+uint32_t EventBus::getDelivered() const {
+    return delivered;
+}
+
+uint32_t EventBus::getHighWater() const {
+    return highWater;
+}
+
+void EventBus::printStats() const {
+    LOG_INFO(STATS, "Bus de eventos: %lu entregados, %lu pendientes (máx: %lu/%lu, descartados: %lu)", delivered,
+             (unsigned long)getPending(), highWater, (unsigned long)CAPACITY, getOverflows());
+}
+
+DeferredEventHandler::DeferredEventHandler(EventBus& eventBus, EventHandler* eventTarget)
+    : bus(eventBus), target(eventTarget) {}
+
+void DeferredEventHandler::on(Event event) {
+    bus.post(target, event);
+}
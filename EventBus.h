@@ -0,0 +1,125 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "EventHandler.h"
+
+// Cola acotada sin locks para varios productores y un consumidor (esquema
+// de Vyukov: cada hueco lleva un número de secuencia). Los productores
+// reservan posición con un CAS sobre head; el consumidor avanza tail sin
+// atómicos. push() no bloquea nunca, así que sirve en callbacks de WiFi,
+// tareas de red o ISRs; si está llena descarta y cuenta el desbordamiento.
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity debe ser potencia de 2");
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    Slot slots[Capacity];
+    std::atomic<uint32_t> head;  // siguiente posición a reservar (productores)
+    uint32_t tail;               // siguiente posición a leer (sólo el consumidor)
+    std::atomic<uint32_t> overflows;
+
+public:
+    MpscQueue() : head(0), tail(0), overflows(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const T& value) {
+        uint32_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & (Capacity - 1)];
+            int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - position);
+            if (diff == 0) {
+                // Hueco libre: reservarlo (si otro productor se adelanta, position se actualiza)
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // El consumidor no ha liberado aún este hueco: cola llena
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Sólo desde el consumidor
+    bool pop(T& value) {
+        Slot& slot = slots[tail & (Capacity - 1)];
+        if ((int32_t)(slot.sequence.load(std::memory_order_acquire) - (tail + 1)) < 0) {
+            return false;  // vacía, o el productor aún está escribiendo este hueco
+        }
+        value = slot.value;
+        slot.sequence.store(tail + Capacity, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+    // Aproximado: incluye huecos reservados que aún se están escribiendo
+    size_t size() const {
+        return head.load(std::memory_order_relaxed) - tail;
+    }
+
+    uint32_t getOverflows() const {
+        return overflows.load(std::memory_order_relaxed);
+    }
+};
+
+// Bus de eventos: los productores encolan (evento, destinatario) desde
+// cualquier contexto y loop() los entrega con dispatch(), de modo que los
+// manejadores nunca se ejecutan dentro de la pila de una petición HTTP ni de
+// un callback del driver.
+class EventBus {
+public:
+    static const size_t CAPACITY = 32;
+
+private:
+    struct Entry {
+        EventHandler* handler;
+        int eventId;
+    };
+
+    MpscQueue<Entry, CAPACITY> queue;
+    uint32_t delivered;
+    uint32_t highWater;
+
+public:
+    EventBus();
+
+    // Seguro desde cualquier tarea o ISR; false si la cola está llena
+    bool post(EventHandler* handler, Event event);
+    // Entrega como mucho maxEvents; devuelve cuántos entregó
+    int dispatch(int maxEvents = 8);
+
+    size_t getPending() const;
+    uint32_t getOverflows() const;
+    uint32_t getDelivered() const;
+    uint32_t getHighWater() const;
+    void printStats() const;
+};
+
+// EventHandler que encola en el bus en lugar de entregar: se da a los
+// productores (p. ej. WiFiConnection) en lugar del destinatario real
+class DeferredEventHandler : public EventHandler {
+private:
+    EventBus& bus;
+    EventHandler* target;
+
+public:
+    DeferredEventHandler(EventBus& eventBus, EventHandler* eventTarget);
+
+    void on(Event event) override;
+};
+
+#endif
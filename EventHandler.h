@@ -1,11 +1,16 @@
 #ifndef EVENT_HANDLER_H
 #define EVENT_HANDLER_H
 
+#include <type_traits>
+
 struct Event {
     int id;
 
-    explicit Event(int eventId) : id(eventId) {}
-    bool operator==(const Event& other) const { return id == other.id; }
+    constexpr explicit Event(int eventId) : id(eventId) {}
+    // Desde un enum de ids tipado (enum class)
+    template <typename Id, typename = typename std::enable_if<std::is_enum<Id>::value>::type>
+    constexpr explicit Event(Id eventId) : id(static_cast<int>(eventId)) {}
+    constexpr bool operator==(const Event& other) const { return id == other.id; }
 };
 
 class EventHandler {
@@ -0,0 +1,241 @@
+#include "EventStreamClient.h"
+#include "HttpConnectionPool.h"
+#include "TlsClient.h"
+
+EventStreamClient::EventStreamClient(PushEventHandler* pushHandler)
+    : handler(pushHandler), client(nullptr), port(0), secure(false), state(DISABLED),
+      lineLength(0), lineOverflow(false), dataLength(0),
+      lastActivity(0), retryAt(0), retryDelay(MIN_RETRY_DELAY),
+      eventsReceived(0), resubscriptions(0) {
+    lastEventId[0] = '\0';
+}
+
+EventStreamClient::~EventStreamClient() {
+    stop();
+    delete client;
+}
+
+bool EventStreamClient::begin(const String& url) {
+    char newHost[HttpConnectionPool::MAX_HOST];
+    uint16_t newPort;
+    bool newSecure;
+    const char* newPath;
+    if (!HttpConnectionPool::parseURL(url.c_str(), newHost, sizeof(newHost), newPort, newSecure, &newPath)) {
+        return false;
+    }
+
+    stop();
+    if (client != nullptr && newSecure != secure) {
+        delete client;
+        client = nullptr;
+    }
+
+    host = newHost;
+    port = newPort;
+    secure = newSecure;
+    path = newPath;
+
+    state = WAITING;
+    retryAt = millis();
+    retryDelay = MIN_RETRY_DELAY;
+    return true;
+}
+
+void EventStreamClient::stop() {
+    if (client != nullptr) {
+        client->stop();
+    }
+    state = DISABLED;
+}
+
+void EventStreamClient::update(unsigned long now, bool networkUp) {
+    if (state == DISABLED) {
+        return;
+    }
+
+    if (!networkUp) {
+        if (state != WAITING) {
+            client->stop();
+            state = WAITING;
+        }
+        retryAt = now;
+        return;
+    }
+
+    if (state == WAITING) {
+        if ((long)(now - retryAt) >= 0) {
+            connect(now);
+        }
+        return;
+    }
+
+    // Leer una cantidad acotada por llamada para no acaparar el loop
+    size_t budget = MAX_BYTES_PER_UPDATE;
+    while (budget > 0 && client->available() > 0) {
+        int c = client->read();
+        if (c < 0) {
+            break;
+        }
+        budget--;
+        lastActivity = now;
+
+        if (c == '\n') {
+            line[lineLength] = '\0';
+            if (!lineOverflow) {
+                processLine(now);
+            }
+            lineLength = 0;
+            lineOverflow = false;
+            if (state == WAITING) {
+                return;  // processLine() rechazó la respuesta
+            }
+        } else if (c != '\r') {
+            if (lineLength < MAX_LINE - 1) {
+                line[lineLength++] = (char)c;
+            } else {
+                lineOverflow = true;
+            }
+        }
+    }
+
+    if (!client->connected() && client->available() == 0) {
+        fail(now);
+    } else if (now - lastActivity >= HEARTBEAT_TIMEOUT) {
+        // Sin datos ni heartbeat: la conexión está muerta aunque el socket siga abierto
+        fail(now);
+    }
+}
+
+void EventStreamClient::setHandler(PushEventHandler* pushHandler) {
+    handler = pushHandler;
+}
+
+EventStreamClient::State EventStreamClient::getState() const {
+    return state;
+}
+
+bool EventStreamClient::isSubscribed() const {
+    return state == SUBSCRIBED;
+}
+
+unsigned long EventStreamClient::getEventsReceived() const {
+    return eventsReceived;
+}
+
+unsigned long EventStreamClient::getResubscriptions() const {
+    return resubscriptions;
+}
+
+void EventStreamClient::connect(unsigned long now) {
+    if (client == nullptr) {
+        if (secure) {
+            client = TlsClient::createSecureClient();
+        } else {
+            client = new WiFiClient();
+        }
+    }
+
+    if (!client->connect(host.c_str(), port)) {
+        fail(now);
+        return;
+    }
+
+    // HTTP/1.0: el servidor no puede usar chunked y el stream dura hasta cerrar
+    String request = "GET " + path + " HTTP/1.0\r\n";
+    request += "Host: " + host + "\r\n";
+    request += "Accept: text/event-stream\r\n";
+    request += "Cache-Control: no-cache\r\n";
+    if (lastEventId[0] != '\0') {
+        request += "Last-Event-ID: ";
+        request += lastEventId;
+        request += "\r\n";
+    }
+    request += "\r\n";
+    client->print(request);
+
+    state = READING_HEADERS;
+    lineLength = 0;
+    lineOverflow = false;
+    dataLength = 0;
+    lastActivity = now;
+}
+
+void EventStreamClient::fail(unsigned long now) {
+    client->stop();
+    state = WAITING;
+    resubscriptions++;
+
+    // Backoff exponencial con jitter para no sincronizar la flota
+    retryAt = now + retryDelay + random(retryDelay / 2 + 1);
+    retryDelay = retryDelay * 2 > MAX_RETRY_DELAY ? MAX_RETRY_DELAY : retryDelay * 2;
+}
+
+void EventStreamClient::processLine(unsigned long now) {
+    if (state == READING_HEADERS) {
+        if (strncmp(line, "HTTP/", 5) == 0) {
+            const char* status = strchr(line, ' ');
+            if (status == nullptr || atoi(status + 1) != 200) {
+                fail(now);
+            }
+        } else if (lineLength == 0) {
+            state = SUBSCRIBED;
+            retryDelay = MIN_RETRY_DELAY;
+            if (handler != nullptr) {
+                handler->onPushSubscribed();
+            }
+        }
+        return;
+    }
+
+    if (lineLength == 0) {
+        // Línea vacía: fin del evento
+        dispatch();
+        return;
+    }
+
+    if (line[0] == ':') {
+        return;  // Comentario / heartbeat
+    }
+
+    char* value = strchr(line, ':');
+    if (value != nullptr) {
+        *value++ = '\0';
+        if (*value == ' ') {
+            value++;
+        }
+    } else {
+        value = line + lineLength;
+    }
+
+    if (strcmp(line, "data") == 0) {
+        size_t length = strlen(value);
+        if (dataLength > 0 && dataLength < MAX_LINE - 1) {
+            data[dataLength++] = '\n';
+        }
+        if (dataLength + length < MAX_LINE) {
+            memcpy(data + dataLength, value, length);
+            dataLength += length;
+        }
+    } else if (strcmp(line, "id") == 0) {
+        strncpy(lastEventId, value, sizeof(lastEventId) - 1);
+        lastEventId[sizeof(lastEventId) - 1] = '\0';
+    } else if (strcmp(line, "retry") == 0) {
+        unsigned long retry = strtoul(value, nullptr, 10);
+        if (retry >= MIN_RETRY_DELAY && retry <= MAX_RETRY_DELAY) {
+            retryDelay = retry;
+        }
+    }
+}
+
+void EventStreamClient::dispatch() {
+    if (dataLength == 0) {
+        return;
+    }
+
+    data[dataLength] = '\0';
+    dataLength = 0;
+    eventsReceived++;
+    if (handler != nullptr) {
+        handler->onPushEvent(data);
+    }
+}
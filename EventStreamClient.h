@@ -0,0 +1,76 @@
+#ifndef EVENT_STREAM_CLIENT_H
+#define EVENT_STREAM_CLIENT_H
+
+#include <WiFiClientSecure.h>
+
+// Receptor de los eventos entregados por push
+class PushEventHandler {
+public:
+    virtual void onPushEvent(const char* data) = 0;
+    virtual void onPushSubscribed() = 0;
+    virtual ~PushEventHandler() = default;
+};
+
+// Suscripción Server-Sent Events persistente. Se avanza desde update() sin
+// bloquear (salvo el propio connect()), detecta conexiones muertas por falta
+// de heartbeat y se vuelve a suscribir con backoff exponencial enviando
+// Last-Event-ID para no perder eventos.
+class EventStreamClient {
+public:
+    enum State {
+        DISABLED,
+        WAITING,          // esperando al siguiente intento de suscripción
+        READING_HEADERS,
+        SUBSCRIBED
+    };
+
+    static const unsigned long HEARTBEAT_TIMEOUT = 45000;
+    static const unsigned long MIN_RETRY_DELAY = 1000;
+    static const unsigned long MAX_RETRY_DELAY = 60000;
+    static const size_t MAX_LINE = 512;
+    static const size_t MAX_BYTES_PER_UPDATE = 512;
+
+private:
+    PushEventHandler* handler;
+    WiFiClient* client;
+    String host;
+    String path;
+    uint16_t port;
+    bool secure;
+
+    State state;
+    char line[MAX_LINE];
+    size_t lineLength;
+    bool lineOverflow;
+    char data[MAX_LINE];
+    size_t dataLength;
+    char lastEventId[64];
+
+    unsigned long lastActivity;
+    unsigned long retryAt;
+    unsigned long retryDelay;
+    unsigned long eventsReceived;
+    unsigned long resubscriptions;
+
+    void connect(unsigned long now);
+    void fail(unsigned long now);
+    void processLine(unsigned long now);
+    void dispatch();
+
+public:
+    EventStreamClient(PushEventHandler* pushHandler = nullptr);
+    ~EventStreamClient();
+
+    bool begin(const String& url);
+    void stop();
+    void update(unsigned long now, bool networkUp);
+
+    void setHandler(PushEventHandler* pushHandler);
+
+    State getState() const;
+    bool isSubscribed() const;
+    unsigned long getEventsReceived() const;
+    unsigned long getResubscriptions() const;
+};
+
+#endif
@@ -1,468 +1,780 @@
 #include "GeoEntryDevice.h"
+#include <LittleFS.h>
 
 GeoEntryDevice::GeoEntryDevice(const String& wifiSSID, const String& wifiPassword, 
                                const String& apiURL, const String& deviceID, const String& userID)
-    : ssid(wifiSSID), password(wifiPassword), serverURL(apiURL), deviceId(deviceID), userId(userID),
-      lastCheck(0), checkInterval(20000), lastSensorCheck(0), sensorCheckInterval(20000), 
-      lastEventId(""), userAtHome(false),
-      tvSensorActive(false), luzSensorActive(false), acSensorActive(false), cafeteraSensorActive(false),
-      lastLed1Blink(0), lastLed2Blink(0), led1BlinkState(false), led2BlinkState(false),
-      led1Pattern(0), led2Pattern(0) {
+    : wifi(wifiSSID, wifiPassword, GeoEntryEvents::WIFI_CONNECTED, GeoEntryEvents::WIFI_DISCONNECTED),
+      restTransport(apiURL, "https://geoentry-edge-api.onrender.com/", deviceID, userID),
+      transport(&restTransport),
+      networkTaskHandle(nullptr), controlTaskHandle(nullptr), networkUp(false),
+      deferredEvents(eventBus, this), appliedLedVersion(0),
+      checkInterval(20000), sensorCheckInterval(20000), statusInterval(DEFAULT_STATUS_INTERVAL),
+      adaptivePolling(true), pendingSettings(),
+      proximityTask(Scheduler::INVALID_TASK), sensorTask(Scheduler::INVALID_TASK),
+      statusTask(Scheduler::INVALID_TASK), journalTask(Scheduler::INVALID_TASK), userAtHome(false), eventSeenUs(0),
+      journalEnabled(true), actuationBatchFailed(false), geofences(MAX_HOME_LOCATIONS, MAX_HOME_VERTICES),
+      geofenceAtHome(false), positionKnown(false) {
+    lastEventId[0] = '\0';
     
     proximityLed = nullptr;
-    smartLed1 = nullptr;
-    smartLed2 = nullptr;
+    memset(&controlStats, 0, sizeof(controlStats));
+    // portMUX_INITIALIZER_UNLOCKED es un inicializador de llaves: no admite asignación directa
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    settingsLock = unlocked;
+    
+    // Asignación por defecto de SMART_LEDS: LED verde = TV/Luz, LED azul = AC/Cafetera
+    smartLeds.configure(SMART_LEDS, sensorRegistry);
 }
 
 GeoEntryDevice::~GeoEntryDevice() {
+    if (networkTaskHandle != nullptr) {
+        vTaskDelete(networkTaskHandle);
+    }
+    if (controlTaskHandle != nullptr) {
+        vTaskDelete(controlTaskHandle);
+    }
     delete proximityLed;
-    delete smartLed1;
-    delete smartLed2;
 }
 
 void GeoEntryDevice::init() {
     Serial.begin(115200);
-    Serial.println("Iniciando GeoEntry Device...");
+    // Los logs se vuelcan desde su propia tarea, fuera de red y control
+    Logger::begin(NETWORK_CORE, LOG_PRIORITY);
+    LOG_INFO(DEVICE, "Iniciando GeoEntry Device...");
     
     initializeLeds();
     
-    WiFi.begin(ssid.c_str(), password.c_str());
-    Serial.print("Conectando a WiFi");
+    if (journalEnabled) {
+        // formatOnFail: una partición nueva o dañada se formatea en vez de quedarse sin diario
+        if (!LittleFS.begin(true) || !journal.begin(LittleFS)) {
+            LOG_ERROR(DEVICE, "❌ LittleFS no disponible: el diario de actuaciones queda sólo en RAM");
+        }
+        // El cursor sobrevive al reinicio: no se vuelven a aplicar eventos ya procesados
+        if (journal.getLastEventId()[0] != '\0') {
+            snprintf(lastEventId, sizeof(lastEventId), "%s", journal.getLastEventId());
+            LOG_INFO(DEVICE, "📒 Último evento procesado: %s", lastEventId);
+        }
+    }
     
-    // Patrón de espera mientras conecta
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
-        smartLed1->handle(LedCommands::TOGGLE);
+    if (geofences.size() > 0 && geofences.build()) {
+        LOG_INFO(DEVICE, "📍 %d geovallas locales: enter/exit a partir de updatePosition()", geofences.size());
     }
     
-    // WiFi conectado - patrón de éxito
-    smartLed1->handle(LedCommands::TURN_ON);
-    smartLed2->handle(LedCommands::TURN_ON);
-    delay(1000);
-    smartLed1->handle(LedCommands::TURN_OFF);
-    smartLed2->handle(LedCommands::TURN_OFF);
+    LOG_INFO(DEVICE, "Transporte: %s", transport->getName());
+    transport->begin(this);
     
-    Serial.println();
-    Serial.println("WiFi conectado!");
-    Serial.print("Dirección IP: ");
-    Serial.println(WiFi.localIP());
+    // La conexión avanza en segundo plano; WIFI_CONNECTED llega desde la tarea CHECK_WIFI
+    unsigned long now = millis();
+    LOG_INFO(DEVICE, "Conectando a WiFi...");
+    // Los eventos de WiFi se encolan y los entrega la tarea de control
+    wifi.setHandler(&deferredEvents);
+    wifi.begin(now);
     
-    on(GeoEntryEvents::WIFI_CONNECTED);
+    // Programar las tareas cooperativas
+    proximityTask = scheduler.schedule(this, GeoEntryCommands::CHECK_PROXIMITY, now, 0, checkInterval);
+    sensorTask = scheduler.schedule(this, GeoEntryCommands::CHECK_SENSORS, now, 0, sensorCheckInterval);
+    scheduler.schedule(this, GeoEntryCommands::UPDATE_TRANSPORT, now, 0, TRANSPORT_UPDATE_INTERVAL);
+    scheduler.schedule(this, GeoEntryCommands::CHECK_WIFI, now, WIFI_CHECK_INTERVAL, WIFI_CHECK_INTERVAL);
+    if (statusInterval > 0) {
+        statusTask = scheduler.schedule(this, GeoEntryCommands::UPDATE_STATUS, now, statusInterval, statusInterval);
+    }
+    if (journalEnabled) {
+        journalTask = scheduler.schedule(this, GeoEntryCommands::REPLAY_JOURNAL, now, JOURNAL_REPLAY_INTERVAL,
+                                         JOURNAL_REPLAY_INTERVAL);
+    }
     
-    Serial.println("GeoEntry Device iniciado correctamente");
-    Serial.println("Monitoreando eventos de proximidad y sensores inteligentes...");
+    // Red en el núcleo 0 (junto a la pila WiFi), control en el núcleo 1
+    xTaskCreatePinnedToCore(networkTask, "geoentry_net", NETWORK_STACK_SIZE, this,
+                            NETWORK_PRIORITY, &networkTaskHandle, NETWORK_CORE);
+    xTaskCreatePinnedToCore(controlTask, "geoentry_ctrl", CONTROL_STACK_SIZE, this,
+                            CONTROL_PRIORITY, &controlTaskHandle, CONTROL_CORE);
+    
+    LOG_INFO(DEVICE, "GeoEntry Device iniciado correctamente");
+    LOG_INFO(DEVICE, "Monitoreando eventos de proximidad y sensores inteligentes...");
 }
 
 void GeoEntryDevice::initializeLeds() {
     proximityLed = new Led(2, false);  // LED rojo para proximidad
-    smartLed1 = new Led(4, false);     // LED verde para TV/Luz
-    smartLed2 = new Led(5, false);     // LED azul para AC/Cafetera
     
     proximityLed->turnOff(); 
-    smartLed1->turnOff();
-    smartLed2->turnOff();
+    if (!smartLeds.attach(SMART_LEDS, ledEngine)) {
+        LOG_ERROR(LEDS, "⚠️ No se pudieron configurar los canales LEDC de los LEDs inteligentes");
+    }
 } 
 
 void GeoEntryDevice::loop() {
-    if (WiFi.status() != WL_CONNECTED) {
-        on(GeoEntryEvents::WIFI_DISCONNECTED);
-        reconnectWiFi();
-        return;
+    // El trabajo lo hacen las tareas de red y de control; loop() sólo cede la CPU
+    vTaskDelay(pdMS_TO_TICKS(1000));
+}
+
+void GeoEntryDevice::networkTask(void* parameter) {
+    static_cast<GeoEntryDevice*>(parameter)->runNetwork();
+}
+
+void GeoEntryDevice::controlTask(void* parameter) {
+    static_cast<GeoEntryDevice*>(parameter)->runControl();
+}
+
+void GeoEntryDevice::runNetwork() {
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(networkStep(millis())));
     }
+}
+
+unsigned long GeoEntryDevice::networkStep(unsigned long now) {
+    METRIC_SCOPE(NETWORK_STEP);
+    
+    // Sondeos, transporte y WiFi; cada tarea es un paso corto
+    scheduler.run(now);
     
-    // Verificar eventos de proximidad
-    if (millis() - lastCheck >= checkInterval) {
-        handle(GeoEntryCommands::CHECK_PROXIMITY);
-        lastCheck = millis();
+    // Actuaciones pedidas por el control
+    int commandId;
+    while (networkCommands.pop(commandId)) {
+        handle(Command(commandId));
     }
     
-    // Verificar estados de sensores
-    if (millis() - lastSensorCheck >= sensorCheckInterval) {
-        handle(GeoEntryCommands::CHECK_SENSORS);
-        lastSensorCheck = millis();
+    // Posiciones para las geovallas locales, en orden (la histéresis depende de él)
+    PositionUpdate update;
+    while (positionUpdates.pop(update)) {
+        evaluatePosition(update);
     }
     
-    // Actualizar patrones de parpadeo de LEDs inteligentes
-    updateSmartLedPatterns();
+    // Dormir hasta la siguiente tarea, revisando la cola al menos cada NETWORK_MAX_IDLE
+    unsigned long wait = scheduler.timeUntilNext(millis());
+    if (wait > NETWORK_MAX_IDLE) {
+        wait = NETWORK_MAX_IDLE;
+    }
+    return wait > 0 ? wait : 1;
+}
+
+void GeoEntryDevice::runControl() {
+    TickType_t lastWake = xTaskGetTickCount();
+    unsigned long expected = micros();
     
-    delay(50); // Reducido para mejor respuesta de los patrones
+    for (;;) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_PERIOD));
+        
+        // Desviación respecto al instante teórico de esta activación
+        expected += CONTROL_PERIOD * 1000;
+        unsigned long now = micros();
+        long deviation = (long)(now - expected);
+        unsigned long jitter = deviation < 0 ? -deviation : deviation;
+        controlStats.ticks++;
+        controlStats.lastJitterUs = jitter;
+        controlStats.totalJitterUs += jitter;
+        if (jitter > controlStats.maxJitterUs) {
+            controlStats.maxJitterUs = jitter;
+        }
+        if (jitter >= CONTROL_PERIOD * 1000) {
+            controlStats.overruns++;
+            expected = now;
+        }
+        controlStatsSnapshot.publish(controlStats);
+        
+        controlStep();
+    }
 }
 
-void GeoEntryDevice::on(Event event) {
-    if (event == GeoEntryEvents::USER_ENTERED) {
-        Serial.println("🏠 Usuario ENTRÓ a casa");
-        setProximityStatus(true);
-        userAtHome = true;
-    } else if (event == GeoEntryEvents::USER_EXITED) {
-        Serial.println("🚶 Usuario SALIÓ de casa");
-        setProximityStatus(false);
-        userAtHome = false;
-    } else if (event == GeoEntryEvents::WIFI_CONNECTED) {
-        Serial.println("📶 WiFi conectado");
-        // Patrón de éxito en LEDs inteligentes
-        smartLed1->blink(2, 200);
-        smartLed2->blink(2, 200);
-    } else if (event == GeoEntryEvents::WIFI_DISCONNECTED) {
-        Serial.println("📶 WiFi desconectado");
-        // Apagar LEDs inteligentes cuando no hay WiFi
-        smartLed1->handle(LedCommands::TURN_OFF);
-        smartLed2->handle(LedCommands::TURN_OFF);
-    } else if (event == GeoEntryEvents::API_REQUEST_SUCCESS) {
-        // Breve destello para indicar comunicación exitosa
-    } else if (event == GeoEntryEvents::API_REQUEST_FAILED) {
-        // Patrón de error
-        smartLed1->blink(3, 100);
-        smartLed2->blink(3, 100);
+void GeoEntryDevice::controlStep() {
+    METRIC_SCOPE(CONTROL_STEP);
+    
+    // Entregar los eventos encolados por la red, el WiFi o las ISRs
+    eventBus.dispatch(EVENTS_PER_LOOP);
+    
+    // Recoger los patrones que la red haya publicado desde la última vez
+    if (ledSnapshot.getVersion() != appliedLedVersion) {
+        LedSnapshot snapshot;
+        appliedLedVersion = ledSnapshot.read(snapshot);
+        smartLeds.setPatterns(snapshot.patterns);
     }
+    
+    updateSmartLedPatterns();
+}
+
+void GeoEntryDevice::postNetworkCommand(Command command) {
+    if (!networkCommands.push(command.id)) {
+        LOG_WARN(DEVICE, "⚠️ Cola de comandos de red llena, comando descartado");
+    }
+}
+
+// Mismo orden que GeoEntryEventId; nullptr = evento sin acción
+const GeoEntryDevice::EventTable GeoEntryDevice::EVENTS = EventTable::make(
+    &GeoEntryDevice::onUserEntered,
+    &GeoEntryDevice::onUserExited,
+    &GeoEntryDevice::onWiFiConnected,
+    &GeoEntryDevice::onWiFiDisconnected,
+    nullptr,  // API_REQUEST_SUCCESS
+    &GeoEntryDevice::onApiRequestFailed);
+
+// Mismo orden que GeoEntryCommandId
+const GeoEntryDevice::CommandTable GeoEntryDevice::COMMANDS = CommandTable::make(
+    &GeoEntryDevice::checkProximityEvents,
+    &GeoEntryDevice::checkSensorStates,
+    &GeoEntryDevice::reconnectWiFi,
+    &GeoEntryDevice::resetSystem,
+    &GeoEntryDevice::updateSystemStatus,
+    &GeoEntryDevice::updateSmartLedPatterns,
+    &GeoEntryDevice::updateTransport,
+    &GeoEntryDevice::checkWiFi,
+    &GeoEntryDevice::turnOnAllSensorsOnEnter,
+    &GeoEntryDevice::turnOffAllSensorsOnExit,
+    &GeoEntryDevice::replayJournal,
+    &GeoEntryDevice::applySettings);
+
+void GeoEntryDevice::on(Event event) {
+    EVENTS.dispatch(*this, event.id);
 }
 
 void GeoEntryDevice::handle(Command command) {
-    if (command == GeoEntryCommands::CHECK_PROXIMITY) {
-        checkProximityEvents();
-    } else if (command == GeoEntryCommands::CHECK_SENSORS) {
-        checkSensorStates();
-    } else if (command == GeoEntryCommands::RECONNECT_WIFI) {
-        reconnectWiFi();
-    } else if (command == GeoEntryCommands::RESET_SYSTEM) {
-        ESP.restart();
-    } else if (command == GeoEntryCommands::UPDATE_STATUS) {
-        updateSystemStatus();
-    }
+    COMMANDS.dispatch(*this, command.id);
 }
 
-void GeoEntryDevice::checkProximityEvents() {
-    if (WiFi.status() != WL_CONNECTED) {
-        return;
-    }
+void GeoEntryDevice::onUserEntered() {
+    Metrics::record(METRIC_EVENT_TO_CONTROL, micros() - eventSeenUs);
+    LOG_INFO(DEVICE, "🏠 Usuario ENTRÓ a casa");
+    setProximityStatus(true);
+    userAtHome = true;
     
-    HTTPClient http;
-    String url = serverURL + "proximity-events/device/" + deviceId;
-    
-    http.begin(url.c_str());
-    http.addHeader("Content-Type", "application/json");
+    // 🔥 NUEVA LÓGICA: Encender todos los sensores automáticamente (en la tarea de red)
+    postNetworkCommand(GeoEntryCommands::ACTUATE_ENTER);
+    LOG_DEBUG(LEDS, "Estado del LED de Proximidad: ENCENDIDO");
+}
+
+void GeoEntryDevice::onUserExited() {
+    Metrics::record(METRIC_EVENT_TO_CONTROL, micros() - eventSeenUs);
+    LOG_INFO(DEVICE, "🚶 Usuario SALIÓ de casa");
+    setProximityStatus(false);
+    userAtHome = false;
     
-    Serial.println("Consultando: " + url);
+    // Apagar LEDs inmediatamente
+    updateSmartLedPatterns();
     
-    int httpResponseCode = http.GET();
+    // 🔥 NUEVA LÓGICA: Apagar todos los sensores automáticamente (en la tarea de red)
+    postNetworkCommand(GeoEntryCommands::ACTUATE_EXIT);
+    LOG_DEBUG(LEDS, "Estado del LED de Proximidad: APAGADO");
+}
+
+void GeoEntryDevice::onWiFiConnected() {
+    LOG_INFO(DEVICE, "📶 WiFi conectado - IP: %s", WiFi.localIP().toString());
+    networkUp = true;
+    // Patrón de éxito en LEDs inteligentes
+    flashSmartLeds(2, 200);
+}
+
+void GeoEntryDevice::onWiFiDisconnected() {
+    LOG_WARN(DEVICE, "📶 WiFi desconectado");
+    networkUp = false;
+    // Apagar LEDs inteligentes cuando no hay WiFi
+    updateSmartLedPatterns();
+}
+
+void GeoEntryDevice::onApiRequestFailed() {
+    // Patrón de error
+    flashSmartLeds(3, 100);
+}
+
+void GeoEntryDevice::reconnectWiFi() {
+    wifi.reconnect(millis());
+}
+
+void GeoEntryDevice::resetSystem() {
+    ESP.restart();
+}
+
+void GeoEntryDevice::updateTransport() {
+    transport->update(millis(), wifi.isConnected());
+}
+
+void GeoEntryDevice::checkWiFi() {
+    bool wasConnected = wifi.isConnected();
+    wifi.update(millis());
     
-    if (httpResponseCode > 0) {
-        String response = http.getString();
-        on(GeoEntryEvents::API_REQUEST_SUCCESS);
-        processProximityEvents(response);
-    } else {
-        Serial.printf("Error en petición HTTP: %d\n", httpResponseCode);
-        on(GeoEntryEvents::API_REQUEST_FAILED);
+    if (!wasConnected && wifi.isConnected()) {
+        // Sondear enseguida en lugar de esperar al siguiente intervalo
+        unsigned long now = millis();
+        scheduler.reschedule(proximityTask, now);
+        scheduler.reschedule(sensorTask, now);
+        if (journalTask != Scheduler::INVALID_TASK) {
+            scheduler.reschedule(journalTask, now);
+        }
     }
-    
-    http.end();
 }
 
-void GeoEntryDevice::processProximityEvents(String jsonResponse) {
-    DynamicJsonDocument doc(4096);
-    DeserializationError error = deserializeJson(doc, jsonResponse);
+void GeoEntryDevice::checkProximityEvents() {
+    if (!wifi.isConnected()) {
+        return;
+    }
     
-    if (error) {
-        Serial.print("Error parsing JSON: ");
-        Serial.println(error.c_str());
+    // Retry-After: no volver a llamar al servidor antes de lo que pidió
+    unsigned long now = millis();
+    unsigned long wait = polling.retryRemaining(now);
+    if (wait > 0) {
+        scheduler.reschedule(proximityTask, now + wait);
         return;
     }
     
-    if (doc.is<JsonArray>()) {
-        JsonArray events = doc.as<JsonArray>();
-        
-        if (events.size() > 0) {
-            JsonObject latestEvent = events[0];
-            processEvent(latestEvent);
-        } else {
-            Serial.println("No hay eventos de proximidad");
-        }
-    } else if (doc.is<JsonObject>()) {
-        // Si es un solo objeto
-        JsonObject event = doc.as<JsonObject>();
-        processEvent(event);
-    } else if (doc["data"].is<JsonArray>()) {
-        // Si viene encapsulado en un objeto con campo "data"
-        JsonArray events = doc["data"];
-        
-        for (JsonObject event : events) {
-            processEvent(event);
-        }
+    // El cursor viaja en la URL del sondeo REST ("?since=...")
+    static_assert(sizeof("?since=") - 1 + MAX_EVENT_ID - 1 <= HttpConnectionPool::MAX_URL_SUFFIX,
+                  "MAX_URL_SUFFIX no cubre el cursor de eventos");
+    transport->pollProximity(lastEventId);
+    
+    if (adaptivePolling) {
+        now = millis();
+        scheduler.reschedule(proximityTask, now + polling.onPoll(now));
     }
 }
 
 void GeoEntryDevice::processEvent(JsonObject event) {
-    String eventId = event["event_id"].as<String>();
-    if (eventId.isEmpty()) {
-        eventId = event["id"].as<String>();
-    }
-    
-    String eventType = event["event_type"].as<String>();
+    METRIC_SCOPE(PROCESS_EVENT);
     
-    String locationName = event["home_location_name"].as<String>();
-    if (locationName.isEmpty()) {
-        locationName = event["location_name"].as<String>();
+    const char* eventId = event["event_id"] | "";
+    if (eventId[0] == '\0') {
+        eventId = event["id"] | "";
     }
     
+    const char* eventType = event["event_type"] | "";
+    
+    const char* locationName = event["home_location_name"] | "";
     float distance = event["distance"];
-    String createdAt = event["created_at"].as<String>();
     
-    if (eventId == lastEventId) {
+    if (strcmp(eventId, lastEventId) == 0) {
         return;
     }
     
-    lastEventId = eventId;
+    snprintf(lastEventId, sizeof(lastEventId), "%s", eventId);
+    if (journalEnabled) {
+        journal.recordEvent(lastEventId);
+    }
+    
+    LOG_INFO(DEVICE, "Nuevo evento de proximidad: %s (%s)", eventType, eventId);
+    LOG_DEBUG(DEVICE, "Ubicación: %s, distancia: %.2f metros", locationName, distance);
     
-    Serial.println("=== NUEVO EVENTO DE PROXIMIDAD ===");
-    Serial.println("ID del evento: " + eventId);
-    Serial.println("Tipo de evento: " + eventType);
-    Serial.println("Ubicación: " + locationName);
-    if (distance > 0) {
-        Serial.println("Distancia: " + String(distance) + " metros");
+    bool entered = strcmp(eventType, "enter") == 0;
+    bool exited = strcmp(eventType, "exit") == 0;
+    if (positionKnown && ((entered && geofenceAtHome) || (exited && !geofenceAtHome))) {
+        // Las geovallas locales ya generaron este cambio
+        LOG_DEBUG(DEVICE, "Evento %s ya detectado por las geovallas locales", eventType);
+        return;
     }
-    if (!createdAt.isEmpty()) {
-        Serial.println("Fecha: " + createdAt);
+    if (entered || exited) {
+        geofenceAtHome = entered;
     }
-    Serial.println("================================");
     
-    if (eventType == "enter") {
-        on(GeoEntryEvents::USER_ENTERED);
-        Serial.println("🏠 USUARIO ENTRÓ A " + locationName + " - LED ROJO ENCENDIDO");
-        
-        // 🔥 NUEVA LÓGICA: Encender todos los sensores automáticamente
-        turnOnAllSensorsOnEnter();
-        
-    } else if (eventType == "exit") {
-        on(GeoEntryEvents::USER_EXITED);
-        Serial.println("🚪 USUARIO SALIÓ DE " + locationName + " - LED ROJO APAGADO");
-        
-        // 🔥 NUEVA LÓGICA: Apagar todos los sensores automáticamente
-        turnOffAllSensorsOnExit();
+    // Estamos dentro del transporte: LED y actuación se ejecutan al entregar
+    // el evento desde loop(), no en esta pila
+    eventSeenUs = micros();
+    if (entered) {
+        LOG_INFO(DEVICE, "🏠 USUARIO ENTRÓ A %s - LED ROJO ENCENDIDO", locationName);
+        polling.onStateChange(distance, millis());
+        deferredEvents.on(GeoEntryEvents::USER_ENTERED);
+    } else if (exited) {
+        LOG_INFO(DEVICE, "🚪 USUARIO SALIÓ DE %s - LED ROJO APAGADO", locationName);
+        polling.onStateChange(distance, millis());
+        deferredEvents.on(GeoEntryEvents::USER_EXITED);
     }
-    
-    Serial.println("Estado del LED de Proximidad: " + String(userAtHome ? "ENCENDIDO" : "APAGADO"));
-    Serial.println();
 }
 
-void GeoEntryDevice::reconnectWiFi() {
-    if (WiFi.status() == WL_CONNECTED) {
+void GeoEntryDevice::evaluatePosition(const PositionUpdate& update) {
+    METRIC_SCOPE(GEOFENCE);
+    
+    unsigned long ignored = geofences.getStats().ignored;
+    GeofenceTransition transitions[MAX_HOME_LOCATIONS];
+    int count = geofences.update(update.position, update.accuracyM, transitions, MAX_HOME_LOCATIONS);
+    if (geofences.getStats().ignored != ignored) {
+        LOG_DEBUG(DEVICE, "Posición descartada: precisión de %u m", (unsigned)update.accuracyM);
         return;
     }
     
-    Serial.println("Reconectando WiFi...");
-    WiFi.disconnect();
-    WiFi.begin(ssid.c_str(), password.c_str());
+    // En casa = dentro de alguna geovalla; pasar de una a otra no es un cambio
+    bool atHome = geofences.getInsideCount() > 0;
+    positionKnown = true;
+    if (atHome == geofenceAtHome) {
+        return;
+    }
+    geofenceAtHome = atHome;
     
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
+    const char* locationName = "";
+    for (int i = 0; i < count; i++) {
+        if (transitions[i].entered == atHome) {
+            locationName = geofences.getName(transitions[i].fence);
+            break;
+        }
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        on(GeoEntryEvents::WIFI_CONNECTED);
+    // Justo en el borde: el sondeo se acelera como con un evento del servidor
+    eventSeenUs = micros();
+    polling.onStateChange(polling.getConfig().geofenceRadiusM, millis());
+    if (atHome) {
+        LOG_INFO(DEVICE, "🏠 USUARIO ENTRÓ A %s (geovalla local) - LED ROJO ENCENDIDO", locationName);
+        deferredEvents.on(GeoEntryEvents::USER_ENTERED);
+    } else {
+        LOG_INFO(DEVICE, "🚪 USUARIO SALIÓ DE %s (geovalla local) - LED ROJO APAGADO", locationName);
+        deferredEvents.on(GeoEntryEvents::USER_EXITED);
+    }
+}
+
+void GeoEntryDevice::onProximityEvent(JsonObject event) {
+    processEvent(event);
+}
+
+void GeoEntryDevice::onTransportConnected() {
+    // Recuperar enseguida lo que llegó mientras no había canal
+    unsigned long now = millis();
+    scheduler.reschedule(proximityTask, now);
+    if (journalTask != Scheduler::INVALID_TASK) {
+        scheduler.reschedule(journalTask, now);
     }
 }
 
+void GeoEntryDevice::onRequestResult(bool success) {
+    deferredEvents.on(success ? GeoEntryEvents::API_REQUEST_SUCCESS : GeoEntryEvents::API_REQUEST_FAILED);
+}
+
+void GeoEntryDevice::onRetryAfter(unsigned long delayMs) {
+    polling.onRetryAfter(delayMs, millis());
+}
+
 void GeoEntryDevice::updateSystemStatus() {
     // Función mantenida para compatibilidad pero ya no usa LED de estado
     // Los LEDs inteligentes muestran ahora el estado del sistema
+    transport->printStatus();
+    if (adaptivePolling) {
+        LOG_INFO(STATS, "Sondeo de proximidad adaptativo: cada %lu ms (%s)", polling.getInterval(),
+                 polling.isNearEdge() ? "cerca del borde" : "lejos del borde");
+    } else {
+        LOG_INFO(STATS, "Sondeo de proximidad fijo: cada %lu ms", checkInterval);
+    }
+    if (journalEnabled) {
+        journal.printStats();
+    }
+    if (geofences.size() > 0) {
+        const GeofenceStats& stats = geofences.getStats();
+        LOG_INFO(STATS, "Geovallas locales: %lu posiciones (%lu descartadas), %lu evaluaciones, %lu cambios (%s)",
+                 stats.updates, stats.ignored, stats.evaluated, stats.transitions,
+                 geofenceAtHome ? "en casa" : "fuera");
+    }
+    eventBus.printStats();
+    Logger::printStats();
+    TlsClient::printStats();
+    Metrics::printStats();
+    
+    // Las escribe la tarea de control: copia coherente del último paso publicado
+    ControlLoopStats control;
+    controlStatsSnapshot.read(control);
+    unsigned long ticks = control.ticks > 0 ? control.ticks : 1;
+    LOG_INFO(STATS, "Tarea de control: %lu pasos de %lu ms (jitter medio: %lu us, máx: %lu us, desbordes: %lu)",
+             control.ticks, CONTROL_PERIOD, (unsigned long)(control.totalJitterUs / ticks),
+             control.maxJitterUs, control.overruns);
 }
 
 void GeoEntryDevice::checkSensorStates() {
-    if (WiFi.status() != WL_CONNECTED) {
+    if (!wifi.isConnected()) {
         return;
     }
     
-    HTTPClient http;
-    String url = "https://geoentry-edge-api.onrender.com/sensors/user/" + userId;
-    
-    http.begin(url.c_str());
-    http.addHeader("Content-Type", "application/json");
-    
-    Serial.println("Consultando sensores: " + url);
+    unsigned long now = millis();
+    unsigned long wait = polling.retryRemaining(now);
+    if (wait > 0) {
+        scheduler.reschedule(sensorTask, now + wait);
+        return;
+    }
     
-    int httpResponseCode = http.GET();
+    transport->pollSensors();
     
-    if (httpResponseCode > 0) {
-        String response = http.getString();
-        
-        processSensorStates(response);
-    } else {
-        Serial.printf("Error en petición de sensores: %d\n", httpResponseCode);
+    if (adaptivePolling && !userAtHome) {
+        // Fuera de casa los LEDs están apagados y enter revalida la caché
+        // antes de actuar: basta con sondear al techo del modo adaptativo
+        unsigned long away = polling.getConfig().maxIntervalMs;
+        scheduler.reschedule(sensorTask, millis() + (away > sensorCheckInterval ? away : sensorCheckInterval));
     }
-    
-    http.end();
 }
 
-void GeoEntryDevice::processSensorStates(String jsonResponse) {
-    DynamicJsonDocument doc(4096);
-    DeserializationError error = deserializeJson(doc, jsonResponse);
-    
-    if (error) {
-        Serial.print("Error parsing sensors JSON: ");
-        Serial.println(error.c_str());
-        return;
-    }
+void GeoEntryDevice::onSensorStatesBegin() {
+    // Cada instantánea es completa: se reconstruye el registro
+    sensorRegistry.clear();
+}
+
+void GeoEntryDevice::onSensorState(JsonObject sensor) {
+    const char* type = sensor["sensor_type"] | "";
+    bool isActive = sensor["isActive"] | false;
     
-    // Resetear estados
-    tvSensorActive = false;
-    luzSensorActive = false;
-    acSensorActive = false;
-    cafeteraSensorActive = false;
+    LOG_DEBUG(SENSORS, "Sensor: %s - %s", type, isActive ? "ACTIVO" : "INACTIVO");
     
-    JsonArray sensors;
-    if (doc.is<JsonArray>()) {
-        sensors = doc.as<JsonArray>();
-    } else if (doc["data"].is<JsonArray>()) {
-        sensors = doc["data"];
-    } else {
-        Serial.println("Formato de respuesta de sensores inesperado");
-        return;
+    if (!sensorRegistry.set(sensor["id"] | "", type, isActive)) {
+        LOG_ERROR(SENSORS, "❌ Registro de sensores lleno o id no válido, se ignora %s", type);
     }
-    
-    Serial.println("=== ESTADOS DE SENSORES ===");
-    for (JsonObject sensor : sensors) {
-        String name = sensor["name"].as<String>();
-        String type = sensor["sensor_type"].as<String>();
-        bool isActive = sensor["isActive"];
-        
-        Serial.println("Sensor: " + name + " (" + type + ") - " + (isActive ? "ACTIVO" : "INACTIVO"));
-        
-        // Mapear tipos de sensores correctos de la base de datos
-        if (type == "led_tv") {
-            tvSensorActive = isActive;
-        } else if (type == "smart_light") {
-            luzSensorActive = isActive;
-        } else if (type == "air_conditioner") {
-            acSensorActive = isActive;
-        } else if (type == "coffee_maker") {
-            cafeteraSensorActive = isActive;
-        }
+}
+
+void GeoEntryDevice::onSensorStatesEnd(bool complete) {
+    if (!complete) {
+        return;
     }
     
     calculateLedPatterns();
-    Serial.println("============================");
 }
 
 void GeoEntryDevice::calculateLedPatterns() {
-    Serial.println("=== CALCULANDO PATRONES DE LED ===");
-    Serial.println("Usuario en casa: " + String(userAtHome ? "SÍ" : "NO"));
+    // Cada LED combina los dos tipos de sensor que tiene asignados; fuera de
+    // casa se calculan igual pero updateSmartLedPatterns() los mantiene apagados.
+    // La tarea de control los recoge del snapshot en su siguiente paso
+    LedSnapshot snapshot;
+    smartLeds.compute(sensorRegistry, snapshot.patterns);
+    ledSnapshot.publish(snapshot);
     
     if (!userAtHome) {
         // ❌ USUARIO FUERA: Apagar todos los LEDs inteligentes
-        led1Pattern = 0; // OFF
-        led2Pattern = 0; // OFF
-        Serial.println("🚫 Usuario fuera de casa - LEDs inteligentes DESACTIVADOS");
-        Serial.println("   LED Verde: APAGADO (no importa estado de TV/Luz)");
-        Serial.println("   LED Azul: APAGADO (no importa estado de AC/Cafetera)");
+        LOG_DEBUG(LEDS, "🚫 Usuario fuera de casa - LEDs inteligentes DESACTIVADOS");
         return;
     }
     
     // ✅ USUARIO EN CASA: Activar patrones según sensores
-    Serial.println("🏠 Usuario en casa - Activando automatización:");
-    
-    // LED Verde: TV + Luz
-    led1Pattern = getLedPattern(tvSensorActive, luzSensorActive);
-    Serial.println("   LED Verde (TV/Luz): " + getPatternDescription(led1Pattern, "TV", "Luz"));
+    for (int channel = 0; channel < SMART_LED_CHANNELS; channel++) {
+        const LedChannelMapping& mapping = smartLeds.getMapping(channel);
+        LOG_DEBUG(LEDS, "LED %s: %s (%s%s %s%s)", smartLeds.getName(channel),
+                  LedPatterns::get(snapshot.patterns[channel]).name,
+                  mapping.primaryLabel, sensorRegistry.isTypeActive(mapping.primaryType) ? "✅" : "❌",
+                  mapping.secondaryLabel, sensorRegistry.isTypeActive(mapping.secondaryType) ? "✅" : "❌");
+    }
+}
+
+void GeoEntryDevice::updateSmartLedPatterns() {
+    METRIC_SCOPE(LED_UPDATE);
     
-    // LED Azul: AC + Cafetera  
-    led2Pattern = getLedPattern(acSensorActive, cafeteraSensorActive);
-    Serial.println("   LED Azul (AC/Cafetera): " + getPatternDescription(led2Pattern, "AC", "Cafetera"));
+    // Avanzar el parpadeo no bloqueante del LED de proximidad
+    proximityLed->update(millis());
     
-    Serial.println("=====================================");
+    // Los LEDs inteligentes los temporiza el LEDC: aquí sólo se publica el
+    // patrón vigente (el motor ignora los que no cambian). Usuario fuera o
+    // sin WiFi: forzar LEDs apagados
+    smartLeds.apply(ledEngine, userAtHome && networkUp);
 }
 
-int GeoEntryDevice::getLedPattern(bool sensor1, bool sensor2) {
-    if (!sensor1 && !sensor2) return 0;  // Ambos apagados = LED apagado
-    if (sensor1 && sensor2) return 1;     // Ambos encendidos = LED sólido
-    if (sensor1 && !sensor2) return 2;    // Solo sensor1 = parpadeo lento
-    if (!sensor1 && sensor2) return 3;    // Solo sensor2 = parpadeo rápido
-    return 0;
+void GeoEntryDevice::flashSmartLeds(uint8_t times, uint16_t halfPeriodMs) {
+    // El destello se superpone al patrón y al terminar se reanuda solo
+    smartLeds.flash(ledEngine, times, halfPeriodMs);
 }
 
-void GeoEntryDevice::updateSmartLedPatterns() {
-    unsigned long currentTime = millis();
-    
-    if (!userAtHome) {
-        // Usuario fuera: forzar LEDs apagados
-        smartLed1->setState(false);
-        smartLed2->setState(false);
+void GeoEntryDevice::setWiFiCredentials(const String& newSSID, const String& newPassword) {
+    wifi.setCredentials(newSSID, newPassword);
+}
+
+void GeoEntryDevice::setTransport(Transport* newTransport) {
+    transport = newTransport != nullptr ? newTransport : &restTransport;
+}
+
+void GeoEntryDevice::setAPIConfiguration(const String& url, const String& deviceID) {
+    restTransport.setAPIConfiguration(url, deviceID);
+}
+
+void GeoEntryDevice::setEdgeAPIConfiguration(const String& url) {
+    restTransport.setEdgeAPIConfiguration(url);
+}
+
+void GeoEntryDevice::enablePushEvents(bool enabled) {
+    if (networkTaskHandle == nullptr) {
+        restTransport.enablePushEvents(enabled);
         return;
     }
+    portENTER_CRITICAL(&settingsLock);
+    pendingSettings.pushEvents = enabled;
+    pendingSettings.changed |= SETTING_PUSH_EVENTS;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
+}
+
+void GeoEntryDevice::setUserConfiguration(const String& userID) {
+    restTransport.setUserConfiguration(userID);
+}
+
+// Antes de init() no hay tarea de red y los ajustes se aplican directamente;
+// después el scheduler, el sondeo y el transporte son suyos
+void GeoEntryDevice::setCheckInterval(unsigned long interval) {
+    if (networkTaskHandle == nullptr) {
+        applyCheckInterval(interval);
+        return;
+    }
+    portENTER_CRITICAL(&settingsLock);
+    pendingSettings.checkInterval = interval;
+    // Gana el último modo pedido
+    pendingSettings.changed = (pendingSettings.changed | SETTING_CHECK_INTERVAL) & ~SETTING_ADAPTIVE_POLLING;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
+}
+
+void GeoEntryDevice::setAdaptivePolling(const AdaptivePollingConfig& config) {
+    if (networkTaskHandle == nullptr) {
+        applyAdaptivePolling(config);
+        return;
+    }
+    portENTER_CRITICAL(&settingsLock);
+    pendingSettings.polling = config;
+    pendingSettings.changed = (pendingSettings.changed | SETTING_ADAPTIVE_POLLING) & ~SETTING_CHECK_INTERVAL;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
+}
+
+void GeoEntryDevice::setSensorCheckInterval(unsigned long interval) {
+    if (networkTaskHandle == nullptr) {
+        applySensorCheckInterval(interval);
+        return;
+    }
+    portENTER_CRITICAL(&settingsLock);
+    pendingSettings.sensorCheckInterval = interval;
+    pendingSettings.changed |= SETTING_SENSOR_INTERVAL;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
+}
+
+void GeoEntryDevice::setStatusInterval(unsigned long interval) {
+    if (networkTaskHandle == nullptr) {
+        applyStatusInterval(interval);
+        return;
+    }
+    portENTER_CRITICAL(&settingsLock);
+    pendingSettings.statusInterval = interval;
+    pendingSettings.changed |= SETTING_STATUS_INTERVAL;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
+}
+
+void GeoEntryDevice::applySettings() {
+    portENTER_CRITICAL(&settingsLock);
+    PendingSettings settings = pendingSettings;
+    pendingSettings.changed = 0;
+    pendingSettings.ledMappings = 0;
+    pendingSettings.ledPatterns = 0;
+    portEXIT_CRITICAL(&settingsLock);
     
-    // Usuario en casa: aplicar patrones normales
-    
-    // Manejar LED Verde (TV/Luz)
-    switch (led1Pattern) {
-        case 0: // Apagado
-            smartLed1->setState(false);
-            break;
-        case 1: // Sólido
-            smartLed1->setState(true);
-            break;
-        case 2: // Parpadeo lento (1000ms)
-            if (currentTime - lastLed1Blink >= 1000) {
-                led1BlinkState = !led1BlinkState;
-                smartLed1->setState(led1BlinkState);
-                lastLed1Blink = currentTime;
-            }
-            break;
-        case 3: // Parpadeo rápido (300ms)
-            if (currentTime - lastLed1Blink >= 300) {
-                led1BlinkState = !led1BlinkState;
-                smartLed1->setState(led1BlinkState);
-                lastLed1Blink = currentTime;
-            }
-            break;
+    if (settings.changed & SETTING_CHECK_INTERVAL) {
+        applyCheckInterval(settings.checkInterval);
+    }
+    if (settings.changed & SETTING_ADAPTIVE_POLLING) {
+        applyAdaptivePolling(settings.polling);
+    }
+    if (settings.changed & SETTING_SENSOR_INTERVAL) {
+        applySensorCheckInterval(settings.sensorCheckInterval);
+    }
+    if (settings.changed & SETTING_STATUS_INTERVAL) {
+        applyStatusInterval(settings.statusInterval);
+    }
+    if (settings.changed & SETTING_PUSH_EVENTS) {
+        restTransport.enablePushEvents(settings.pushEvents);
     }
     
-    // Manejar LED Azul (AC/Cafetera)
-    switch (led2Pattern) {
-        case 0: // Apagado
-            smartLed2->setState(false);
-            break;
-        case 1: // Sólido
-            smartLed2->setState(true);
-            break;
-        case 2: // Parpadeo lento (1000ms)
-            if (currentTime - lastLed2Blink >= 1000) {
-                led2BlinkState = !led2BlinkState;
-                smartLed2->setState(led2BlinkState);
-                lastLed2Blink = currentTime;
+    // Primero las asignaciones (recalculan todos los LEDs) y después los
+    // patrones fijados, que duran hasta el siguiente recálculo
+    if (settings.ledMappings != 0) {
+        for (int channel = 0; channel < SMART_LED_CHANNELS; channel++) {
+            const PendingLedMapping& mapping = settings.mappings[channel];
+            if ((settings.ledMappings & (1 << channel)) &&
+                !smartLeds.setMapping(channel, sensorRegistry, mapping.primaryType, mapping.secondaryType,
+                                      mapping.primaryLabel, mapping.secondaryLabel)) {
+                LOG_ERROR(LEDS, "❌ LED %s: no caben más tipos de sensor en el registro", smartLeds.getName(channel));
             }
-            break;
-        case 3: // Parpadeo rápido (300ms)
-            if (currentTime - lastLed2Blink >= 300) {
-                led2BlinkState = !led2BlinkState;
-                smartLed2->setState(led2BlinkState);
-                lastLed2Blink = currentTime;
-            }
-            break;
+        }
+        calculateLedPatterns();
+    }
+    for (int channel = 0; channel < SMART_LED_CHANNELS; channel++) {
+        if (settings.ledPatterns & (1 << channel)) {
+            applySmartLedPattern(channel, settings.patterns[channel]);
+        }
     }
 }
 
-void GeoEntryDevice::setWiFiCredentials(const String& newSSID, const String& newPassword) {
-    ssid = newSSID;
-    password = newPassword;
+void GeoEntryDevice::applyCheckInterval(unsigned long interval) {
+    checkInterval = interval;
+    adaptivePolling = false;
+    scheduler.setPeriod(proximityTask, millis(), interval);
 }
 
-void GeoEntryDevice::setAPIConfiguration(const String& url, const String& deviceID) {
-    serverURL = url;
-    deviceId = deviceID;
+void GeoEntryDevice::applyAdaptivePolling(const AdaptivePollingConfig& config) {
+    polling.configure(config);
+    adaptivePolling = true;
+    scheduler.reschedule(proximityTask, millis());
 }
 
-void GeoEntryDevice::setUserConfiguration(const String& userID) {
-    userId = userID;
+void GeoEntryDevice::applySensorCheckInterval(unsigned long interval) {
+    sensorCheckInterval = interval;
+    scheduler.setPeriod(sensorTask, millis(), interval);
 }
 
-void GeoEntryDevice::setCheckInterval(unsigned long interval) {
-    checkInterval = interval;
+void GeoEntryDevice::applyStatusInterval(unsigned long interval) {
+    statusInterval = interval;
+    if (statusTask != Scheduler::INVALID_TASK && interval == 0) {
+        scheduler.cancel(statusTask);
+        statusTask = Scheduler::INVALID_TASK;
+    } else if (statusTask != Scheduler::INVALID_TASK) {
+        scheduler.setPeriod(statusTask, millis(), interval);
+    } else if (interval > 0 && networkTaskHandle != nullptr) {
+        statusTask = scheduler.schedule(this, GeoEntryCommands::UPDATE_STATUS, millis(), interval, interval);
+    }
 }
 
-void GeoEntryDevice::setSensorCheckInterval(unsigned long interval) {
-    sensorCheckInterval = interval;
+void GeoEntryDevice::setActuationLimits(int maxInFlight, unsigned long minIntervalMs) {
+    restTransport.setActuationLimits(maxInFlight, minIntervalMs);
+}
+
+void GeoEntryDevice::setActuationJournal(bool enabled) {
+    journalEnabled = enabled;
+}
+
+bool GeoEntryDevice::addHomeLocation(const char* name, double latitude, double longitude, uint32_t radiusM) {
+    GeoPoint center = {(int32_t)lround(latitude * 1e6), (int32_t)lround(longitude * 1e6)};
+    return geofences.addCircle(name, center, radiusM) >= 0;
+}
+
+bool GeoEntryDevice::addHomeArea(const char* name, const GeoPoint* vertices, int vertexCount) {
+    return geofences.addPolygon(name, vertices, vertexCount) >= 0;
+}
+
+void GeoEntryDevice::setGeofenceConfig(const GeofenceConfig& config) {
+    geofences.configure(config);
+}
+
+bool GeoEntryDevice::updatePosition(double latitude, double longitude, float accuracyM) {
+    PositionUpdate update;
+    update.position.latE6 = (int32_t)lround(latitude * 1e6);
+    update.position.lonE6 = (int32_t)lround(longitude * 1e6);
+    update.accuracyM = accuracyM <= 0 ? 0 : (accuracyM >= UINT16_MAX ? UINT16_MAX : (uint16_t)lroundf(accuracyM));
+    return positionUpdates.push(update);
+}
+
+void GeoEntryDevice::setSensorCacheMaxAge(unsigned long ms) {
+    restTransport.setSensorCacheMaxAge(ms);
+}
+
+void GeoEntryDevice::setCircuitBreaker(int failureThreshold, unsigned long minBackoffMs,
+                                       unsigned long maxBackoffMs) {
+    restTransport.setCircuitBreaker(failureThreshold, minBackoffMs, maxBackoffMs);
+}
+
+bool GeoEntryDevice::setTlsTrustAnchor(const char* pem) {
+    return TlsClient::setTrustAnchor(pem);
+}
+
+bool GeoEntryDevice::setLedChannelMapping(int channel, const char* primaryType, const char* secondaryType,
+                                          const char* primaryLabel, const char* secondaryLabel) {
+    if (networkTaskHandle == nullptr) {
+        return smartLeds.setMapping(channel, sensorRegistry, primaryType, secondaryType, primaryLabel,
+                                    secondaryLabel);
+    }
+    
+    // Las asignaciones y el registro son de la tarea de red
+    if (channel < 0 || channel >= SMART_LED_CHANNELS || primaryType == nullptr || secondaryType == nullptr ||
+        primaryType[0] == '\0' || secondaryType[0] == '\0' ||
+        strlen(primaryType) >= SensorRegistry::MAX_TYPE_NAME || strlen(secondaryType) >= SensorRegistry::MAX_TYPE_NAME) {
+        return false;
+    }
+    portENTER_CRITICAL(&settingsLock);
+    PendingLedMapping& mapping = pendingSettings.mappings[channel];
+    strcpy(mapping.primaryType, primaryType);
+    strcpy(mapping.secondaryType, secondaryType);
+    mapping.primaryLabel = primaryLabel;
+    mapping.secondaryLabel = secondaryLabel;
+    pendingSettings.ledMappings |= 1 << channel;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
+    return true;
 }
 
 bool GeoEntryDevice::isUserAtHome() const {
@@ -470,11 +782,45 @@ bool GeoEntryDevice::isUserAtHome() const {
 }
 
 bool GeoEntryDevice::isWiFiConnected() const {
-    return WiFi.status() == WL_CONNECTED;
+    return wifi.isConnected();
 }
 
 String GeoEntryDevice::getLastEventId() const {
-    return lastEventId;
+    return String(lastEventId);
+}
+
+const PollStats& GeoEntryDevice::getProximityPollStats() const {
+    return restTransport.getProximityPollStats();
+}
+
+const PollStats& GeoEntryDevice::getSensorPollStats() const {
+    return restTransport.getSensorPollStats();
+}
+
+const SensorCacheStats& GeoEntryDevice::getSensorCacheStats() const {
+    return transport->getSensorCache().getStats();
+}
+
+const ActuationJournal& GeoEntryDevice::getActuationJournal() const {
+    return journal;
+}
+
+const GeofenceEngine& GeoEntryDevice::getGeofences() const {
+    return geofences;
+}
+
+const SensorRegistry& GeoEntryDevice::getSensorRegistry() const {
+    return sensorRegistry;
+}
+
+const EventBus& GeoEntryDevice::getEventBus() const {
+    return eventBus;
+}
+
+ControlLoopStats GeoEntryDevice::getControlLoopStats() const {
+    ControlLoopStats stats;
+    controlStatsSnapshot.read(stats);
+    return stats;
 }
 
 void GeoEntryDevice::setProximityStatus(bool atHome) {
@@ -485,215 +831,191 @@ void GeoEntryDevice::setProximityStatus(bool atHome) {
     }
 }
 
-void GeoEntryDevice::setSmartLed1Pattern(int pattern) {
-    led1Pattern = pattern;
+void GeoEntryDevice::setSmartLedPattern(int channel, int pattern) {
+    if (channel < 0 || channel >= SMART_LED_CHANNELS) {
+        return;
+    }
+    if (networkTaskHandle == nullptr) {
+        applySmartLedPattern(channel, pattern);
+        return;
+    }
+    portENTER_CRITICAL(&settingsLock);
+    pendingSettings.patterns[channel] = pattern;
+    pendingSettings.ledPatterns |= 1 << channel;
+    portEXIT_CRITICAL(&settingsLock);
+    postNetworkCommand(GeoEntryCommands::APPLY_SETTINGS);
 }
 
-void GeoEntryDevice::setSmartLed2Pattern(int pattern) {
-    led2Pattern = pattern;
+// Como calculateLedPatterns(): los patrones llegan a la tarea de control
+// por el snapshot, del que la red es el único escritor
+void GeoEntryDevice::applySmartLedPattern(int channel, uint8_t pattern) {
+    LedSnapshot snapshot;
+    ledSnapshot.read(snapshot);
+    snapshot.patterns[channel] = pattern;
+    ledSnapshot.publish(snapshot);
+}
+
+uint8_t GeoEntryDevice::getSmartLedPattern(int channel) const {
+    if (channel < 0 || channel >= SMART_LED_CHANNELS) {
+        return LED_PATTERN_OFF;
+    }
+    LedSnapshot snapshot;
+    ledSnapshot.read(snapshot);
+    return snapshot.patterns[channel];
 }
 
 void GeoEntryDevice::turnOnAllSensorsOnEnter() {
-    Serial.println("🏠 USUARIO ENTRÓ - Encendiendo todos los sensores automáticamente...");
-    
-    HTTPClient http;
-    String url = "https://geoentry-edge-api.onrender.com/sensors/user/" + userId;
-    
-    http.begin(url.c_str());
-    http.addHeader("Content-Type", "application/json");
+    METRIC_SCOPE(ACTUATE_ENQUEUE);
     
-    Serial.println("📋 Consultando sensores del usuario: " + url);
+    LOG_INFO(DEVICE, "🏠 USUARIO ENTRÓ - Encendiendo todos los sensores automáticamente...");
     
-    int httpResponseCode = http.GET();
+    // Encender TODOS los sensores a través del transporte activo
+    int sensorsActivated = actuateAllSensors(true);
     
-    if (httpResponseCode == 200) {
-        String response = http.getString();
-        Serial.println("📋 Sensores obtenidos para encender: " + response);
-        
-        // Parsear y encender TODOS los sensores
-        DynamicJsonDocument doc(2048);
-        DeserializationError error = deserializeJson(doc, response);
-        
-        if (error) {
-            Serial.print("❌ Error parsing JSON: ");
-            Serial.println(error.c_str());
-            http.end();
-            return;
-        }
-        
-        JsonArray sensors;
-        if (doc.is<JsonArray>()) {
-            sensors = doc.as<JsonArray>();
-        } else if (doc["data"].is<JsonArray>()) {
-            sensors = doc["data"];
-        } else {
-            Serial.println("❌ Formato de respuesta inesperado");
-            http.end();
-            return;
-        }
-        
-        int sensorsActivated = 0;
-        for (JsonObject sensor : sensors) {
-            String sensorId = sensor["id"];
-            String sensorType = sensor["sensor_type"];
-            String sensorName = sensor["name"];
-            bool isActive = sensor["isActive"];
-            
-            if (!isActive) {
-                // Encender este sensor
-                turnOnSensor(sensorId, sensorType);
-                sensorsActivated++;
-                delay(300); // Esperar entre llamadas para no saturar API
-            } else {
-                Serial.println("✅ " + sensorName + " (" + sensorType + ") ya estaba encendido");
-            }
-        }
-        
-        if (sensorsActivated > 0) {
-            Serial.println("🎉 Se encendieron " + String(sensorsActivated) + " sensores automáticamente");
-            
-            // Esperar un poco y consultar estados actualizados
-            delay(1000);
-            checkSensorStates();
-        } else {
-            Serial.println("ℹ️ Todos los sensores ya estaban encendidos");
-        }
-        
+    if (sensorsActivated > 0) {
+        LOG_INFO(DEVICE, "🎉 Encendiendo %d sensores automáticamente", sensorsActivated);
+    } else if (sensorsActivated == 0) {
+        LOG_INFO(DEVICE, "ℹ️ Todos los sensores ya estaban encendidos");
     } else {
-        Serial.println("❌ Error obteniendo sensores para encender: " + String(httpResponseCode));
+        LOG_ERROR(DEVICE, "❌ No se pudieron encender los sensores");
     }
-    
-    http.end();
 }
 
 void GeoEntryDevice::turnOffAllSensorsOnExit() {
-    Serial.println("🚨 USUARIO SALIÓ - Apagando todos los sensores automáticamente...");
+    METRIC_SCOPE(ACTUATE_ENQUEUE);
     
-    HTTPClient http;
-    String url = "https://geoentry-edge-api.onrender.com/sensors/user/" + userId;
+    LOG_INFO(DEVICE, "🚨 USUARIO SALIÓ - Apagando todos los sensores automáticamente...");
     
-    http.begin(url.c_str());
-    http.addHeader("Content-Type", "application/json");
+    // Apagar los sensores activos a través del transporte activo
+    int sensorsDeactivated = actuateAllSensors(false);
     
-    int httpResponseCode = http.GET();
-    
-    if (httpResponseCode == 200) {
-        String response = http.getString();
-        Serial.println("📋 Sensores obtenidos para apagar: " + response);
-        
-        // Parsear y apagar sensores activos
-        DynamicJsonDocument doc(2048);
-        DeserializationError error = deserializeJson(doc, response);
-        
-        if (error) {
-            Serial.print("❌ Error parsing JSON: ");
-            Serial.println(error.c_str());
-            http.end();
-            return;
-        }
-        
-        JsonArray sensors;
-        if (doc.is<JsonArray>()) {
-            sensors = doc.as<JsonArray>();
-        } else if (doc["data"].is<JsonArray>()) {
-            sensors = doc["data"];
-        } else {
-            Serial.println("❌ Formato de respuesta inesperado");
-            http.end();
-            return;
-        }
-        
-        int sensorsDeactivated = 0;
-        for (JsonObject sensor : sensors) {
-            String sensorId = sensor["id"];
-            String sensorType = sensor["sensor_type"];
-            String sensorName = sensor["name"];
-            bool isActive = sensor["isActive"];
-            
-            if (isActive) {
-                // Apagar este sensor
-                turnOffSensor(sensorId, sensorType);
-                sensorsDeactivated++;
-                delay(300); // Esperar entre llamadas
-            }
-        }
-        
-        Serial.println("🔒 Se apagaron " + String(sensorsDeactivated) + " sensores por seguridad");
-        
+    if (sensorsDeactivated >= 0) {
+        LOG_INFO(DEVICE, "🔒 Apagando %d sensores por seguridad", sensorsDeactivated);
+    } else if (journalEnabled) {
+        LOG_ERROR(DEVICE, "❌ No se pudieron apagar los sensores: queda en el diario para reintentarlo");
     } else {
-        Serial.println("❌ Error obteniendo sensores para apagar: " + String(httpResponseCode));
+        LOG_ERROR(DEVICE, "❌ No se pudieron apagar los sensores");
     }
     
-    http.end();
+    // Actualizar estados locales inmediatamente (el diario lleva el servidor al mismo estado)
+    sensorRegistry.setAllInactive();
     
-    // Actualizar estados locales inmediatamente
-    tvSensorActive = false;
-    luzSensorActive = false;
-    acSensorActive = false;
-    cafeteraSensorActive = false;
-    
-    // Apagar LEDs inmediatamente
-    led1Pattern = 0;
-    led2Pattern = 0;
-    updateSmartLedPatterns();
+    // Patrones apagados para cuando el usuario vuelva (el control ya los apagó)
+    LedSnapshot allOff = {};
+    ledSnapshot.publish(allOff);
     
-    Serial.println("🏠 Casa completamente apagada por seguridad");
+    LOG_INFO(DEVICE, "🏠 Casa completamente apagada por seguridad");
 }
 
-void GeoEntryDevice::turnOnSensor(String sensorId, String sensorType) {
-    Serial.println("🔌 Encendiendo sensor: " + sensorType + " (ID: " + sensorId + ")");
-    
-    HTTPClient http;
-    String url = "https://geoentry-edge-api.onrender.com/sensors/" + sensorId + "/status";
-    
-    http.begin(url.c_str());
-    http.addHeader("Content-Type", "application/json");
-    
-    // Body para encender sensor
-    String jsonBody = "{\"isActive\": true}";
-    
-    // Usar sendRequest para PATCH ya que no todos los ESP32 tienen PATCH directo
-    int httpResponseCode = http.sendRequest("PATCH", jsonBody);
-    
-    if (httpResponseCode == 200) {
-        Serial.println("✅ " + sensorType + " encendido exitosamente");
-    } else {
-        Serial.println("❌ Error encendiendo " + sensorType + ": " + String(httpResponseCode));
+int GeoEntryDevice::actuateAllSensors(bool targetState) {
+    if (!journalEnabled) {
+        return transport->actuateAll(targetState);
     }
     
-    http.end();
+    // La intención llega a flash antes que el primer PATCH
+    journal.recordActuateAll(targetState);
+    int count = transport->actuateAll(targetState);
+    journal.actuateAllSent(count);
+    return count;
 }
 
-void GeoEntryDevice::turnOffSensor(String sensorId, String sensorType) {
-    Serial.println("🔌 Apagando sensor: " + sensorType + " (ID: " + sensorId + ")");
-    
-    HTTPClient http;
-    String url = "https://geoentry-edge-api.onrender.com/sensors/" + sensorId + "/status";
-    
-    http.begin(url.c_str());
-    http.addHeader("Content-Type", "application/json");
+// true si la caché, vigente, ya muestra el sensor en targetState
+static bool cacheShows(const SensorCache& cache, const char* sensorId, bool targetState) {
+    if (!cache.isFresh(millis())) {
+        return false;
+    }
+    for (int i = 0; i < cache.getCapacity(); i++) {
+        const CachedSensor* sensor = cache.get(i);
+        if (sensor != nullptr && strcmp(sensor->id, sensorId) == 0) {
+            return sensor->isActive == targetState;
+        }
+    }
+    return false;
+}
+
+void GeoEntryDevice::replayJournal() {
+    if (!journalEnabled) {
+        return;
+    }
     
-    // Body para apagar sensor
-    String jsonBody = "{\"isActive\": false}";
+    // Eventos y fallos acumulados llegan a flash como mucho una vez por intervalo
+    journal.flush();
+    if (!wifi.isConnected() || !journal.hasPending()) {
+        return;
+    }
     
-    // Usar sendRequest para PATCH ya que no todos los ESP32 tienen PATCH directo
-    int httpResponseCode = http.sendRequest("PATCH", jsonBody);
+    bool targetState;
+    if (journal.takeActuateAll(targetState)) {
+        LOG_INFO(DEVICE, "📒 Diario: reenviando %s de todos los sensores", targetState ? "encendido" : "apagado");
+        journal.actuateAllSent(transport->actuateAll(targetState));
+        return;
+    }
     
-    if (httpResponseCode == 200) {
-        Serial.println("✅ " + sensorType + " apagado exitosamente");
+    // Sólo la última orden de cada sensor, y no si el servidor ya la refleja
+    const SensorCache& cache = transport->getSensorCache();
+    JournalCommand command;
+    int sent = 0;
+    while (sent < JOURNAL_REPLAY_BATCH && journal.takeCommand(command)) {
+        if (cacheShows(cache, command.sensorId, command.targetState)) {
+            journal.recordSuccess(command.sensorId, command.targetState);
+            continue;
+        }
+        LOG_INFO(DEVICE, "📒 Diario: reenviando %s de %s", command.targetState ? "encendido" : "apagado",
+                 command.sensorType);
+        if (!transport->actuate(command.sensorId, command.sensorType, command.targetState)) {
+            journal.releaseCommand(command.sensorId);
+            break;
+        }
+        sent++;
+    }
+    journal.flush();
+}
+
+void GeoEntryDevice::onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) {
+    if (result.httpResponseCode == 200) {
+        LOG_INFO(DEVICE, "✅ %s %s exitosamente (%lu ms)", result.sensorType,
+                 result.targetState ? "encendido" : "apagado", result.durationMs);
+    } else if (result.httpResponseCode == CircuitBreaker::REJECTED) {
+        LOG_WARN(DEVICE, "⛔ %s sin %s: API en pausa", result.sensorType,
+                 result.targetState ? "encender" : "apagar");
+    } else if (result.httpResponseCode == ActuationResult::URL_TOO_LONG) {
+        LOG_ERROR(DEVICE, "⚙️ %s sin %s: la URL del API configurada es demasiado larga", result.sensorType,
+                  result.targetState ? "encender" : "apagar");
+    } else if (result.httpResponseCode == ActuationResult::NOT_QUEUED) {
+        LOG_WARN(DEVICE, "📥 %s sin %s: cola de actuación llena, queda en el diario", result.sensorType,
+                 result.targetState ? "encender" : "apagar");
+    } else if (result.httpResponseCode == ActuationResult::UNCONFIRMED) {
+        LOG_WARN(DEVICE, "⏳ %s sin confirmar: el broker tiene la orden de %s pero el sensor no respondió",
+                 result.sensorType, result.targetState ? "encender" : "apagar");
     } else {
-        Serial.println("❌ Error apagando " + sensorType + ": " + String(httpResponseCode));
+        LOG_ERROR(DEVICE, "❌ Error %s %s: %d", result.targetState ? "encendiendo" : "apagando",
+                  result.sensorType, result.httpResponseCode);
     }
     
-    http.end();
-}
-
-String GeoEntryDevice::getPatternDescription(int pattern, String sensor1, String sensor2) {
-    switch(pattern) {
-        case 0: return "APAGADO (" + sensor1 + "❌ " + sensor2 + "❌)";
-        case 1: return "SÓLIDO (" + sensor1 + "✅ " + sensor2 + "✅)";
-        case 2: return "PARPADEO LENTO (" + sensor1 + "✅ " + sensor2 + "❌)";
-        case 3: return "PARPADEO RÁPIDO (" + sensor1 + "❌ " + sensor2 + "✅)";
-        default: return "DESCONOCIDO";
+    if (journalEnabled) {
+        if (result.httpResponseCode == 200) {
+            journal.recordSuccess(result.sensorId, result.targetState);
+        } else {
+            journal.recordFailure(result.sensorId, result.sensorType, result.targetState);
+            // Lo que no cupo en la cola se reenvía en cuanto se vacíe el lote
+            if (result.httpResponseCode != ActuationResult::NOT_QUEUED) {
+                actuationBatchFailed = true;
+            }
+        }
+    }
+    
+    if (result.batchComplete) {
+        Metrics::record(METRIC_ACTUATION_BATCH, batchDurationMs * 1000);
+        LOG_INFO(DEVICE, "⏱️ Lote de actuación completado en %lu ms", batchDurationMs);
+        
+        if (journalEnabled) {
+            journal.completeBatch();
+            journal.flush();
+            // Lote limpio con órdenes aún pendientes: seguir vaciando el diario
+            if (!actuationBatchFailed && journal.hasPending() && journalTask != Scheduler::INVALID_TASK) {
+                scheduler.reschedule(journalTask, millis());
+            }
+            actuationBatchFailed = false;
+        }
     }
 }
@@ -2,62 +2,241 @@
 #define GEOENTRY_DEVICE_H
 
 #include "Device.h"
+#include "Dispatch.h"
+#include "EventBus.h"
+#include "StateSnapshot.h"
+#include "Logger.h"
+#include "Metrics.h"
 #include "Led.h"
+#include "Scheduler.h"
+#include "AdaptivePolling.h"
+#include "ActuationJournal.h"
+#include "GeofenceEngine.h"
+#include "WiFiConnection.h"
+#include "Transport.h"
+#include "RestTransport.h"
+#include "SensorRegistry.h"
+#include "LedPatternEngine.h"
+#include "SmartLedArray.h"
+#include "TlsClient.h"
 #include <WiFi.h>
-#include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include <atomic>
+
+// LEDs inteligentes: una fila por LED (pin, nombre, tipos que representa)
+constexpr SmartLedConfig SMART_LEDS[] = {
+    {4, "Verde", "led_tv", "smart_light", "TV", "Luz"},
+    {5, "Azul", "air_conditioner", "coffee_maker", "AC", "Cafetera"},
+};
+
+enum class GeoEntryEventId : int {
+    USER_ENTERED = MessageDomains::GEOENTRY_EVENTS,
+    USER_EXITED,
+    WIFI_CONNECTED,
+    WIFI_DISCONNECTED,
+    API_REQUEST_SUCCESS,
+    API_REQUEST_FAILED,
+    END
+};
+
+enum class GeoEntryCommandId : int {
+    CHECK_PROXIMITY = MessageDomains::GEOENTRY_COMMANDS,
+    CHECK_SENSORS,
+    RECONNECT_WIFI,
+    RESET_SYSTEM,
+    UPDATE_STATUS,
+    UPDATE_LEDS,
+    UPDATE_TRANSPORT,
+    CHECK_WIFI,
+    ACTUATE_ENTER,
+    ACTUATE_EXIT,
+    REPLAY_JOURNAL,
+    APPLY_SETTINGS,
+    END
+};
+
+// Puntualidad de la tarea de control: desviación de cada activación
+// respecto a su instante teórico
+struct ControlLoopStats {
+    unsigned long ticks;
+    unsigned long overruns;       // pasos que ocuparon un periodo entero
+    unsigned long lastJitterUs;
+    unsigned long maxJitterUs;
+    unsigned long long totalJitterUs;
+};
+
+class GeoEntryDevice final : public Device, public TransportListener {
+public:
+    static const int SMART_LED_CHANNELS = sizeof(SMART_LEDS) / sizeof(SMART_LEDS[0]);
 
-class GeoEntryDevice : public Device {
 private:
+    // on() y handle() indexan estas tablas por id (ver GeoEntryDevice.cpp)
+    typedef DispatchTable<GeoEntryDevice, GeoEntryEventId,
+                          GeoEntryEventId::USER_ENTERED, GeoEntryEventId::END> EventTable;
+    typedef DispatchTable<GeoEntryDevice, GeoEntryCommandId,
+                          GeoEntryCommandId::CHECK_PROXIMITY, GeoEntryCommandId::END> CommandTable;
+    static const EventTable EVENTS;
+    static const CommandTable COMMANDS;
 
     Led* proximityLed;  // LED rojo - indica presencia en casa
-    Led* smartLed1;     // LED verde - sensores TV/Luz
-    Led* smartLed2;     // LED azul - sensores AC/Cafetera
     
-    String ssid;
-    String password;
+    // LEDs inteligentes (tabla SMART_LEDS) generados por LEDC
+    LedPatternEngine ledEngine;
+    SmartLedArray<SMART_LED_CHANNELS> smartLeds;
+    
+    WiFiConnection wifi;  // Máquina de estados WiFi no bloqueante
+    
+    // Backend de comunicación: REST por defecto, reemplazable con setTransport()
+    RestTransport restTransport;
+    Transport* transport;
+    
+    static const unsigned long TRANSPORT_UPDATE_INTERVAL = 20;
+    static const unsigned long DEFAULT_STATUS_INTERVAL = 60000;
+    static const unsigned long WIFI_CHECK_INTERVAL = 100;
+    static const int EVENTS_PER_LOOP = 8;
+    static const size_t MAX_EVENT_ID = ActuationJournal::MAX_EVENT_ID;
+    static const unsigned long JOURNAL_REPLAY_INTERVAL = 10000;
+    static const int JOURNAL_REPLAY_BATCH = 4;
+    static const int MAX_HOME_LOCATIONS = 8;
+    static const int MAX_HOME_VERTICES = 64;
+    
+    // Reparto entre núcleos: la red junto a la pila WiFi (núcleo 0) y el
+    // control en tiempo real en el núcleo 1
+    static const int NETWORK_CORE = 0;
+    static const int CONTROL_CORE = 1;
+    static const uint32_t NETWORK_STACK_SIZE = 12288;
+    static const uint32_t CONTROL_STACK_SIZE = 4096;
+    static const UBaseType_t NETWORK_PRIORITY = 1;
+    static const UBaseType_t CONTROL_PRIORITY = 3;
+    static const UBaseType_t LOG_PRIORITY = 1;
+    static const unsigned long CONTROL_PERIOD = 10;
+    static const unsigned long NETWORK_MAX_IDLE = 20;
     
-    String serverURL;
-    String deviceId;
-    String userId;  // ID del usuario para consultar sensores
+    // Tarea de red: planificador cooperativo con sondeos, transporte y WiFi
+    Scheduler scheduler;
+    TaskHandle_t networkTaskHandle;
+    MpscQueue<int, 8> networkCommands;  // del control a la red (actuación)
+    
+    // Tarea de control: eventos, LEDs y LED de proximidad
+    TaskHandle_t controlTaskHandle;
+    ControlLoopStats controlStats;  // sólo tarea de control
+    StateSnapshot<ControlLoopStats> controlStatsSnapshot;  // copia publicada para la red
+    bool networkUp;  // según WIFI_CONNECTED / WIFI_DISCONNECTED
+    
+    // Eventos producidos por red, WiFi o ISRs: se encolan y el control los entrega
+    EventBus eventBus;
+    DeferredEventHandler deferredEvents;
+    
+    // Patrones calculados por la red a partir de los sensores
+    struct LedSnapshot {
+        uint8_t patterns[SMART_LED_CHANNELS];
+    };
+    StateSnapshot<LedSnapshot> ledSnapshot;
+    uint32_t appliedLedVersion;
     
-    unsigned long lastCheck;
     unsigned long checkInterval;
-    unsigned long lastSensorCheck;
     unsigned long sensorCheckInterval;
-    String lastEventId;
-    bool userAtHome;
-    
-    // Estados de sensores virtuales
-    bool tvSensorActive;
-    bool luzSensorActive;
-    bool acSensorActive;
-    bool cafeteraSensorActive;
-    
-    // Variables para control de patrones de parpadeo
-    unsigned long lastLed1Blink;
-    unsigned long lastLed2Blink;
-    bool led1BlinkState;
-    bool led2BlinkState;
-    int led1Pattern;  // 0=off, 1=solid, 2=slow, 3=fast
-    int led2Pattern;  // 0=off, 1=solid, 2=slow, 3=fast
+    unsigned long statusInterval;  // volcado periódico de UPDATE_STATUS (0 = nunca)
+    AdaptivePolling polling;  // intervalo de proximidad y Retry-After (sólo tarea de red)
+    bool adaptivePolling;     // false = checkInterval fijo
+    
+    // Ajustes pedidos desde otra tarea tras init(): se guardan bajo el
+    // cerrojo y APPLY_SETTINGS los aplica en la tarea de red
+    enum SettingFlags : uint8_t {
+        SETTING_CHECK_INTERVAL = 1 << 0,
+        SETTING_ADAPTIVE_POLLING = 1 << 1,
+        SETTING_SENSOR_INTERVAL = 1 << 2,
+        SETTING_STATUS_INTERVAL = 1 << 3,
+        SETTING_PUSH_EVENTS = 1 << 4
+    };
+    // Los tipos se copian: se internan después, en la tarea de red
+    struct PendingLedMapping {
+        char primaryType[SensorRegistry::MAX_TYPE_NAME];
+        char secondaryType[SensorRegistry::MAX_TYPE_NAME];
+        const char* primaryLabel;
+        const char* secondaryLabel;
+    };
+    static_assert(SMART_LED_CHANNELS <= 8, "un bit por LED en ledMappings y ledPatterns");
+    struct PendingSettings {
+        uint8_t changed;  // SettingFlags
+        unsigned long checkInterval;
+        AdaptivePollingConfig polling;
+        unsigned long sensorCheckInterval;
+        unsigned long statusInterval;
+        bool pushEvents;
+        uint8_t ledMappings;  // un bit por LED con asignación pendiente
+        uint8_t ledPatterns;  // un bit por LED con patrón pendiente
+        PendingLedMapping mappings[SMART_LED_CHANNELS];
+        uint8_t patterns[SMART_LED_CHANNELS];
+    };
+    portMUX_TYPE settingsLock;
+    PendingSettings pendingSettings;
+    int proximityTask;
+    int sensorTask;
+    int statusTask;
+    int journalTask;
+    char lastEventId[MAX_EVENT_ID];  // cursor de sondeo (sólo tarea de red)
+    std::atomic<bool> userAtHome;  // lo escribe el control, lo lee la red
+    std::atomic<uint32_t> eventSeenUs;  // micros() del último enter/exit en processEvent
+    
+    // Intención de enter/exit, PATCH fallidos y último evento en flash: se
+    // reenvían al volver la red (sólo tarea de red)
+    ActuationJournal journal;
+    bool journalEnabled;
+    bool actuationBatchFailed;
+    
+    // Geovallas locales: posiciones crudas de cualquier tarea, evaluadas en
+    // la de red, que decide enter/exit sin esperar al servidor
+    struct PositionUpdate {
+        GeoPoint position;
+        uint16_t accuracyM;
+    };
+    GeofenceEngine geofences;
+    MpscQueue<PositionUpdate, 8> positionUpdates;
+    bool geofenceAtHome;   // en alguna geovalla según la última posición
+    bool positionKnown;    // ya se evaluó alguna posición
+    
+    // Estados de sensores por tipo (la asignación de tipos a LEDs vive en smartLeds)
+    SensorRegistry sensorRegistry;
     
     void initializeLeds();
+    
+    static void networkTask(void* parameter);
+    static void controlTask(void* parameter);
+    void runNetwork();
+    void runControl();
+    void postNetworkCommand(Command command);
+    
+    // Manejadores de eventos
+    void onUserEntered();
+    void onUserExited();
+    void onWiFiConnected();
+    void onWiFiDisconnected();
+    void onApiRequestFailed();
+    
+    // Manejadores de comandos
+    void reconnectWiFi();
+    void resetSystem();
+    void updateTransport();
+    void checkWiFi();
     void checkProximityEvents();
     void checkSensorStates();
-    void processProximityEvents(String jsonResponse);
-    void processSensorStates(String jsonResponse);
     void processEvent(JsonObject event);
-    void reconnectWiFi();
     void updateSystemStatus();
     void updateSmartLedPatterns();
+    void flashSmartLeds(uint8_t times, uint16_t halfPeriodMs);
     void calculateLedPatterns();
-    int getLedPattern(bool sensor1, bool sensor2);
     void turnOnAllSensorsOnEnter();
     void turnOffAllSensorsOnExit();
-    void turnOnSensor(String sensorId, String sensorType);
-    void turnOffSensor(String sensorId, String sensorType);
-    String getPatternDescription(int pattern, String sensor1, String sensor2);
+    int actuateAllSensors(bool targetState);
+    void replayJournal();
+    void evaluatePosition(const PositionUpdate& update);
+    void applySettings();
+    void applyCheckInterval(unsigned long interval);
+    void applyAdaptivePolling(const AdaptivePollingConfig& config);
+    void applySensorCheckInterval(unsigned long interval);
+    void applyStatusInterval(unsigned long interval);
+    void applySmartLedPattern(int channel, uint8_t pattern);
 
 public:
     GeoEntryDevice(
@@ -73,39 +252,108 @@ public:
     void on(Event event) override;
     void handle(Command command) override;
     
+    void onProximityEvent(JsonObject event) override;
+    void onSensorStatesBegin() override;
+    void onSensorState(JsonObject sensor) override;
+    void onSensorStatesEnd(bool complete) override;
+    void onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) override;
+    void onRequestResult(bool success) override;
+    void onRetryAfter(unsigned long delayMs) override;
+    void onTransportConnected() override;
+    
     void init();
     void loop();
     
+    // Un paso de la tarea de red (devuelve los ms que puede dormir) y uno de
+    // la de control. init() los ejecuta en sus tareas; son públicos para
+    // poder simularlos paso a paso en el host (host/)
+    unsigned long networkStep(unsigned long now);
+    void controlStep();
+    
+    // Debe llamarse antes de init(); nullptr vuelve al transporte REST
+    void setTransport(Transport* newTransport);
     void setWiFiCredentials(const String& ssid, const String& password);
     void setAPIConfiguration(const String& url, const String& deviceId);
+    void setEdgeAPIConfiguration(const String& url);
     void setUserConfiguration(const String& userID);
+    // enablePushEvents() y los intervalos son seguros desde cualquier tarea:
+    // tras init() se encolan y los aplica la tarea de red (APPLY_SETTINGS)
+    void enablePushEvents(bool enabled);
+    // Intervalo fijo de proximidad: desactiva el sondeo adaptativo
     void setCheckInterval(unsigned long interval);
+    // Sondeo adaptativo (activo por defecto) con los límites indicados
+    void setAdaptivePolling(const AdaptivePollingConfig& config);
     void setSensorCheckInterval(unsigned long interval);
+    // Estado, estadísticas y métricas por el log cada interval ms (0 = nunca)
+    void setStatusInterval(unsigned long interval);
+    void setActuationLimits(int maxInFlight, unsigned long minIntervalMs);
+    void setSensorCacheMaxAge(unsigned long ms);
+    void setCircuitBreaker(int failureThreshold, unsigned long minBackoffMs, unsigned long maxBackoffMs);
+    // Diario de actuaciones en LittleFS (activo por defecto). Antes de init()
+    void setActuationJournal(bool enabled);
+    // Geovallas locales (casas, oficina...): con ellas updatePosition() genera
+    // USER_ENTERED/USER_EXITED en el dispositivo y los eventos del servidor
+    // que coinciden se ignoran. Antes de init(); name debe ser estático.
+    // Devuelven false si no caben (MAX_HOME_LOCATIONS / MAX_HOME_VERTICES)
+    bool addHomeLocation(const char* name, double latitude, double longitude, uint32_t radiusM);
+    bool addHomeArea(const char* name, const GeoPoint* vertices, int vertexCount);
+    void setGeofenceConfig(const GeofenceConfig& config);
+    // Posición cruda (GPS, BLE de la app...). Segura desde cualquier tarea;
+    // false si la cola está llena
+    bool updatePosition(double latitude, double longitude, float accuracyM);
+    // PEM de la CA raíz del API: activa TLS verificado con reanudación de
+    // sesión. Antes de init(); se parsea una vez y el buffer no se conserva
+    bool setTlsTrustAnchor(const char* pem);
+    // channel = fila de SMART_LEDS (0 = LED verde, 1 = LED azul); las etiquetas deben ser estáticas.
+    // Segura desde cualquier tarea: tras init() se encola (APPLY_SETTINGS) y
+    // devuelve false sólo si el canal o los tipos no son válidos; si el
+    // registro no admite más tipos se avisa por el log al aplicarla
+    bool setLedChannelMapping(int channel, const char* primaryType, const char* secondaryType,
+                              const char* primaryLabel, const char* secondaryLabel);
     
     bool isUserAtHome() const;
     bool isWiFiConnected() const;
     String getLastEventId() const;
+    const PollStats& getProximityPollStats() const;
+    const PollStats& getSensorPollStats() const;
+    const SensorCacheStats& getSensorCacheStats() const;
+    const ActuationJournal& getActuationJournal() const;
+    const GeofenceEngine& getGeofences() const;
+    const SensorRegistry& getSensorRegistry() const;
+    const EventBus& getEventBus() const;
+    // Copia coherente de la última publicada por la tarea de control
+    ControlLoopStats getControlLoopStats() const;
     
     void setProximityStatus(bool atHome);
-    void setSmartLed1Pattern(int pattern);
-    void setSmartLed2Pattern(int pattern);
+    // Fija el patrón (LedPattern) de un LED hasta el siguiente recálculo.
+    // Segura desde cualquier tarea: lo publica la tarea de red
+    void setSmartLedPattern(int channel, int pattern);
+    // Patrón publicado para un LED (el que aplica la tarea de control)
+    uint8_t getSmartLedPattern(int channel) const;
 };
 
 namespace GeoEntryEvents {
-    const Event USER_ENTERED(1);
-    const Event USER_EXITED(2);
-    const Event WIFI_CONNECTED(3);
-    const Event WIFI_DISCONNECTED(4);
-    const Event API_REQUEST_SUCCESS(5);
-    const Event API_REQUEST_FAILED(6);
+    constexpr Event USER_ENTERED(GeoEntryEventId::USER_ENTERED);
+    constexpr Event USER_EXITED(GeoEntryEventId::USER_EXITED);
+    constexpr Event WIFI_CONNECTED(GeoEntryEventId::WIFI_CONNECTED);
+    constexpr Event WIFI_DISCONNECTED(GeoEntryEventId::WIFI_DISCONNECTED);
+    constexpr Event API_REQUEST_SUCCESS(GeoEntryEventId::API_REQUEST_SUCCESS);
+    constexpr Event API_REQUEST_FAILED(GeoEntryEventId::API_REQUEST_FAILED);
 }
 
 namespace GeoEntryCommands {
-    const Command CHECK_PROXIMITY(1);
-    const Command CHECK_SENSORS(2);
-    const Command RECONNECT_WIFI(3);
-    const Command RESET_SYSTEM(4);
-    const Command UPDATE_STATUS(5);
+    constexpr Command CHECK_PROXIMITY(GeoEntryCommandId::CHECK_PROXIMITY);
+    constexpr Command CHECK_SENSORS(GeoEntryCommandId::CHECK_SENSORS);
+    constexpr Command RECONNECT_WIFI(GeoEntryCommandId::RECONNECT_WIFI);
+    constexpr Command RESET_SYSTEM(GeoEntryCommandId::RESET_SYSTEM);
+    constexpr Command UPDATE_STATUS(GeoEntryCommandId::UPDATE_STATUS);
+    constexpr Command UPDATE_LEDS(GeoEntryCommandId::UPDATE_LEDS);
+    constexpr Command UPDATE_TRANSPORT(GeoEntryCommandId::UPDATE_TRANSPORT);
+    constexpr Command CHECK_WIFI(GeoEntryCommandId::CHECK_WIFI);
+    constexpr Command ACTUATE_ENTER(GeoEntryCommandId::ACTUATE_ENTER);
+    constexpr Command ACTUATE_EXIT(GeoEntryCommandId::ACTUATE_EXIT);
+    constexpr Command REPLAY_JOURNAL(GeoEntryCommandId::REPLAY_JOURNAL);
+    constexpr Command APPLY_SETTINGS(GeoEntryCommandId::APPLY_SETTINGS);
 }
 
 #endif
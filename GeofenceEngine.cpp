@@ -0,0 +1,465 @@
+#include "GeofenceEngine.h"
+#include "Logger.h"
+#include <algorithm>
+#include <math.h>
+
+// Radio medio de la Tierra (IUGG) y metros por microgrado de latitud
+static const double EARTH_RADIUS_M = 6371008.8;
+static const double METERS_PER_E6 = EARTH_RADIUS_M * M_PI / 180.0 / 1e6;
+
+// Tabla de sin(Δ / 2) en Q30 con Δ en microgrados, un paso cada 2^18
+// microgrados (0,26°) hasta Δ = 180° (sin 90°). Interpolando linealmente el
+// error es menor que 1e-6 relativo; el redondeo de Q30 (un paso son ~1,2 cm)
+// añade unos centímetros fijos, muy por debajo del error del GPS
+static const int SIN_STEP_BITS = 18;
+static const uint32_t HALF_TURN_E6 = 180000000;
+static const int SIN_TABLE_SIZE = (HALF_TURN_E6 >> SIN_STEP_BITS) + 2;
+static const int32_t Q30_ONE = 1 << 30;
+
+static int32_t sinTable[SIN_TABLE_SIZE];
+static bool sinTableReady = false;
+
+static void buildSinTable() {
+    if (sinTableReady) {
+        return;
+    }
+    for (int i = 0; i < SIN_TABLE_SIZE; i++) {
+        double halfAngle = (double)((uint32_t)i << SIN_STEP_BITS) / 2e6 * M_PI / 180.0;
+        sinTable[i] = (int32_t)lround(sin(halfAngle) * Q30_ONE);
+    }
+    sinTableReady = true;
+}
+
+// Lista antes de main() para las funciones estáticas; el constructor la
+// vuelve a pedir por si se crea un motor desde otro constructor global
+static struct SinTableInit {
+    SinTableInit() {
+        buildSinTable();
+    }
+} sinTableInit;
+
+// sin(Δ / 2) en Q30 para 0 <= Δ <= 180° en microgrados
+static int32_t sinHalfQ30(uint32_t deltaE6) {
+    if (deltaE6 >= HALF_TURN_E6) {
+        return Q30_ONE;
+    }
+    uint32_t index = deltaE6 >> SIN_STEP_BITS;
+    int64_t fraction = deltaE6 & ((1u << SIN_STEP_BITS) - 1);
+    int32_t base = sinTable[index];
+    return base + (int32_t)(((int64_t)(sinTable[index + 1] - base) * fraction) >> SIN_STEP_BITS);
+}
+
+// sin²(d / 2R) en Q60: comparar con él equivale a comparar distancias
+static uint64_t havFromMeters(double meters) {
+    double s = sin(meters / (2.0 * EARTH_RADIUS_M));
+    return (uint64_t)ldexp(s * s, 60);
+}
+
+static int32_t clampLatitude(int64_t latE6) {
+    return (int32_t)std::max<int64_t>(-90000000, std::min<int64_t>(90000000, latE6));
+}
+
+struct CellEntry {
+    uint64_t key;
+    int fence;
+
+    bool operator<(const CellEntry& other) const {
+        return key < other.key || (key == other.key && fence < other.fence);
+    }
+};
+
+GeofenceEngine::GeofenceEngine(int maxFences, int maxVertices)
+    : hysteresisE6(0), capacity(maxFences), count(0), vertexCapacity(maxVertices), vertexCount(0),
+      cellKeys(nullptr), cellStart(nullptr), entries(nullptr), cellCount(0), indexed(false), activeCount(0),
+      stamp(0) {
+    buildSinTable();
+    fences = new Fence[capacity];
+    vertices = new LocalVertex[vertexCapacity];
+    configure(GeofenceConfig());
+}
+
+GeofenceEngine::~GeofenceEngine() {
+    freeIndex();
+    delete[] fences;
+    delete[] vertices;
+}
+
+void GeofenceEngine::configure(const GeofenceConfig& newConfig) {
+    config = newConfig;
+    if (config.cellSizeE6 < 100) {
+        config.cellSizeE6 = 100;
+    }
+    hysteresisE6 = (int32_t)ceil(config.hysteresisM / METERS_PER_E6);
+    for (int i = 0; i < count; i++) {
+        prepare(fences[i]);
+    }
+    indexed = false;
+}
+
+const GeofenceConfig& GeofenceEngine::getConfig() const {
+    return config;
+}
+
+// Umbrales y caja de una geovalla según la histéresis vigente
+void GeofenceEngine::prepare(Fence& fence) const {
+    int32_t marginLatE6 = hysteresisE6;
+    if (fence.shape == FENCE_CIRCLE) {
+        // Con radios menores que la histéresis se entra a medio radio
+        uint32_t enterM = fence.radiusM > config.hysteresisM ? fence.radiusM - config.hysteresisM : fence.radiusM / 2;
+        uint32_t exitM = fence.radiusM + config.hysteresisM;
+        fence.enterHav = havFromMeters(enterM);
+        fence.exitHav = havFromMeters(exitM);
+        marginLatE6 = (int32_t)ceil(exitM / METERS_PER_E6) + 1;
+    }
+
+    // En longitud el margen crece con 1 / cos(lat) (tope cerca de los polos)
+    double cosLat = std::max((double)fence.cosLatQ30 / Q30_ONE, 0.01);
+    int64_t marginLonE6 = (int64_t)ceil(marginLatE6 / cosLat) + 1;
+    fence.min.latE6 = clampLatitude((int64_t)fence.low.latE6 - marginLatE6);
+    fence.max.latE6 = clampLatitude((int64_t)fence.high.latE6 + marginLatE6);
+    fence.min.lonE6 = (int32_t)std::max<int64_t>(INT32_MIN, (int64_t)fence.low.lonE6 - marginLonE6);
+    fence.max.lonE6 = (int32_t)std::min<int64_t>(INT32_MAX, (int64_t)fence.high.lonE6 + marginLonE6);
+}
+
+int GeofenceEngine::addCircle(const char* name, GeoPoint center, uint32_t radiusM) {
+    if (count >= capacity || radiusM == 0 || abs(center.latE6) > 90000000 || abs(center.lonE6) > 180000000) {
+        return -1;
+    }
+
+    Fence& fence = fences[count];
+    fence.name = name;
+    fence.shape = FENCE_CIRCLE;
+    fence.inside = false;
+    fence.stamp = 0;
+    fence.low = center;
+    fence.high = center;
+    fence.origin = center;
+    fence.cosLatQ30 = cosLatQ30(center.latE6);
+    fence.radiusM = radiusM;
+    fence.firstVertex = 0;
+    fence.vertexCount = 0;
+    prepare(fence);
+
+    indexed = false;
+    return count++;
+}
+
+int GeofenceEngine::addPolygon(const char* name, const GeoPoint* points, int pointCount) {
+    if (count >= capacity || pointCount < 3 || vertexCount + pointCount > vertexCapacity) {
+        return -1;
+    }
+
+    Fence& fence = fences[count];
+    fence.low = points[0];
+    fence.high = points[0];
+    for (int i = 0; i < pointCount; i++) {
+        if (abs(points[i].latE6) > 90000000 || abs(points[i].lonE6) > 180000000) {
+            return -1;
+        }
+        fence.low.latE6 = std::min(fence.low.latE6, points[i].latE6);
+        fence.low.lonE6 = std::min(fence.low.lonE6, points[i].lonE6);
+        fence.high.latE6 = std::max(fence.high.latE6, points[i].latE6);
+        fence.high.lonE6 = std::max(fence.high.lonE6, points[i].lonE6);
+    }
+
+    fence.name = name;
+    fence.shape = FENCE_POLYGON;
+    fence.inside = false;
+    fence.stamp = 0;
+    fence.origin.latE6 = (int32_t)(((int64_t)fence.low.latE6 + fence.high.latE6) / 2);
+    fence.origin.lonE6 = (int32_t)(((int64_t)fence.low.lonE6 + fence.high.lonE6) / 2);
+    fence.cosLatQ30 = cosLatQ30(fence.origin.latE6);
+    fence.radiusM = 0;
+    fence.enterHav = 0;
+    fence.exitHav = 0;
+    fence.firstVertex = vertexCount;
+    fence.vertexCount = pointCount;
+
+    // Plano local: a escala de una casa o un barrio la distorsión es despreciable
+    LocalVertex* local = vertices + vertexCount;
+    for (int i = 0; i < pointCount; i++) {
+        local[i].x = (int32_t)((((int64_t)points[i].lonE6 - fence.origin.lonE6) * fence.cosLatQ30) >> 30);
+        local[i].y = points[i].latE6 - fence.origin.latE6;
+    }
+    for (int i = 0; i < pointCount; i++) {
+        const LocalVertex& next = local[(i + 1) % pointCount];
+        double dx = (double)next.x - local[i].x;
+        double dy = (double)next.y - local[i].y;
+        local[i].edgeLength = (uint32_t)ceil(sqrt(dx * dx + dy * dy));
+    }
+    prepare(fence);
+
+    vertexCount += pointCount;
+    indexed = false;
+    return count++;
+}
+
+void GeofenceEngine::clear() {
+    freeIndex();
+    count = 0;
+    vertexCount = 0;
+    activeCount = 0;
+    indexed = false;
+}
+
+// ---------------------------------------------------------------- Índice
+
+int32_t GeofenceEngine::cellIndex(int32_t valueE6) const {
+    // División hacia -infinito para que las celdas no se solapen en el 0
+    if (valueE6 >= 0) {
+        return valueE6 / config.cellSizeE6;
+    }
+    return -(int32_t)(((int64_t)config.cellSizeE6 - 1 - valueE6) / config.cellSizeE6);
+}
+
+uint64_t GeofenceEngine::cellKey(int32_t latE6, int32_t lonE6) const {
+    return ((uint64_t)(uint32_t)cellIndex(latE6) << 32) | (uint32_t)cellIndex(lonE6);
+}
+
+void GeofenceEngine::freeIndex() {
+    delete[] cellKeys;
+    delete[] cellStart;
+    delete[] entries;
+    cellKeys = nullptr;
+    cellStart = nullptr;
+    entries = nullptr;
+    cellCount = 0;
+}
+
+bool GeofenceEngine::build() {
+    freeIndex();
+
+    // Cada geovalla se apunta en todas las celdas que toca su caja
+    uint64_t total = 0;
+    for (int i = 0; i < count; i++) {
+        uint64_t rows = (uint64_t)(cellIndex(fences[i].max.latE6) - cellIndex(fences[i].min.latE6) + 1);
+        uint64_t cols = (uint64_t)(cellIndex(fences[i].max.lonE6) - cellIndex(fences[i].min.lonE6) + 1);
+        total += rows * cols;
+    }
+    if (total > MAX_INDEX_ENTRIES) {
+        LOG_ERROR(DEVICE, "❌ Índice de geovallas demasiado grande (%lu celdas); aumenta cellSizeE6",
+                  (unsigned long)total);
+        return false;
+    }
+
+    CellEntry* pairs = new CellEntry[total > 0 ? total : 1];
+    uint32_t pairCount = 0;
+    for (int i = 0; i < count; i++) {
+        for (int32_t row = cellIndex(fences[i].min.latE6); row <= cellIndex(fences[i].max.latE6); row++) {
+            for (int32_t col = cellIndex(fences[i].min.lonE6); col <= cellIndex(fences[i].max.lonE6); col++) {
+                pairs[pairCount].key = ((uint64_t)(uint32_t)row << 32) | (uint32_t)col;
+                pairs[pairCount].fence = i;
+                pairCount++;
+            }
+        }
+    }
+    std::sort(pairs, pairs + pairCount);
+
+    int keys = 0;
+    for (uint32_t i = 0; i < pairCount; i++) {
+        if (i == 0 || pairs[i].key != pairs[i - 1].key) {
+            keys++;
+        }
+    }
+    cellKeys = new uint64_t[keys > 0 ? keys : 1];
+    cellStart = new uint32_t[keys + 1];
+    entries = new int[pairCount > 0 ? pairCount : 1];
+    for (uint32_t i = 0; i < pairCount; i++) {
+        if (i == 0 || pairs[i].key != pairs[i - 1].key) {
+            cellKeys[cellCount] = pairs[i].key;
+            cellStart[cellCount] = i;
+            cellCount++;
+        }
+        entries[i] = pairs[i].fence;
+    }
+    cellStart[cellCount] = pairCount;
+    delete[] pairs;
+
+    indexed = true;
+    LOG_DEBUG(DEVICE, "🗺️ Índice de geovallas: %d geovallas en %d celdas (%lu entradas)", count, cellCount,
+              (unsigned long)pairCount);
+    return true;
+}
+
+// ---------------------------------------------------------------- Evaluación
+
+int32_t GeofenceEngine::cosLatQ30(int32_t latE6) {
+    // cos(lat) = sin(90° - |lat|) = sin(Δ / 2) con Δ = 2·(90° - |lat|)
+    uint32_t fromPole = 90000000u - (uint32_t)std::min(abs(latE6), (int32_t)90000000);
+    return sinHalfQ30(2 * fromPole);
+}
+
+uint64_t GeofenceEngine::haversineQ60(const GeoPoint& a, int32_t cosLatA, const GeoPoint& b, int32_t cosLatB) {
+    uint32_t dLat = (uint32_t)llabs((int64_t)b.latE6 - a.latE6);
+    uint32_t dLon = (uint32_t)llabs((int64_t)b.lonE6 - a.lonE6);
+    if (dLon > HALF_TURN_E6) {
+        dLon = 2 * HALF_TURN_E6 - dLon;
+    }
+
+    // sin²(Δφ/2) + cos φ1 · cos φ2 · sin²(Δλ/2), todo en Q60
+    uint64_t s1 = (uint64_t)sinHalfQ30(dLat);
+    uint64_t s2 = (uint64_t)sinHalfQ30(dLon);
+    uint64_t cosProduct = ((uint64_t)cosLatA * (uint64_t)cosLatB) >> 30;
+    uint64_t weighted = (cosProduct * s2) >> 30;
+    return s1 * s1 + weighted * s2;
+}
+
+float GeofenceEngine::havToMeters(uint64_t havQ60) {
+    double a = std::min(ldexp((double)havQ60, -60), 1.0);
+    return (float)(2.0 * EARTH_RADIUS_M * asin(sqrt(a)));
+}
+
+bool GeofenceEngine::contains(const Fence& fence, const GeoPoint& point, int32_t cosLatQ30) const {
+    // Fuera de la caja se está más allá del borde de salida
+    if (point.latE6 < fence.min.latE6 || point.latE6 > fence.max.latE6 || point.lonE6 < fence.min.lonE6 ||
+        point.lonE6 > fence.max.lonE6) {
+        return false;
+    }
+    if (fence.shape == FENCE_CIRCLE) {
+        uint64_t hav = haversineQ60(point, cosLatQ30, fence.origin, fence.cosLatQ30);
+        return hav <= (fence.inside ? fence.exitHav : fence.enterHav);
+    }
+    return containsPolygon(fence, point);
+}
+
+bool GeofenceEngine::containsPolygon(const Fence& fence, const GeoPoint& point) const {
+    const LocalVertex* local = vertices + fence.firstVertex;
+    int n = fence.vertexCount;
+    int64_t px = (((int64_t)point.lonE6 - fence.origin.lonE6) * fence.cosLatQ30) >> 30;
+    int64_t py = (int64_t)point.latE6 - fence.origin.latE6;
+
+    // Cruce de rayos: px < x de la arista a la altura py, sin dividir
+    bool inside = false;
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const LocalVertex& a = local[j];
+        const LocalVertex& b = local[i];
+        if ((b.y > py) != (a.y > py)) {
+            int64_t lhs = (px - b.x) * ((int64_t)a.y - b.y);
+            int64_t rhs = (py - b.y) * ((int64_t)a.x - b.x);
+            if (a.y > b.y ? lhs < rhs : lhs > rhs) {
+                inside = !inside;
+            }
+        }
+    }
+    if (inside == fence.inside) {
+        return inside;
+    }
+
+    // Sólo cambia de estado a hysteresisE6 o más de todas las aristas
+    int64_t h = hysteresisE6;
+    for (int i = 0; i < n; i++) {
+        const LocalVertex& a = local[i];
+        const LocalVertex& b = local[(i + 1) % n];
+        int64_t dx = (int64_t)b.x - a.x;
+        int64_t dy = (int64_t)b.y - a.y;
+        int64_t qx = px - a.x;
+        int64_t qy = py - a.y;
+        int64_t dot = qx * dx + qy * dy;
+        bool near;
+        if (dot <= 0) {
+            near = qx * qx + qy * qy < h * h;
+        } else if (dot >= dx * dx + dy * dy) {
+            int64_t rx = px - b.x;
+            int64_t ry = py - b.y;
+            near = rx * rx + ry * ry < h * h;
+        } else {
+            // Distancia a la recta: |q × d| / |d|
+            near = llabs(qx * dy - qy * dx) < h * (int64_t)a.edgeLength;
+        }
+        if (near) {
+            return fence.inside;
+        }
+    }
+    return inside;
+}
+
+void GeofenceEngine::evaluate(int index, const GeoPoint& point, int32_t cosLatQ30, GeofenceTransition* transitions,
+                              int maxTransitions, int& transitionCount) {
+    Fence& fence = fences[index];
+    if (fence.stamp == stamp) {
+        return;
+    }
+    fence.stamp = stamp;
+    stats.evaluated++;
+
+    bool inside = contains(fence, point, cosLatQ30);
+    if (inside == fence.inside) {
+        return;
+    }
+    if (inside) {
+        if (activeCount >= MAX_ACTIVE) {
+            // Sin hueco no se podría detectar la salida fuera de su celda
+            return;
+        }
+        active[activeCount++] = index;
+    } else {
+        for (int i = 0; i < activeCount; i++) {
+            if (active[i] == index) {
+                active[i] = active[--activeCount];
+                break;
+            }
+        }
+    }
+    fence.inside = inside;
+    stats.transitions++;
+    if (transitionCount < maxTransitions) {
+        transitions[transitionCount].fence = index;
+        transitions[transitionCount].entered = inside;
+        transitionCount++;
+    }
+}
+
+int GeofenceEngine::update(GeoPoint position, uint16_t accuracyM, GeofenceTransition* transitions,
+                           int maxTransitions) {
+    stats.updates++;
+    if (config.maxAccuracyM > 0 && accuracyM > config.maxAccuracyM) {
+        stats.ignored++;
+        return 0;
+    }
+    if (!indexed && !build()) {
+        return 0;
+    }
+
+    stamp++;
+    int32_t cosLat = cosLatQ30(position.latE6);
+    int transitionCount = 0;
+
+    // Primero las geovallas en las que ya se está: su salida puede caer
+    // fuera de la celda actual. Se copia la lista porque evaluate() la cambia
+    int current[MAX_ACTIVE];
+    int currentCount = activeCount;
+    memcpy(current, active, sizeof(int) * activeCount);
+    for (int i = 0; i < currentCount; i++) {
+        evaluate(current[i], position, cosLat, transitions, maxTransitions, transitionCount);
+    }
+
+    uint64_t key = cellKey(position.latE6, position.lonE6);
+    const uint64_t* cell = std::lower_bound(cellKeys, cellKeys + cellCount, key);
+    if (cell != cellKeys + cellCount && *cell == key) {
+        int slot = (int)(cell - cellKeys);
+        for (uint32_t i = cellStart[slot]; i < cellStart[slot + 1]; i++) {
+            evaluate(entries[i], position, cosLat, transitions, maxTransitions, transitionCount);
+        }
+    }
+    return transitionCount;
+}
+
+int GeofenceEngine::size() const {
+    return count;
+}
+
+int GeofenceEngine::getInsideCount() const {
+    return activeCount;
+}
+
+bool GeofenceEngine::isInside(int fence) const {
+    return fence >= 0 && fence < count && fences[fence].inside;
+}
+
+const char* GeofenceEngine::getName(int fence) const {
+    return fence >= 0 && fence < count ? fences[fence].name : "";
+}
+
+const GeofenceStats& GeofenceEngine::getStats() const {
+    return stats;
+}
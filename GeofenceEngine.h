@@ -0,0 +1,149 @@
+#ifndef GEOFENCE_ENGINE_H
+#define GEOFENCE_ENGINE_H
+
+#include <Arduino.h>
+
+// Coordenadas en microgrados (grados x 1e6): 0,11 m de resolución en latitud
+struct GeoPoint {
+    int32_t latE6;
+    int32_t lonE6;
+};
+
+struct GeofenceConfig {
+    uint16_t hysteresisM;   // se entra a h metros dentro del borde y se sale a h metros fuera
+    uint16_t maxAccuracyM;  // posiciones con más incertidumbre se ignoran (0 = ninguna)
+    int32_t cellSizeE6;     // lado de la celda del índice (5000 = 0,005°, unos 550 m)
+
+    GeofenceConfig() : hysteresisM(15), maxAccuracyM(50), cellSizeE6(5000) {}
+};
+
+struct GeofenceTransition {
+    int fence;
+    bool entered;
+};
+
+struct GeofenceStats {
+    unsigned long updates;
+    unsigned long ignored;     // por precisión insuficiente
+    unsigned long evaluated;   // geovallas comprobadas en total (candidatas del índice + activas)
+    unsigned long transitions;
+
+    GeofenceStats() : updates(0), ignored(0), evaluated(0), transitions(0) {}
+};
+
+// Evaluador local de geovallas (círculos y polígonos). Cada posición se
+// compara sólo con las geovallas de su celda en una rejilla fija, más
+// aquellas en las que ya se está. Los círculos usan haversine en punto fijo:
+// sin²(d / 2R) con una tabla de senos Q30 se compara con el umbral de cada
+// radio, sin raíz ni arcoseno. Los polígonos, cruce de rayos en un plano
+// local. Un estado sólo cambia a hysteresisM metros del borde, para que el
+// ruido del GPS no haga rebotar enter/exit. Sin reservas de memoria al
+// evaluar; sólo lo usa una tarea
+class GeofenceEngine {
+public:
+    static const int MAX_ACTIVE = 16;  // geovallas en las que se puede estar a la vez
+    static const uint32_t MAX_INDEX_ENTRIES = 65536;  // pares celda-geovalla del índice
+
+private:
+    enum FenceShape : uint8_t {
+        FENCE_CIRCLE,
+        FENCE_POLYGON
+    };
+
+    struct Fence {
+        const char* name;
+        FenceShape shape;
+        bool inside;
+        uint32_t stamp;      // última actualización en la que se evaluó
+        GeoPoint low;        // extremos del contorno (círculo: el centro)
+        GeoPoint high;
+        GeoPoint min;        // caja que contiene el borde de salida
+        GeoPoint max;
+        GeoPoint origin;     // círculo: centro; polígono: origen del plano local
+        int32_t cosLatQ30;   // cos(latitud de origin)
+        uint32_t radiusM;    // círculo: radio nominal
+        uint64_t enterHav;   // círculo: sin²(d / 2R) en Q60 a la distancia de entrada
+        uint64_t exitHav;    //          y a la de salida
+        int firstVertex;     // polígono: vértices en vertices[firstVertex..]
+        int vertexCount;
+    };
+
+    // Vértice en el plano local del polígono (x = Δlon·cos(lat), y = Δlat,
+    // en microgrados de latitud) con la longitud de la arista que empieza en él
+    struct LocalVertex {
+        int32_t x;
+        int32_t y;
+        uint32_t edgeLength;
+    };
+
+    GeofenceConfig config;
+    int32_t hysteresisE6;
+
+    Fence* fences;
+    int capacity;
+    int count;
+    LocalVertex* vertices;
+    int vertexCapacity;
+    int vertexCount;
+
+    // Índice: claves de celda ordenadas; las geovallas de cellKeys[i] son
+    // entries[cellStart[i]..cellStart[i + 1])
+    uint64_t* cellKeys;
+    uint32_t* cellStart;
+    int* entries;
+    int cellCount;
+    bool indexed;
+
+    int active[MAX_ACTIVE];
+    int activeCount;
+    uint32_t stamp;
+    GeofenceStats stats;
+
+    GeofenceEngine(const GeofenceEngine&) = delete;
+    GeofenceEngine& operator=(const GeofenceEngine&) = delete;
+
+    uint64_t cellKey(int32_t latE6, int32_t lonE6) const;
+    int32_t cellIndex(int32_t valueE6) const;
+    void freeIndex();
+    void prepare(Fence& fence) const;
+    bool contains(const Fence& fence, const GeoPoint& point, int32_t cosLatQ30) const;
+    bool containsPolygon(const Fence& fence, const GeoPoint& point) const;
+    void evaluate(int index, const GeoPoint& point, int32_t cosLatQ30, GeofenceTransition* transitions,
+                  int maxTransitions, int& transitionCount);
+
+public:
+    GeofenceEngine(int maxFences, int maxVertices);
+    ~GeofenceEngine();
+
+    // Cambia la histéresis o la rejilla; el índice se reconstruye en la
+    // siguiente actualización
+    void configure(const GeofenceConfig& newConfig);
+    const GeofenceConfig& getConfig() const;
+
+    // Devuelven el índice de la geovalla o -1 si no caben o no son válidas.
+    // name debe ser estático
+    int addCircle(const char* name, GeoPoint center, uint32_t radiusM);
+    int addPolygon(const char* name, const GeoPoint* points, int pointCount);
+    void clear();
+
+    // Reconstruye el índice (también lo hace update() si hace falta)
+    bool build();
+
+    // Evalúa una posición; escribe hasta maxTransitions cambios de estado y
+    // devuelve cuántos hubo
+    int update(GeoPoint position, uint16_t accuracyM, GeofenceTransition* transitions, int maxTransitions);
+
+    int size() const;
+    int getInsideCount() const;
+    bool isInside(int fence) const;
+    const char* getName(int fence) const;
+    const GeofenceStats& getStats() const;
+
+    // sin²(d / 2R) en Q60 entre dos puntos (cos de sus latitudes en Q30) y
+    // su conversión a metros; expuestos para comparar con la versión double
+    static uint64_t haversineQ60(const GeoPoint& a, int32_t cosLatA, const GeoPoint& b, int32_t cosLatB);
+    static int32_t cosLatQ30(int32_t latE6);
+    static float havToMeters(uint64_t havQ60);
+};
+
+#endif
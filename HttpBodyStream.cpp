@@ -0,0 +1,126 @@
+#include "HttpBodyStream.h"
+
+HttpBodyStream::HttpBodyStream(HTTPClient& http)
+    : source(http.getStream()), chunked(http.header("Transfer-Encoding").equalsIgnoreCase("chunked")),
+      remaining(http.getSize()), chunkRemaining(0), finished(false), peeked(-1), bytesRead(0) {
+    if (!chunked && remaining == 0) {
+        finished = true;
+    }
+}
+
+int HttpBodyStream::available() {
+    if (peeked >= 0) {
+        return 1;
+    }
+    if (finished) {
+        return 0;
+    }
+
+    long buffered = source.available();
+    long limit = chunked ? chunkRemaining : remaining;
+    if (limit >= 0 && buffered > limit) {
+        buffered = limit;
+    }
+    return buffered;
+}
+
+int HttpBodyStream::read() {
+    if (peeked >= 0) {
+        int c = peeked;
+        peeked = -1;
+        return c;
+    }
+    return readRaw();
+}
+
+int HttpBodyStream::peek() {
+    if (peeked < 0) {
+        peeked = readRaw();
+    }
+    return peeked;
+}
+
+size_t HttpBodyStream::write(uint8_t) {
+    return 0;
+}
+
+void HttpBodyStream::drain() {
+    while (read() >= 0) {
+    }
+}
+
+unsigned long HttpBodyStream::getBytesRead() const {
+    return bytesRead;
+}
+
+int HttpBodyStream::readRaw() {
+    if (finished) {
+        return -1;
+    }
+
+    if (chunked && chunkRemaining == 0 && !readChunkHeader()) {
+        finished = true;
+        return -1;
+    }
+
+    // readBytes() espera con el timeout del cliente si aún no llegaron datos
+    char c;
+    if (source.readBytes(&c, 1) != 1) {
+        finished = true;
+        return -1;
+    }
+    bytesRead++;
+
+    if (chunked) {
+        chunkRemaining--;
+        if (chunkRemaining == 0) {
+            skipLine();  // CRLF que cierra cada chunk
+        }
+    } else if (remaining > 0) {
+        remaining--;
+        if (remaining == 0) {
+            finished = true;
+        }
+    }
+
+    return (uint8_t)c;
+}
+
+bool HttpBodyStream::readChunkHeader() {
+    // Formato: <tamaño hex>[;extensiones]\r\n
+    long size = 0;
+    bool inExtension = false;
+    char c;
+    while (source.readBytes(&c, 1) == 1 && c != '\n') {
+        if (inExtension || c == '\r') {
+            continue;
+        }
+        if (c == ';') {
+            inExtension = true;
+        } else if (c >= '0' && c <= '9') {
+            size = size * 16 + (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            size = size * 16 + (c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            size = size * 16 + (c - 'A' + 10);
+        }
+    }
+
+    if (size == 0) {
+        // Último chunk: consumir trailers hasta la línea vacía final
+        String line;
+        do {
+            line = source.readStringUntil('\n');
+        } while (line.length() > 1);
+        return false;
+    }
+
+    chunkRemaining = size;
+    return true;
+}
+
+void HttpBodyStream::skipLine() {
+    char c;
+    while (source.readBytes(&c, 1) == 1 && c != '\n') {
+    }
+}
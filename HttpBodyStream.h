@@ -0,0 +1,39 @@
+#ifndef HTTP_BODY_STREAM_H
+#define HTTP_BODY_STREAM_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+// Stream de solo lectura sobre el cuerpo de una respuesta HTTP/1.1. Respeta
+// Content-Length y decodifica Transfer-Encoding: chunked al vuelo, de modo que
+// ArduinoJson puede deserializar directamente desde la conexión keep-alive
+// sin copiar la respuesta completa a un String.
+class HttpBodyStream : public Stream {
+private:
+    Stream& source;
+    bool chunked;
+    long remaining;       // bytes restantes (-1 = hasta cerrar la conexión)
+    long chunkRemaining;
+    bool finished;
+    int peeked;           // byte leído por peek() pendiente de entregar (-1 = ninguno)
+    unsigned long bytesRead;
+
+    int readRaw();
+    bool readChunkHeader();
+    void skipLine();
+
+public:
+    explicit HttpBodyStream(HTTPClient& http);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override;
+
+    // Descarta lo que quede del cuerpo para poder reutilizar la conexión
+    void drain();
+
+    unsigned long getBytesRead() const;
+};
+
+#endif
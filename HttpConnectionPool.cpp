@@ -0,0 +1,248 @@
+#include "HttpConnectionPool.h"
+#include "Metrics.h"
+#include "TlsClient.h"
+
+// Cabeceras de respuesta que necesitan los lectores del cuerpo (HttpBodyStream) y el sondeo
+static const char* COLLECTED_HEADERS[] = { "Transfer-Encoding", "ETag", "Retry-After" };
+
+HttpConnectionPool::Connection::Connection()
+    : client(nullptr), port(0), secure(false), inUse(false), reused(false),
+      contentType("application/json"), headerCount(0), lastResult(0) {
+    host[0] = '\0';
+    url[0] = '\0';
+}
+
+HttpConnectionPool::HttpConnectionPool(int maxConnectionsPerHost)
+    : maxPerHost(maxConnectionsPerHost), reusedCount(0), establishedCount(0) {}
+
+HttpConnectionPool::~HttpConnectionPool() {
+    closeAll();
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        delete connections[i].client;
+        connections[i].client = nullptr;
+    }
+}
+
+HTTPClient* HttpConnectionPool::acquire(const char* url, const char* contentType) {
+    char host[MAX_HOST];
+    uint16_t port;
+    bool secure;
+    if (strlen(url) >= MAX_URL || !parseURL(url, host, sizeof(host), port, secure)) {
+        return nullptr;
+    }
+
+    Connection* connection = allocateConnection(host, port, secure);
+    if (connection == nullptr) {
+        return nullptr;
+    }
+
+    connection->inUse = true;
+    strcpy(connection->url, url);
+    connection->contentType = contentType;
+    connection->headerCount = 0;
+    prepare(connection);
+    return &connection->http;
+}
+
+int HttpConnectionPool::send(HTTPClient* http, const char* method, const char* payload) {
+    Connection* connection = findConnection(http);
+    if (connection == nullptr) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    // Sobrecarga de buffer crudo: no copia el cuerpo a un String
+    uint32_t startUs = micros();
+    uint8_t* body = (uint8_t*)payload;
+    size_t bodyLength = strlen(payload);
+    int httpResponseCode = http->sendRequest(method, body, bodyLength);
+
+    if (connection->reused && isConnectionError(httpResponseCode)) {
+        // El servidor cerró la conexión keep-alive mientras estaba inactiva
+        connection->client->stop();
+        prepare(connection);
+        httpResponseCode = http->sendRequest(method, body, bodyLength);
+    }
+
+    // Conexión nueva = DNS + handshake TCP/TLS + servidor; reutilizada = sólo servidor y red
+    if (connection->reused) {
+        reusedCount++;
+        Metrics::record(METRIC_HTTP_REUSED, micros() - startUs);
+    } else {
+        establishedCount++;
+        Metrics::record(METRIC_HTTP_NEW, micros() - startUs);
+    }
+
+    connection->lastResult = httpResponseCode;
+    return httpResponseCode;
+}
+
+bool HttpConnectionPool::setHeader(HTTPClient* http, const char* name, const char* value) {
+    Connection* connection = findConnection(http);
+    if (connection == nullptr || connection->headerCount >= MAX_EXTRA_HEADERS ||
+        strlen(name) >= MAX_HEADER_NAME || strlen(value) >= MAX_HEADER_VALUE) {
+        return false;
+    }
+
+    strcpy(connection->headerNames[connection->headerCount], name);
+    strcpy(connection->headerValues[connection->headerCount], value);
+    connection->headerCount++;
+    http->addHeader(name, value);
+    return true;
+}
+
+void HttpConnectionPool::release(HTTPClient* http) {
+    Connection* connection = findConnection(http);
+    if (connection == nullptr) {
+        return;
+    }
+
+    // Con setReuse(true) end() deja el socket abierto si el servidor lo permite
+    http->end();
+    if (isConnectionError(connection->lastResult)) {
+        connection->client->stop();
+    }
+    connection->inUse = false;
+}
+
+void HttpConnectionPool::closeAll() {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        close(&connections[i]);
+    }
+}
+
+unsigned long HttpConnectionPool::getReusedCount() const {
+    return reusedCount;
+}
+
+unsigned long HttpConnectionPool::getEstablishedCount() const {
+    return establishedCount;
+}
+
+HttpConnectionPool::Connection* HttpConnectionPool::findConnection(HTTPClient* http) {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (&connections[i].http == http) {
+            return &connections[i];
+        }
+    }
+    return nullptr;
+}
+
+HttpConnectionPool::Connection* HttpConnectionPool::allocateConnection(const char* host, uint16_t port, bool secure) {
+    int openForHost = 0;
+    Connection* idleForHost = nullptr;
+    Connection* empty = nullptr;
+    Connection* idleOther = nullptr;
+
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        Connection* connection = &connections[i];
+        bool sameHost = connection->client != nullptr && strcmp(connection->host, host) == 0 &&
+                        connection->port == port && connection->secure == secure;
+
+        if (sameHost) {
+            openForHost++;
+            if (!connection->inUse && idleForHost == nullptr) {
+                idleForHost = connection;
+            }
+        } else if (connection->client == nullptr) {
+            if (empty == nullptr) {
+                empty = connection;
+            }
+        } else if (!connection->inUse && idleOther == nullptr) {
+            idleOther = connection;
+        }
+    }
+
+    // Preferir una conexión ya abierta hacia el mismo host
+    if (idleForHost != nullptr) {
+        return idleForHost;
+    }
+
+    if (openForHost >= maxPerHost) {
+        return nullptr;
+    }
+
+    Connection* connection = empty;
+    if (connection == nullptr && idleOther != nullptr) {
+        // Desalojar una conexión inactiva de otro host
+        connection = idleOther;
+        close(connection);
+        delete connection->client;
+        connection->client = nullptr;
+    }
+
+    if (connection == nullptr) {
+        return nullptr;
+    }
+
+    if (secure) {
+        connection->client = TlsClient::createSecureClient();
+    } else {
+        connection->client = new WiFiClient();
+    }
+    strcpy(connection->host, host);  // parseURL ya limitó la longitud a MAX_HOST
+    connection->port = port;
+    connection->secure = secure;
+    return connection;
+}
+
+void HttpConnectionPool::prepare(Connection* connection) {
+    connection->reused = connection->client->connected();
+    connection->lastResult = 0;
+
+    connection->http.setReuse(true);
+    connection->http.begin(*connection->client, connection->url);
+    connection->http.addHeader("Content-Type", connection->contentType);
+    for (int i = 0; i < connection->headerCount; i++) {
+        connection->http.addHeader(connection->headerNames[i], connection->headerValues[i]);
+    }
+    connection->http.collectHeaders(COLLECTED_HEADERS, sizeof(COLLECTED_HEADERS) / sizeof(COLLECTED_HEADERS[0]));
+}
+
+void HttpConnectionPool::close(Connection* connection) {
+    if (connection->client == nullptr) {
+        return;
+    }
+    connection->http.end();
+    connection->client->stop();
+    connection->inUse = false;
+}
+
+bool HttpConnectionPool::parseURL(const char* url, char* host, size_t hostSize, uint16_t& port, bool& secure,
+                                  const char** path) {
+    const char* schemeEnd = strstr(url, "://");
+    if (schemeEnd == nullptr) {
+        return false;
+    }
+
+    secure = strncmp(url, "https", 5) == 0;
+    port = secure ? 443 : 80;
+
+    const char* hostStart = schemeEnd + 3;
+    const char* pathStart = strchr(hostStart, '/');
+    const char* authorityEnd = pathStart != nullptr ? pathStart : hostStart + strlen(hostStart);
+    if (path != nullptr) {
+        *path = pathStart != nullptr ? pathStart : "/";
+    }
+
+    const char* portStart = (const char*)memchr(hostStart, ':', authorityEnd - hostStart);
+    const char* hostEnd = portStart != nullptr ? portStart : authorityEnd;
+    if (portStart != nullptr) {
+        port = atoi(portStart + 1);
+    }
+
+    size_t hostLength = hostEnd - hostStart;
+    if (hostLength == 0 || hostLength >= hostSize) {
+        return false;
+    }
+    memcpy(host, hostStart, hostLength);
+    host[hostLength] = '\0';
+    return true;
+}
+
+bool HttpConnectionPool::isConnectionError(int httpResponseCode) {
+    return httpResponseCode == HTTPC_ERROR_CONNECTION_REFUSED ||
+           httpResponseCode == HTTPC_ERROR_SEND_HEADER_FAILED ||
+           httpResponseCode == HTTPC_ERROR_SEND_PAYLOAD_FAILED ||
+           httpResponseCode == HTTPC_ERROR_CONNECTION_LOST ||
+           httpResponseCode == HTTPC_ERROR_READ_TIMEOUT;
+}
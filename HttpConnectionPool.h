@@ -0,0 +1,85 @@
+#ifndef HTTP_CONNECTION_POOL_H
+#define HTTP_CONNECTION_POOL_H
+
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+
+// Pool de conexiones HTTP keep-alive: mantiene abiertas una o dos conexiones
+// por host y las reutiliza entre peticiones para evitar repetir el handshake
+// TCP/TLS en cada consulta al API.
+class HttpConnectionPool {
+public:
+    static const int MAX_CONNECTIONS = 4;
+    static const int MAX_EXTRA_HEADERS = 2;
+    // Base configurada (proximity-events/device/{id}, sensors/user/{id},
+    // sensors/) más lo que añade cada petición: "?since=" + cursor de evento
+    // (< 48), "{sensorId}/status" (id < 40) o "/stream"
+    static const size_t MAX_URL_PREFIX = 160;
+    static const size_t MAX_URL_SUFFIX = 64;
+    static const size_t MAX_URL = MAX_URL_PREFIX + MAX_URL_SUFFIX;
+    static const size_t MAX_HOST = 64;
+    static const size_t MAX_HEADER_NAME = 24;
+    static const size_t MAX_HEADER_VALUE = 96;
+
+private:
+    struct Connection {
+        WiFiClient* client;  // TlsClient::createSecureClient() para https, WiFiClient para http
+        HTTPClient http;
+        char host[MAX_HOST];
+        uint16_t port;
+        bool secure;
+        bool inUse;
+        bool reused;         // la petición actual viaja por una conexión ya abierta
+        // Copias en buffers fijos: preparar una petición no reserva memoria
+        char url[MAX_URL];
+        const char* contentType;  // debe ser una cadena estática
+        char headerNames[MAX_EXTRA_HEADERS][MAX_HEADER_NAME];
+        char headerValues[MAX_EXTRA_HEADERS][MAX_HEADER_VALUE];
+        int headerCount;
+        int lastResult;
+
+        Connection();
+    };
+
+    Connection connections[MAX_CONNECTIONS];
+    int maxPerHost;
+    unsigned long reusedCount;
+    unsigned long establishedCount;
+
+    Connection* findConnection(HTTPClient* http);
+    Connection* allocateConnection(const char* host, uint16_t port, bool secure);
+    void prepare(Connection* connection);
+    void close(Connection* connection);
+
+    static bool isConnectionError(int httpResponseCode);
+
+public:
+    HttpConnectionPool(int maxConnectionsPerHost = 2);
+    ~HttpConnectionPool();
+
+    // Devuelve un HTTPClient listo para la URL (begin() ya hecho) o nullptr
+    // si todas las conexiones del host están ocupadas o la URL no cabe.
+    HTTPClient* acquire(const char* url, const char* contentType = "application/json");
+
+    // Envía la petición; si una conexión reutilizada fue cerrada por el
+    // servidor, reconecta y reintenta una vez de forma transparente.
+    int send(HTTPClient* http, const char* method, const char* payload = "");
+
+    // Cabecera adicional que se conserva si send() tiene que reconectar
+    bool setHeader(HTTPClient* http, const char* name, const char* value);
+
+    // Libera la conexión dejándola abierta para la siguiente petición,
+    // salvo que la última respuesta haya sido un error de conexión.
+    void release(HTTPClient* http);
+
+    void closeAll();
+
+    unsigned long getReusedCount() const;
+    unsigned long getEstablishedCount() const;
+
+    // Extrae host, puerto y esquema sin crear Strings; path apunta dentro de url
+    static bool parseURL(const char* url, char* host, size_t hostSize, uint16_t& port, bool& secure,
+                         const char** path = nullptr);
+};
+
+#endif
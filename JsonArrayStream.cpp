@@ -0,0 +1,98 @@
+#include "JsonArrayStream.h"
+
+JsonArrayStream::JsonArrayStream(Stream& stream, JsonDocument& item, JsonDocument& filter)
+    : stream(stream), item(item), filter(filter), mode(START), count(0),
+      wrapped(nullptr), wrappedIndex(0) {}
+
+JsonArrayStream::~JsonArrayStream() {
+    delete wrapped;
+}
+
+bool JsonArrayStream::next(JsonObject& element) {
+    if (mode == START) {
+        start();
+    }
+
+    if (mode == STREAMING) {
+        int c = peekNonWhitespace();
+        if (c == ',') {
+            stream.read();
+            c = peekNonWhitespace();
+        }
+        if (c == ']' || c < 0) {
+            stream.read();
+            mode = DONE;
+            return false;
+        }
+
+        error = deserializeJson(item, stream, DeserializationOption::Filter(filter));
+        if (error) {
+            mode = DONE;
+            return false;
+        }
+        element = item.as<JsonObject>();
+        count++;
+        return true;
+    }
+
+    if (mode == BUFFERED) {
+        JsonArray data = (*wrapped)["data"];
+        if (!data.isNull()) {
+            if (wrappedIndex < (int)data.size()) {
+                element = data[wrappedIndex++];
+                count++;
+                return true;
+            }
+        } else if (wrappedIndex == 0) {
+            wrappedIndex++;
+            element = wrapped->as<JsonObject>();
+            count++;
+            return true;
+        }
+        mode = DONE;
+    }
+
+    return false;
+}
+
+DeserializationError JsonArrayStream::getError() const {
+    return error;
+}
+
+int JsonArrayStream::getCount() const {
+    return count;
+}
+
+int JsonArrayStream::peekNonWhitespace() {
+    int c = stream.peek();
+    while (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+        stream.read();
+        c = stream.peek();
+    }
+    return c;
+}
+
+void JsonArrayStream::start() {
+    int c = peekNonWhitespace();
+
+    if (c == '[') {
+        stream.read();
+        mode = STREAMING;
+        return;
+    }
+
+    if (c != '{') {
+        error = c < 0 ? DeserializationError::EmptyInput : DeserializationError::InvalidInput;
+        mode = DONE;
+        return;
+    }
+
+    // Objeto en la raíz: conservar los campos del elemento y la lista "data"
+    StaticJsonDocument<256> wrappedFilter;
+    wrappedFilter.set(filter);
+    wrappedFilter["data"][0].set(filter.as<JsonVariantConst>());
+
+    wrapped = new DynamicJsonDocument(WRAPPED_CAPACITY);
+    error = deserializeJson(*wrapped, stream, DeserializationOption::Filter(wrappedFilter));
+    mode = error ? DONE : BUFFERED;
+}
@@ -0,0 +1,47 @@
+#ifndef JSON_ARRAY_STREAM_H
+#define JSON_ARRAY_STREAM_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Recorre una lista JSON elemento a elemento directamente desde un Stream.
+// Cada elemento se deserializa con un filtro en un documento de tamaño fijo,
+// así que la memoria usada no depende del tamaño de la respuesta. Acepta un
+// array en la raíz, un objeto {"data": [...]} o un único objeto.
+class JsonArrayStream {
+public:
+    static const size_t WRAPPED_CAPACITY = 1024;
+
+private:
+    enum Mode {
+        START,
+        STREAMING,  // array en la raíz: un elemento por llamada a next()
+        BUFFERED,   // objeto en la raíz: se deserializa una vez con filtro
+        DONE
+    };
+
+    Stream& stream;
+    JsonDocument& item;
+    JsonDocument& filter;
+    Mode mode;
+    DeserializationError error;
+    int count;
+
+    DynamicJsonDocument* wrapped;
+    int wrappedIndex;
+
+    int peekNonWhitespace();
+    void start();
+
+public:
+    JsonArrayStream(Stream& stream, JsonDocument& item, JsonDocument& filter);
+    ~JsonArrayStream();
+
+    // Devuelve false al terminar la lista o ante un error de formato
+    bool next(JsonObject& element);
+
+    DeserializationError getError() const;
+    int getCount() const;
+};
+
+#endif
@@ -2,7 +2,8 @@
 #include <Arduino.h>
 
 Led::Led(int pin, bool inverted, CommandHandler* commandHandler)
-    : Actuator(pin, commandHandler), currentState(false), inverted(inverted) {
+    : Actuator(pin, commandHandler), currentState(false), inverted(inverted),
+      blinkTogglesLeft(0), blinkIntervalMs(0), nextBlinkToggle(0), blinkRestoreState(false) {
     init();
 }
 
@@ -11,16 +12,15 @@ void Led::init() {
     setState(false);
 }
 
+// Mismo orden que LedCommandId
+const Led::CommandTable Led::COMMANDS = CommandTable::make(
+    &Led::turnOn,
+    &Led::turnOff,
+    &Led::toggle,
+    &Led::blinkDefault);
+
 void Led::handle(Command command) {
-    if (command == LedCommands::TURN_ON) {
-        turnOn();
-    } else if (command == LedCommands::TURN_OFF) {
-        turnOff();
-    } else if (command == LedCommands::TOGGLE) {
-        toggle();
-    } else if (command == LedCommands::BLINK) {
-        blink();
-    } else {
+    if (!COMMANDS.dispatch(*this, command.id)) {
         Actuator::handle(command);
     }
 }
@@ -48,14 +48,39 @@ bool Led::getState() const {
 }
 
 void Led::blink(int times, int delayMs) {
-    bool originalState = currentState;
+    if (times <= 0) {
+        return;
+    }
     
-    for (int i = 0; i < times; i++) {
-        turnOn();
-        delay(delayMs);
-        turnOff();
-        delay(delayMs);
+    if (!isBlinking()) {
+        blinkRestoreState = currentState;
+    }
+    
+    blinkTogglesLeft = times * 2;
+    blinkIntervalMs = delayMs;
+    turnOn();
+    nextBlinkToggle = millis() + blinkIntervalMs;
+}
+
+void Led::update(unsigned long now) {
+    if (!isBlinking() || (long)(now - nextBlinkToggle) < 0) {
+        return;
     }
     
-    setState(originalState);
+    blinkTogglesLeft--;
+    if (blinkTogglesLeft > 0) {
+        toggle();
+        nextBlinkToggle += blinkIntervalMs;
+    } else {
+        // Último medio periodo apagado: restaurar el estado previo al parpadeo
+        setState(blinkRestoreState);
+    }
+}
+
+void Led::blinkDefault() {
+    blink();
+}
+
+bool Led::isBlinking() const {
+    return blinkTogglesLeft > 0;
 }
@@ -2,11 +2,32 @@
 #define LED_H
 
 #include "Actuator.h"
+#include "Dispatch.h"
 
-class Led : public Actuator {
+enum class LedCommandId : int {
+    TURN_ON = MessageDomains::LED_COMMANDS,
+    TURN_OFF,
+    TOGGLE,
+    BLINK,
+    END
+};
+
+// final: las llamadas sobre un Led* conocido no pasan por la vtable
+class Led final : public Actuator {
 private:
+    typedef DispatchTable<Led, LedCommandId, LedCommandId::TURN_ON, LedCommandId::END> CommandTable;
+    static const CommandTable COMMANDS;
+    
     bool currentState;
     bool inverted;
+    
+    // Parpadeo no bloqueante: se avanza desde update()
+    int blinkTogglesLeft;
+    unsigned long blinkIntervalMs;
+    unsigned long nextBlinkToggle;
+    bool blinkRestoreState;
+    
+    void blinkDefault();
 
 public:
     Led(int pin, bool inverted = false, CommandHandler* commandHandler = nullptr);
@@ -21,13 +42,15 @@ public:
     
     void init();
     void blink(int times = 1, int delayMs = 500);
+    void update(unsigned long now);
+    bool isBlinking() const;
 };
 
 namespace LedCommands {
-    const Command TURN_ON(1);
-    const Command TURN_OFF(2);
-    const Command TOGGLE(3);
-    const Command BLINK(4);
+    constexpr Command TURN_ON(LedCommandId::TURN_ON);
+    constexpr Command TURN_OFF(LedCommandId::TURN_OFF);
+    constexpr Command TOGGLE(LedCommandId::TOGGLE);
+    constexpr Command BLINK(LedCommandId::BLINK);
 }
 
 #endif
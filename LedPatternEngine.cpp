@@ -0,0 +1,218 @@
+#include "LedPatternEngine.h"
+
+LedWaveform::LedWaveform()
+    : pattern(LED_PATTERN_OFF), step(0), flashToggles(0), flashHalfPeriodMs(0), deadlineUs(0) {}
+
+void LedWaveform::start(uint8_t newPattern, int64_t nowUs) {
+    pattern = newPattern < LED_PATTERN_COUNT ? newPattern : (uint8_t)LED_PATTERN_OFF;
+    step = 0;
+    deadlineUs = nowUs;
+}
+
+void LedWaveform::flash(uint8_t times, uint16_t halfPeriodMs, int64_t nowUs) {
+    flashToggles = times * 2;
+    flashHalfPeriodMs = halfPeriodMs;
+    deadlineUs = nowUs;
+}
+
+bool LedWaveform::advance(int64_t nowUs, uint8_t& level, uint16_t& fadeMs) {
+    fadeMs = 0;
+
+    if (flashToggles > 0) {
+        // Encendido en los toggles pares: times destellos completos
+        level = (flashToggles % 2 == 0) ? 255 : 0;
+        flashToggles--;
+        deadlineUs += (int64_t)flashHalfPeriodMs * 1000;
+        if (flashToggles == 0) {
+            step = 0;  // al terminar se reanuda el patrón desde el principio
+        }
+        return true;
+    }
+
+    const LedPatternSpec& spec = LedPatterns::get(pattern);
+    const LedStep& current = spec.steps[step];
+
+    level = current.level;
+    if (current.fade) {
+        fadeMs = current.durationMs;
+    }
+    if (current.durationMs == 0) {
+        return false;
+    }
+
+    step = (step + 1) % spec.stepCount;
+    deadlineUs += (int64_t)current.durationMs * 1000;
+    if (deadlineUs <= nowUs) {
+        // Demasiado retraso (no debería pasar): resincronizar sin ráfagas
+        deadlineUs = nowUs + (int64_t)current.durationMs * 1000;
+    }
+    return true;
+}
+
+LedPatternEngine::LedPatternEngine() : channelCount(0), hardwareReady(false) {}
+
+LedPatternEngine::~LedPatternEngine() {
+    for (int i = 0; i < channelCount; i++) {
+        esp_timer_stop(channels[i].timer);
+        esp_timer_delete(channels[i].timer);
+    }
+}
+
+int LedPatternEngine::addChannel(int pin) {
+    if (channelCount >= MAX_CHANNELS) {
+        return -1;
+    }
+
+    if (!hardwareReady) {
+        ledc_timer_config_t timerConfig = {};
+        timerConfig.speed_mode = SPEED_MODE;
+        timerConfig.timer_num = PWM_TIMER;
+        timerConfig.duty_resolution = PWM_RESOLUTION;
+        timerConfig.freq_hz = PWM_FREQUENCY;
+        timerConfig.clk_cfg = LEDC_AUTO_CLK;
+        if (ledc_timer_config(&timerConfig) != ESP_OK) {
+            return -1;
+        }
+        // Las rampas (breathing) las ejecuta el hardware
+        ledc_fade_func_install(0);
+        hardwareReady = true;
+    }
+
+    int index = channelCount;
+    Channel& channel = channels[index];
+    channel.owner = this;
+    channel.pin = pin;
+    channel.ledcChannel = (ledc_channel_t)(LEDC_CHANNEL_0 + index);
+    // portMUX_INITIALIZER_UNLOCKED es un inicializador de llaves: no admite asignación directa
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    channel.lock = unlocked;
+    channel.patternRequested = false;
+    channel.requestedPattern = LED_PATTERN_OFF;
+    channel.flashRequested = false;
+    channel.requestedFlashes = 0;
+    channel.requestedHalfPeriodMs = 0;
+    channel.currentPattern = LED_PATTERN_OFF;
+
+    ledc_channel_config_t channelConfig = {};
+    channelConfig.gpio_num = pin;
+    channelConfig.speed_mode = SPEED_MODE;
+    channelConfig.channel = channel.ledcChannel;
+    channelConfig.timer_sel = PWM_TIMER;
+    channelConfig.duty = 0;
+    channelConfig.hpoint = 0;
+    if (ledc_channel_config(&channelConfig) != ESP_OK) {
+        return -1;
+    }
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onTimer;
+    timerArgs.arg = &channel;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "led_pattern";
+    if (esp_timer_create(&timerArgs, &channel.timer) != ESP_OK) {
+        return -1;
+    }
+
+    channelCount++;
+    return index;
+}
+
+void LedPatternEngine::setPattern(int index, uint8_t pattern) {
+    if (index < 0 || index >= channelCount || channels[index].currentPattern == pattern) {
+        return;
+    }
+
+    Channel& channel = channels[index];
+    channel.currentPattern = pattern;
+
+    portENTER_CRITICAL(&channel.lock);
+    channel.requestedPattern = pattern;
+    channel.patternRequested = true;
+    portEXIT_CRITICAL(&channel.lock);
+
+    wake(channel);
+}
+
+void LedPatternEngine::flash(int index, uint8_t times, uint16_t halfPeriodMs) {
+    if (index < 0 || index >= channelCount || times == 0) {
+        return;
+    }
+
+    Channel& channel = channels[index];
+    portENTER_CRITICAL(&channel.lock);
+    channel.requestedFlashes = times;
+    channel.requestedHalfPeriodMs = halfPeriodMs;
+    channel.flashRequested = true;
+    portEXIT_CRITICAL(&channel.lock);
+
+    wake(channel);
+}
+
+uint8_t LedPatternEngine::getPattern(int index) const {
+    return index >= 0 && index < channelCount ? channels[index].currentPattern : (uint8_t)LED_PATTERN_OFF;
+}
+
+void LedPatternEngine::wake(Channel& channel) {
+    // La petición se aplica desde el callback, el único que toca el LEDC
+    esp_timer_stop(channel.timer);
+    esp_timer_start_once(channel.timer, 0);
+}
+
+void LedPatternEngine::onTimer(void* argument) {
+    Channel* channel = static_cast<Channel*>(argument);
+    channel->owner->run(*channel);
+}
+
+void LedPatternEngine::run(Channel& channel) {
+    int64_t now = esp_timer_get_time();
+
+    bool newPattern = false;
+    bool newFlash = false;
+    uint8_t pattern = 0;
+    uint8_t flashes = 0;
+    uint16_t halfPeriodMs = 0;
+
+    portENTER_CRITICAL(&channel.lock);
+    if (channel.patternRequested) {
+        newPattern = true;
+        pattern = channel.requestedPattern;
+        channel.patternRequested = false;
+    }
+    if (channel.flashRequested) {
+        newFlash = true;
+        flashes = channel.requestedFlashes;
+        halfPeriodMs = channel.requestedHalfPeriodMs;
+        channel.flashRequested = false;
+    }
+    portEXIT_CRITICAL(&channel.lock);
+
+    LedWaveform& waveform = channel.waveform;
+    if (newPattern) {
+        waveform.start(pattern, now);
+    }
+    if (newFlash) {
+        waveform.flash(flashes, halfPeriodMs, now);
+    }
+
+    uint8_t level;
+    uint16_t fadeMs;
+    bool rearm = waveform.advance(now, level, fadeMs);
+
+    if (fadeMs > 0) {
+        ledc_set_fade_with_time(SPEED_MODE, channel.ledcChannel, toDuty(level), fadeMs);
+        ledc_fade_start(SPEED_MODE, channel.ledcChannel, LEDC_FADE_NO_WAIT);
+    } else {
+        ledc_set_duty(SPEED_MODE, channel.ledcChannel, toDuty(level));
+        ledc_update_duty(SPEED_MODE, channel.ledcChannel);
+    }
+
+    if (rearm) {
+        int64_t delay = waveform.deadlineUs - esp_timer_get_time();
+        esp_timer_start_once(channel.timer, delay > 0 ? delay : 0);
+    }
+}
+
+uint32_t LedPatternEngine::toDuty(uint8_t level) {
+    // 0-255 a la resolución de 10 bits del timer LEDC
+    return ((uint32_t)level * ((1u << PWM_RESOLUTION) - 1)) / 255;
+}
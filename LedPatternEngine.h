@@ -0,0 +1,133 @@
+#ifndef LED_PATTERN_ENGINE_H
+#define LED_PATTERN_ENGINE_H
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+enum LedPattern : uint8_t {
+    LED_PATTERN_OFF = 0,
+    LED_PATTERN_SOLID = 1,
+    LED_PATTERN_SLOW_BLINK = 2,
+    LED_PATTERN_FAST_BLINK = 3,
+    LED_PATTERN_BREATHING = 4,
+    LED_PATTERN_DOUBLE_PULSE = 5,
+    LED_PATTERN_COUNT
+};
+
+struct LedStep {
+    uint8_t level;        // brillo 0-255 al final del paso
+    uint16_t durationMs;  // 0 = mantener indefinidamente
+    bool fade;            // llegar a level con rampa hardware durante durationMs
+};
+
+struct LedPatternSpec {
+    const char* name;      // para los logs
+    const LedStep* steps;  // secuencia de fases, se repite en bucle
+    uint8_t stepCount;
+};
+
+// Tabla de patrones: añadir uno es añadir su secuencia, una fila en TABLE y
+// su valor en LedPattern. Todo se resuelve en compilación.
+namespace LedPatterns {
+    template <size_t N>
+    constexpr uint8_t countOf(const LedStep (&)[N]) {
+        return N;
+    }
+
+    constexpr LedStep OFF_STEPS[] = {{0, 0, false}};
+    constexpr LedStep SOLID_STEPS[] = {{255, 0, false}};
+    constexpr LedStep SLOW_BLINK_STEPS[] = {{255, 1000, false}, {0, 1000, false}};
+    constexpr LedStep FAST_BLINK_STEPS[] = {{255, 300, false}, {0, 300, false}};
+    constexpr LedStep BREATHING_STEPS[] = {{255, 1500, true}, {0, 1500, true}};
+    constexpr LedStep DOUBLE_PULSE_STEPS[] = {{255, 120, false}, {0, 180, false}, {255, 120, false}, {0, 1080, false}};
+
+    constexpr LedPatternSpec TABLE[] = {
+        {"APAGADO", OFF_STEPS, countOf(OFF_STEPS)},
+        {"SÓLIDO", SOLID_STEPS, countOf(SOLID_STEPS)},
+        {"PARPADEO LENTO", SLOW_BLINK_STEPS, countOf(SLOW_BLINK_STEPS)},
+        {"PARPADEO RÁPIDO", FAST_BLINK_STEPS, countOf(FAST_BLINK_STEPS)},
+        {"RESPIRACIÓN", BREATHING_STEPS, countOf(BREATHING_STEPS)},
+        {"DOBLE PULSO", DOUBLE_PULSE_STEPS, countOf(DOUBLE_PULSE_STEPS)},
+    };
+    static_assert(sizeof(TABLE) / sizeof(TABLE[0]) == LED_PATTERN_COUNT, "TABLE necesita una fila por LedPattern");
+
+    constexpr const LedPatternSpec& get(uint8_t pattern) {
+        return TABLE[pattern < LED_PATTERN_COUNT ? pattern : (uint8_t)LED_PATTERN_OFF];
+    }
+}
+
+// Forma de onda de un canal. No toca hardware: dado el instante actual dice
+// qué nivel aplicar y cuándo es el siguiente paso, así que se puede simular
+// en el host. Los deadlines son absolutos (se suman duraciones al deadline
+// anterior), por lo que el periodo no deriva aunque el callback llegue tarde.
+struct LedWaveform {
+    uint8_t pattern;
+    uint8_t step;
+    uint8_t flashToggles;         // medios periodos de destello pendientes
+    uint16_t flashHalfPeriodMs;
+    int64_t deadlineUs;
+
+    LedWaveform();
+    void start(uint8_t newPattern, int64_t nowUs);
+    void flash(uint8_t times, uint16_t halfPeriodMs, int64_t nowUs);
+
+    // Ejecuta el paso vencido. Devuelve false si el nivel queda fijo y no
+    // hace falta volver a despertar (deadlineUs no se usa)
+    bool advance(int64_t nowUs, uint8_t& level, uint16_t& fadeMs);
+};
+
+// Motor de patrones LED: el PWM y las rampas los genera el periférico LEDC y
+// cada cambio de paso lo dispara un esp_timer, fuera del loop. Los patrones
+// siguen exactos aunque una petición HTTP bloquee loop().
+class LedPatternEngine {
+public:
+    static const int MAX_CHANNELS = 8;  // canales LEDC de baja velocidad
+    static const uint32_t PWM_FREQUENCY = 5000;
+    static const ledc_mode_t SPEED_MODE = LEDC_LOW_SPEED_MODE;
+    static const ledc_timer_t PWM_TIMER = LEDC_TIMER_1;
+    static const ledc_timer_bit_t PWM_RESOLUTION = LEDC_TIMER_10_BIT;
+
+private:
+    struct Channel {
+        LedPatternEngine* owner;
+        int pin;
+        ledc_channel_t ledcChannel;
+        esp_timer_handle_t timer;
+        LedWaveform waveform;  // sólo la toca la tarea de esp_timer
+
+        // Peticiones desde el loop, protegidas por lock
+        portMUX_TYPE lock;
+        bool patternRequested;
+        uint8_t requestedPattern;
+        bool flashRequested;
+        uint8_t requestedFlashes;
+        uint16_t requestedHalfPeriodMs;
+
+        uint8_t currentPattern;  // último patrón pedido (lado del loop)
+    };
+
+    Channel channels[MAX_CHANNELS];
+    int channelCount;
+    bool hardwareReady;
+
+    static void onTimer(void* argument);
+    void run(Channel& channel);
+    void wake(Channel& channel);
+    static uint32_t toDuty(uint8_t level);
+
+public:
+    LedPatternEngine();
+    ~LedPatternEngine();
+
+    // Devuelve el índice del canal o -1 si no hay más canales o falló el LEDC
+    int addChannel(int pin);
+
+    void setPattern(int channel, uint8_t pattern);
+    // Destello temporal (times encendidos); luego vuelve al patrón actual
+    void flash(int channel, uint8_t times, uint16_t halfPeriodMs);
+    uint8_t getPattern(int channel) const;
+};
+
+#endif
@@ -0,0 +1,252 @@
+#include "Logger.h"
+
+static const char LEVEL_LETTERS[] = {'-', 'E', 'W', 'I', 'D'};
+static const char* const MODULE_NAMES[LOG_MODULE_COUNT] = {"DEV", "NET", "SENS", "LED", "STAT"};
+
+MpscQueue<LogRecord, Logger::CAPACITY> Logger::queue;
+TaskHandle_t Logger::drainTaskHandle = nullptr;
+uint32_t Logger::written = 0;
+uint32_t Logger::reportedDrops = 0;
+uint32_t Logger::highWater = 0;
+
+void Logger::begin(int core, UBaseType_t priority) {
+    if (drainTaskHandle != nullptr) {
+        return;
+    }
+    xTaskCreatePinnedToCore(drainTask, "log_drain", DRAIN_STACK_SIZE, nullptr, priority, &drainTaskHandle, core);
+}
+
+void Logger::drainTask(void* parameter) {
+    for (;;) {
+        if (drain(DRAIN_BATCH) == 0) {
+            vTaskDelay(pdMS_TO_TICKS(DRAIN_IDLE));
+        }
+    }
+}
+
+void Logger::start(LogRecord& entry, uint8_t module, uint8_t level, const char* format) {
+    entry.format = format;
+    entry.timestampMs = millis();
+    entry.level = level;
+    entry.module = module;
+    entry.argCount = 0;
+    entry.textUsed = 0;
+}
+
+void Logger::add(LogRecord& entry, LogArgType type, LogArg value) {
+    entry.types[entry.argCount] = type;
+    entry.args[entry.argCount] = value;
+    entry.argCount++;
+}
+
+void Logger::store(LogRecord& entry, int value) {
+    LogArg arg;
+    arg.i = value;
+    add(entry, LOG_ARG_SIGNED, arg);
+}
+
+void Logger::store(LogRecord& entry, long value) {
+    store(entry, (int)value);
+}
+
+void Logger::store(LogRecord& entry, long long value) {
+    store(entry, (int)value);
+}
+
+void Logger::store(LogRecord& entry, unsigned int value) {
+    LogArg arg;
+    arg.u = value;
+    add(entry, LOG_ARG_UNSIGNED, arg);
+}
+
+void Logger::store(LogRecord& entry, unsigned long value) {
+    store(entry, (unsigned int)value);
+}
+
+void Logger::store(LogRecord& entry, unsigned long long value) {
+    store(entry, (unsigned int)value);
+}
+
+void Logger::store(LogRecord& entry, double value) {
+    LogArg arg;
+    arg.f = (float)value;
+    add(entry, LOG_ARG_FLOAT, arg);
+}
+
+void Logger::store(LogRecord& entry, const char* value) {
+    // Se copia truncando al espacio libre; si no queda, apunta al último
+    // terminador escrito (cadena vacía)
+    LogArg arg;
+    size_t available = LogRecord::TEXT_SIZE - entry.textUsed;
+    if (available == 0) {
+        arg.offset = LogRecord::TEXT_SIZE - 1;
+    } else {
+        arg.offset = entry.textUsed;
+        const char* source = value != nullptr ? value : "";
+        size_t length = strnlen(source, available - 1);
+        memcpy(entry.text + entry.textUsed, source, length);
+        entry.text[entry.textUsed + length] = '\0';
+        entry.textUsed += length + 1;
+    }
+    add(entry, LOG_ARG_STRING, arg);
+}
+
+void Logger::store(LogRecord& entry, const String& value) {
+    store(entry, value.c_str());
+}
+
+int Logger::drain(int maxRecords) {
+    uint32_t pending = queue.size();
+    if (pending > highWater) {
+        highWater = pending;
+    }
+
+    // Avisar de lo descartado antes de los registros que sí llegaron
+    uint32_t dropped = queue.getOverflows();
+    if (dropped != reportedDrops) {
+        char message[48];
+        snprintf(message, sizeof(message), "%lu registros descartados", (unsigned long)(dropped - reportedDrops));
+        writeLine('W', millis(), "LOG", message);
+        reportedDrops = dropped;
+    }
+
+    int count = 0;
+    LogRecord entry;
+    char message[LINE_SIZE];
+    while (count < maxRecords && queue.pop(entry)) {
+        format(entry, message, sizeof(message));
+        char levelLetter = entry.level < sizeof(LEVEL_LETTERS) ? LEVEL_LETTERS[entry.level] : '?';
+        const char* module = entry.module < LOG_MODULE_COUNT ? MODULE_NAMES[entry.module] : "?";
+        writeLine(levelLetter, entry.timestampMs, module, message);
+        count++;
+    }
+    written += count;
+    return count;
+}
+
+void Logger::writeLine(char levelLetter, uint32_t timestampMs, const char* module, const char* message) {
+    // Mismo aspecto que los logs de ESP-IDF: "I (12345) NET: mensaje"
+    char prefix[32];
+    int length = snprintf(prefix, sizeof(prefix), "%c (%lu) %s: ", levelLetter, (unsigned long)timestampMs, module);
+    Serial.write((const uint8_t*)prefix, length);
+    Serial.write((const uint8_t*)message, strlen(message));
+    Serial.write('\n');
+}
+
+// Un argumento según la conversión del formato; si el tipo guardado no
+// encaja se convierte (o se escribe "?" para cadenas)
+static int formatArgument(const LogRecord& entry, int index, const char* spec, char conversion,
+                          char* out, size_t size) {
+    if (index >= entry.argCount) {
+        return snprintf(out, size, "?");
+    }
+
+    uint8_t type = entry.types[index];
+    const LogArg& arg = entry.args[index];
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'c': {
+            int value = type == LOG_ARG_FLOAT ? (int)arg.f : arg.i;
+            return type == LOG_ARG_STRING ? snprintf(out, size, "?") : snprintf(out, size, spec, value);
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o': {
+            unsigned int value = type == LOG_ARG_FLOAT ? (unsigned int)arg.f : arg.u;
+            return type == LOG_ARG_STRING ? snprintf(out, size, "?") : snprintf(out, size, spec, value);
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G': {
+            double value = type == LOG_ARG_FLOAT ? (double)arg.f
+                           : type == LOG_ARG_SIGNED ? (double)arg.i
+                           : (double)arg.u;
+            return type == LOG_ARG_STRING ? snprintf(out, size, "?") : snprintf(out, size, spec, value);
+        }
+        case 's':
+            return type == LOG_ARG_STRING ? snprintf(out, size, spec, entry.text + arg.offset)
+                                          : snprintf(out, size, "?");
+        default:
+            return snprintf(out, size, "?");
+    }
+}
+
+size_t Logger::format(const LogRecord& entry, char* out, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    size_t length = 0;
+    int argIndex = 0;
+    const char* p = entry.format;
+
+    while (*p != '\0' && length + 1 < size) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            out[length++] = '%';
+            p++;
+            continue;
+        }
+
+        // Se conservan flags, ancho y precisión; los modificadores de longitud
+        // sobran porque los argumentos ya están normalizados a 32 bits
+        char spec[16];
+        size_t specLength = 0;
+        spec[specLength++] = '%';
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr) {
+            if (specLength < sizeof(spec) - 2) {
+                spec[specLength++] = *p;
+            }
+            p++;
+        }
+        while (*p != '\0' && strchr("hlLjzt", *p) != nullptr) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char conversion = *p++;
+        spec[specLength++] = conversion;
+        spec[specLength] = '\0';
+
+        int count = formatArgument(entry, argIndex++, spec, conversion, out + length, size - length);
+        if (count > 0) {
+            // snprintf devuelve lo que habría escrito: limitar a lo que cabe
+            length += (size_t)count < size - length ? (size_t)count : size - length - 1;
+        }
+    }
+
+    out[length] = '\0';
+    return length;
+}
+
+uint32_t Logger::getWritten() {
+    return written;
+}
+
+uint32_t Logger::getDropped() {
+    return queue.getOverflows();
+}
+
+size_t Logger::getPending() {
+    return queue.size();
+}
+
+uint32_t Logger::getHighWater() {
+    return highWater;
+}
+
+void Logger::printStats() {
+    LOG_INFO(STATS, "Log: %lu escritos, %u pendientes (máx: %lu/%u, descartados: %lu)", written,
+             (unsigned int)getPending(), highWater, (unsigned int)CAPACITY, getDropped());
+}
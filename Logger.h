@@ -0,0 +1,154 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "EventBus.h"
+
+// Niveles de log: un registro se compila sólo si su nivel es <= el umbral
+// de su módulo
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Umbrales por módulo en compilación. Se cambian con flags de build, p. ej.
+// -DLOG_THRESHOLD_NET=LOG_LEVEL_DEBUG o -DLOG_THRESHOLD=LOG_LEVEL_WARN
+#ifndef LOG_THRESHOLD
+#define LOG_THRESHOLD LOG_LEVEL_INFO
+#endif
+#ifndef LOG_THRESHOLD_DEVICE
+#define LOG_THRESHOLD_DEVICE LOG_THRESHOLD
+#endif
+#ifndef LOG_THRESHOLD_NET
+#define LOG_THRESHOLD_NET LOG_THRESHOLD
+#endif
+#ifndef LOG_THRESHOLD_SENSORS
+#define LOG_THRESHOLD_SENSORS LOG_THRESHOLD
+#endif
+#ifndef LOG_THRESHOLD_LEDS
+#define LOG_THRESHOLD_LEDS LOG_THRESHOLD
+#endif
+#ifndef LOG_THRESHOLD_STATS
+#define LOG_THRESHOLD_STATS LOG_THRESHOLD
+#endif
+
+enum LogModule : uint8_t {
+    LOG_MODULE_DEVICE,   // GeoEntryDevice: eventos, WiFi, enter/exit
+    LOG_MODULE_NET,      // transportes REST/MQTT y peticiones HTTP
+    LOG_MODULE_SENSORS,  // estados de sensores y caché
+    LOG_MODULE_LEDS,     // patrones de los LEDs inteligentes
+    LOG_MODULE_STATS,    // estadísticas de UPDATE_STATUS
+    LOG_MODULE_COUNT
+};
+
+enum LogArgType : uint8_t {
+    LOG_ARG_SIGNED,
+    LOG_ARG_UNSIGNED,
+    LOG_ARG_FLOAT,
+    LOG_ARG_STRING
+};
+
+union LogArg {
+    int32_t i;
+    uint32_t u;
+    float f;
+    uint32_t offset;  // posición de la cadena en text
+};
+
+// Un registro ocupa un hueco fijo del anillo: el formato (un literal, que
+// hace de id), la marca de tiempo y los argumentos ya convertidos. Las
+// cadenas se copian en text porque pueden no sobrevivir hasta el volcado
+struct LogRecord {
+    static const int MAX_ARGS = 8;
+    static const size_t TEXT_SIZE = 40;
+
+    const char* format;
+    uint32_t timestampMs;
+    uint8_t level;
+    uint8_t module;
+    uint8_t argCount;
+    uint8_t textUsed;
+    uint8_t types[MAX_ARGS];
+    LogArg args[MAX_ARGS];
+    char text[TEXT_SIZE];
+};
+
+// Log diferido: record() sólo copia el registro al anillo (sin formatear ni
+// tocar Serial) y una tarea de baja prioridad lo formatea y lo vuelca. Si el
+// anillo está lleno el registro se descarta y se cuenta. Los enteros de 64
+// bits se guardan truncados a 32.
+class Logger {
+public:
+    static const size_t CAPACITY = 64;
+    static const size_t LINE_SIZE = 192;
+    static const int DRAIN_BATCH = 16;
+    static const unsigned long DRAIN_IDLE = 20;
+    static const uint32_t DRAIN_STACK_SIZE = 4096;
+
+private:
+    static MpscQueue<LogRecord, CAPACITY> queue;
+    static TaskHandle_t drainTaskHandle;
+    static uint32_t written;
+    static uint32_t reportedDrops;
+    static uint32_t highWater;
+
+    static void start(LogRecord& entry, uint8_t module, uint8_t level, const char* format);
+    static void add(LogRecord& entry, LogArgType type, LogArg value);
+
+    static void store(LogRecord& entry, int value);
+    static void store(LogRecord& entry, long value);
+    static void store(LogRecord& entry, long long value);
+    static void store(LogRecord& entry, unsigned int value);
+    static void store(LogRecord& entry, unsigned long value);
+    static void store(LogRecord& entry, unsigned long long value);
+    static void store(LogRecord& entry, double value);
+    static void store(LogRecord& entry, const char* value);
+    static void store(LogRecord& entry, const String& value);
+
+    static void drainTask(void* parameter);
+    static void writeLine(char levelLetter, uint32_t timestampMs, const char* module, const char* message);
+
+public:
+    // Arranca la tarea de volcado. Antes de begin() los registros esperan en el anillo
+    static void begin(int core, UBaseType_t priority);
+
+    template <typename... Args>
+    static void record(uint8_t module, uint8_t level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Demasiados argumentos para un registro de log");
+        LogRecord entry;
+        start(entry, module, level, format);
+        int expand[] = {0, (store(entry, args), 0)...};
+        (void)expand;
+        queue.push(entry);
+    }
+
+    // Formatea y vuelca como mucho maxRecords; sólo desde un único consumidor
+    // (la tarea de volcado, o el llamador si no se ha llamado a begin())
+    static int drain(int maxRecords);
+
+    // Aplica el formato printf del registro a sus argumentos guardados
+    static size_t format(const LogRecord& entry, char* out, size_t size);
+
+    static uint32_t getWritten();
+    static uint32_t getDropped();
+    static size_t getPending();
+    static uint32_t getHighWater();
+    static void printStats();
+};
+
+#define LOG_AT(module, level, format, ...)                                               \
+    do {                                                                                 \
+        if ((level) <= LOG_THRESHOLD_##module) {                                         \
+            Logger::record(LOG_MODULE_##module, (level), format, ##__VA_ARGS__);         \
+        }                                                                                \
+    } while (0)
+
+#define LOG_ERROR(module, format, ...) LOG_AT(module, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define LOG_WARN(module, format, ...) LOG_AT(module, LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOG_INFO(module, format, ...) LOG_AT(module, LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_DEBUG(module, format, ...) LOG_AT(module, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+
+#endif
@@ -0,0 +1,130 @@
+#include "Metrics.h"
+#include "Logger.h"
+
+static const char* const STAGE_NAMES[METRIC_STAGE_COUNT] = {
+    "network_step", "control_step", "proximity_poll", "sensor_poll", "http_new", "http_reused",
+    "json_parse", "process_event", "event_to_control", "actuate_enqueue", "patch", "actuation_batch",
+    "led_update", "tls_handshake", "tls_resume", "geofence",
+};
+
+LatencyHistogram Metrics::histograms[METRIC_STAGE_COUNT];
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucketFor(uint32_t us) {
+    if (us < SUB_BUCKETS) {
+        return us;  // 0..3 us exactos
+    }
+    // Bit más alto y los dos siguientes: 4..7 -> 4..7, 8..9 -> 8, 10..11 -> 9, ...
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - 2)) & (SUB_BUCKETS - 1);
+    int bucket = (msb - 1) * SUB_BUCKETS + sub;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint32_t LatencyHistogram::bucketLimit(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket + 1;
+    }
+    int msb = bucket / SUB_BUCKETS + 1;
+    int sub = bucket % SUB_BUCKETS;
+    return (uint32_t)(SUB_BUCKETS + sub + 1) << (msb - 2);
+}
+
+void LatencyHistogram::record(uint32_t us) {
+    buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t current = maxUs.load(std::memory_order_relaxed);
+    while (us > current && !maxUs.compare_exchange_weak(current, us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    maxUs.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::getMax() const {
+    return maxUs.load(std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::percentile(float p) const {
+    uint32_t total = getCount();
+    if (total == 0) {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)(p * total + 0.999f);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    // Los cubos pueden ir por delante de count si hay un record() en curso
+    uint32_t seen = 0;
+    uint32_t maximum = getMax();
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint32_t limit = bucketLimit(i) - 1;
+            return limit < maximum ? limit : maximum;
+        }
+    }
+    return maximum;
+}
+
+const LatencyHistogram& Metrics::get(MetricStage stage) {
+    return histograms[stage];
+}
+
+const char* Metrics::getName(MetricStage stage) {
+    return stage < METRIC_STAGE_COUNT ? STAGE_NAMES[stage] : "?";
+}
+
+void Metrics::reset() {
+    for (int i = 0; i < METRIC_STAGE_COUNT; i++) {
+        histograms[i].reset();
+    }
+}
+
+void Metrics::printStats() {
+    LOG_INFO(STATS, "Memoria: %lu B libres (mínimo: %lu B, bloque máx: %lu B)", (unsigned long)ESP.getFreeHeap(),
+             (unsigned long)ESP.getMinFreeHeap(), (unsigned long)ESP.getMaxAllocHeap());
+
+    for (int i = 0; i < METRIC_STAGE_COUNT; i++) {
+        const LatencyHistogram& histogram = histograms[i];
+        if (histogram.getCount() == 0) {
+            continue;
+        }
+        LOG_INFO(STATS, "⏱️ %s: %lu muestras, p50 %lu us, p90 %lu us, p99 %lu us, máx %lu us", STAGE_NAMES[i],
+                 (unsigned long)histogram.getCount(), (unsigned long)histogram.percentile(0.50f),
+                 (unsigned long)histogram.percentile(0.90f), (unsigned long)histogram.percentile(0.99f),
+                 (unsigned long)histogram.getMax());
+    }
+}
+
+void Metrics::write(Print& out) {
+    out.printf("uptime_ms %lu\n", millis());
+    out.printf("heap_free %lu\n", (unsigned long)ESP.getFreeHeap());
+    out.printf("heap_min_free %lu\n", (unsigned long)ESP.getMinFreeHeap());
+    out.printf("heap_max_alloc %lu\n", (unsigned long)ESP.getMaxAllocHeap());
+    out.printf("# etapa n p50_us p90_us p99_us max_us\n");
+
+    for (int i = 0; i < METRIC_STAGE_COUNT; i++) {
+        const LatencyHistogram& histogram = histograms[i];
+        if (histogram.getCount() == 0) {
+            continue;
+        }
+        out.printf("%s %lu %lu %lu %lu %lu\n", STAGE_NAMES[i], (unsigned long)histogram.getCount(),
+                   (unsigned long)histogram.percentile(0.50f), (unsigned long)histogram.percentile(0.90f),
+                   (unsigned long)histogram.percentile(0.99f), (unsigned long)histogram.getMax());
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Métricas de latencia por etapa en RAM fija. Se desactivan en compilación
+// con -DMETRICS_ENABLED=0 (METRIC_SCOPE y Metrics::record no generan código)
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+enum MetricStage : uint8_t {
+    METRIC_NETWORK_STEP,      // un paso de la tarea de red (sondeos, transporte, WiFi)
+    METRIC_CONTROL_STEP,      // un paso de la tarea de control
+    METRIC_PROXIMITY_POLL,    // pollProximity completo
+    METRIC_SENSOR_POLL,       // pollSensors completo
+    METRIC_HTTP_NEW,          // petición por conexión nueva: DNS + TCP/TLS + servidor
+    METRIC_HTTP_REUSED,       // petición por conexión keep-alive: servidor + red
+    METRIC_JSON_PARSE,        // lectura y parseo en streaming del cuerpo
+    METRIC_PROCESS_EVENT,     // processEvent
+    METRIC_EVENT_TO_CONTROL,  // de processEvent (red) a onUserEntered/Exited (control)
+    METRIC_ACTUATE_ENQUEUE,   // actuateAll: caché (o GET) y encolado de los PATCH
+    METRIC_PATCH,             // un PATCH de sensor en un trabajador
+    METRIC_ACTUATION_BATCH,   // primer encolado -> último PATCH del lote
+    METRIC_LED_UPDATE,        // updateSmartLedPatterns
+    METRIC_TLS_HANDSHAKE,     // handshake TLS completo (TlsClient, sin sesión guardada)
+    METRIC_TLS_RESUME,        // handshake TLS ofreciendo la sesión guardada del host
+    METRIC_GEOFENCE,          // evaluación de una posición en las geovallas locales
+    METRIC_STAGE_COUNT
+};
+
+// Histograma logarítmico en microsegundos: 4 cubos por potencia de dos
+// (error relativo < 25 %) hasta ~16 s; lo que supera el rango va al último.
+// record() es seguro desde varias tareas y no bloquea
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 4;
+    static const int BUCKETS = 92;
+
+private:
+    std::atomic<uint32_t> buckets[BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> maxUs;
+
+public:
+    LatencyHistogram();
+
+    void record(uint32_t us);
+    void reset();
+
+    uint32_t getCount() const;
+    uint32_t getMax() const;
+    // Cota superior del cubo que contiene el percentil (0 < p <= 1), sin pasar del máximo
+    uint32_t percentile(float p) const;
+
+    static int bucketFor(uint32_t us);
+    static uint32_t bucketLimit(int bucket);  // primer valor que ya no cabe en el cubo
+};
+
+class Metrics {
+private:
+    static LatencyHistogram histograms[METRIC_STAGE_COUNT];
+
+public:
+    static void record(MetricStage stage, uint32_t us) {
+#if METRICS_ENABLED
+        histograms[stage].record(us);
+#else
+        (void)stage;
+        (void)us;
+#endif
+    }
+
+    static const LatencyHistogram& get(MetricStage stage);
+    static const char* getName(MetricStage stage);
+    static void reset();
+
+    // Volcado periódico por el log (UPDATE_STATUS)
+    static void printStats();
+
+    // Texto compacto para un endpoint /metrics: "nombre valor" por línea y
+    // una línea "etapa n p50 p90 p99 máx" (us) por cada etapa con muestras
+    static void write(Print& out);
+};
+
+// Mide el ámbito en el que se declara y lo registra al salir
+class StageTimer {
+private:
+    MetricStage stage;
+    uint32_t startUs;
+
+public:
+    explicit StageTimer(MetricStage stage) : stage(stage), startUs(micros()) {}
+    ~StageTimer() { Metrics::record(stage, micros() - startUs); }
+};
+
+#define METRIC_CONCAT_(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_(a, b)
+
+#if METRICS_ENABLED
+#define METRIC_SCOPE(stage) StageTimer METRIC_CONCAT(stageTimer, __LINE__)(METRIC_##stage)
+#else
+#define METRIC_SCOPE(stage) ((void)0)
+#endif
+
+#endif
@@ -3,9 +3,27 @@
 
 #include "EventHandler.h"
 #include "CommandHandler.h"
+#include "Dispatch.h"
+#include "EventBus.h"
+#include "StateSnapshot.h"
+#include "Logger.h"
 #include "Sensor.h"
 #include "Actuator.h"
 #include "Device.h"
+#include "HttpConnectionPool.h"
+#include "ActuationPipeline.h"
+#include "Scheduler.h"
+#include "WiFiConnection.h"
+#include "HttpBodyStream.h"
+#include "JsonArrayStream.h"
+#include "EventStreamClient.h"
+#include "SensorCache.h"
+#include "SensorRegistry.h"
+#include "LedPatternEngine.h"
+#include "SmartLedArray.h"
+#include "Transport.h"
+#include "RestTransport.h"
+#include "MqttTransport.h"
 #include "Led.h"
 #include "GeoEntryDevice.h"
 
@@ -0,0 +1,387 @@
+#include "MqttTransport.h"
+#include "Logger.h"
+
+MqttTransport::MqttTransport(const String& uri, const String& deviceID, const String& userID,
+                             const String& prefix)
+    : listener(nullptr), client(nullptr), messages(nullptr), started(false), connected(false),
+      brokerURI(uri), deviceId(deviceID), userId(userID), topicPrefix(prefix),
+      sensorsDirty(false), pendingCount(0), batchStart(0),
+      connects(0), published(0), droppedMessages(0) {
+    memset(pending, 0, sizeof(pending));
+
+    eventFilter["event_id"] = true;
+    eventFilter["id"] = true;
+    eventFilter["event_type"] = true;
+    eventFilter["distance"] = true;
+    eventFilter["home_location_name"] = true;
+}
+
+MqttTransport::~MqttTransport() {
+    if (client != nullptr) {
+        esp_mqtt_client_destroy(client);
+    }
+    if (messages != nullptr) {
+        vQueueDelete(messages);
+    }
+}
+
+void MqttTransport::setCredentials(const String& user, const String& pass) {
+    username = user;
+    password = pass;
+}
+
+const char* MqttTransport::getName() const {
+    return "MQTT";
+}
+
+void MqttTransport::begin(TransportListener* transportListener) {
+    listener = transportListener;
+    if (client != nullptr) {
+        return;
+    }
+
+    clientId = "geoentry-" + deviceId;
+    proximityTopic = topicPrefix + "devices/" + deviceId + "/proximity";
+    statusTopic = topicPrefix + "devices/" + deviceId + "/status";
+    sensorTopicPrefix = topicPrefix + "users/" + userId + "/sensors/";
+    sensorSubscription = sensorTopicPrefix + "+";
+
+    messages = xQueueCreate(QUEUE_LENGTH, sizeof(Message));
+
+    esp_mqtt_client_config_t config = {};
+#if ESP_IDF_VERSION_MAJOR >= 5
+    config.broker.address.uri = brokerURI.c_str();
+    config.credentials.client_id = clientId.c_str();
+    config.credentials.username = username.isEmpty() ? nullptr : username.c_str();
+    config.credentials.authentication.password = password.isEmpty() ? nullptr : password.c_str();
+    config.session.keepalive = KEEPALIVE_SECONDS;
+    config.session.last_will.topic = statusTopic.c_str();
+    config.session.last_will.msg = "offline";
+    config.session.last_will.qos = 1;
+    config.session.last_will.retain = 1;
+#else
+    config.uri = brokerURI.c_str();
+    config.client_id = clientId.c_str();
+    config.username = username.isEmpty() ? nullptr : username.c_str();
+    config.password = password.isEmpty() ? nullptr : password.c_str();
+    config.keepalive = KEEPALIVE_SECONDS;
+    config.lwt_topic = statusTopic.c_str();
+    config.lwt_msg = "offline";
+    config.lwt_qos = 1;
+    config.lwt_retain = 1;
+#endif
+
+    client = esp_mqtt_client_init(&config);
+    if (client == nullptr) {
+        LOG_ERROR(NET, "❌ No se pudo crear el cliente MQTT");
+        return;
+    }
+    esp_mqtt_client_register_event(client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, mqttEventHandler, this);
+}
+
+void MqttTransport::update(unsigned long now, bool networkUp) {
+    if (client == nullptr) {
+        return;
+    }
+
+    // esp-mqtt reconecta por su cuenta una vez arrancado
+    if (!started && networkUp) {
+        started = esp_mqtt_client_start(client) == ESP_OK;
+    }
+
+    for (int i = 0; i < MESSAGES_PER_UPDATE; i++) {
+        if (xQueueReceive(messages, &received, 0) != pdTRUE) {
+            break;
+        }
+        processMessage(received, now);
+    }
+
+    // Entregar una sola instantánea cuando se vacía la ráfaga de retenidos
+    if (sensorsDirty && uxQueueMessagesWaiting(messages) == 0) {
+        sensorsDirty = false;
+        sensorCache.notify(listener);
+    }
+
+    // La suscripción mantiene la caché al día mientras hay conexión
+    if (connected) {
+        sensorCache.touch(now);
+    }
+
+    expirePending(now);
+}
+
+void MqttTransport::pollProximity(const char* cursor) {
+    // Los eventos llegan por el tópico retenido; no hay nada que sondear
+}
+
+void MqttTransport::pollSensors() {
+    // El estado de los sensores llega por sus tópicos retenidos
+}
+
+int MqttTransport::actuateAll(bool targetState) {
+    if (!connected || !sensorCache.lookup(millis())) {
+        LOG_ERROR(NET, "❌ Broker MQTT no conectado");
+        return -1;
+    }
+
+    unsigned long now = millis();
+    int sensorsActuated = 0;
+    for (int i = 0; i < sensorCache.getCapacity(); i++) {
+        const CachedSensor* sensor = sensorCache.get(i);
+        if (sensor == nullptr) {
+            continue;
+        }
+        if (sensor->isActive == targetState) {
+            if (targetState) {
+                LOG_DEBUG(SENSORS, "✅ %s ya estaba encendido", sensor->type);
+            }
+            continue;
+        }
+        if (publishActuation(sensor->id, sensor->type, targetState, now) >= 0) {
+            sensorsActuated++;
+        } else {
+            reportNotQueued(listener, sensor->id, sensor->type, targetState);
+        }
+    }
+    return sensorsActuated;
+}
+
+bool MqttTransport::actuate(const char* sensorId, const char* sensorType, bool targetState) {
+    if (!connected) {
+        return false;
+    }
+    return publishActuation(sensorId, sensorType, targetState, millis()) >= 0;
+}
+
+const SensorCache& MqttTransport::getSensorCache() const {
+    return sensorCache;
+}
+
+void MqttTransport::printStatus() {
+    LOG_INFO(STATS, "MQTT %s (conexiones: %lu, publicados: %lu, sin confirmar: %d, descartados: %lu)",
+             connected ? "conectado" : "desconectado", connects, published, pendingCount,
+             (unsigned long)droppedMessages);
+    sensorCache.printStats();
+}
+
+bool MqttTransport::isConnected() const {
+    return connected;
+}
+
+unsigned long MqttTransport::getDroppedMessages() const {
+    return droppedMessages;
+}
+
+void MqttTransport::mqttEventHandler(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData) {
+    static_cast<MqttTransport*>(handlerArgs)->onMqttEvent(static_cast<esp_mqtt_event_handle_t>(eventData));
+}
+
+void MqttTransport::onMqttEvent(esp_mqtt_event_handle_t event) {
+    // Corre en la tarea de esp-mqtt: sólo copiar a la cola, sin logs ni listener
+    switch (event->event_id) {
+        case MQTT_EVENT_CONNECTED:
+            // Sensores antes que proximidad: sus retenidos llegan primero y un
+            // evento "enter" retenido ya encuentra la caché cargada
+            esp_mqtt_client_subscribe(client, sensorSubscription.c_str(), 1);
+            esp_mqtt_client_subscribe(client, proximityTopic.c_str(), 1);
+            esp_mqtt_client_publish(client, statusTopic.c_str(), "online", 0, 1, 1);
+            incoming.kind = CONNECTED;
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            incoming.kind = DISCONNECTED;
+            break;
+        case MQTT_EVENT_PUBLISHED:
+            incoming.kind = PUBLISHED;
+            incoming.msgId = event->msg_id;
+            break;
+        case MQTT_EVENT_DATA:
+            // Los mensajes fragmentados o demasiado grandes no caben en la cola
+            if (event->current_data_offset != 0 || event->data_len != event->total_data_len ||
+                event->topic_len >= (int)MAX_TOPIC || event->data_len >= (int)MAX_PAYLOAD) {
+                droppedMessages++;
+                return;
+            }
+            incoming.kind = DATA;
+            memcpy(incoming.topic, event->topic, event->topic_len);
+            incoming.topic[event->topic_len] = '\0';
+            memcpy(incoming.payload, event->data, event->data_len);
+            incoming.payload[event->data_len] = '\0';
+            break;
+        default:
+            return;
+    }
+
+    if (xQueueSend(messages, &incoming, 0) != pdTRUE) {
+        droppedMessages++;
+    }
+}
+
+void MqttTransport::processMessage(const Message& message, unsigned long now) {
+    switch (message.kind) {
+        case CONNECTED:
+            connected = true;
+            connects++;
+            sensorCache.touch(now);
+            LOG_INFO(NET, "📡 Conectado al broker MQTT: %s", brokerURI.c_str());
+            listener->onTransportConnected();
+            break;
+        case DISCONNECTED:
+            if (connected) {
+                LOG_WARN(NET, "📡 Desconectado del broker MQTT");
+            }
+            connected = false;
+            break;
+        case PUBLISHED:
+            // El broker tiene el comando, pero el sensor aún no lo ha aplicado
+            for (int i = 0; i < MAX_PENDING; i++) {
+                if (pending[i].msgId == message.msgId) {
+                    pending[i].acked = true;
+                    break;
+                }
+            }
+            break;
+        case DATA:
+            if (proximityTopic == message.topic) {
+                processProximity(message.payload);
+            } else if (strncmp(message.topic, sensorTopicPrefix.c_str(), sensorTopicPrefix.length()) == 0) {
+                processSensor(message.topic + sensorTopicPrefix.length(), message.payload);
+            }
+            break;
+    }
+}
+
+void MqttTransport::processProximity(const char* payload) {
+    if (payload[0] == '\0') {
+        return;  // Retenido borrado
+    }
+
+    StaticJsonDocument<EVENT_DOC_SIZE> event;
+    DeserializationError error = deserializeJson(event, payload, DeserializationOption::Filter(eventFilter));
+
+    if (error) {
+        LOG_ERROR(NET, "Error parsing MQTT JSON: %s", error.c_str());
+        listener->onRequestResult(false);
+        return;
+    }
+
+    listener->onRequestResult(true);
+    listener->onProximityEvent(event.as<JsonObject>());
+}
+
+void MqttTransport::processSensor(const char* sensorId, const char* payload) {
+    if (sensorId[0] == '\0' || strchr(sensorId, '/') != nullptr) {
+        return;
+    }
+
+    if (payload[0] == '\0') {
+        // Retenido vacío: el sensor se dio de baja
+        if (sensorCache.remove(sensorId)) {
+            sensorsDirty = true;
+        }
+        return;
+    }
+
+    StaticJsonDocument<SENSOR_DOC_SIZE> sensor;
+    DeserializationError error = deserializeJson(sensor, payload);
+    if (error) {
+        LOG_ERROR(NET, "Error parsing sensor MQTT JSON: %s", error.c_str());
+        return;
+    }
+
+    // Cada mensaje retenido es un delta sobre la caché
+    bool isActive = sensor["isActive"] | false;
+    if (sensorCache.apply(sensorId, sensor["sensor_type"] | "", isActive, millis())) {
+        sensorsDirty = true;
+    }
+    confirmActuation(sensorId, isActive, millis());
+}
+
+void MqttTransport::confirmActuation(const char* sensorId, bool isActive, unsigned long now) {
+    // El estado puede llegar antes que el PUBACK: basta con que coincida
+    for (int i = 0; i < MAX_PENDING; i++) {
+        if (pending[i].msgId != 0 && pending[i].targetState == isActive &&
+            strcmp(pending[i].sensorId, sensorId) == 0) {
+            completeActuation(i, 200, now);
+        }
+    }
+}
+
+int MqttTransport::publishActuation(const char* sensorId, const char* sensorType, bool targetState,
+                                     unsigned long now) {
+    int slot = -1;
+    for (int i = 0; i < MAX_PENDING; i++) {
+        if (pending[i].msgId == 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        LOG_ERROR(SENSORS, "❌ Demasiadas actuaciones sin confirmar, no se pudo actuar sobre %s", sensorType);
+        return -1;
+    }
+    // Recortado en la entrada pendiente, el estado retenido nunca la confirmaría
+    if (strlen(sensorId) >= sizeof(pending[slot].sensorId) || strlen(sensorType) >= sizeof(pending[slot].sensorType)) {
+        LOG_ERROR(SENSORS, "❌ Id o tipo de sensor demasiado largo, actuación descartada");
+        return -1;
+    }
+
+    LOG_INFO(SENSORS, "🔌 %s sensor: %s (ID: %s)", targetState ? "Encendiendo" : "Apagando", sensorType,
+             sensorId);
+
+    char topic[MAX_TOPIC];
+    int topicLength = snprintf(topic, sizeof(topic), "%s%s/set", sensorTopicPrefix.c_str(), sensorId);
+    if (topicLength < 0 || topicLength >= (int)sizeof(topic)) {
+        LOG_ERROR(SENSORS, "❌ Tópico demasiado largo para %s (ID: %s)", sensorType, sensorId);
+        return -1;
+    }
+    const char* payload = targetState ? "{\"isActive\": true}" : "{\"isActive\": false}";
+
+    // enqueue no bloquea el loop: la tarea de esp-mqtt envía y espera el PUBACK
+    int msgId = esp_mqtt_client_enqueue(client, topic, payload, 0, 1, 0, true);
+    if (msgId <= 0) {
+        LOG_ERROR(SENSORS, "❌ No se pudo publicar la actuación de %s", sensorType);
+        return -1;
+    }
+
+    if (pendingCount == 0) {
+        batchStart = now;
+    }
+    pendingCount++;
+    published++;
+
+    PendingActuation& entry = pending[slot];
+    entry.msgId = msgId;
+    snprintf(entry.sensorId, sizeof(entry.sensorId), "%s", sensorId);
+    snprintf(entry.sensorType, sizeof(entry.sensorType), "%s", sensorType);
+    entry.targetState = targetState;
+    entry.acked = false;
+    entry.sentAt = now;
+    return msgId;
+}
+
+void MqttTransport::completeActuation(int slot, int responseCode, unsigned long now) {
+    PendingActuation& entry = pending[slot];
+
+    ActuationResult result;
+    memcpy(result.sensorId, entry.sensorId, sizeof(result.sensorId));
+    memcpy(result.sensorType, entry.sensorType, sizeof(result.sensorType));
+    result.targetState = entry.targetState;
+    result.httpResponseCode = responseCode;
+    result.durationMs = now - entry.sentAt;
+
+    entry.msgId = 0;
+    pendingCount--;
+    result.batchComplete = pendingCount == 0;
+
+    listener->onActuationResult(result, result.batchComplete ? now - batchStart : 0);
+}
+
+void MqttTransport::expirePending(unsigned long now) {
+    for (int i = 0; i < MAX_PENDING; i++) {
+        if (pending[i].msgId != 0 && now - pending[i].sentAt >= ACK_TIMEOUT) {
+            // Sin estado retenido a tiempo no hay confirmación: el diario la
+            // reintentará igual que un fallo (-1: ni siquiera hubo PUBACK)
+            completeActuation(i, pending[i].acked ? ActuationResult::UNCONFIRMED : -1, now);
+        }
+    }
+}
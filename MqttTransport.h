@@ -0,0 +1,126 @@
+#ifndef MQTT_TRANSPORT_H
+#define MQTT_TRANSPORT_H
+
+#include "Transport.h"
+#include <mqtt_client.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+// Transporte MQTT sobre el cliente esp-mqtt de ESP-IDF: una sola conexión
+// persistente en lugar de sondeos. Tópicos (bajo topicPrefix):
+//   devices/{deviceId}/proximity          último evento de proximidad (retenido)
+//   devices/{deviceId}/status             "online" / "offline" (retenido, LWT)
+//   users/{userId}/sensors/{sensorId}     estado del sensor (retenido)
+//   users/{userId}/sensors/{sensorId}/set comando {"isActive": bool}, QoS 1
+// El PUBACK sólo dice que el broker tiene el comando; una actuación se da
+// por hecha cuando el estado retenido del sensor llega con el valor pedido.
+// La tarea de esp-mqtt sólo copia los mensajes a una cola; update() los
+// procesa desde el loop, donde se llama al listener.
+class MqttTransport : public Transport {
+public:
+    static const int MAX_PENDING = 16;
+    static const int QUEUE_LENGTH = 16;
+    static const int MESSAGES_PER_UPDATE = 4;
+    static const size_t MAX_TOPIC = 128;
+    static const size_t MAX_PAYLOAD = 384;
+    static const unsigned long ACK_TIMEOUT = 10000;  // hasta el estado retenido
+    static const int KEEPALIVE_SECONDS = 30;
+
+private:
+    enum MessageKind : uint8_t {
+        CONNECTED,
+        DISCONNECTED,
+        DATA,
+        PUBLISHED
+    };
+
+    struct Message {
+        MessageKind kind;
+        int msgId;
+        char topic[MAX_TOPIC];
+        char payload[MAX_PAYLOAD];
+    };
+
+    struct PendingActuation {
+        int msgId;  // 0 = libre
+        char sensorId[40];
+        char sensorType[24];
+        bool targetState;
+        bool acked;  // PUBACK recibido; falta el estado retenido
+        unsigned long sentAt;
+    };
+
+    TransportListener* listener;
+    esp_mqtt_client_handle_t client;
+    QueueHandle_t messages;
+    bool started;
+    bool connected;
+
+    String brokerURI;
+    String username;
+    String password;
+    String deviceId;
+    String userId;
+    String topicPrefix;
+
+    // Se construyen en begin() y no cambian mientras la tarea MQTT las lee
+    String clientId;
+    String proximityTopic;
+    String statusTopic;
+    String sensorTopicPrefix;  // users/{userId}/sensors/
+    String sensorSubscription; // users/{userId}/sensors/+
+
+    static const size_t EVENT_DOC_SIZE = 384;
+    static const size_t SENSOR_DOC_SIZE = 192;
+    StaticJsonDocument<128> eventFilter;
+
+    // Estado retenido de los sensores; se mantiene al día mientras hay conexión
+    SensorCache sensorCache;
+    bool sensorsDirty;
+
+    PendingActuation pending[MAX_PENDING];
+    int pendingCount;
+    unsigned long batchStart;
+
+    Message incoming;  // sólo la usa la tarea de esp-mqtt
+    Message received;  // sólo la usa el loop
+
+    unsigned long connects;
+    unsigned long published;
+    volatile unsigned long droppedMessages;
+
+    static void mqttEventHandler(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData);
+    void onMqttEvent(esp_mqtt_event_handle_t event);
+
+    void processMessage(const Message& message, unsigned long now);
+    void processProximity(const char* payload);
+    void processSensor(const char* sensorId, const char* payload);
+    int publishActuation(const char* sensorId, const char* sensorType, bool targetState, unsigned long now);
+    void confirmActuation(const char* sensorId, bool isActive, unsigned long now);
+    void completeActuation(int slot, int responseCode, unsigned long now);
+    void expirePending(unsigned long now);
+
+public:
+    MqttTransport(const String& brokerURI, const String& deviceID, const String& userID,
+                  const String& topicPrefix = "geoentry/");
+    ~MqttTransport();
+
+    // Debe llamarse antes de begin()
+    void setCredentials(const String& user, const String& pass);
+
+    const char* getName() const override;
+
+    void begin(TransportListener* transportListener) override;
+    void update(unsigned long now, bool networkUp) override;
+    void pollProximity(const char* cursor) override;
+    void pollSensors() override;
+    int actuateAll(bool targetState) override;
+    bool actuate(const char* sensorId, const char* sensorType, bool targetState) override;
+    const SensorCache& getSensorCache() const override;
+    void printStatus() override;
+
+    bool isConnected() const;
+    unsigned long getDroppedMessages() const;
+};
+
+#endif
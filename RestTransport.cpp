@@ -0,0 +1,436 @@
+#include "RestTransport.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+void PollStats::record(unsigned long bytes, bool wasNotModified) {
+    polls++;
+    lastBytes = bytes;
+    totalBytes += bytes;
+    if (wasNotModified) {
+        notModified++;
+    }
+}
+
+RestTransport::RestTransport(const String& apiURL, const String& edgeAPIURL,
+                             const String& deviceID, const String& userID)
+    : listener(nullptr), serverURL(apiURL), edgeURL(edgeAPIURL), deviceId(deviceID), userId(userID), rejectedURLs(0),
+      proximityURLValid(false), sensorsURLValid(false),
+      proximityBreaker("proximity"), sensorsBreaker("sensors"), actuationPipeline(edgeAPIURL), batchChangedCache(false), sensorsDelivered(false),
+      pushClient(this), lastProximityPoll(0) {
+    proximityETag[0] = '\0';
+    sensorsETag[0] = '\0';
+    buildURLs();
+    initializeJsonFilters();
+}
+
+const char* RestTransport::getName() const {
+    return "REST";
+}
+
+void RestTransport::begin(TransportListener* transportListener) {
+    listener = transportListener;
+    actuationPipeline.begin();
+}
+
+void RestTransport::update(unsigned long now, bool networkUp) {
+    pushClient.update(now, networkUp);
+    processActuationResults();
+}
+
+void RestTransport::pollProximity(const char* cursor) {
+    // Con push activo el sondeo queda como red de seguridad de baja frecuencia
+    if (pushClient.isSubscribed() && millis() - lastProximityPoll < PUSH_FALLBACK_POLL_INTERVAL) {
+        return;
+    }
+
+    // URL truncada al configurar: apuntaría a otro recurso
+    if (!proximityURLValid) {
+        rejectedURLs++;
+        return;
+    }
+
+    // API caída: ni red ni avisos de error hasta la siguiente sonda
+    if (!proximityBreaker.allow(millis())) {
+        return;
+    }
+
+    lastProximityPoll = millis();
+    METRIC_SCOPE(PROXIMITY_POLL);
+
+    // Cursor incremental: pedir sólo eventos posteriores al último procesado
+    char url[HttpConnectionPool::MAX_URL];
+    const char* requestURL = proximityURL;
+    if (cursor[0] != '\0') {
+        if (!checkURL(snprintf(url, sizeof(url), "%s?since=%s", proximityURL, cursor), "proximidad")) {
+            return;
+        }
+        requestURL = url;
+    }
+
+    HTTPClient* http = connectionPool.acquire(requestURL);
+    if (http == nullptr) {
+        LOG_WARN(NET, "Sin conexiones HTTP disponibles");
+        return;
+    }
+
+    if (proximityETag[0] != '\0') {
+        connectionPool.setHeader(http, "If-None-Match", proximityETag);
+    }
+
+    LOG_DEBUG(NET, "Consultando: %s", requestURL);
+
+    int httpResponseCode = connectionPool.send(http, "GET");
+    proximityBreaker.record(httpResponseCode, millis(), reportRetryAfter(http, httpResponseCode));
+
+    if (httpResponseCode == HTTP_CODE_NOT_MODIFIED) {
+        // Sin cambios: el servidor no envía cuerpo
+        listener->onRequestResult(true);
+        proximityPollStats.record(0, true);
+    } else if (!CircuitBreaker::isFailure(httpResponseCode)) {
+        listener->onRequestResult(true);
+
+        char etag[HttpConnectionPool::MAX_HEADER_VALUE];
+        copyETag(http, etag);
+
+        // Deserializar directamente desde la conexión, sin copiar a un String
+        HttpBodyStream body(*http);
+        bool cursorMoved = processProximityEvents(body, cursor);
+        body.drain();
+        proximityPollStats.record(body.getBytesRead(), false);
+
+        // Si avanzó el cursor la URL cambia y el ETag anterior ya no aplica
+        bool keepETag = httpResponseCode == HTTP_CODE_OK && !cursorMoved;
+        snprintf(proximityETag, sizeof(proximityETag), "%s", keepETag ? etag : "");
+    } else {
+        LOG_ERROR(NET, "Error en petición HTTP: %d", httpResponseCode);
+        listener->onRequestResult(false);
+    }
+
+    connectionPool.release(http);
+}
+
+bool RestTransport::processProximityEvents(Stream& body, const char* cursor) {
+    METRIC_SCOPE(JSON_PARSE);
+    // Sólo interesa el evento más reciente (el primero de la lista)
+    StaticJsonDocument<EVENT_DOC_SIZE> item;
+    JsonArrayStream events(body, item, eventFilter);
+
+    JsonObject latestEvent;
+    if (events.next(latestEvent)) {
+        const char* eventId = latestEvent["event_id"] | "";
+        if (eventId[0] == '\0') {
+            eventId = latestEvent["id"] | "";
+        }
+        bool cursorMoved = strcmp(eventId, cursor) != 0;
+        listener->onProximityEvent(latestEvent);
+        return cursorMoved;
+    }
+
+    if (events.getError()) {
+        LOG_ERROR(NET, "Error parsing JSON: %s", events.getError().c_str());
+    } else if (cursor[0] == '\0') {
+        LOG_DEBUG(NET, "No hay eventos de proximidad");
+    }
+    return false;
+}
+
+void RestTransport::pollSensors() {
+    if (!sensorsURLValid) {
+        rejectedURLs++;
+        return;
+    }
+
+    if (!sensorsBreaker.allow(millis())) {
+        return;
+    }
+
+    METRIC_SCOPE(SENSOR_POLL);
+    HTTPClient* http = connectionPool.acquire(sensorsURL);
+    if (http == nullptr) {
+        LOG_WARN(NET, "Sin conexiones HTTP disponibles");
+        return;
+    }
+
+    if (sensorsETag[0] != '\0') {
+        connectionPool.setHeader(http, "If-None-Match", sensorsETag);
+    }
+
+    LOG_DEBUG(NET, "Consultando sensores: %s", sensorsURL);
+
+    int httpResponseCode = connectionPool.send(http, "GET");
+    sensorsBreaker.record(httpResponseCode, millis(), reportRetryAfter(http, httpResponseCode));
+
+    if (httpResponseCode == HTTP_CODE_NOT_MODIFIED) {
+        // La lista no cambió: la caché sigue siendo válida
+        sensorCache.touch(millis());
+        sensorPollStats.record(0, true);
+    } else if (!CircuitBreaker::isFailure(httpResponseCode)) {
+        char etag[HttpConnectionPool::MAX_HEADER_VALUE];
+        copyETag(http, etag);
+
+        HttpBodyStream body(*http);
+        bool complete = processSensorStates(body);
+        body.drain();
+        sensorPollStats.record(body.getBytesRead(), false);
+
+        // Un 304 posterior sólo vale si la caché recogió la lista entera
+        bool keepETag = httpResponseCode == HTTP_CODE_OK && complete;
+        snprintf(sensorsETag, sizeof(sensorsETag), "%s", keepETag ? etag : "");
+    } else {
+        LOG_ERROR(NET, "Error en petición de sensores: %d", httpResponseCode);
+    }
+
+    connectionPool.release(http);
+}
+
+void RestTransport::copyETag(HTTPClient* http, char* etag) {
+    // HTTPClient guarda las cabeceras como String; se copia a un buffer fijo.
+    // Un ETag más largo que el buffer se descarta (no sería válido truncado)
+    const String& value = http->header("ETag");
+    if (value.length() < HttpConnectionPool::MAX_HEADER_VALUE) {
+        memcpy(etag, value.c_str(), value.length() + 1);
+    } else {
+        etag[0] = '\0';
+    }
+}
+
+unsigned long RestTransport::reportRetryAfter(HTTPClient* http, int httpResponseCode) {
+    unsigned long delayMs = CircuitBreaker::retryAfterMs(http, httpResponseCode);
+    if (delayMs > 0) {
+        LOG_WARN(NET, "⏳ El servidor pide esperar %lu ms (HTTP %d)", delayMs, httpResponseCode);
+        listener->onRetryAfter(delayMs);
+    }
+    return delayMs;
+}
+
+bool RestTransport::processSensorStates(Stream& body) {
+    METRIC_SCOPE(JSON_PARSE);
+    StaticJsonDocument<SENSOR_DOC_SIZE> item;
+    JsonArrayStream sensors(body, item, sensorFilter);
+
+    // Reconciliar por diferencias contra la caché
+    sensorCache.beginSync();
+    JsonObject sensor;
+    while (sensors.next(sensor)) {
+        sensorCache.apply(sensor["id"].as<const char*>(), sensor["sensor_type"].as<const char*>(),
+                          sensor["isActive"].as<bool>(), millis());
+    }
+
+    bool complete = !sensors.getError();
+    if (!complete) {
+        LOG_ERROR(NET, "Error parsing sensors JSON: %s", sensors.getError().c_str());
+    }
+
+    int changes = sensorCache.endSync(complete, millis());
+    if (changes > 0 || !sensorsDelivered) {
+        sensorsDelivered = true;
+        sensorCache.notify(listener);
+    }
+    return complete;
+}
+
+int RestTransport::actuateAll(bool targetState) {
+    if (!sensorCache.lookup(millis())) {
+        // Caché vacía u obsoleta: revalidar con un GET condicional (un 304 basta)
+        pollSensors();
+        if (!sensorCache.isFresh(millis())) {
+            LOG_ERROR(SENSORS, "❌ No se pudo obtener el estado de los sensores");
+            return -1;
+        }
+    }
+
+    int sensorsActuated = 0;
+    for (int i = 0; i < sensorCache.getCapacity(); i++) {
+        const CachedSensor* sensor = sensorCache.get(i);
+        if (sensor == nullptr) {
+            continue;
+        }
+
+        if (sensor->isActive != targetState) {
+            LOG_INFO(SENSORS, "🔌 %s sensor: %s (ID: %s)", targetState ? "Encendiendo" : "Apagando",
+                     sensor->type, sensor->id);
+            if (actuationPipeline.enqueue(sensor->id, sensor->type, targetState)) {
+                sensorsActuated++;
+            } else {
+                LOG_ERROR(SENSORS, "❌ Cola de actuación llena, no se pudo actuar sobre %s", sensor->type);
+                reportNotQueued(listener, sensor->id, sensor->type, targetState);
+            }
+        } else if (targetState) {
+            LOG_DEBUG(SENSORS, "✅ %s ya estaba encendido", sensor->type);
+        }
+    }
+    return sensorsActuated;
+}
+
+bool RestTransport::actuate(const char* sensorId, const char* sensorType, bool targetState) {
+    LOG_INFO(SENSORS, "🔌 %s sensor: %s (ID: %s)", targetState ? "Encendiendo" : "Apagando", sensorType, sensorId);
+    if (!actuationPipeline.enqueue(sensorId, sensorType, targetState)) {
+        LOG_ERROR(SENSORS, "❌ No se pudo encolar la actuación sobre %s", sensorType);
+        return false;
+    }
+    return true;
+}
+
+void RestTransport::processActuationResults() {
+    ActuationResult result;
+
+    while (actuationPipeline.poll(result)) {
+        // Un PATCH confirmado es un delta: se aplica a la caché sin otro GET
+        if (result.httpResponseCode == 200 &&
+            sensorCache.setState(result.sensorId, result.targetState, millis())) {
+            batchChangedCache = true;
+        }
+
+        listener->onActuationResult(result, actuationPipeline.getLastBatchDuration());
+
+        if (result.batchComplete && batchChangedCache) {
+            batchChangedCache = false;
+            sensorCache.notify(listener);
+        }
+    }
+}
+
+void RestTransport::onPushEvent(const char* data) {
+    StaticJsonDocument<EVENT_DOC_SIZE> event;
+    DeserializationError error = deserializeJson(event, data, DeserializationOption::Filter(eventFilter));
+
+    if (error) {
+        LOG_ERROR(NET, "Error parsing push JSON: %s", error.c_str());
+        return;
+    }
+
+    listener->onProximityEvent(event.as<JsonObject>());
+}
+
+void RestTransport::onPushSubscribed() {
+    LOG_INFO(NET, "📡 Suscrito a eventos push de proximidad");
+
+    // Sondear una vez para recuperar lo que llegó mientras no había suscripción
+    lastProximityPoll = millis() - PUSH_FALLBACK_POLL_INTERVAL;
+    listener->onTransportConnected();
+}
+
+const SensorCache& RestTransport::getSensorCache() const {
+    return sensorCache;
+}
+
+void RestTransport::printStatus() {
+    LOG_INFO(STATS, "Conexiones HTTP reutilizadas: %lu / establecidas: %lu", connectionPool.getReusedCount(),
+             connectionPool.getEstablishedCount());
+    LOG_INFO(STATS, "Sondeos de proximidad: %lu (304: %lu, último: %lu B, total: %lu B)", proximityPollStats.polls,
+             proximityPollStats.notModified, proximityPollStats.lastBytes, proximityPollStats.totalBytes);
+    LOG_INFO(STATS, "Sondeos de sensores: %lu (304: %lu, último: %lu B, total: %lu B)", sensorPollStats.polls,
+             sensorPollStats.notModified, sensorPollStats.lastBytes, sensorPollStats.totalBytes);
+    sensorCache.printStats();
+    proximityBreaker.printStats();
+    sensorsBreaker.printStats();
+    actuationPipeline.getBreaker().printStats();
+    unsigned long rejected = getRejectedURLs();
+    if (rejected > 0) {
+        LOG_WARN(STATS, "Peticiones descartadas por URL demasiado larga: %lu", rejected);
+    }
+}
+
+void RestTransport::setAPIConfiguration(const String& url, const String& deviceID) {
+    serverURL = url;
+    deviceId = deviceID;
+    proximityETag[0] = '\0';
+    buildURLs();
+}
+
+void RestTransport::setEdgeAPIConfiguration(const String& url) {
+    edgeURL = url;
+    actuationPipeline.setBaseURL(url);
+    sensorsETag[0] = '\0';
+    buildURLs();
+}
+
+void RestTransport::setUserConfiguration(const String& userID) {
+    userId = userID;
+    // Los sensores en caché son de otro usuario
+    sensorCache.invalidate();
+    sensorsETag[0] = '\0';
+    buildURLs();
+}
+
+void RestTransport::buildURLs() {
+    int length = snprintf(proximityURL, sizeof(proximityURL), "%sproximity-events/device/%s", serverURL.c_str(),
+                          deviceId.c_str());
+    proximityURLValid = length >= 0 && (size_t)length < sizeof(proximityURL);
+    if (!proximityURLValid) {
+        LOG_ERROR(NET, "❌ URL de proximidad demasiado larga (%d de %u caracteres), no se sondeará", length,
+                  (unsigned)sizeof(proximityURL) - 1);
+    }
+    length = snprintf(sensorsURL, sizeof(sensorsURL), "%ssensors/user/%s", edgeURL.c_str(), userId.c_str());
+    sensorsURLValid = length >= 0 && (size_t)length < sizeof(sensorsURL);
+    if (!sensorsURLValid) {
+        LOG_ERROR(NET, "❌ URL de sensores demasiado larga (%d de %u caracteres), no se sondeará", length,
+                  (unsigned)sizeof(sensorsURL) - 1);
+    }
+}
+
+// Una URL truncada apuntaría a otro recurso: la petición no se envía
+bool RestTransport::checkURL(int length, const char* what) {
+    if (length >= 0 && (size_t)length < HttpConnectionPool::MAX_URL) {
+        return true;
+    }
+    rejectedURLs++;
+    LOG_ERROR(NET, "❌ URL de %s demasiado larga (%d caracteres), petición descartada", what, length);
+    return false;
+}
+
+void RestTransport::setActuationLimits(int maxInFlight, unsigned long minIntervalMs) {
+    actuationPipeline.configure(maxInFlight, minIntervalMs);
+}
+
+void RestTransport::setSensorCacheMaxAge(unsigned long ms) {
+    sensorCache.setMaxAge(ms);
+}
+
+void RestTransport::setCircuitBreaker(int failureThreshold, unsigned long minBackoffMs, unsigned long maxBackoffMs) {
+    proximityBreaker.configure(failureThreshold, minBackoffMs, maxBackoffMs);
+    sensorsBreaker.configure(failureThreshold, minBackoffMs, maxBackoffMs);
+    actuationPipeline.getBreaker().configure(failureThreshold, minBackoffMs, maxBackoffMs);
+}
+
+void RestTransport::enablePushEvents(bool enabled) {
+    if (enabled) {
+        char streamURL[HttpConnectionPool::MAX_URL];
+        if (!proximityURLValid) {
+            rejectedURLs++;
+            LOG_ERROR(NET, "❌ URL de push no disponible: la de proximidad no cabe");
+            return;
+        }
+        if (!checkURL(snprintf(streamURL, sizeof(streamURL), "%s/stream", proximityURL), "push")) {
+            return;
+        }
+        pushClient.begin(streamURL);
+    } else {
+        pushClient.stop();
+    }
+}
+
+const PollStats& RestTransport::getProximityPollStats() const {
+    return proximityPollStats;
+}
+
+const PollStats& RestTransport::getSensorPollStats() const {
+    return sensorPollStats;
+}
+
+unsigned long RestTransport::getRejectedURLs() const {
+    return rejectedURLs + actuationPipeline.getRejectedURLs();
+}
+
+void RestTransport::initializeJsonFilters() {
+    // Sólo se conservan los campos que usa el dispositivo
+    eventFilter["event_id"] = true;
+    eventFilter["id"] = true;
+    eventFilter["event_type"] = true;
+    eventFilter["distance"] = true;
+    eventFilter["home_location_name"] = true;
+
+    sensorFilter["id"] = true;
+    sensorFilter["sensor_type"] = true;
+    sensorFilter["isActive"] = true;
+}
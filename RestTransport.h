@@ -0,0 +1,116 @@
+#ifndef REST_TRANSPORT_H
+#define REST_TRANSPORT_H
+
+#include "Transport.h"
+#include "HttpConnectionPool.h"
+#include "ActuationPipeline.h"
+#include "CircuitBreaker.h"
+#include "HttpBodyStream.h"
+#include "JsonArrayStream.h"
+#include "EventStreamClient.h"
+#include <HTTPClient.h>
+
+// Contadores de un sondeo condicional (bytes de cuerpo descargados y 304)
+struct PollStats {
+    unsigned long polls;
+    unsigned long notModified;
+    unsigned long lastBytes;
+    unsigned long totalBytes;
+
+    PollStats() : polls(0), notModified(0), lastBytes(0), totalBytes(0) {}
+    void record(unsigned long bytes, bool wasNotModified);
+};
+
+// Transporte por defecto: sondeo REST del Edge API con GET condicionales,
+// PATCH de sensores en paralelo y entrega push opcional por SSE.
+class RestTransport : public Transport, public PushEventHandler {
+public:
+    static const unsigned long PUSH_FALLBACK_POLL_INTERVAL = 300000;
+
+private:
+    TransportListener* listener;
+
+    String serverURL;
+    String edgeURL;  // Base de los endpoints de sensores (sin /api/v1/)
+    String deviceId;
+    String userId;
+
+    // URLs fijas precalculadas al configurar: el sondeo no crea Strings
+    char proximityURL[HttpConnectionPool::MAX_URL_PREFIX];
+    char sensorsURL[HttpConnectionPool::MAX_URL_PREFIX];
+    unsigned long rejectedURLs;  // peticiones no enviadas porque la URL no cabía
+    bool proximityURLValid;      // false si la URL fija no cupo: no se sondea
+    bool sensorsURLValid;
+
+    HttpConnectionPool connectionPool;  // Conexiones keep-alive reutilizadas hacia el API
+
+    // GET condicionales: ETag de la última respuesta 200 de cada sondeo
+    char proximityETag[HttpConnectionPool::MAX_HEADER_VALUE];
+    char sensorsETag[HttpConnectionPool::MAX_HEADER_VALUE];
+    PollStats proximityPollStats;
+    PollStats sensorPollStats;
+
+    // Un cortacircuitos por endpoint; el de PATCH vive en actuationPipeline
+    CircuitBreaker proximityBreaker;
+    CircuitBreaker sensorsBreaker;
+
+    // Filtros de ArduinoJson: sólo se guardan los campos que se usan
+    static const size_t EVENT_DOC_SIZE = 384;
+    static const size_t SENSOR_DOC_SIZE = 192;
+    StaticJsonDocument<128> eventFilter;
+    StaticJsonDocument<96> sensorFilter;
+
+    // PATCH de sensores en paralelo con límite de concurrencia y ritmo
+    ActuationPipeline actuationPipeline;
+    bool batchChangedCache;
+
+    // Último estado conocido: enter/exit actúan desde aquí sin otro GET
+    SensorCache sensorCache;
+    bool sensorsDelivered;
+
+    // Entrega push opcional (SSE); el sondeo sigue como respaldo
+    EventStreamClient pushClient;
+    unsigned long lastProximityPoll;
+
+    void initializeJsonFilters();
+    void buildURLs();
+    bool checkURL(int length, const char* what);
+    static void copyETag(HTTPClient* http, char* etag);
+    unsigned long reportRetryAfter(HTTPClient* http, int httpResponseCode);
+    bool processProximityEvents(Stream& body, const char* cursor);
+    bool processSensorStates(Stream& body);
+    void processActuationResults();
+
+public:
+    RestTransport(const String& apiURL, const String& edgeURL, const String& deviceID, const String& userID);
+
+    const char* getName() const override;
+
+    void begin(TransportListener* transportListener) override;
+    void update(unsigned long now, bool networkUp) override;
+    void pollProximity(const char* cursor) override;
+    void pollSensors() override;
+    int actuateAll(bool targetState) override;
+    bool actuate(const char* sensorId, const char* sensorType, bool targetState) override;
+    const SensorCache& getSensorCache() const override;
+    void printStatus() override;
+
+    void onPushEvent(const char* data) override;
+    void onPushSubscribed() override;
+
+    void setAPIConfiguration(const String& url, const String& deviceID);
+    void setEdgeAPIConfiguration(const String& url);
+    void setUserConfiguration(const String& userID);
+    void setActuationLimits(int maxInFlight, unsigned long minIntervalMs);
+    void setSensorCacheMaxAge(unsigned long ms);
+    // Umbral de fallos seguidos y espera mínima/máxima de los tres endpoints
+    void setCircuitBreaker(int failureThreshold, unsigned long minBackoffMs, unsigned long maxBackoffMs);
+    void enablePushEvents(bool enabled);
+
+    const PollStats& getProximityPollStats() const;
+    const PollStats& getSensorPollStats() const;
+    // Peticiones (sondeos, push y PATCH) no enviadas porque la URL no cabía
+    unsigned long getRejectedURLs() const;
+};
+
+#endif
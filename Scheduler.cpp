@@ -0,0 +1,164 @@
+#include "Scheduler.h"
+
+Scheduler::Task::Task()
+    : deadline(0), period(0), command(0), handler(nullptr), id(INVALID_TASK) {}
+
+Scheduler::Scheduler() : size(0), nextId(0) {}
+
+int Scheduler::schedule(CommandHandler* handler, Command command, unsigned long now,
+                        unsigned long delayMs, unsigned long periodMs) {
+    if (size >= MAX_TASKS || handler == nullptr) {
+        return INVALID_TASK;
+    }
+
+    Task task;
+    task.deadline = now + delayMs;
+    task.period = periodMs;
+    task.command = command;
+    task.handler = handler;
+    task.id = nextId++;
+    push(task);
+    return task.id;
+}
+
+bool Scheduler::cancel(int taskId) {
+    int index = indexOf(taskId);
+    if (index < 0) {
+        return false;
+    }
+    removeAt(index);
+    return true;
+}
+
+bool Scheduler::setPeriod(int taskId, unsigned long now, unsigned long periodMs) {
+    int index = indexOf(taskId);
+    if (index < 0) {
+        return false;
+    }
+
+    Task task = heap[index];
+    removeAt(index);
+    task.period = periodMs;
+    task.deadline = now + periodMs;
+    push(task);
+    return true;
+}
+
+bool Scheduler::reschedule(int taskId, unsigned long deadline) {
+    int index = indexOf(taskId);
+    if (index < 0) {
+        return false;
+    }
+
+    Task task = heap[index];
+    removeAt(index);
+    task.deadline = deadline;
+    push(task);
+    return true;
+}
+
+int Scheduler::run(unsigned long now, int maxTasks) {
+    int executed = 0;
+
+    while (size > 0 && executed < maxTasks && !before(now, heap[0].deadline)) {
+        Task task = pop();
+
+        if (task.period > 0) {
+            // Reprogramar sobre el deadline previsto para no acumular deriva;
+            // si vamos muy atrasados, saltar los periodos perdidos.
+            task.deadline += task.period;
+            if (before(task.deadline, now)) {
+                task.deadline = now + task.period;
+            }
+            push(task);
+        }
+
+        task.handler->handle(task.command);
+        executed++;
+    }
+
+    return executed;
+}
+
+int Scheduler::getTaskCount() const {
+    return size;
+}
+
+unsigned long Scheduler::timeUntilNext(unsigned long now) const {
+    if (size == 0 || !before(now, heap[0].deadline)) {
+        return 0;
+    }
+    return heap[0].deadline - now;
+}
+
+bool Scheduler::before(unsigned long a, unsigned long b) {
+    // Comparación segura frente al desbordamiento de millis()
+    return (long)(a - b) < 0;
+}
+
+void Scheduler::push(const Task& task) {
+    heap[size] = task;
+    siftUp(size);
+    size++;
+}
+
+Scheduler::Task Scheduler::pop() {
+    Task top = heap[0];
+    removeAt(0);
+    return top;
+}
+
+void Scheduler::siftUp(int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!before(heap[index].deadline, heap[parent].deadline)) {
+            break;
+        }
+        Task tmp = heap[index];
+        heap[index] = heap[parent];
+        heap[parent] = tmp;
+        index = parent;
+    }
+}
+
+void Scheduler::siftDown(int index) {
+    for (;;) {
+        int left = 2 * index + 1;
+        int right = left + 1;
+        int smallest = index;
+
+        if (left < size && before(heap[left].deadline, heap[smallest].deadline)) {
+            smallest = left;
+        }
+        if (right < size && before(heap[right].deadline, heap[smallest].deadline)) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+
+        Task tmp = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = tmp;
+        index = smallest;
+    }
+}
+
+int Scheduler::indexOf(int taskId) const {
+    for (int i = 0; i < size; i++) {
+        if (heap[i].id == taskId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Scheduler::removeAt(int index) {
+    size--;
+    if (index == size) {
+        return;
+    }
+    heap[index] = heap[size];
+    siftDown(index);
+    siftUp(index);
+}
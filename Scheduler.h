@@ -0,0 +1,54 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "CommandHandler.h"
+
+// Planificador cooperativo: min-heap de tareas ordenadas por deadline. Cada
+// tarea entrega un Command a su CommandHandler cuando vence, de modo que
+// sondeos, animaciones de LED y reconexión se ejecutan como pasos cortos.
+class Scheduler {
+public:
+    static const int MAX_TASKS = 16;
+    static const int INVALID_TASK = -1;
+
+private:
+    struct Task {
+        unsigned long deadline;
+        unsigned long period;  // 0 = se ejecuta una sola vez
+        Command command;
+        CommandHandler* handler;
+        int id;
+
+        Task();
+    };
+
+    Task heap[MAX_TASKS];
+    int size;
+    int nextId;
+
+    static bool before(unsigned long a, unsigned long b);
+    void push(const Task& task);
+    Task pop();
+    void siftUp(int index);
+    void siftDown(int index);
+    int indexOf(int taskId) const;
+    void removeAt(int index);
+
+public:
+    Scheduler();
+
+    // Devuelve el id de la tarea o INVALID_TASK si el heap está lleno
+    int schedule(CommandHandler* handler, Command command, unsigned long now,
+                 unsigned long delayMs, unsigned long periodMs = 0);
+    bool cancel(int taskId);
+    bool setPeriod(int taskId, unsigned long now, unsigned long periodMs);
+    bool reschedule(int taskId, unsigned long deadline);
+
+    // Ejecuta como mucho maxTasks tareas vencidas; devuelve cuántas ejecutó
+    int run(unsigned long now, int maxTasks = 4);
+
+    int getTaskCount() const;
+    unsigned long timeUntilNext(unsigned long now) const;
+};
+
+#endif
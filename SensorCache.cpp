@@ -0,0 +1,208 @@
+#include "SensorCache.h"
+#include "Transport.h"
+#include "Logger.h"
+
+SensorCache::SensorCache()
+    : version(0), valid(false), syncing(false), lastSync(0), maxAge(DEFAULT_MAX_AGE), syncChanges(0) {
+    memset(sensors, 0, sizeof(sensors));
+}
+
+void SensorCache::beginSync() {
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        sensors[i].seen = false;
+    }
+    syncing = true;
+    syncChanges = 0;
+}
+
+bool SensorCache::apply(const char* id, const char* type, bool isActive, unsigned long now) {
+    if (id == nullptr || id[0] == '\0' || strlen(id) >= sizeof(sensors[0].id)) {
+        return false;
+    }
+
+    int index = find(id);
+    if (index < 0) {
+        for (int i = 0; i < MAX_SENSORS; i++) {
+            if (!sensors[i].used) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            LOG_ERROR(SENSORS, "❌ Caché de sensores llena, se ignora %s", id);
+            return false;
+        }
+
+        CachedSensor& added = sensors[index];
+        strcpy(added.id, id);
+        strncpy(added.type, type != nullptr ? type : "", sizeof(added.type) - 1);
+        added.type[sizeof(added.type) - 1] = '\0';
+        added.isActive = isActive;
+        added.used = true;
+        added.seen = true;
+        recordChange(added, now);
+        return true;
+    }
+
+    CachedSensor& sensor = sensors[index];
+    sensor.seen = true;
+
+    bool changed = sensor.isActive != isActive;
+    if (type != nullptr && strncmp(sensor.type, type, sizeof(sensor.type) - 1) != 0) {
+        strncpy(sensor.type, type, sizeof(sensor.type) - 1);
+        sensor.type[sizeof(sensor.type) - 1] = '\0';
+        changed = true;
+    }
+    if (changed) {
+        sensor.isActive = isActive;
+        recordChange(sensor, now);
+    }
+    return changed;
+}
+
+int SensorCache::endSync(bool complete, unsigned long now) {
+    syncing = false;
+    if (!complete) {
+        return syncChanges;
+    }
+
+    // Lo que no vino en la instantánea ya no existe
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (sensors[i].used && !sensors[i].seen) {
+            sensors[i].used = false;
+            version++;
+            syncChanges++;
+            stats.changes++;
+        }
+    }
+
+    valid = true;
+    lastSync = now;
+    stats.syncs++;
+    return syncChanges;
+}
+
+bool SensorCache::setState(const char* id, bool isActive, unsigned long now) {
+    int index = find(id);
+    if (index < 0 || sensors[index].isActive == isActive) {
+        return false;
+    }
+    sensors[index].isActive = isActive;
+    recordChange(sensors[index], now);
+    return true;
+}
+
+bool SensorCache::remove(const char* id) {
+    int index = find(id);
+    if (index < 0) {
+        return false;
+    }
+    sensors[index].used = false;
+    version++;
+    stats.changes++;
+    return true;
+}
+
+void SensorCache::touch(unsigned long now) {
+    valid = true;
+    lastSync = now;
+}
+
+void SensorCache::invalidate() {
+    valid = false;
+}
+
+bool SensorCache::lookup(unsigned long now) {
+    if (!valid) {
+        stats.misses++;
+        return false;
+    }
+
+    stats.lastAgeMs = now - lastSync;
+    if (stats.lastAgeMs > stats.maxObservedAgeMs) {
+        stats.maxObservedAgeMs = stats.lastAgeMs;
+    }
+
+    if (stats.lastAgeMs > maxAge) {
+        stats.staleMisses++;
+        return false;
+    }
+    stats.hits++;
+    return true;
+}
+
+bool SensorCache::isFresh(unsigned long now) const {
+    return valid && now - lastSync <= maxAge;
+}
+
+int SensorCache::getCapacity() const {
+    return MAX_SENSORS;
+}
+
+const CachedSensor* SensorCache::get(int index) const {
+    if (index < 0 || index >= MAX_SENSORS || !sensors[index].used) {
+        return nullptr;
+    }
+    return &sensors[index];
+}
+
+int SensorCache::size() const {
+    int count = 0;
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (sensors[i].used) count++;
+    }
+    return count;
+}
+
+uint32_t SensorCache::getVersion() const {
+    return version;
+}
+
+void SensorCache::setMaxAge(unsigned long ms) {
+    maxAge = ms;
+}
+
+const SensorCacheStats& SensorCache::getStats() const {
+    return stats;
+}
+
+void SensorCache::notify(TransportListener* listener) const {
+    StaticJsonDocument<192> item;
+
+    listener->onSensorStatesBegin();
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (!sensors[i].used) {
+            continue;
+        }
+        item.clear();
+        item["id"] = sensors[i].id;
+        item["sensor_type"] = sensors[i].type;
+        item["isActive"] = sensors[i].isActive;
+        listener->onSensorState(item.as<JsonObject>());
+    }
+    listener->onSensorStatesEnd(true);
+}
+
+void SensorCache::printStats() const {
+    LOG_INFO(STATS, "Caché de sensores: %d sensores, v%lu (aciertos: %lu, fallos: %lu, obsoleta: %lu, "
+             "antigüedad: %lu ms, máx: %lu ms, cambios: %lu)", size(), version, stats.hits, stats.misses,
+             stats.staleMisses, stats.lastAgeMs, stats.maxObservedAgeMs, stats.changes);
+}
+
+int SensorCache::find(const char* id) const {
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (sensors[i].used && strcmp(sensors[i].id, id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SensorCache::recordChange(CachedSensor& sensor, unsigned long now) {
+    sensor.version = ++version;
+    sensor.updatedAt = now;
+    stats.changes++;
+    if (syncing) {
+        syncChanges++;
+    }
+}
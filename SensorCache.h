@@ -0,0 +1,86 @@
+#ifndef SENSOR_CACHE_H
+#define SENSOR_CACHE_H
+
+#include <Arduino.h>
+#include "SensorRegistry.h"
+
+class TransportListener;
+
+struct CachedSensor {
+    char id[40];
+    char type[24];
+    bool isActive;
+    uint32_t version;         // versión de la caché en la que cambió por última vez
+    unsigned long updatedAt;  // millis() del último cambio
+    bool used;
+    bool seen;                // presente en la instantánea en curso
+};
+
+struct SensorCacheStats {
+    unsigned long hits;
+    unsigned long misses;        // sin datos (nunca sincronizada o invalidada)
+    unsigned long staleMisses;   // con datos, pero más viejos que maxAge
+    unsigned long lastAgeMs;     // antigüedad en la última consulta
+    unsigned long maxObservedAgeMs;
+    unsigned long syncs;
+    unsigned long changes;       // diferencias aplicadas (altas, bajas y cambios)
+
+    SensorCacheStats()
+        : hits(0), misses(0), staleMisses(0), lastAgeMs(0), maxObservedAgeMs(0), syncs(0), changes(0) {}
+};
+
+// Último estado conocido de cada sensor, indexado por id. Las instantáneas
+// completas se reconcilian por diferencias (sólo cuentan los cambios) y las
+// actuaciones confirmadas se aplican como deltas locales, así enter/exit
+// calculan qué sensores actuar sin volver a pedir la lista.
+class SensorCache {
+public:
+    static const int MAX_SENSORS = SensorRegistry::MAX_SENSORS;  // unos 5 KB
+    static const unsigned long DEFAULT_MAX_AGE = 60000;
+
+private:
+    CachedSensor sensors[MAX_SENSORS];
+    uint32_t version;
+    bool valid;
+    bool syncing;
+    unsigned long lastSync;
+    unsigned long maxAge;
+    int syncChanges;
+    SensorCacheStats stats;
+
+    int find(const char* id) const;
+    void recordChange(CachedSensor& sensor, unsigned long now);
+
+public:
+    SensorCache();
+
+    // Instantánea completa: beginSync(), apply() por sensor y endSync().
+    // Devuelve cuántas diferencias hubo; con complete = false no se dan
+    // de baja los sensores ausentes ni se renueva la frescura
+    void beginSync();
+    bool apply(const char* id, const char* type, bool isActive, unsigned long now);
+    int endSync(bool complete, unsigned long now);
+
+    // Deltas sueltos (actuación confirmada, mensaje MQTT...)
+    bool setState(const char* id, bool isActive, unsigned long now);
+    bool remove(const char* id);
+    void touch(unsigned long now);  // el transporte confirma que refleja al servidor
+    void invalidate();
+
+    // Registra acierto/fallo: true si se puede actuar con lo que hay
+    bool lookup(unsigned long now);
+    bool isFresh(unsigned long now) const;
+
+    int getCapacity() const;
+    const CachedSensor* get(int index) const;  // nullptr si el hueco está libre
+    int size() const;
+    uint32_t getVersion() const;
+
+    void setMaxAge(unsigned long ms);
+    const SensorCacheStats& getStats() const;
+
+    void notify(TransportListener* listener) const;
+    void printStats() const;
+};
+
+#endif
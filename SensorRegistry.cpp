@@ -0,0 +1,155 @@
+#include "SensorRegistry.h"
+
+SensorRegistry::SensorRegistry() : typeCount(0), sensorCount(0) {
+    memset(typeBuckets, -1, sizeof(typeBuckets));
+    memset(activeByType, 0, sizeof(activeByType));
+    clear();
+}
+
+uint32_t SensorRegistry::hash(const char* text) {
+    // FNV-1a de 32 bits
+    uint32_t value = 2166136261u;
+    while (*text != '\0') {
+        value ^= (uint8_t)*text++;
+        value *= 16777619u;
+    }
+    return value;
+}
+
+uint8_t SensorRegistry::intern(const char* typeName) {
+    if (typeName == nullptr || typeName[0] == '\0' || strlen(typeName) >= MAX_TYPE_NAME) {
+        return NO_TYPE;
+    }
+
+    uint32_t typeHash = hash(typeName);
+    int bucket = typeHash & (TYPE_BUCKETS - 1);
+    while (typeBuckets[bucket] >= 0) {
+        int typeId = typeBuckets[bucket];
+        if (typeHashes[typeId] == typeHash && strcmp(typeNames[typeId], typeName) == 0) {
+            return typeId;
+        }
+        bucket = (bucket + 1) & (TYPE_BUCKETS - 1);
+    }
+
+    if (typeCount >= MAX_TYPES) {
+        return NO_TYPE;
+    }
+
+    uint8_t typeId = typeCount++;
+    strcpy(typeNames[typeId], typeName);
+    typeHashes[typeId] = typeHash;
+    typeBuckets[bucket] = typeId;
+    return typeId;
+}
+
+uint8_t SensorRegistry::findType(const char* typeName) const {
+    if (typeName == nullptr) {
+        return NO_TYPE;
+    }
+
+    uint32_t typeHash = hash(typeName);
+    int bucket = typeHash & (TYPE_BUCKETS - 1);
+    while (typeBuckets[bucket] >= 0) {
+        int typeId = typeBuckets[bucket];
+        if (typeHashes[typeId] == typeHash && strcmp(typeNames[typeId], typeName) == 0) {
+            return typeId;
+        }
+        bucket = (bucket + 1) & (TYPE_BUCKETS - 1);
+    }
+    return NO_TYPE;
+}
+
+const char* SensorRegistry::getTypeName(uint8_t typeId) const {
+    return typeId < typeCount ? typeNames[typeId] : "";
+}
+
+uint8_t SensorRegistry::getTypeCount() const {
+    return typeCount;
+}
+
+void SensorRegistry::clear() {
+    memset(sensorBuckets, -1, sizeof(sensorBuckets));
+    memset(activeBits, 0, sizeof(activeBits));
+    memset(activeByType, 0, sizeof(activeByType));
+    sensorCount = 0;
+}
+
+int SensorRegistry::findSensor(const char* sensorId, uint32_t idHash) const {
+    int bucket = idHash & (SENSOR_BUCKETS - 1);
+    while (sensorBuckets[bucket] >= 0) {
+        int index = sensorBuckets[bucket];
+        if (idHashes[index] == idHash && strcmp(ids[index], sensorId) == 0) {
+            return index;
+        }
+        bucket = (bucket + 1) & (SENSOR_BUCKETS - 1);
+    }
+    return -1;
+}
+
+bool SensorRegistry::set(const char* sensorId, const char* typeName, bool isActive) {
+    if (sensorId == nullptr || sensorId[0] == '\0' || strlen(sensorId) >= MAX_ID) {
+        return false;
+    }
+
+    uint32_t idHash = hash(sensorId);
+    int index = findSensor(sensorId, idHash);
+
+    if (index < 0) {
+        if (sensorCount >= MAX_SENSORS) {
+            return false;
+        }
+        index = sensorCount++;
+        strcpy(ids[index], sensorId);
+        idHashes[index] = idHash;
+        sensorTypes[index] = NO_TYPE;
+
+        int bucket = idHash & (SENSOR_BUCKETS - 1);
+        while (sensorBuckets[bucket] >= 0) {
+            bucket = (bucket + 1) & (SENSOR_BUCKETS - 1);
+        }
+        sensorBuckets[bucket] = index;
+    }
+
+    // Quitar la contribución anterior antes de aplicar la nueva
+    uint32_t mask = 1u << (index & 31);
+    uint32_t& word = activeBits[index >> 5];
+    if ((word & mask) && sensorTypes[index] != NO_TYPE) {
+        activeByType[sensorTypes[index]]--;
+    }
+
+    sensorTypes[index] = intern(typeName);
+    if (isActive) {
+        word |= mask;
+        if (sensorTypes[index] != NO_TYPE) {
+            activeByType[sensorTypes[index]]++;
+        }
+    } else {
+        word &= ~mask;
+    }
+    return true;
+}
+
+void SensorRegistry::setAllInactive() {
+    memset(activeBits, 0, sizeof(activeBits));
+    memset(activeByType, 0, sizeof(activeByType));
+}
+
+bool SensorRegistry::isActive(const char* sensorId) const {
+    if (sensorId == nullptr) {
+        return false;
+    }
+    int index = findSensor(sensorId, hash(sensorId));
+    return index >= 0 && (activeBits[index >> 5] & (1u << (index & 31))) != 0;
+}
+
+bool SensorRegistry::isTypeActive(uint8_t typeId) const {
+    return typeId < typeCount && activeByType[typeId] > 0;
+}
+
+uint8_t SensorRegistry::countActive(uint8_t typeId) const {
+    return typeId < typeCount ? activeByType[typeId] : 0;
+}
+
+uint8_t SensorRegistry::getSensorCount() const {
+    return sensorCount;
+}
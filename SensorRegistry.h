@@ -0,0 +1,64 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <Arduino.h>
+
+// Registro compacto de sensores del usuario. Los tipos se internan a ids
+// densos (uint8_t) y los sensores se guardan como estructura de arrays con
+// el estado en bitsets; las búsquedas por tipo e id son tablas hash de
+// direccionamiento abierto sobre FNV-1a, sin Strings ni memoria dinámica.
+// El hash sólo acelera la búsqueda: se compara siempre el texto, así dos
+// ids con el mismo hash siguen siendo dos sensores.
+class SensorRegistry {
+public:
+    static const int MAX_SENSORS = 64;
+    static const int MAX_TYPES = 16;
+    static const size_t MAX_TYPE_NAME = 24;
+    static const size_t MAX_ID = 40;  // UUID de 36 caracteres con margen
+    static const uint8_t NO_TYPE = 0xFF;
+
+private:
+    static const int TYPE_BUCKETS = 32;     // potencia de 2, el doble de MAX_TYPES
+    static const int SENSOR_BUCKETS = 128;  // potencia de 2, el doble de MAX_SENSORS
+    static const int WORDS = MAX_SENSORS / 32;
+
+    // Tipos internados
+    char typeNames[MAX_TYPES][MAX_TYPE_NAME];
+    uint32_t typeHashes[MAX_TYPES];
+    int8_t typeBuckets[TYPE_BUCKETS];
+    uint8_t typeCount;
+    uint8_t activeByType[MAX_TYPES];
+
+    // Sensores: el id se guarda entero (unos 2,5 KB) para resolver colisiones
+    char ids[MAX_SENSORS][MAX_ID];
+    uint32_t idHashes[MAX_SENSORS];
+    uint8_t sensorTypes[MAX_SENSORS];
+    uint32_t activeBits[WORDS];
+    int8_t sensorBuckets[SENSOR_BUCKETS];
+    uint8_t sensorCount;
+
+    static uint32_t hash(const char* text);
+    int findSensor(const char* sensorId, uint32_t idHash) const;
+
+public:
+    SensorRegistry();
+
+    // Devuelve el id del tipo, dándolo de alta si hace falta (NO_TYPE si no cabe)
+    uint8_t intern(const char* typeName);
+    uint8_t findType(const char* typeName) const;
+    const char* getTypeName(uint8_t typeId) const;
+    uint8_t getTypeCount() const;
+
+    // Vacía los sensores (los tipos internados se conservan)
+    void clear();
+    // Alta o actualización; false si el registro está lleno o el id no cabe
+    bool set(const char* sensorId, const char* typeName, bool isActive);
+    void setAllInactive();
+
+    bool isActive(const char* sensorId) const;
+    bool isTypeActive(uint8_t typeId) const;
+    uint8_t countActive(uint8_t typeId) const;
+    uint8_t getSensorCount() const;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef SMART_LED_ARRAY_H
+#define SMART_LED_ARRAY_H
+
+#include <Arduino.h>
+#include "LedPatternEngine.h"
+#include "SensorRegistry.h"
+
+// Configuración de un LED inteligente: pin, nombre y los dos tipos de sensor
+// que representa. Las cadenas deben ser estáticas.
+struct SmartLedConfig {
+    int pin;
+    const char* name;
+    const char* primaryType;
+    const char* secondaryType;
+    const char* primaryLabel;
+    const char* secondaryLabel;
+};
+
+// Qué tipos de sensor representa un LED inteligente: sólo el primario
+// activo = parpadeo lento, sólo el secundario = parpadeo rápido
+struct LedChannelMapping {
+    uint8_t primaryType;
+    uint8_t secondaryType;
+    const char* primaryLabel;    // deben ser cadenas estáticas
+    const char* secondaryLabel;
+};
+
+// Patrón según el estado de los sensores, indexado por primario | secundario << 1
+constexpr uint8_t PATTERN_BY_SENSOR_STATE[4] = {
+    LED_PATTERN_OFF,         // ninguno activo
+    LED_PATTERN_SLOW_BLINK,  // sólo el primario
+    LED_PATTERN_FAST_BLINK,  // sólo el secundario
+    LED_PATTERN_SOLID,       // ambos
+};
+
+// N LEDs inteligentes sobre el motor de patrones. El cálculo y la
+// publicación son bucles sin ramas sobre los N canales; añadir un LED es
+// añadir una fila a la tabla de configuración.
+template <int N>
+class SmartLedArray {
+private:
+    LedChannelMapping mappings[N];
+    const char* names[N];
+    int engineChannels[N];
+    uint8_t patterns[N];
+
+public:
+    static const int SIZE = N;
+
+    SmartLedArray() {
+        for (int i = 0; i < N; i++) {
+            mappings[i] = {SensorRegistry::NO_TYPE, SensorRegistry::NO_TYPE, "", ""};
+            names[i] = "";
+            engineChannels[i] = -1;
+            patterns[i] = LED_PATTERN_OFF;
+        }
+    }
+
+    // Asigna tipos y etiquetas de la tabla (los tipos se internan ya)
+    bool configure(const SmartLedConfig (&table)[N], SensorRegistry& registry) {
+        bool ok = true;
+        for (int i = 0; i < N; i++) {
+            names[i] = table[i].name;
+            ok &= setMapping(i, registry, table[i].primaryType, table[i].secondaryType,
+                             table[i].primaryLabel, table[i].secondaryLabel);
+        }
+        return ok;
+    }
+
+    // Reserva un canal del motor por LED; false si alguno no se pudo configurar
+    bool attach(const SmartLedConfig (&table)[N], LedPatternEngine& engine) {
+        bool ok = true;
+        for (int i = 0; i < N; i++) {
+            engineChannels[i] = engine.addChannel(table[i].pin);
+            ok &= engineChannels[i] >= 0;
+        }
+        return ok;
+    }
+
+    bool setMapping(int channel, SensorRegistry& registry, const char* primaryType, const char* secondaryType,
+                    const char* primaryLabel, const char* secondaryLabel) {
+        if (channel < 0 || channel >= N) {
+            return false;
+        }
+
+        LedChannelMapping& mapping = mappings[channel];
+        mapping.primaryType = registry.intern(primaryType);
+        mapping.secondaryType = registry.intern(secondaryType);
+        mapping.primaryLabel = primaryLabel;
+        mapping.secondaryLabel = secondaryLabel;
+        return mapping.primaryType != SensorRegistry::NO_TYPE && mapping.secondaryType != SensorRegistry::NO_TYPE;
+    }
+
+    // Calcula el patrón de cada LED a partir de los estados del registro.
+    // Sólo lee las asignaciones, así que puede ejecutarse en otra tarea
+    void compute(const SensorRegistry& registry, uint8_t (&out)[N]) const {
+        for (int i = 0; i < N; i++) {
+            uint8_t state = (registry.countActive(mappings[i].primaryType) > 0) |
+                            ((registry.countActive(mappings[i].secondaryType) > 0) << 1);
+            out[i] = PATTERN_BY_SENSOR_STATE[state];
+        }
+    }
+
+    void setPatterns(const uint8_t (&in)[N]) {
+        for (int i = 0; i < N; i++) {
+            patterns[i] = in[i];
+        }
+    }
+
+    // Publica los patrones en el motor; con enabled = false se apagan todos
+    void apply(LedPatternEngine& engine, bool enabled) const {
+        uint8_t mask = enabled ? 0xFF : 0x00;  // LED_PATTERN_OFF es 0
+        for (int i = 0; i < N; i++) {
+            engine.setPattern(engineChannels[i], patterns[i] & mask);
+        }
+    }
+
+    void flash(LedPatternEngine& engine, uint8_t times, uint16_t halfPeriodMs) const {
+        for (int i = 0; i < N; i++) {
+            engine.flash(engineChannels[i], times, halfPeriodMs);
+        }
+    }
+
+    void setPattern(int channel, uint8_t pattern) {
+        if (channel >= 0 && channel < N) {
+            patterns[channel] = pattern;
+        }
+    }
+
+    void clear() {
+        for (int i = 0; i < N; i++) {
+            patterns[i] = LED_PATTERN_OFF;
+        }
+    }
+
+    uint8_t getPattern(int channel) const {
+        return patterns[channel];
+    }
+
+    const LedChannelMapping& getMapping(int channel) const {
+        return mappings[channel];
+    }
+
+    const char* getName(int channel) const {
+        return names[channel];
+    }
+};
+
+#endif
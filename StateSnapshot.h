@@ -0,0 +1,73 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Estado compartido entre tareas con versión (seqlock): un único escritor
+// publica copias completas y los lectores obtienen siempre una copia
+// coherente sin bloquear al escritor. La versión es par cuando el valor es
+// estable; un lector que coincide con una escritura reintenta.
+//
+// El valor se guarda en palabras atómicas (accesos relajados, que en el
+// ESP32 son cargas y almacenamientos normales): así la lectura concurrente
+// con una escritura no es una carrera de datos, sólo una copia que se descarta
+template <typename T>
+class StateSnapshot {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "StateSnapshot copia T palabra a palabra");
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> words[WORDS];
+
+    void store(const T& value) {
+        uint32_t copy[WORDS] = {};
+        memcpy(copy, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(copy[i], std::memory_order_relaxed);
+        }
+    }
+
+public:
+    StateSnapshot() : sequence(0) {
+        T initial = T();
+        store(initial);
+    }
+
+    // Sólo desde la tarea propietaria
+    void publish(const T& newValue) {
+        uint32_t current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store(newValue);
+        sequence.store(current + 2, std::memory_order_release);
+    }
+
+    // Devuelve la versión de la copia leída
+    uint32_t read(T& out) const {
+        for (;;) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;  // escritura en curso en el otro núcleo
+            }
+            uint32_t copy[WORDS];
+            for (size_t i = 0; i < WORDS; i++) {
+                copy[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                memcpy(&out, copy, sizeof(T));
+                return before;
+            }
+        }
+    }
+
+    uint32_t getVersion() const {
+        return sequence.load(std::memory_order_acquire);
+    }
+};
+
+#endif
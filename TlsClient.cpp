@@ -0,0 +1,374 @@
+#include "TlsClient.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <esp_idf_version.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+
+bool TlsClient::trustConfigured = false;
+SemaphoreHandle_t TlsClient::sessionLock = nullptr;
+TlsClient::CachedSession TlsClient::sessions[TlsClient::MAX_SESSIONS];
+TlsStats TlsClient::stats = {0, 0, 0, 0};
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+static void freeSession(esp_tls_client_session_t* session) {
+    if (session == nullptr) {
+        return;
+    }
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_tls_free_client_session(session);
+#else
+    // IDF 4.4 no tiene esp_tls_free_client_session
+    mbedtls_ssl_session_free(&session->saved_session);
+    free(session);
+#endif
+}
+#endif
+
+TlsClient::TlsClient() : tls(nullptr), rxStart(0), rxEnd(0), peerClosed(false) {}
+
+TlsClient::~TlsClient() {
+    stop();
+}
+
+// ---------------------------------------------------------------- Estado compartido
+
+bool TlsClient::setTrustAnchor(const char* pem) {
+    if (pem == nullptr || pem[0] == '\0') {
+        return false;
+    }
+    if (sessionLock == nullptr) {
+        sessionLock = xSemaphoreCreateMutex();
+    }
+
+    // Las sesiones se negociaron con la CA anterior
+    forgetSessions();
+
+    lockSessions();
+    if (trustConfigured) {
+        esp_tls_free_global_ca_store();
+        trustConfigured = false;
+    }
+    // mbedTLS necesita el '\0' final dentro de la longitud para parsear PEM
+    esp_err_t result = esp_tls_set_global_ca_store((const unsigned char*)pem, strlen(pem) + 1);
+    trustConfigured = result == ESP_OK;
+    unlockSessions();
+
+    if (trustConfigured) {
+        LOG_INFO(NET, "🔒 CA fijada cargada: TLS verificado con reanudación de sesión");
+    } else {
+        LOG_ERROR(NET, "❌ CA fijada inválida (error %d): se mantiene TLS sin verificación", (int)result);
+    }
+    return trustConfigured;
+}
+
+bool TlsClient::isTrustConfigured() {
+    return trustConfigured;
+}
+
+WiFiClient* TlsClient::createSecureClient() {
+    if (trustConfigured) {
+        return new TlsClient();
+    }
+    WiFiClientSecure* secureClient = new WiFiClientSecure();
+    secureClient->setInsecure();
+    return secureClient;
+}
+
+void TlsClient::lockSessions() {
+    xSemaphoreTake(sessionLock, portMAX_DELAY);
+}
+
+void TlsClient::unlockSessions() {
+    xSemaphoreGive(sessionLock);
+}
+
+TlsClient::CachedSession* TlsClient::findSession(const char* host, uint16_t port, bool allocate) {
+    CachedSession* free = nullptr;
+    CachedSession* oldest = nullptr;
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        CachedSession* entry = &sessions[i];
+        if (entry->host[0] == '\0') {
+            if (free == nullptr) {
+                free = entry;
+            }
+            continue;
+        }
+        if (entry->port == port && strcmp(entry->host, host) == 0) {
+            return entry;
+        }
+        if (oldest == nullptr || (long)(entry->lastUsed - oldest->lastUsed) < 0) {
+            oldest = entry;
+        }
+    }
+    if (!allocate) {
+        return nullptr;
+    }
+
+    // Sin hueco: se descarta la sesión usada hace más tiempo
+    CachedSession* entry = free != nullptr ? free : oldest;
+    releaseSession(entry);
+    strncpy(entry->host, host, MAX_HOST - 1);
+    entry->host[MAX_HOST - 1] = '\0';
+    entry->port = port;
+    return entry;
+}
+
+void TlsClient::releaseSession(CachedSession* entry) {
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    freeSession(entry->session);
+    entry->session = nullptr;
+#endif
+    entry->host[0] = '\0';
+    entry->port = 0;
+    entry->lastUsed = 0;
+}
+
+void TlsClient::forgetSessions() {
+    if (sessionLock == nullptr) {
+        return;
+    }
+    lockSessions();
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        releaseSession(&sessions[i]);
+    }
+    unlockSessions();
+}
+
+const TlsStats& TlsClient::getStats() {
+    return stats;
+}
+
+void TlsClient::printStats() {
+    if (!trustConfigured) {
+        return;
+    }
+    LOG_INFO(STATS, "🔒 TLS: %lu handshakes completos, %lu con sesión reanudada, %lu fallidos, %lu sesiones guardadas",
+             stats.handshakes, stats.resumptions, stats.failures, stats.sessionsSaved);
+}
+
+// ---------------------------------------------------------------- Conexión
+
+int TlsClient::handshake(const char* host, uint16_t port, int32_t timeoutMs) {
+    stop();
+    if (!trustConfigured || host == nullptr || strlen(host) >= MAX_HOST) {
+        return 0;
+    }
+
+    esp_tls_cfg_t cfg = {};
+    cfg.timeout_ms = timeoutMs > 0 ? timeoutMs : DEFAULT_TIMEOUT_MS;
+    cfg.use_global_ca_store = true;
+
+    // Un handshake a la vez: si varias tareas conectan al mismo host, la
+    // primera negocia la sesión y las demás la reanudan en vez de repetirlo
+    lockSessions();
+    CachedSession* entry = findSession(host, port, false);
+    bool resuming = false;
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (entry != nullptr && entry->session != nullptr) {
+        cfg.client_session = entry->session;
+        resuming = true;
+    }
+#endif
+
+    tls = esp_tls_init();
+    uint32_t startUs = micros();
+    int result = tls != nullptr ? esp_tls_conn_new_sync(host, strlen(host), port, &cfg, tls) : -1;
+    uint32_t elapsedUs = micros() - startUs;
+
+    if (result != 1) {
+        stats.failures++;
+        if (entry != nullptr) {
+            // Un ticket caducado no rompe el handshake (el servidor hace uno
+            // completo); si falla igualmente, no se vuelve a ofrecer
+            releaseSession(entry);
+        }
+        unlockSessions();
+        if (tls != nullptr) {
+            esp_tls_conn_destroy(tls);
+            tls = nullptr;
+        }
+        LOG_WARN(NET, "❌ Handshake TLS con %s:%u fallido tras %lu ms", host, (unsigned)port,
+                 (unsigned long)(elapsedUs / 1000));
+        return 0;
+    }
+
+    if (resuming) {
+        stats.resumptions++;
+        Metrics::record(METRIC_TLS_RESUME, elapsedUs);
+    } else {
+        stats.handshakes++;
+        Metrics::record(METRIC_TLS_HANDSHAKE, elapsedUs);
+    }
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    // Copia de la sesión negociada (o del ticket renovado) para la próxima conexión
+    esp_tls_client_session_t* session = esp_tls_get_client_session(tls);
+    if (session != nullptr) {
+        entry = findSession(host, port, true);
+        freeSession(entry->session);
+        entry->session = session;
+        stats.sessionsSaved++;
+    }
+#endif
+    if (entry != nullptr) {
+        entry->lastUsed = millis();
+    }
+    unlockSessions();
+
+    LOG_DEBUG(NET, "🔒 TLS con %s:%u en %lu ms (%s)", host, (unsigned)port, (unsigned long)(elapsedUs / 1000),
+              resuming ? "sesión reanudada" : "handshake completo");
+    return 1;
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip, port, DEFAULT_TIMEOUT_MS);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    // La verificación del certificado necesita el nombre del host
+    (void)ip;
+    (void)port;
+    (void)timeoutMs;
+    LOG_ERROR(NET, "❌ TlsClient necesita el nombre del host, no una IP");
+    return 0;
+}
+
+int TlsClient::connect(const char* host, uint16_t port) {
+    return handshake(host, port, DEFAULT_TIMEOUT_MS);
+}
+
+int TlsClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    return handshake(host, port, timeoutMs);
+}
+
+uint8_t TlsClient::connected() {
+    if (rxStart < rxEnd) {
+        return 1;
+    }
+    if (tls == nullptr || peerClosed) {
+        return 0;
+    }
+
+    // Como WiFiClient: un recv sin bloquear distingue cierre (0) de inactividad (EAGAIN)
+    int fd = -1;
+    if (esp_tls_get_conn_sockfd(tls, &fd) != ESP_OK || fd < 0) {
+        return 0;
+    }
+    uint8_t probe;
+    int result = recv(fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (result > 0 || (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+        return 1;
+    }
+    peerClosed = true;
+    return 0;
+}
+
+void TlsClient::stop() {
+    if (tls != nullptr) {
+        esp_tls_conn_destroy(tls);
+        tls = nullptr;
+    }
+    rxStart = 0;
+    rxEnd = 0;
+    peerClosed = false;
+}
+
+// ---------------------------------------------------------------- E/S
+
+bool TlsClient::fill() {
+    if (rxStart < rxEnd) {
+        return true;
+    }
+    if (tls == nullptr || peerClosed) {
+        return false;
+    }
+
+    if (esp_tls_get_bytes_avail(tls) <= 0) {
+        // Nada descifrado pendiente: sólo se lee si el socket tiene datos
+        int fd = -1;
+        if (esp_tls_get_conn_sockfd(tls, &fd) != ESP_OK || fd < 0) {
+            return false;
+        }
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(fd, &readable);
+        struct timeval timeout = {0, 0};
+        if (select(fd + 1, &readable, nullptr, nullptr, &timeout) <= 0) {
+            return false;
+        }
+    }
+
+    ssize_t bytes = esp_tls_conn_read(tls, rxBuffer, RX_BUFFER_SIZE);
+    if (bytes > 0) {
+        rxStart = 0;
+        rxEnd = bytes;
+        return true;
+    }
+    if (bytes == ESP_TLS_ERR_SSL_WANT_READ || bytes == ESP_TLS_ERR_SSL_WANT_WRITE) {
+        return false;
+    }
+    peerClosed = true;  // 0: close_notify del servidor; < 0: error
+    return false;
+}
+
+size_t TlsClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t TlsClient::write(const uint8_t* buffer, size_t size) {
+    if (tls == nullptr || peerClosed) {
+        return 0;
+    }
+    size_t written = 0;
+    while (written < size) {
+        ssize_t bytes = esp_tls_conn_write(tls, buffer + written, size - written);
+        if (bytes > 0) {
+            written += bytes;
+        } else if (bytes != ESP_TLS_ERR_SSL_WANT_READ && bytes != ESP_TLS_ERR_SSL_WANT_WRITE) {
+            peerClosed = true;
+            break;
+        }
+    }
+    return written;
+}
+
+int TlsClient::available() {
+    if (!fill()) {
+        return 0;
+    }
+    ssize_t pending = esp_tls_get_bytes_avail(tls);
+    return (int)(rxEnd - rxStart) + (pending > 0 ? (int)pending : 0);
+}
+
+int TlsClient::read() {
+    if (!fill()) {
+        return -1;
+    }
+    return rxBuffer[rxStart++];
+}
+
+int TlsClient::read(uint8_t* buffer, size_t size) {
+    size_t copied = 0;
+    while (copied < size && fill()) {
+        size_t chunk = rxEnd - rxStart;
+        if (chunk > size - copied) {
+            chunk = size - copied;
+        }
+        memcpy(buffer + copied, rxBuffer + rxStart, chunk);
+        rxStart += chunk;
+        copied += chunk;
+    }
+    return copied > 0 ? (int)copied : -1;
+}
+
+int TlsClient::peek() {
+    if (!fill()) {
+        return -1;
+    }
+    return rxBuffer[rxStart];
+}
+
+void TlsClient::flush() {
+    // Las escrituras de esp-tls ya son síncronas
+}
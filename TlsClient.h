@@ -0,0 +1,95 @@
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_tls.h>
+
+struct TlsStats {
+    unsigned long handshakes;      // completos: sin sesión guardada para el host
+    unsigned long resumptions;     // intentados con una sesión guardada
+    unsigned long failures;
+    unsigned long sessionsSaved;
+};
+
+// Cliente https sobre esp-tls con dos ahorros frente a WiFiClientSecure:
+// - La CA fijada se parsea una vez al almacén global de mbedTLS y todas las
+//   conexiones la reutilizan (WiFiClientSecure la parsea en cada connect).
+// - La sesión TLS (ticket) de cada host se guarda y se ofrece en la
+//   siguiente conexión, también tras un cierre del servidor o una
+//   reconexión WiFi, así que sólo el primer handshake es completo.
+// Sin CA fijada (setTrustAnchor) createSecureClient() sigue devolviendo
+// WiFiClientSecure sin verificación, como hasta ahora.
+class TlsClient : public WiFiClient {
+public:
+    static const size_t RX_BUFFER_SIZE = 512;
+    static const size_t MAX_HOST = 64;
+    static const int MAX_SESSIONS = 2;
+    static const int32_t DEFAULT_TIMEOUT_MS = 5000;
+
+private:
+    struct CachedSession {
+        char host[MAX_HOST];
+        uint16_t port;
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        esp_tls_client_session_t* session;
+#endif
+        unsigned long lastUsed;
+    };
+
+    esp_tls_t* tls;
+    uint8_t rxBuffer[RX_BUFFER_SIZE];
+    size_t rxStart;
+    size_t rxEnd;
+    bool peerClosed;
+
+    // Compartido por todos los clientes (pool, trabajadores de actuación, SSE)
+    static bool trustConfigured;
+    static SemaphoreHandle_t sessionLock;
+    static CachedSession sessions[MAX_SESSIONS];
+    static TlsStats stats;
+
+    bool fill();
+    int handshake(const char* host, uint16_t port, int32_t timeoutMs);
+    static void lockSessions();
+    static void unlockSessions();
+    static CachedSession* findSession(const char* host, uint16_t port, bool allocate);
+    static void releaseSession(CachedSession* entry);
+
+public:
+    TlsClient();
+    ~TlsClient() override;
+
+    // PEM de la CA raíz del API (terminado en '\0'). Se valida una sola vez;
+    // debe llamarse antes de abrir conexiones
+    static bool setTrustAnchor(const char* pem);
+    static bool isTrustConfigured();
+
+    // Cliente para una URL https: TlsClient con CA fijada, si no WiFiClientSecure
+    static WiFiClient* createSecureClient();
+
+    // Olvida las sesiones guardadas (p. ej. tras cambiar la CA)
+    static void forgetSessions();
+    static const TlsStats& getStats();
+    static void printStats();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeoutMs) override;
+    uint8_t connected() override;
+    void stop() override;
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    void flush() override;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "SensorCache.h"
+
+struct ActuationResult {
+    static const int UNCONFIRMED = 202;  // el broker tiene la orden, el sensor no la confirmó
+    static const int NOT_QUEUED = -101;  // cola del transporte llena: la orden no llegó a salir
+    static const int URL_TOO_LONG = -102;  // la URL configurada no cabe: error local, no del servidor
+
+    char sensorId[40];
+    char sensorType[24];
+    bool targetState;
+    int httpResponseCode;  // código HTTP; en MQTT 200 = estado retenido con el valor pedido
+    unsigned long durationMs;
+    bool batchComplete;  // último resultado pendiente del lote actual
+};
+
+// Receptor de lo que entrega un transporte. Todas las llamadas se hacen desde
+// el loop (dentro de los métodos del transporte), nunca desde otra tarea.
+class TransportListener {
+public:
+    virtual void onProximityEvent(JsonObject event) = 0;
+
+    // Una instantánea completa de sensores: begin, un onSensorState por
+    // sensor y end (complete = false si la lista llegó cortada o con error)
+    virtual void onSensorStatesBegin() = 0;
+    virtual void onSensorState(JsonObject sensor) = 0;
+    virtual void onSensorStatesEnd(bool complete) = 0;
+
+    virtual void onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) = 0;
+    virtual void onRequestResult(bool success) = 0;
+
+    // El servidor pidió no volver a llamarle antes de delayMs (Retry-After)
+    virtual void onRetryAfter(unsigned long delayMs) = 0;
+
+    // El transporte (re)estableció su canal: conviene sondear enseguida
+    virtual void onTransportConnected() = 0;
+
+    virtual ~TransportListener() = default;
+};
+
+// Backend de comunicación de GeoEntryDevice (REST, MQTT...). Los métodos son
+// pasos cortos llamados desde el Scheduler; sólo se invocan con WiFi activo,
+// salvo update(), que recibe el estado del enlace.
+class Transport {
+public:
+    virtual const char* getName() const = 0;
+
+    virtual void begin(TransportListener* listener) = 0;
+    virtual void update(unsigned long now, bool networkUp) = 0;
+
+    // cursor: id del último evento procesado (vacío si no hay ninguno)
+    virtual void pollProximity(const char* cursor) = 0;
+    virtual void pollSensors() = 0;
+
+    // Lleva todos los sensores del usuario a targetState según la caché de
+    // sensores. Devuelve cuántos se mandaron a cambiar o -1 si no hay un
+    // estado fiable del que partir. Los que no caben en la cola se entregan
+    // al momento por onActuationResult con NOT_QUEUED
+    virtual int actuateAll(bool targetState) = 0;
+    // Un solo sensor, sin consultar la caché (reenvío del diario). false si
+    // no se pudo encolar; el resultado llega por onActuationResult
+    virtual bool actuate(const char* sensorId, const char* sensorType, bool targetState) = 0;
+
+    virtual const SensorCache& getSensorCache() const = 0;
+
+    virtual void printStatus() = 0;
+
+    virtual ~Transport() = default;
+
+protected:
+    static void reportNotQueued(TransportListener* listener, const char* sensorId, const char* sensorType,
+                                bool targetState) {
+        ActuationResult result;
+        snprintf(result.sensorId, sizeof(result.sensorId), "%s", sensorId);
+        snprintf(result.sensorType, sizeof(result.sensorType), "%s", sensorType);
+        result.targetState = targetState;
+        result.httpResponseCode = ActuationResult::NOT_QUEUED;
+        result.durationMs = 0;
+        result.batchComplete = false;  // no pertenece al lote en vuelo
+        listener->onActuationResult(result, 0);
+    }
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "WiFiConnection.h"
+
+WiFiConnection::WiFiConnection(const String& ssid, const String& password,
+                               Event connectedEvent, Event disconnectedEvent,
+                               EventHandler* eventHandler)
+    : ssid(ssid), password(password), handler(eventHandler),
+      connectedEvent(connectedEvent), disconnectedEvent(disconnectedEvent),
+      linkUp(false), linkDown(false), state(IDLE), stateSince(0), backoffMs(MIN_BACKOFF),
+      cachedChannel(0), hasCachedAP(false), usingCachedAP(false) {
+    memset(cachedBSSID, 0, sizeof(cachedBSSID));
+}
+
+void WiFiConnection::begin(unsigned long now) {
+    if (state != IDLE) {
+        return;
+    }
+
+    WiFi.mode(WIFI_STA);
+    WiFi.persistent(false);       // No escribir credenciales en flash en cada intento
+    WiFi.setAutoReconnect(false); // La reconexión la gobierna esta máquina de estados
+    WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) {
+        onWiFiEvent(event, info);
+    });
+
+    startConnect(now);
+}
+
+void WiFiConnection::update(unsigned long now) {
+    switch (state) {
+        case IDLE:
+            break;
+
+        case CONNECTING:
+            if (linkDown) {
+                // Rechazo del AP (clave, AP ausente) o caída justo tras GOT_IP:
+                // fallo inmediato, sin esperar al timeout
+                linkUp = false;
+                linkDown = false;
+                failConnect(now);
+            } else if (linkUp) {
+                linkUp = false;
+                linkDown = false;
+
+                // Guardar el punto de acceso para reconectar sin escanear
+                uint8_t* bssid = WiFi.BSSID();
+                if (bssid != nullptr) {
+                    memcpy(cachedBSSID, bssid, sizeof(cachedBSSID));
+                    cachedChannel = WiFi.channel();
+                    hasCachedAP = true;
+                }
+
+                state = CONNECTED;
+                stateSince = now;
+                backoffMs = MIN_BACKOFF;
+                if (handler != nullptr) {
+                    handler->on(connectedEvent);
+                }
+            } else if (now - stateSince >= (usingCachedAP ? FAST_CONNECT_TIMEOUT : CONNECT_TIMEOUT)) {
+                failConnect(now);
+            }
+            break;
+
+        case CONNECTED:
+            // Sin autoReconnect no llega otro evento tras una caída perdida:
+            // el estado del driver manda
+            if (linkDown || WiFi.status() != WL_CONNECTED) {
+                linkDown = false;
+                linkUp = false;
+                if (handler != nullptr) {
+                    handler->on(disconnectedEvent);
+                }
+                startConnect(now);
+            }
+            break;
+
+        case BACKOFF:
+            if (now - stateSince >= backoffMs) {
+                backoffMs = backoffMs * 2 > MAX_BACKOFF ? MAX_BACKOFF : backoffMs * 2;
+                startConnect(now);
+            }
+            break;
+    }
+}
+
+void WiFiConnection::reconnect(unsigned long now) {
+    if (state == CONNECTED || state == CONNECTING) {
+        return;
+    }
+    backoffMs = MIN_BACKOFF;
+    startConnect(now);
+}
+
+void WiFiConnection::setCredentials(const String& newSSID, const String& newPassword) {
+    ssid = newSSID;
+    password = newPassword;
+    hasCachedAP = false;
+}
+
+void WiFiConnection::setHandler(EventHandler* eventHandler) {
+    handler = eventHandler;
+}
+
+WiFiConnection::State WiFiConnection::getState() const {
+    return state;
+}
+
+bool WiFiConnection::isConnected() const {
+    return state == CONNECTED;
+}
+
+void WiFiConnection::startConnect(unsigned long now) {
+    linkUp = false;
+    linkDown = false;
+    usingCachedAP = hasCachedAP;
+
+    if (usingCachedAP) {
+        WiFi.begin(ssid.c_str(), password.c_str(), cachedChannel, cachedBSSID);
+    } else {
+        WiFi.begin(ssid.c_str(), password.c_str());
+    }
+
+    state = CONNECTING;
+    stateSince = now;
+}
+
+void WiFiConnection::failConnect(unsigned long now) {
+    if (usingCachedAP) {
+        // El AP cacheado no respondió: olvidarlo y escanear
+        hasCachedAP = false;
+        startConnect(now);
+    } else {
+        enterBackoff(now);
+    }
+}
+
+void WiFiConnection::enterBackoff(unsigned long now) {
+    WiFi.disconnect();
+    state = BACKOFF;
+    stateSince = now;
+}
+
+void WiFiConnection::onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    // linkDown sólo queda activo si la caída es posterior al último GOT_IP
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        linkDown = false;
+        linkUp = true;
+    } else if (event == ARDUINO_EVENT_WIFI_STA_LOST_IP) {
+        linkDown = true;
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        // ASSOC_LEAVE es la desconexión que hace el propio WiFi.begin() al
+        // cambiar de AP: no es un fallo del intento en curso
+        if (info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE) {
+            linkDown = true;
+        }
+    }
+}
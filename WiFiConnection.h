@@ -0,0 +1,66 @@
+#ifndef WIFI_CONNECTION_H
+#define WIFI_CONNECTION_H
+
+#include <WiFi.h>
+#include "EventHandler.h"
+
+// Máquina de estados de la conexión WiFi dirigida por los eventos del driver.
+// Nunca bloquea: update() avanza los estados y emite WIFI_CONNECTED /
+// WIFI_DISCONNECTED al EventHandler en cada transición. Tras una caída se
+// reintenta primero con el BSSID y canal cacheados (sin escaneo).
+class WiFiConnection {
+public:
+    enum State {
+        IDLE,
+        CONNECTING,
+        CONNECTED,
+        BACKOFF
+    };
+
+    static const unsigned long FAST_CONNECT_TIMEOUT = 3000;
+    static const unsigned long CONNECT_TIMEOUT = 10000;
+    static const unsigned long MIN_BACKOFF = 1000;
+    static const unsigned long MAX_BACKOFF = 30000;
+
+private:
+    String ssid;
+    String password;
+    EventHandler* handler;
+    Event connectedEvent;
+    Event disconnectedEvent;
+
+    // Escritos desde la tarea de eventos del WiFi, consumidos en update()
+    volatile bool linkUp;
+    volatile bool linkDown;
+
+    State state;
+    unsigned long stateSince;
+    unsigned long backoffMs;
+
+    uint8_t cachedBSSID[6];
+    int32_t cachedChannel;
+    bool hasCachedAP;
+    bool usingCachedAP;
+
+    void startConnect(unsigned long now);
+    void failConnect(unsigned long now);
+    void enterBackoff(unsigned long now);
+    void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info);
+
+public:
+    WiFiConnection(const String& ssid, const String& password,
+                   Event connectedEvent, Event disconnectedEvent,
+                   EventHandler* eventHandler = nullptr);
+
+    void begin(unsigned long now);
+    void update(unsigned long now);
+    void reconnect(unsigned long now);
+
+    void setCredentials(const String& ssid, const String& password);
+    void setHandler(EventHandler* eventHandler);
+
+    State getState() const;
+    bool isConnected() const;
+};
+
+#endif
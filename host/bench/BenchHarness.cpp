@@ -0,0 +1,104 @@
+#include "BenchHarness.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef ARDUINOJSON_VERSION
+#define BENCH_ARDUINOJSON ARDUINOJSON_VERSION
+#else
+#define BENCH_ARDUINOJSON "unknown"
+#endif
+
+static std::atomic<unsigned long long> allocations(0);
+static std::atomic<unsigned long long> allocatedBytes(0);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+unsigned long long BenchAllocs::count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+unsigned long long BenchAllocs::bytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+BenchHarness::BenchHarness(double minTime, const char* nameFilter)
+    : minTimeSeconds(minTime), filter(nameFilter != nullptr ? nameFilter : "") {}
+
+bool BenchHarness::enabled(const char* name) const {
+    return filter.empty() || strstr(name, filter.c_str()) != nullptr;
+}
+
+void BenchHarness::record(const char* name, unsigned long long iterations, double* samples,
+                          unsigned long long allocs, unsigned long long bytes) {
+    std::sort(samples, samples + SAMPLES);
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = samples[SAMPLES / 2];
+    result.minNsPerOp = samples[0];
+    result.allocsPerOp = (double)allocs / (double)(iterations * SAMPLES);
+    result.bytesPerOp = (double)bytes / (double)(iterations * SAMPLES);
+    results.push_back(result);
+}
+
+const std::vector<BenchResult>& BenchHarness::getResults() const {
+    return results;
+}
+
+void BenchHarness::writeJson(FILE* out) const {
+    fprintf(out, "{\n  \"schema\": 2,\n");
+    fprintf(out, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(out, "  \"arduinojson\": \"%s\",\n", BENCH_ARDUINOJSON);
+    fprintf(out, "  \"samples\": %d,\n", SAMPLES);
+    fprintf(out, "  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        fprintf(out,
+                "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, "
+                "\"min_ns_per_op\": %.1f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f}",
+                i > 0 ? "," : "", result.name.c_str(), result.iterations, result.nsPerOp, result.minNsPerOp,
+                result.allocsPerOp, result.bytesPerOp);
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+void BenchHarness::writeTable(FILE* out) const {
+    fprintf(out, "%-34s %14s %12s %12s %14s %10s %10s\n", "benchmark", "iteraciones", "ns/op", "min ns/op",
+            "op/s", "allocs/op", "bytes/op");
+    for (const BenchResult& result : results) {
+        fprintf(out, "%-34s %14llu %12.1f %12.1f %14.0f %10.3f %10.0f\n", result.name.c_str(), result.iterations,
+                result.nsPerOp, result.minNsPerOp, result.nsPerOp > 0 ? 1e9 / result.nsPerOp : 0.0,
+                result.allocsPerOp, result.bytesPerOp);
+    }
+}
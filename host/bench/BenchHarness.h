@@ -0,0 +1,90 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Reservas de memoria dinámica desde el arranque (operator new global)
+namespace BenchAllocs {
+    unsigned long long count();
+    unsigned long long bytes();
+}
+
+struct BenchResult {
+    std::string name;
+    unsigned long long iterations;  // por muestra
+    double nsPerOp;                 // mediana de las muestras
+    double minNsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+// Mide cuerpos sin argumentos (una operación por llamada) con tiempo de
+// pared real; el reloj virtual del host no interviene. Calibra las
+// iteraciones hasta que una muestra dura minTime / SAMPLES y se queda con la
+// mediana de SAMPLES muestras
+class BenchHarness {
+public:
+    static const int SAMPLES = 5;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double minTimeSeconds;
+    std::string filter;
+    std::vector<BenchResult> results;
+
+    template <typename Body>
+    static double timeIterations(Body& body, unsigned long long iterations) {
+        Clock::time_point start = Clock::now();
+        for (unsigned long long i = 0; i < iterations; i++) {
+            body();
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    void record(const char* name, unsigned long long iterations, double* samples, unsigned long long allocs,
+                unsigned long long bytes);
+
+public:
+    BenchHarness(double minTime, const char* nameFilter);
+
+    bool enabled(const char* name) const;
+
+    template <typename Body>
+    void run(const char* name, Body body) {
+        if (!enabled(name)) {
+            return;
+        }
+
+        // Calentar y calibrar
+        double sampleTarget = minTimeSeconds * 1e9 / SAMPLES;
+        unsigned long long iterations = 1;
+        double elapsed = timeIterations(body, iterations);
+        while (elapsed < sampleTarget && iterations < (1ULL << 40)) {
+            double factor = elapsed > 0 ? sampleTarget / elapsed * 1.2 : 10.0;
+            factor = factor < 2.0 ? 2.0 : (factor > 100.0 ? 100.0 : factor);
+            iterations = (unsigned long long)(iterations * factor);
+            elapsed = timeIterations(body, iterations);
+        }
+
+        double samples[SAMPLES];
+        unsigned long long allocsBefore = BenchAllocs::count();
+        unsigned long long bytesBefore = BenchAllocs::bytes();
+        for (int i = 0; i < SAMPLES; i++) {
+            samples[i] = timeIterations(body, iterations) / iterations;
+        }
+        record(name, iterations, samples, BenchAllocs::count() - allocsBefore, BenchAllocs::bytes() - bytesBefore);
+    }
+
+    const std::vector<BenchResult>& getResults() const;
+
+    // {"schema":2,...,"benchmarks":[...]}
+    void writeJson(FILE* out) const;
+    void writeTable(FILE* out) const;
+};
+
+#endif
@@ -0,0 +1,508 @@
+#include "BenchHarness.h"
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <vector>
+#include "ActuationJournal.h"
+#include "GeoEntryDevice.h"
+#include "GeofenceEngine.h"
+#include "JsonArrayStream.h"
+#include "LedPatternEngine.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "SmartLedArray.h"
+
+// Endpoints simulados: mismas rutas que construye RestTransport
+static const char* API_URL = "http://api.geoentry.local/api/v1/";
+static const char* EDGE_URL = "http://api.geoentry.local/";
+static const char* DEVICE_ID = "7b4cdbcd-2bf0-4047-9355-05e33babf2c9";
+static const char* USER_ID = "dd380cd7-852b-4855-9c68-c45f71b62521";
+static const char* PROXIMITY_PREFIX = "http://api.geoentry.local/api/v1/proximity-events/";
+static const char* SENSORS_PREFIX = "http://api.geoentry.local/sensors/";
+
+// Respuestas con la forma de las del Edge API (campos de más incluidos: el
+// filtro de ArduinoJson los descarta)
+static const char* PROXIMITY_BODY =
+    "[{\"id\":\"evt-0005\",\"event_id\":\"evt-0005\",\"event_type\":\"enter\",\"distance\":12.5,"
+    "\"home_location_name\":\"Casa\",\"user_id\":\"dd380cd7-852b-4855-9c68-c45f71b62521\","
+    "\"latitude\":-12.0464,\"longitude\":-77.0428,\"created_at\":\"2026-10-16T08:00:05Z\"},"
+    "{\"id\":\"evt-0004\",\"event_id\":\"evt-0004\",\"event_type\":\"exit\",\"distance\":240.1,"
+    "\"home_location_name\":\"Casa\",\"user_id\":\"dd380cd7-852b-4855-9c68-c45f71b62521\","
+    "\"latitude\":-12.0471,\"longitude\":-77.0436,\"created_at\":\"2026-10-16T07:40:11Z\"},"
+    "{\"id\":\"evt-0003\",\"event_id\":\"evt-0003\",\"event_type\":\"enter\",\"distance\":9.8,"
+    "\"home_location_name\":\"Casa\",\"user_id\":\"dd380cd7-852b-4855-9c68-c45f71b62521\","
+    "\"latitude\":-12.0465,\"longitude\":-77.0427,\"created_at\":\"2026-10-16T06:58:42Z\"}]";
+static const char* PROXIMITY_LATEST_ID = "evt-0005";
+
+static const char* SENSORS_BODY =
+    "[{\"id\":\"s-01\",\"sensor_type\":\"led_tv\",\"isActive\":true,\"name\":\"TV sala\",\"user_id\":\"u\"},"
+    "{\"id\":\"s-02\",\"sensor_type\":\"smart_light\",\"isActive\":false,\"name\":\"Luz sala\",\"user_id\":\"u\"},"
+    "{\"id\":\"s-03\",\"sensor_type\":\"smart_light\",\"isActive\":true,\"name\":\"Luz cocina\",\"user_id\":\"u\"},"
+    "{\"id\":\"s-04\",\"sensor_type\":\"air_conditioner\",\"isActive\":false,\"name\":\"AC\",\"user_id\":\"u\"},"
+    "{\"id\":\"s-05\",\"sensor_type\":\"coffee_maker\",\"isActive\":true,\"name\":\"Cafetera\",\"user_id\":\"u\"},"
+    "{\"id\":\"s-06\",\"sensor_type\":\"smart_light\",\"isActive\":false,\"name\":\"Luz patio\",\"user_id\":\"u\"}]";
+
+// Cuenta lo que entrega el transporte sin hacer nada más
+class CountingListener : public TransportListener {
+public:
+    unsigned long proximityEvents = 0;
+    unsigned long sensorStates = 0;
+    unsigned long results = 0;
+
+    void onProximityEvent(JsonObject event) override { proximityEvents++; }
+    void onSensorStatesBegin() override {}
+    void onSensorState(JsonObject sensor) override { sensorStates++; }
+    void onSensorStatesEnd(bool complete) override {}
+    void onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) override {}
+    void onRequestResult(bool success) override { results++; }
+    void onRetryAfter(unsigned long delayMs) override {}
+    void onTransportConnected() override {}
+};
+
+class CountingHandler : public EventHandler {
+public:
+    unsigned long events = 0;
+
+    void on(Event event) override { events++; }
+};
+
+// Cuerpo en memoria para JsonArrayStream sin pasar por HTTP
+class MemoryStream : public Stream {
+private:
+    const char* data;
+    size_t length;
+    size_t position;
+
+public:
+    explicit MemoryStream(const char* text) : data(text), length(strlen(text)), position(0) {}
+
+    void rewind() { position = 0; }
+    int available() override { return (int)(length - position); }
+    int read() override { return position < length ? (uint8_t)data[position++] : -1; }
+    int peek() override { return position < length ? (uint8_t)data[position] : -1; }
+    size_t write(uint8_t) override { return 0; }
+};
+
+static void benchJson(BenchHarness& harness) {
+    CountingListener listener;
+    RestTransport rest(API_URL, EDGE_URL, DEVICE_ID, USER_ID);
+    rest.begin(&listener);
+
+    HostHttp::clear();
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, PROXIMITY_BODY);
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, SENSORS_BODY);
+
+    // GET + cuerpo completo + JsonArrayStream hasta el primer evento
+    harness.run("json/proximity_poll_200", [&]() { rest.pollProximity(""); });
+    harness.run("json/sensor_poll_200", [&]() { rest.pollSensors(); });
+
+    // Lo mismo con el cuerpo en trozos (HttpBodyStream deshace el chunked)
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, SENSORS_BODY, nullptr, true);
+    harness.run("json/sensor_poll_200_chunked", [&]() { rest.pollSensors(); });
+
+    // Con ETag: la primera respuesta es 200 y las siguientes 304 sin cuerpo
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, PROXIMITY_BODY, "\"prox-v5\"");
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, SENSORS_BODY, "\"sens-v1\"");
+    rest.pollProximity(PROXIMITY_LATEST_ID);
+    rest.pollSensors();
+    harness.run("json/proximity_poll_304", [&]() { rest.pollProximity(PROXIMITY_LATEST_ID); });
+    harness.run("json/sensor_poll_304", [&]() { rest.pollSensors(); });
+
+    // Sólo el parseo en streaming, sin HTTP
+    StaticJsonDocument<192> item;
+    StaticJsonDocument<96> filter;
+    filter["id"] = true;
+    filter["sensor_type"] = true;
+    filter["isActive"] = true;
+    MemoryStream body(SENSORS_BODY);
+    harness.run("json/array_stream_sensors", [&]() {
+        body.rewind();
+        JsonArrayStream sensors(body, item, filter);
+        JsonObject sensor;
+        while (sensors.next(sensor)) {
+            listener.sensorStates++;
+        }
+    });
+
+    // Línea base: el camino anterior al streaming, con getString() del cuerpo
+    // entero y DynamicJsonDocument(4096) con todos los campos. Comparar con
+    // json/*_poll_200 y json/array_stream_sensors (tiempo, allocs y bytes)
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, PROXIMITY_BODY);
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, SENSORS_BODY);
+    String proximityURL = String(API_URL) + "proximity-events/device/" + DEVICE_ID;
+    String sensorsURL = String(EDGE_URL) + "sensors/user/" + USER_ID;
+    HTTPClient http;
+    http.setReuse(true);
+    harness.run("json/baseline_proximity_poll_200", [&]() {
+        http.begin(proximityURL);
+        if (http.GET() == 200) {
+            String response = http.getString();
+            DynamicJsonDocument doc(4096);
+            if (!deserializeJson(doc, response)) {
+                JsonArray events = doc.as<JsonArray>();
+                if (events.size() > 0) {
+                    listener.onProximityEvent(events[0]);
+                }
+            }
+        }
+        http.end();
+    });
+    harness.run("json/baseline_sensor_poll_200", [&]() {
+        http.begin(sensorsURL);
+        if (http.GET() == 200) {
+            String response = http.getString();
+            DynamicJsonDocument doc(4096);
+            if (!deserializeJson(doc, response)) {
+                for (JsonObject sensor : doc.as<JsonArray>()) {
+                    listener.onSensorState(sensor);
+                }
+            }
+        }
+        http.end();
+    });
+
+    // Sólo el parseo, desde el String que devolvía getString()
+    String sensorsBody = SENSORS_BODY;
+    harness.run("json/baseline_document_sensors", [&]() {
+        DynamicJsonDocument doc(4096);
+        if (!deserializeJson(doc, sensorsBody)) {
+            for (JsonObject sensor : doc.as<JsonArray>()) {
+                listener.sensorStates++;
+            }
+        }
+    });
+
+    HostHttp::clear();
+}
+
+// Los doce comandos de GeoEntryDevice con manejadores que sólo cuentan,
+// despachados por DispatchTable y por la cadena if/else que la precedía
+class DispatchBaseline : public CommandHandler {
+private:
+    typedef DispatchTable<DispatchBaseline, GeoEntryCommandId, GeoEntryCommandId::CHECK_PROXIMITY,
+                          GeoEntryCommandId::END> Table;
+    static const Table TABLE;
+
+    template <int I>
+    void count() {
+        calls[I]++;
+    }
+
+public:
+    unsigned long calls[Table::SIZE] = {};
+
+    __attribute__((noinline, noclone)) void handle(Command command) override {
+        TABLE.dispatch(*this, command.id);
+    }
+
+    __attribute__((noinline, noclone)) void handleChain(Command command) {
+        if (command == GeoEntryCommands::CHECK_PROXIMITY) {
+            count<0>();
+        } else if (command == GeoEntryCommands::CHECK_SENSORS) {
+            count<1>();
+        } else if (command == GeoEntryCommands::RECONNECT_WIFI) {
+            count<2>();
+        } else if (command == GeoEntryCommands::RESET_SYSTEM) {
+            count<3>();
+        } else if (command == GeoEntryCommands::UPDATE_STATUS) {
+            count<4>();
+        } else if (command == GeoEntryCommands::UPDATE_LEDS) {
+            count<5>();
+        } else if (command == GeoEntryCommands::UPDATE_TRANSPORT) {
+            count<6>();
+        } else if (command == GeoEntryCommands::CHECK_WIFI) {
+            count<7>();
+        } else if (command == GeoEntryCommands::ACTUATE_ENTER) {
+            count<8>();
+        } else if (command == GeoEntryCommands::ACTUATE_EXIT) {
+            count<9>();
+        } else if (command == GeoEntryCommands::REPLAY_JOURNAL) {
+            count<10>();
+        } else if (command == GeoEntryCommands::APPLY_SETTINGS) {
+            count<11>();
+        }
+    }
+
+    static const int SIZE = Table::SIZE;
+};
+
+const DispatchBaseline::Table DispatchBaseline::TABLE = Table::make(
+    &DispatchBaseline::count<0>, &DispatchBaseline::count<1>, &DispatchBaseline::count<2>,
+    &DispatchBaseline::count<3>, &DispatchBaseline::count<4>, &DispatchBaseline::count<5>,
+    &DispatchBaseline::count<6>, &DispatchBaseline::count<7>, &DispatchBaseline::count<8>,
+    &DispatchBaseline::count<9>, &DispatchBaseline::count<10>, &DispatchBaseline::count<11>);
+
+static void benchDispatch(BenchHarness& harness, GeoEntryDevice& device) {
+    // Entrada vacía de la tabla de eventos: sólo el coste del despacho
+    harness.run("dispatch/device_event", [&]() { device.on(GeoEntryEvents::API_REQUEST_SUCCESS); });
+    harness.run("dispatch/device_command", [&]() { device.handle(GeoEntryCommands::UPDATE_LEDS); });
+
+    Led led(13);
+    harness.run("dispatch/led_command", [&]() { led.handle(LedCommands::TOGGLE); });
+
+    // Tabla contra cadena if/else: todos los comandos por turno y el último
+    // de la cadena (su peor caso)
+    DispatchBaseline baseline;
+    int next = 0;
+    harness.run("dispatch/table_all_commands", [&]() {
+        baseline.handle(Command(MessageDomains::GEOENTRY_COMMANDS + next));
+        next = next + 1 < DispatchBaseline::SIZE ? next + 1 : 0;
+    });
+    harness.run("dispatch/if_chain_all_commands", [&]() {
+        baseline.handleChain(Command(MessageDomains::GEOENTRY_COMMANDS + next));
+        next = next + 1 < DispatchBaseline::SIZE ? next + 1 : 0;
+    });
+    harness.run("dispatch/table_last_command", [&]() { baseline.handle(GeoEntryCommands::APPLY_SETTINGS); });
+    harness.run("dispatch/if_chain_last_command", [&]() { baseline.handleChain(GeoEntryCommands::APPLY_SETTINGS); });
+
+    EventBus bus;
+    CountingHandler handler;
+    harness.run("dispatch/event_bus_roundtrip", [&]() {
+        bus.post(&handler, GeoEntryEvents::API_REQUEST_SUCCESS);
+        bus.dispatch(1);
+    });
+}
+
+// N LEDs inteligentes con tipos repartidos entre ocho: compute() lee el
+// registro y apply() publica N patrones. Cada apply() alterna encendido y
+// apagado para que todos los canales cambien de patrón. El motor tiene
+// MAX_CHANNELS canales LEDC: con más LEDs, los que no tienen canal sólo
+// cuestan la comprobación de setPattern()
+template <int N>
+static void benchSmartLeds(BenchHarness& harness, const char* computeName, const char* applyName) {
+    static const char* TYPES[] = {"led_tv", "smart_light", "air_conditioner", "coffee_maker",
+                                  "heater", "fan", "speaker", "washer"};
+    SmartLedConfig table[N];
+    for (int i = 0; i < N; i++) {
+        table[i] = {2 + i, "led", TYPES[i % 8], TYPES[(i + 1) % 8], "primario", "secundario"};
+    }
+
+    SensorRegistry registry;
+    SmartLedArray<N> leds;
+    leds.configure(table, registry);
+    registry.set("s-01", "led_tv", true);
+    registry.set("s-02", "air_conditioner", true);
+    registry.set("s-03", "speaker", true);
+
+    uint8_t patterns[N];
+    harness.run(computeName, [&]() { leds.compute(registry, patterns); });
+
+    LedPatternEngine engine;
+    leds.attach(table, engine);
+    for (int i = 0; i < N; i++) {
+        patterns[i] = LED_PATTERN_SLOW_BLINK + i % 3;  // ninguno apagado
+    }
+    leds.setPatterns(patterns);
+    bool enabled = false;
+    harness.run(applyName, [&]() {
+        enabled = !enabled;
+        leds.apply(engine, enabled);
+    });
+}
+
+static void benchLeds(BenchHarness& harness) {
+    LedWaveform waveform;
+    waveform.start(LED_PATTERN_DOUBLE_PULSE, 0);
+    uint8_t level;
+    uint16_t fadeMs;
+    harness.run("led/waveform_advance", [&]() {
+        if (!waveform.advance(waveform.deadlineUs, level, fadeMs)) {
+            waveform.start(LED_PATTERN_DOUBLE_PULSE, waveform.deadlineUs);
+        }
+    });
+
+    benchSmartLeds<2>(harness, "led/smart_compute_2", "led/smart_apply_2");
+    benchSmartLeds<16>(harness, "led/smart_compute_16", "led/smart_apply_16");
+}
+
+static void benchLogger(BenchHarness& harness) {
+    int sequence = 0;
+    harness.run("log/record_and_drain", [&]() {
+        LOG_INFO(NET, "Sondeo %d: %s (%.1f ms)", sequence++, "evt-0005", 12.5);
+        Logger::drain(1);
+    });
+}
+
+static void benchMetrics(BenchHarness& harness) {
+    // Coste de instrumentar una etapa: dos micros() y un record()
+    harness.run("metrics/stage_timer", [&]() { METRIC_SCOPE(LED_UPDATE); });
+
+    uint32_t sample = 0;
+    harness.run("metrics/histogram_record", [&]() {
+        Metrics::record(METRIC_PATCH, sample);
+        sample = sample * 1664525u + 1013904223u;  // valores repartidos por todos los cubos
+    });
+
+    harness.run("metrics/percentiles", [&]() {
+        const LatencyHistogram& histogram = Metrics::get(METRIC_PATCH);
+        histogram.percentile(0.50f);
+        histogram.percentile(0.99f);
+    });
+    Metrics::reset();
+}
+
+static void benchJournal(BenchHarness& harness) {
+    // Ficheros reales en la partición simulada: mide el formato y la E/S del
+    // host, no la flash (que además borra por sectores)
+    LittleFS.begin(true);
+    char ids[ActuationJournal::MAX_COMMANDS][8];
+    for (int i = 0; i < ActuationJournal::MAX_COMMANDS; i++) {
+        snprintf(ids[i], sizeof(ids[i]), "s-%02d", i + 1);
+    }
+
+    // Un registro por operación (fallo y confirmación alternos): el buffer se
+    // vuelca al llenarse y el fichero se compacta al llegar a MAX_FILE_SIZE
+    ActuationJournal journal("/bench.bin");
+    journal.begin(LittleFS);
+    unsigned long sequence = 0;
+    harness.run("journal/append_buffered", [&]() {
+        const char* id = ids[(sequence >> 1) % ActuationJournal::MAX_COMMANDS];
+        if (sequence & 1) {
+            journal.recordSuccess(id, true);
+        } else {
+            journal.recordFailure(id, "smart_light", true);
+        }
+        sequence++;
+    });
+
+    // Intención de enter/exit: escritura adelantada, un volcado por registro
+    harness.run("journal/append_flush", [&]() {
+        journal.recordActuateAll(sequence++ & 1);
+        journal.actuateAllSent(0);
+    });
+    journal.flush();
+
+    // Reinicio con 64 órdenes en el diario (4 por sensor): cargar, combinar
+    // y sacar las 16 que quedan
+    LittleFS.remove("/bench.bin");
+    ActuationJournal pending("/bench.bin");
+    pending.begin(LittleFS);
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 16; i++) {
+            pending.recordFailure(ids[i], "smart_light", round & 1);
+        }
+    }
+    pending.flush();
+    harness.run("journal/load_replay_64", [&]() {
+        ActuationJournal replay("/bench.bin");
+        replay.begin(LittleFS);
+        JournalCommand command;
+        while (replay.takeCommand(command)) {
+        }
+    });
+    LittleFS.format();
+    Logger::drain(Logger::CAPACITY);
+}
+
+static void benchGeofence(BenchHarness& harness) {
+    // Miles de casas en unos 44 x 44 km alrededor de Lima y posiciones al
+    // azar en la misma zona (una de cada cuatro cae dentro de alguna)
+    static const int CIRCLES = 5000;
+    static const int POLYGONS = 1000;
+    static const int POLYGON_VERTICES = 6;
+    static const int POSITIONS = 4096;
+    static const int32_t AREA_E6 = 400000;
+    static const int32_t SOUTH_E6 = -12250000;
+    static const int32_t WEST_E6 = -77240000;
+    randomSeed(25);
+
+    std::vector<GeoPoint> positions(POSITIONS);
+    for (GeoPoint& position : positions) {
+        position.latE6 = SOUTH_E6 + random(AREA_E6);
+        position.lonE6 = WEST_E6 + random(AREA_E6);
+    }
+
+    GeofenceEngine circles(CIRCLES, 0);
+    for (int i = 0; i < CIRCLES; i++) {
+        GeoPoint center = {SOUTH_E6 + (int32_t)random(AREA_E6), WEST_E6 + (int32_t)random(AREA_E6)};
+        circles.addCircle("casa", center, 50 + random(250));
+    }
+
+    // Hexágonos irregulares de 100 a 400 m
+    GeofenceEngine polygons(POLYGONS, POLYGONS * POLYGON_VERTICES);
+    for (int i = 0; i < POLYGONS; i++) {
+        GeoPoint center = {SOUTH_E6 + (int32_t)random(AREA_E6), WEST_E6 + (int32_t)random(AREA_E6)};
+        GeoPoint vertices[POLYGON_VERTICES];
+        for (int v = 0; v < POLYGON_VERTICES; v++) {
+            double angle = 2.0 * M_PI * v / POLYGON_VERTICES;
+            double radiusE6 = 900 + random(2700);
+            vertices[v].latE6 = center.latE6 + (int32_t)(radiusE6 * sin(angle));
+            vertices[v].lonE6 = center.lonE6 + (int32_t)(radiusE6 * cos(angle));
+        }
+        polygons.addPolygon("zona", vertices, POLYGON_VERTICES);
+    }
+
+    harness.run("geofence/build_5000_circles", [&]() { circles.build(); });
+    Logger::drain(Logger::CAPACITY);
+
+    GeofenceTransition transitions[8];
+    size_t next = 0;
+    harness.run("geofence/update_5000_circles", [&]() {
+        circles.update(positions[next++ & (POSITIONS - 1)], 10, transitions, 8);
+    });
+    harness.run("geofence/update_1000_polygons", [&]() {
+        polygons.update(positions[next++ & (POSITIONS - 1)], 10, transitions, 8);
+    });
+
+    // Sin índice útil (una sola celda de 10°): todas las geovallas por posición
+    GeofenceConfig scan;
+    scan.cellSizeE6 = 10000000;
+    circles.configure(scan);
+    harness.run("geofence/scan_5000_circles", [&]() {
+        circles.update(positions[next++ & (POSITIONS - 1)], 10, transitions, 8);
+    });
+    Logger::drain(Logger::CAPACITY);
+}
+
+static void benchTicks(BenchHarness& harness, GeoEntryDevice& device) {
+    harness.run("tick/control_step", [&]() { device.controlStep(); });
+
+    // Un resultado de petición encolado por paso: entrega por el bus incluida
+    harness.run("tick/control_step_events", [&]() {
+        device.onRequestResult(true);
+        device.controlStep();
+    });
+
+    // Nada vence: planificador y cola de comandos vacíos
+    harness.run("tick/network_step_idle", [&]() { device.networkStep(millis()); });
+
+    // Un periodo de control completo en tiempo virtual: reloj + red + control +
+    // volcado de logs, con el API respondiendo 304 a los sondeos condicionales
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, PROXIMITY_BODY, "\"prox-v5\"");
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, SENSORS_BODY, "\"sens-v1\"");
+    HostHttp::respond("PATCH", SENSORS_PREFIX, 200, "{}");
+    harness.run("tick/simulated_10ms", [&]() {
+        HostClock::advanceMs(10);
+        device.networkStep(millis());
+        device.controlStep();
+        Logger::drain(Logger::DRAIN_BATCH);
+    });
+    HostHttp::clear();
+}
+
+void runBenchmarks(BenchHarness& harness) {
+    benchJson(harness);
+    benchLeds(harness);
+    benchLogger(harness);
+    benchMetrics(harness);
+    benchJournal(harness);
+    benchGeofence(harness);
+
+    GeoEntryDevice device("bench-ssid", "", API_URL, DEVICE_ID, USER_ID);
+    device.setEdgeAPIConfiguration(EDGE_URL);
+    device.setCheckInterval(50);
+    device.setSensorCheckInterval(100);
+    device.init();
+
+    // Dejar que WIFI_CONNECTED llegue al control antes de medir
+    for (int i = 0; i < 20; i++) {
+        HostClock::advanceMs(10);
+        device.networkStep(millis());
+        device.controlStep();
+    }
+    Logger::drain(Logger::CAPACITY);
+
+    benchDispatch(harness, device);
+    benchTicks(harness, device);
+}
@@ -0,0 +1,52 @@
+#include "BenchHarness.h"
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+
+void runBenchmarks(BenchHarness& harness);
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Uso: %s [--filter texto] [--min-time segundos] [--out fichero.json] [--serial]\n"
+            "  --filter    sólo los benchmarks cuyo nombre contenga el texto\n"
+            "  --min-time  tiempo mínimo medido por benchmark (por defecto 0.5 s)\n"
+            "  --out       escribe el JSON en un fichero en vez de en stdout\n"
+            "  --serial    muestra la salida de Serial (logs) por stderr\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* outPath = nullptr;
+    double minTime = 0.5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--serial") == 0) {
+            HostSerial::setOutput(stderr);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    BenchHarness harness(minTime > 0 ? minTime : 0.5, filter);
+    runBenchmarks(harness);
+
+    harness.writeTable(stderr);
+    FILE* out = outPath != nullptr ? fopen(outPath, "w") : stdout;
+    if (out == nullptr) {
+        perror(outPath);
+        return 1;
+    }
+    harness.writeJson(out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
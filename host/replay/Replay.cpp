@@ -0,0 +1,192 @@
+#include "Replay.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <cstdio>
+#include "GeoEntryDevice.h"
+
+static const uint8_t PROXIMITY_LED_PIN = 2;  // Led(2) en GeoEntryDevice::initializeLeds()
+
+// Casa de --local-geofence: cada evento se traduce en una posición a su
+// distancia hacia el norte, con el radio por defecto de AdaptivePolling
+static const double HOME_LATITUDE = -12.0464;
+static const double HOME_LONGITUDE = -77.0428;
+static const uint32_t HOME_RADIUS_M = 100;
+static const double METERS_PER_DEGREE = 111195.0;
+static const float POSITION_ACCURACY_M = 10.0f;
+
+struct LedTransition {
+    uint64_t timeUs;
+    int level;
+};
+
+bool loadSequence(const char* path, std::vector<ReplayEvent>& events) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    bool valid = true;
+    StaticJsonDocument<256> doc;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+        const char* text = line + strspn(line, " \t");
+        if (*text == '\0' || *text == '\n' || *text == '\r' || *text == '#') {
+            continue;
+        }
+
+        ReplayEvent event;
+        const char* type = "";
+        if (!deserializeJson(doc, text)) {
+            type = doc["event_type"] | "";
+            event.timeMs = doc["t_ms"] | 0UL;
+            event.distance = doc["distance"] | 0.0f;
+        }
+        if (strcmp(type, "enter") != 0 && strcmp(type, "exit") != 0) {
+            fprintf(stderr, "%s:%d: línea no válida\n", path, lineNumber);
+            valid = false;
+            break;
+        }
+        snprintf(event.type, sizeof(event.type), "%s", type);
+        if (!events.empty() && event.timeMs < events.back().timeMs) {
+            fprintf(stderr, "%s:%d: t_ms no es creciente\n", path, lineNumber);
+            valid = false;
+            break;
+        }
+        events.push_back(event);
+    }
+
+    fclose(file);
+    return valid && !events.empty();
+}
+
+static LatencyStats summarize(std::vector<double>& samples) {
+    LatencyStats stats = {0, 0.0, 0.0, 0.0};
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t count = samples.size();
+    stats.count = count;
+    stats.p50 = samples[std::min(count - 1, (size_t)(0.50 * count))];
+    stats.p99 = samples[std::min(count - 1, (size_t)(0.99 * count))];
+    stats.max = samples.back();
+    return stats;
+}
+
+static void recordLed(uint8_t pin, int level, void* argument) {
+    if (pin == PROXIMITY_LED_PIN) {
+        static_cast<std::vector<LedTransition>*>(argument)->push_back({HostClock::nowUs(), level});
+    }
+}
+
+void runReplay(const std::vector<ReplayEvent>& sequence, const StandInConfig& config,
+               const ReplayOptions& options, ReplayResult& result) {
+    StandInApi api(config);
+    api.install();
+
+    GeoEntryDevice device("replay-ssid", "", StandInApi::API_URL, StandInApi::DEVICE_ID, StandInApi::USER_ID);
+    device.setEdgeAPIConfiguration(StandInApi::BASE_URL);
+    if (options.checkInterval > 0) {
+        device.setCheckInterval(options.checkInterval);
+    } else {
+        AdaptivePollingConfig polling;
+        polling.minIntervalMs = options.minIntervalMs;
+        polling.maxIntervalMs = options.maxIntervalMs;
+        device.setAdaptivePolling(polling);
+    }
+    device.setSensorCheckInterval(options.sensorCheckInterval);
+    device.setActuationJournal(options.journal);
+    if (options.localGeofence) {
+        device.addHomeLocation("Casa", HOME_LATITUDE, HOME_LONGITUDE, HOME_RADIUS_M);
+    }
+
+    std::vector<LedTransition> transitions;
+    HostPins::onChange(recordLed, &transitions);
+
+    uint64_t startUs = HostClock::nowUs();
+    device.init();
+    HostTasks::runForMs(options.warmupMs);
+
+    // Los eventos se crean en el servidor en su instante; entre medias corren
+    // las tareas del dispositivo (sondeos, control, actuación). Con
+    // --local-geofence la posición llega además al dispositivo en ese instante
+    uint64_t originUs = HostClock::nowUs();
+    std::vector<int> created;
+    for (const ReplayEvent& event : sequence) {
+        HostTasks::runUntil(originUs + (uint64_t)event.timeMs * 1000);
+        created.push_back(api.addEvent(event.type, event.distance));
+        if (options.localGeofence) {
+            device.updatePosition(HOME_LATITUDE + event.distance / METERS_PER_DEGREE, HOME_LONGITUDE,
+                                  POSITION_ACCURACY_M);
+        }
+    }
+    HostTasks::runForMs(options.tailMs);
+    uint64_t endUs = HostClock::nowUs();
+    HostPins::onChange(nullptr, nullptr);
+
+    const std::vector<StandInApi::Event>& events = api.getEvents();
+    const std::vector<StandInApi::Patch>& patches = api.getPatches();
+    std::vector<double> ledMs, firstPatchMs, lastPatchMs;
+    result.options = options;
+    result.events = created.size();
+    result.ledMissed = 0;
+    result.patchFailed = 0;
+
+    for (size_t i = 0; i < created.size(); i++) {
+        uint64_t createdUs = events[created[i]].createdUs;
+        uint64_t windowEndUs = i + 1 < created.size() ? events[created[i + 1]].createdUs : endUs;
+        int expected = strcmp(sequence[i].type, "enter") == 0 ? HIGH : LOW;
+
+        // Primer cambio al nivel esperado antes del siguiente evento. Si el
+        // LED ya estaba en ese nivel (dos "enter" seguidos) no cuenta
+        int levelBefore = LOW;
+        bool reached = false;
+        for (const LedTransition& transition : transitions) {
+            if (transition.timeUs < createdUs) {
+                levelBefore = transition.level;
+            } else if (transition.timeUs < windowEndUs && transition.level == expected) {
+                ledMs.push_back((transition.timeUs - createdUs) / 1000.0);
+                reached = true;
+                break;
+            }
+        }
+        if (!reached && levelBefore != expected) {
+            result.ledMissed++;
+        }
+
+        uint64_t firstUs = UINT64_MAX, lastUs = 0;
+        for (const StandInApi::Patch& patch : patches) {
+            if (patch.event != created[i]) {
+                continue;
+            }
+            if (!patch.ok) {
+                result.patchFailed++;
+                continue;
+            }
+            firstUs = std::min(firstUs, patch.completedUs);
+            lastUs = std::max(lastUs, patch.completedUs);
+        }
+        if (lastUs > 0) {
+            firstPatchMs.push_back((firstUs - createdUs) / 1000.0);
+            lastPatchMs.push_back((lastUs - createdUs) / 1000.0);
+        }
+    }
+
+    result.led = summarize(ledMs);
+    result.firstPatch = summarize(firstPatchMs);
+    result.lastPatch = summarize(lastPatchMs);
+    result.requests = api.getRequests();
+    result.desynced = api.countSensorsNotIn(strcmp(sequence.back().type, "enter") == 0);
+    result.proximityRequests = api.getProximityRequests();
+    result.durationMs = (unsigned long)((endUs - startUs) / 1000);
+    result.errors = api.getErrors();
+    result.bytesSent = api.getBytesSent();
+
+    // El hijo sale con _exit(): la partición temporal no se borraría
+    HostFs::reset();
+}
@@ -0,0 +1,60 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "StandInApi.h"
+#include <vector>
+
+// Evento grabado: instante relativo al inicio de la secuencia
+struct ReplayEvent {
+    unsigned long timeMs;
+    char type[8];  // "enter" | "exit"
+    float distance;
+};
+
+// Lee líneas JSON {"t_ms": 0, "event_type": "enter", "distance": 8.5}; las
+// vacías y las que empiezan por # se ignoran. Devuelve false si alguna no vale
+bool loadSequence(const char* path, std::vector<ReplayEvent>& events);
+
+// Distribución de latencias en ms (percentil por rango más cercano, como
+// percentiles() de tools/geoentry_stand_in.py)
+struct LatencyStats {
+    unsigned long count;
+    double p50;
+    double p99;
+    double max;
+};
+
+struct ReplayOptions {
+    unsigned long checkInterval;     // 0 = sondeo adaptativo entre minIntervalMs y maxIntervalMs
+    unsigned long sensorCheckInterval;
+    unsigned long minIntervalMs;
+    unsigned long maxIntervalMs;
+    unsigned long warmupMs;  // WiFi, primer sondeo e historial antes del primer evento
+    unsigned long tailMs;    // margen tras el último evento
+    bool journal;            // diario de actuaciones (setActuationJournal)
+    bool localGeofence;      // el dispositivo recibe también la posición (updatePosition)
+};
+
+// Resultado de una ejecución: tipo POD para poder devolverlo por una tubería
+struct ReplayResult {
+    ReplayOptions options;
+    unsigned long events;
+    LatencyStats led;         // creación del evento -> cambio del LED de proximidad
+    LatencyStats firstPatch;  // creación del evento -> primer PATCH completado
+    LatencyStats lastPatch;   // creación del evento -> último PATCH completado
+    unsigned long ledMissed;  // el LED no llegó al nivel esperado antes del siguiente evento
+    unsigned long patchFailed;
+    unsigned long desynced;   // sensores que al final no están como pide el último evento
+    unsigned long requests;
+    unsigned long proximityRequests;
+    unsigned long durationMs;  // tiempo virtual total (arranque + secuencia + margen)
+    unsigned long errors;
+    unsigned long bytesSent;
+};
+
+// Arranca un GeoEntryDevice contra StandInApi y reproduce la secuencia en
+// tiempo virtual. Usa el estado global de los shims: una ejecución por proceso
+void runReplay(const std::vector<ReplayEvent>& sequence, const StandInConfig& config,
+               const ReplayOptions& options, ReplayResult& result);
+
+#endif
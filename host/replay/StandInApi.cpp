@@ -0,0 +1,207 @@
+#include "StandInApi.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+const char* const StandInApi::BASE_URL = "http://standin.local/";
+const char* const StandInApi::API_URL = "http://standin.local/api/v1/";
+const char* const StandInApi::DEVICE_ID = "7b4cdbcd-2bf0-4047-9355-05e33babf2c9";
+const char* const StandInApi::USER_ID = "dd380cd7-852b-4855-9c68-c45f71b62521";
+
+static const char* const SENSOR_TYPES[] = {"led_tv", "smart_light", "air_conditioner", "coffee_maker"};
+static const int SENSOR_TYPE_COUNT = sizeof(SENSOR_TYPES) / sizeof(SENSOR_TYPES[0]);
+
+static const char* const PROXIMITY_PATH = "api/v1/proximity-events/device/";
+static const char* const SENSORS_PATH = "sensors/user/";
+static const char* const PATCH_PATH = "sensors/";
+
+// ETag estable por contenido, como el sha1 recortado del servidor Python
+static std::string contentETag(const std::string& body) {
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%016zx\"", std::hash<std::string>()(body));
+    return etag;
+}
+
+StandInApi::StandInApi(const StandInConfig& config)
+    : config(config), random(config.seed), sensorsVersion(1), requests(0), proximityRequests(0), errors(0), bytesSent(0) {
+    char id[16];
+    for (int i = 0; i < config.sensors; i++) {
+        snprintf(id, sizeof(id), "s-%02d", i + 1);
+        sensors.push_back({id, SENSOR_TYPES[i % SENSOR_TYPE_COUNT], false});
+    }
+
+    // Historial previo: el primer GET sin cursor lo recibe entero
+    for (int i = 0; i < config.history; i++) {
+        snprintf(id, sizeof(id), "evt-h%03d", i + 1);
+        events.push_back({id, i % 2 == 0 ? "enter" : "exit", i % 2 == 0 ? 8.0f : 250.0f, UINT64_MAX});
+    }
+}
+
+int StandInApi::countSensorsNotIn(bool isActive) const {
+    int count = 0;
+    for (const SensorState& sensor : sensors) {
+        if (sensor.isActive != isActive) {
+            count++;
+        }
+    }
+    return count;
+}
+
+StandInApi::~StandInApi() {
+    HostHttp::setHandler(nullptr);
+}
+
+void StandInApi::install() {
+    HostHttp::clear();
+    HostHttp::setHandler([this](const HostHttpRequest& request, HostHttpResponse& response) {
+        return handle(request, response);
+    });
+}
+
+int StandInApi::addEvent(const char* type, float distance) {
+    char id[16];
+    snprintf(id, sizeof(id), "evt-%04zu", events.size() + 1);
+    events.push_back({id, type, distance, HostClock::nowUs()});
+    return (int)events.size() - 1;
+}
+
+uint64_t StandInApi::drawLatencyUs() {
+    uint64_t latencyUs = (uint64_t)config.latencyMs * 1000;
+    if (config.jitterMs > 0) {
+        std::uniform_int_distribution<uint64_t> jitter(0, (uint64_t)config.jitterMs * 1000);
+        latencyUs += jitter(random);
+    }
+    return latencyUs;
+}
+
+bool StandInApi::handle(const HostHttpRequest& request, HostHttpResponse& response) {
+    size_t baseLength = strlen(BASE_URL);
+    if (strncmp(request.url, BASE_URL, baseLength) != 0) {
+        return false;
+    }
+    const char* path = request.url + baseLength;
+
+    requests++;
+    if (strncmp(path, PROXIMITY_PATH, strlen(PROXIMITY_PATH)) == 0) {
+        proximityRequests++;
+    }
+    response.latencyUs = drawLatencyUs();
+    response.chunked = false;
+
+    std::uniform_real_distribution<float> failure(0.0f, 1.0f);
+    if (config.errorRate > 0.0f && failure(random) < config.errorRate) {
+        errors++;
+        response.code = HTTP_CODE_SERVICE_UNAVAILABLE;
+        response.body = "{\"error\":\"unavailable\"}";
+        if (config.retryAfterS > 0) {
+            response.retryAfter = std::to_string(config.retryAfterS);
+        }
+        if (strcmp(request.method, "PATCH") == 0) {
+            patches.push_back({HostClock::nowUs() + response.latencyUs, (int)events.size() - 1, false});
+        }
+        return true;
+    }
+
+    if (strcmp(request.method, "GET") == 0 && strncmp(path, PROXIMITY_PATH, strlen(PROXIMITY_PATH)) == 0) {
+        respondProximity(strchr(path, '?'), response);
+    } else if (strcmp(request.method, "GET") == 0 && strncmp(path, SENSORS_PATH, strlen(SENSORS_PATH)) == 0) {
+        respondSensors(response);
+    } else if (strcmp(request.method, "PATCH") == 0 && strncmp(path, PATCH_PATH, strlen(PATCH_PATH)) == 0) {
+        if (!respondPatch(path + strlen(PATCH_PATH), request, response)) {
+            response.code = HTTP_CODE_NOT_FOUND;
+            response.body = "{\"error\":\"sensor not found\"}";
+        }
+    } else {
+        response.code = HTTP_CODE_NOT_FOUND;
+        response.body = "{\"error\":\"not found\"}";
+    }
+
+    if (response.code == HTTP_CODE_OK && !response.etag.empty() && response.etag == request.ifNoneMatch) {
+        return true;  // HTTPClient responde 304 sin cuerpo
+    }
+    bytesSent += response.body.size();
+    return true;
+}
+
+void StandInApi::appendEvent(std::string& body, const Event& event) const {
+    char fields[160];
+    snprintf(fields, sizeof(fields),
+             "{\"event_id\":\"%s\",\"event_type\":\"%s\",\"distance\":%.1f,"
+             "\"home_location_name\":\"Casa\",\"user_id\":\"%s\"",
+             event.id.c_str(), event.type.c_str(), event.distance, USER_ID);
+    body += fields;
+    if (config.padBytes > 0) {
+        body += ",\"notes\":\"";
+        body.append(config.padBytes, 'x');
+        body += '"';
+    }
+    body += '}';
+}
+
+void StandInApi::respondProximity(const char* query, HostHttpResponse& response) {
+    // Más reciente primero; con ?since= sólo los posteriores a ese id (si no
+    // se conoce el id, la lista completa, igual que el servidor Python)
+    size_t oldest = 0;
+    if (query != nullptr && strncmp(query, "?since=", 7) == 0) {
+        const char* since = query + 7;
+        for (size_t i = 0; i < events.size(); i++) {
+            if (events[i].id == since) {
+                oldest = i + 1;
+                break;
+            }
+        }
+    }
+
+    response.body = "[";
+    for (size_t i = events.size(); i > oldest; i--) {
+        if (response.body.size() > 1) {
+            response.body += ',';
+        }
+        appendEvent(response.body, events[i - 1]);
+    }
+    response.body += ']';
+    response.code = HTTP_CODE_OK;
+    response.etag = contentETag(response.body);
+}
+
+void StandInApi::respondSensors(HostHttpResponse& response) {
+    char item[160];
+    response.body = "[";
+    for (size_t i = 0; i < sensors.size(); i++) {
+        snprintf(item, sizeof(item), "%s{\"id\":\"%s\",\"name\":\"Sensor %zu\",\"sensor_type\":\"%s\",\"isActive\":%s}",
+                 i > 0 ? "," : "", sensors[i].id.c_str(), i + 1, sensors[i].type,
+                 sensors[i].isActive ? "true" : "false");
+        response.body += item;
+    }
+    response.body += ']';
+    response.code = HTTP_CODE_OK;
+
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"sens-v%u\"", (unsigned)sensorsVersion);
+    response.etag = etag;
+}
+
+bool StandInApi::respondPatch(const char* path, const HostHttpRequest& request, HostHttpResponse& response) {
+    // {id}/status con {"isActive": bool}
+    const char* slash = strchr(path, '/');
+    if (slash == nullptr || strcmp(slash, "/status") != 0) {
+        return false;
+    }
+    std::string id(path, slash - path);
+
+    for (SensorState& sensor : sensors) {
+        if (sensor.id != id) {
+            continue;
+        }
+        bool isActive = request.payload != nullptr && strstr(request.payload, "true") != nullptr;
+        if (sensor.isActive != isActive) {
+            sensor.isActive = isActive;
+            sensorsVersion++;
+        }
+        response.code = HTTP_CODE_OK;
+        response.body = isActive ? "{\"isActive\":true}" : "{\"isActive\":false}";
+        patches.push_back({HostClock::nowUs() + response.latencyUs, (int)events.size() - 1, true});
+        return true;
+    }
+    return false;
+}
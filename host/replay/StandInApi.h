@@ -0,0 +1,91 @@
+#ifndef STAND_IN_API_H
+#define STAND_IN_API_H
+
+#include <HTTPClient.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Versión en proceso de tools/geoentry_stand_in.py para la build del host:
+// atiende las peticiones del HTTPClient simulado (HostHttp::setHandler) en
+// tiempo virtual, con latencia, errores y tamaño de respuesta configurables
+struct StandInConfig {
+    unsigned long latencyMs = 40;   // latencia base de cada petición
+    unsigned long jitterMs = 20;    // + uniforme en [0, jitterMs]
+    float errorRate = 0.0f;         // fracción de peticiones con 503
+    unsigned long retryAfterS = 0;  // Retry-After de los 503 (0 = sin cabecera)
+    int history = 10;               // eventos antiguos ya presentes al arrancar
+    size_t padBytes = 0;            // relleno por evento (campo que el filtro descarta)
+    int sensors = 4;                // tipos en SENSOR_TYPES, en rotación
+    uint32_t seed = 1;
+};
+
+class StandInApi {
+public:
+    static const char* const BASE_URL;  // Edge API
+    static const char* const API_URL;   // BASE_URL + "api/v1/"
+    static const char* const DEVICE_ID;
+    static const char* const USER_ID;
+
+    struct Event {
+        std::string id;
+        std::string type;
+        float distance;
+        uint64_t createdUs;  // UINT64_MAX en el historial inicial
+    };
+
+    // PATCH atendido: instante en que el dispositivo recibe la respuesta
+    struct Patch {
+        uint64_t completedUs;
+        int event;  // índice en getEvents() del evento vigente, -1 si ninguno
+        bool ok;
+    };
+
+private:
+    struct SensorState {
+        std::string id;
+        const char* type;
+        bool isActive;
+    };
+
+    StandInConfig config;
+    std::mt19937 random;
+    std::vector<Event> events;       // en orden de creación
+    std::vector<SensorState> sensors;
+    std::vector<Patch> patches;
+    uint32_t sensorsVersion;
+    unsigned long requests;
+    unsigned long proximityRequests;
+    unsigned long errors;
+    unsigned long bytesSent;
+
+    bool handle(const HostHttpRequest& request, HostHttpResponse& response);
+    void respondProximity(const char* query, HostHttpResponse& response);
+    void respondSensors(HostHttpResponse& response);
+    bool respondPatch(const char* path, const HostHttpRequest& request, HostHttpResponse& response);
+    void appendEvent(std::string& body, const Event& event) const;
+    uint64_t drawLatencyUs();
+
+public:
+    explicit StandInApi(const StandInConfig& config);
+    ~StandInApi();
+
+    // Sustituye las rutas de HostHttp por este servidor
+    void install();
+
+    // Crea un evento de proximidad con el instante virtual actual
+    int addEvent(const char* type, float distance);
+
+    const std::vector<Event>& getEvents() const { return events; }
+    const std::vector<Patch>& getPatches() const { return patches; }
+    const StandInConfig& getConfig() const { return config; }
+    unsigned long getRequests() const { return requests; }
+    unsigned long getProximityRequests() const { return proximityRequests; }
+    unsigned long getErrors() const { return errors; }
+    unsigned long getBytesSent() const { return bytesSent; }
+    // Sensores cuyo estado en el servidor no es isActive
+    int countSensorsNotIn(bool isActive) const;
+};
+
+#endif
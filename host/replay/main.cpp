@@ -0,0 +1,260 @@
+#include "Replay.h"
+#include "AdaptivePolling.h"
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const int MAX_INTERVALS = 8;
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Uso: %s secuencia.jsonl [opciones]\n"
+            "  --check-interval   ms entre sondeos de proximidad, lista con comas; \"adaptive\" usa el\n"
+            "                     sondeo adaptativo (por defecto 1000)\n"
+            "  --sensor-interval  ms entre sondeos de sensores, lista con comas (por defecto 5000)\n"
+            "  --latency-ms       latencia base del servidor (por defecto 40)\n"
+            "  --jitter-ms        + uniforme en [0, jitter] (por defecto 20)\n"
+            "  --min-interval     mínimo del sondeo adaptativo en ms (por defecto 2000)\n"
+            "  --max-interval     máximo del sondeo adaptativo en ms (por defecto 30000)\n"
+            "  --error-rate       fracción de peticiones con 503 (por defecto 0)\n"
+            "  --retry-after      segundos de Retry-After en los 503 (por defecto 0, sin cabecera)\n"
+            "  --history          eventos antiguos en el servidor al arrancar (por defecto 10)\n"
+            "  --pad-bytes        relleno por evento en las respuestas (por defecto 0)\n"
+            "  --sensors          sensores del usuario (por defecto 4)\n"
+            "  --seed             semilla de latencias y errores (por defecto 1)\n"
+            "  --warmup-ms        tiempo antes del primer evento (por defecto 5000)\n"
+            "  --tail-ms          tiempo tras el último evento (por defecto 10000)\n"
+            "  --no-journal       sin diario de actuaciones (los PATCH fallidos no se reenvían)\n"
+            "  --local-geofence   el dispositivo recibe la posición de cada evento y decide él\n"
+            "                     enter/exit con sus geovallas (el servidor sigue creando el evento)\n"
+            "  --out              escribe el JSON en un fichero en vez de en stdout\n"
+            "  --serial           muestra la salida de Serial (logs) por stderr\n",
+            program);
+}
+
+// Lista de intervalos; "adaptive" se guarda como 0 si allowAdaptive
+static int parseList(const char* text, unsigned long* values, bool allowAdaptive) {
+    static const char ADAPTIVE[] = "adaptive";
+    int count = 0;
+    while (*text != '\0' && count < MAX_INTERVALS) {
+        if (allowAdaptive && strncmp(text, ADAPTIVE, strlen(ADAPTIVE)) == 0) {
+            const char* end = text + strlen(ADAPTIVE);
+            if (*end != ',' && *end != '\0') {
+                return 0;
+            }
+            values[count++] = 0;
+            text = *end == ',' ? end + 1 : end;
+            continue;
+        }
+        char* end;
+        unsigned long value = strtoul(text, &end, 10);
+        if (end == text || value == 0) {
+            return 0;
+        }
+        values[count++] = value;
+        text = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return 0;
+        }
+    }
+    return count;
+}
+
+// Cada combinación en un proceso hijo: los shims (reloj, tareas, WiFi, logs)
+// son globales y así cada ejecución empieza desde cero
+static bool runIsolated(const std::vector<ReplayEvent>& sequence, const StandInConfig& config,
+                        const ReplayOptions& options, ReplayResult& result) {
+    int channel[2];
+    if (pipe(channel) != 0) {
+        perror("pipe");
+        return false;
+    }
+    fflush(nullptr);
+
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return false;
+    }
+    if (child == 0) {
+        close(channel[0]);
+        ReplayResult childResult;
+        runReplay(sequence, config, options, childResult);
+        ssize_t written = write(channel[1], &childResult, sizeof(childResult));
+        _exit(written == (ssize_t)sizeof(childResult) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    size_t received = 0;
+    while (received < sizeof(result)) {
+        ssize_t bytes = read(channel[0], (char*)&result + received, sizeof(result) - received);
+        if (bytes <= 0) {
+            break;
+        }
+        received += bytes;
+    }
+    close(channel[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    return received == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void writeStats(FILE* out, const char* name, const LatencyStats& stats) {
+    fprintf(out, "\"%s\": {\"n\": %lu, \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+            name, stats.count, stats.p50, stats.p99, stats.max);
+}
+
+static std::string checkLabel(const ReplayOptions& options) {
+    return options.checkInterval > 0 ? std::to_string(options.checkInterval) : std::string("adapt");
+}
+
+static double perHour(unsigned long count, unsigned long durationMs) {
+    return durationMs > 0 ? count * 3600000.0 / durationMs : 0.0;
+}
+
+static void writeJson(FILE* out, const char* sequencePath, const StandInConfig& config,
+                      const std::vector<ReplayResult>& results) {
+    fprintf(out, "{\n  \"schema\": \"geoentry-replay/4\",\n  \"sequence\": \"%s\",\n", sequencePath);
+    fprintf(out,
+            "  \"stand_in\": {\"latency_ms\": %lu, \"jitter_ms\": %lu, \"error_rate\": %.3f, "
+            "\"retry_after_s\": %lu, \"history\": %d, \"pad_bytes\": %zu, \"sensors\": %d, \"seed\": %u},\n",
+            config.latencyMs, config.jitterMs, config.errorRate, config.retryAfterS, config.history,
+            config.padBytes, config.sensors, (unsigned)config.seed);
+    fprintf(out, "  \"runs\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const ReplayResult& result = results[i];
+        // check_interval_ms = 0: sondeo adaptativo entre min_interval_ms y max_interval_ms
+        fprintf(out, "    {\"mode\": \"%s\", \"check_interval_ms\": %lu, \"min_interval_ms\": %lu, "
+                     "\"max_interval_ms\": %lu, \"sensor_check_interval_ms\": %lu, \"journal\": %s, \"local_geofence\": %s, "
+                     "\"events\": %lu, ",
+                result.options.checkInterval > 0 ? "fixed" : "adaptive", result.options.checkInterval,
+                result.options.minIntervalMs, result.options.maxIntervalMs, result.options.sensorCheckInterval,
+                result.options.journal ? "true" : "false", result.options.localGeofence ? "true" : "false",
+                result.events);
+        writeStats(out, "led_ms", result.led);
+        fprintf(out, ", ");
+        writeStats(out, "first_patch_ms", result.firstPatch);
+        fprintf(out, ", ");
+        writeStats(out, "last_patch_ms", result.lastPatch);
+        fprintf(out, ", \"led_missed\": %lu, \"patch_failed\": %lu, \"sensors_desynced\": %lu, \"requests\": %lu, "
+                     "\"proximity_requests\": %lu, \"duration_ms\": %lu, \"requests_per_hour\": %.1f, "
+                     "\"proximity_requests_per_hour\": %.1f, \"errors\": %lu, \"bytes_sent\": %lu}%s\n",
+                result.ledMissed, result.patchFailed, result.desynced, result.requests, result.proximityRequests,
+                result.durationMs,
+                perHour(result.requests, result.durationMs), perHour(result.proximityRequests, result.durationMs),
+                result.errors, result.bytesSent, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void writeTable(FILE* out, const std::vector<ReplayResult>& results) {
+    fprintf(out, "%8s %8s %9s %9s %9s %11s %11s %11s %7s %7s %9s %8s %8s\n", "check", "sensors", "led p50",
+            "led p99", "led máx", "patch1 p50", "patch1 p99", "patchN p99", "perdid", "desinc", "peticion", "pet/h",
+            "prox/h");
+    for (const ReplayResult& result : results) {
+        fprintf(out, "%8s %8lu %9.1f %9.1f %9.1f %11.1f %11.1f %11.1f %7lu %7lu %9lu %8.1f %8.1f\n",
+                checkLabel(result.options).c_str(), result.options.sensorCheckInterval, result.led.p50,
+                result.led.p99, result.led.max, result.firstPatch.p50, result.firstPatch.p99, result.lastPatch.p99,
+                result.ledMissed, result.desynced, result.requests, perHour(result.requests, result.durationMs),
+                perHour(result.proximityRequests, result.durationMs));
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* sequencePath = nullptr;
+    const char* outPath = nullptr;
+    unsigned long checkIntervals[MAX_INTERVALS] = {1000};
+    unsigned long sensorIntervals[MAX_INTERVALS] = {5000};
+    int checkCount = 1;
+    int sensorCount = 1;
+    StandInConfig config;
+    AdaptivePollingConfig polling;
+    ReplayOptions options = {0, 0, polling.minIntervalMs, polling.maxIntervalMs, 5000, 10000, true, false};
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--check-interval") == 0 && hasValue) {
+            checkCount = parseList(argv[++i], checkIntervals, true);
+        } else if (strcmp(argv[i], "--sensor-interval") == 0 && hasValue) {
+            sensorCount = parseList(argv[++i], sensorIntervals, false);
+        } else if (strcmp(argv[i], "--latency-ms") == 0 && hasValue) {
+            config.latencyMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--jitter-ms") == 0 && hasValue) {
+            config.jitterMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--min-interval") == 0 && hasValue) {
+            options.minIntervalMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--max-interval") == 0 && hasValue) {
+            options.maxIntervalMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--retry-after") == 0 && hasValue) {
+            config.retryAfterS = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--error-rate") == 0 && hasValue) {
+            config.errorRate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--history") == 0 && hasValue) {
+            config.history = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pad-bytes") == 0 && hasValue) {
+            config.padBytes = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--sensors") == 0 && hasValue) {
+            config.sensors = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--warmup-ms") == 0 && hasValue) {
+            options.warmupMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--tail-ms") == 0 && hasValue) {
+            options.tailMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--no-journal") == 0) {
+            options.journal = false;
+        } else if (strcmp(argv[i], "--local-geofence") == 0) {
+            options.localGeofence = true;
+        } else if (strcmp(argv[i], "--serial") == 0) {
+            HostSerial::setOutput(stderr);
+        } else if (argv[i][0] != '-' && sequencePath == nullptr) {
+            sequencePath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (sequencePath == nullptr || checkCount == 0 || sensorCount == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<ReplayEvent> sequence;
+    if (!loadSequence(sequencePath, sequence)) {
+        return 1;
+    }
+
+    std::vector<ReplayResult> results;
+    for (int c = 0; c < checkCount; c++) {
+        for (int s = 0; s < sensorCount; s++) {
+            options.checkInterval = checkIntervals[c];
+            options.sensorCheckInterval = sensorIntervals[s];
+            ReplayResult result;
+            if (!runIsolated(sequence, config, options, result)) {
+                fprintf(stderr, "❌ Falló la ejecución con check=%s sensors=%lu\n", checkLabel(options).c_str(),
+                        options.sensorCheckInterval);
+                return 1;
+            }
+            results.push_back(result);
+        }
+    }
+
+    writeTable(stderr, results);
+    FILE* out = outPath != nullptr ? fopen(outPath, "w") : stdout;
+    if (out == nullptr) {
+        perror(outPath);
+        return 1;
+    }
+    writeJson(out, sequencePath, config, results);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
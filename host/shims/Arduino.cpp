@@ -0,0 +1,379 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <cctype>
+#include <random>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static FILE* serialOutput = nullptr;
+static unsigned long serialBytes = 0;
+static int pinLevels[HostPins::COUNT];
+static unsigned long pinWrites[HostPins::COUNT];
+static HostPins::ChangeCallback pinCallback = nullptr;
+static void* pinCallbackArgument = nullptr;
+static std::mt19937 randomEngine(1);
+
+// ---------------------------------------------------------------- String
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    char digits[72];
+    int position = sizeof(digits) - 1;
+    digits[position] = '\0';
+    do {
+        int digit = value % base;
+        digits[--position] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    if (negative) {
+        digits[--position] = '-';
+    }
+    return std::string(digits + position);
+}
+
+String::String(int value, unsigned char base)
+    : buffer(base == DEC ? formatInteger(value < 0 ? -(long long)value : value, value < 0, base)
+                         : formatInteger((unsigned int)value, false, base)) {}
+
+String::String(unsigned int value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+
+String::String(long value, unsigned char base)
+    : buffer(base == DEC ? formatInteger(value < 0 ? -(long long)value : value, value < 0, base)
+                         : formatInteger((unsigned long)value, false, base)) {}
+
+String::String(unsigned long value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    buffer = text;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (buffer.size() != other.buffer.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < buffer.size(); i++) {
+        if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)other.buffer[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return buffer.size() >= suffix.buffer.size() &&
+           buffer.compare(buffer.size() - suffix.buffer.size(), suffix.buffer.size(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t position = buffer.find(c, from);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+    size_t position = buffer.find(text.buffer, from);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t position = buffer.rfind(c);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from) const {
+    return from >= buffer.size() ? String() : String(buffer.substr(from));
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        std::swap(from, to);
+    }
+    if (from >= buffer.size()) {
+        return String();
+    }
+    return String(buffer.substr(from, to - from));
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.buffer.empty()) {
+        return;
+    }
+    size_t position = 0;
+    while ((position = buffer.find(find.buffer, position)) != std::string::npos) {
+        buffer.replace(position, find.buffer.size(), replacement.buffer);
+        position += replacement.buffer.size();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < buffer.size()) {
+        buffer.erase(index, count);
+    }
+}
+
+void String::toLowerCase() {
+    for (char& c : buffer) {
+        c = tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase() {
+    for (char& c : buffer) {
+        c = toupper((unsigned char)c);
+    }
+}
+
+void String::trim() {
+    size_t start = 0;
+    while (start < buffer.size() && isspace((unsigned char)buffer[start])) {
+        start++;
+    }
+    size_t end = buffer.size();
+    while (end > start && isspace((unsigned char)buffer[end - 1])) {
+        end--;
+    }
+    buffer = buffer.substr(start, end - start);
+}
+
+StringSumHelper operator+(const StringSumHelper& left, const String& right) {
+    StringSumHelper result(left);
+    result.concat(right);
+    return result;
+}
+
+StringSumHelper operator+(const StringSumHelper& left, const char* right) {
+    StringSumHelper result(left);
+    result.concat(right);
+    return result;
+}
+
+StringSumHelper operator+(const StringSumHelper& left, char right) {
+    StringSumHelper result(left);
+    result.concat(right);
+    return result;
+}
+
+StringSumHelper operator+(const String& left, const String& right) {
+    StringSumHelper result(left);
+    result.concat(right);
+    return result;
+}
+
+StringSumHelper operator+(const String& left, const char* right) {
+    StringSumHelper result(left);
+    result.concat(right);
+    return result;
+}
+
+StringSumHelper operator+(const char* left, const String& right) {
+    StringSumHelper result(left);
+    result.concat(right);
+    return result;
+}
+
+// ---------------------------------------------------------------- Print / Stream
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t count = 0;
+    while (count < size && write(buffer[count]) == 1) {
+        count++;
+    }
+    return count;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char stackBuffer[128];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, copy);
+    va_end(copy);
+    if (length < 0) {
+        va_end(args);
+        return 0;
+    }
+    if ((size_t)length < sizeof(stackBuffer)) {
+        va_end(args);
+        return write((const uint8_t*)stackBuffer, length);
+    }
+    std::string heapBuffer(length + 1, '\0');
+    vsnprintf(&heapBuffer[0], heapBuffer.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)heapBuffer.data(), length);
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) {
+            break;
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0 || c == terminator) {
+            break;
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String result;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) {
+        result.concat((char)c);
+    }
+    return result;
+}
+
+bool Stream::find(const char* target) {
+    size_t length = strlen(target);
+    size_t matched = 0;
+    if (length == 0) {
+        return true;
+    }
+    int c;
+    while ((c = read()) >= 0) {
+        if (c == target[matched]) {
+            if (++matched == length) {
+                return true;
+            }
+        } else {
+            matched = c == target[0] ? 1 : 0;
+        }
+    }
+    return false;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    serialBytes += size;
+    if (serialOutput != nullptr) {
+        fwrite(buffer, 1, size, serialOutput);
+    }
+    return size;
+}
+
+void HostSerial::setOutput(FILE* output) {
+    serialOutput = output;
+}
+
+unsigned long HostSerial::getBytesWritten() {
+    return serialBytes;
+}
+
+// ---------------------------------------------------------------- Tiempo
+
+unsigned long millis() {
+    return (unsigned long)(HostClock::nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)HostClock::nowUs();
+}
+
+void delay(unsigned long ms) {
+    HostClock::advanceMs(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    HostClock::advanceUs(us);
+}
+
+void yield() {}
+
+// ---------------------------------------------------------------- Pines
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HostPins::COUNT) {
+        int level = value != LOW ? HIGH : LOW;
+        bool changed = pinLevels[pin] != level;
+        pinLevels[pin] = level;
+        pinWrites[pin]++;
+        if (changed && pinCallback != nullptr) {
+            pinCallback(pin, level, pinCallbackArgument);
+        }
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HostPins::COUNT ? pinLevels[pin] : LOW;
+}
+
+int HostPins::getLevel(uint8_t pin) {
+    return digitalRead(pin);
+}
+
+unsigned long HostPins::getWrites(uint8_t pin) {
+    return pin < COUNT ? pinWrites[pin] : 0;
+}
+
+void HostPins::onChange(ChangeCallback callback, void* argument) {
+    pinCallback = callback;
+    pinCallbackArgument = argument;
+}
+
+// ---------------------------------------------------------------- Aleatorios (semilla fija: runs repetibles)
+
+long random(long max) {
+    return max <= 0 ? 0 : (long)(randomEngine() % (unsigned long)max);
+}
+
+long random(long min, long max) {
+    return max <= min ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    randomEngine.seed(seed);
+}
+
+uint32_t esp_random() {
+    return randomEngine();
+}
+
+// ---------------------------------------------------------------- ESP
+
+void EspClass::restart() {
+    // En el host no se reinicia nada: se cuenta para poder comprobarlo
+    restarts++;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return 200 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return 180 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return 110 * 1024;
+}
+
+unsigned long EspClass::getRestartCount() const {
+    return restarts;
+}
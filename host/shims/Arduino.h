@@ -0,0 +1,222 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Shim de Arduino-ESP32 para compilar el proyecto en el host (Linux/macOS).
+// Sólo cubre lo que usa el repositorio; el tiempo es virtual (HostClock.h).
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <freertos/FreeRTOS.h>
+#include "HostClock.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define IRAM_ATTR
+#define PROGMEM
+
+#define DEC 10
+#define HEX 16
+
+class String {
+private:
+    std::string buffer;
+
+public:
+    String() {}
+    String(const char* text) : buffer(text != nullptr ? text : "") {}
+    String(const std::string& text) : buffer(text) {}
+    explicit String(char c) : buffer(1, c) {}
+    explicit String(int value, unsigned char base = DEC);
+    explicit String(unsigned int value, unsigned char base = DEC);
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return buffer.c_str(); }
+    unsigned int length() const { return buffer.size(); }
+    bool isEmpty() const { return buffer.empty(); }
+    bool reserve(unsigned int size) { buffer.reserve(size); return true; }
+
+    bool concat(const String& other) { buffer += other.buffer; return true; }
+    bool concat(const char* text) { buffer += text != nullptr ? text : ""; return true; }
+    bool concat(const char* text, unsigned int length) { buffer.append(text, length); return true; }
+    bool concat(char c) { buffer += c; return true; }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) {
+        concat(value);
+        return *this;
+    }
+
+    bool equals(const String& other) const { return buffer == other.buffer; }
+    bool equals(const char* text) const { return buffer == (text != nullptr ? text : ""); }
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* text) const { return equals(text); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* text) const { return !equals(text); }
+    bool operator<(const String& other) const { return buffer < other.buffer; }
+    int compareTo(const String& other) const { return buffer.compare(other.buffer); }
+
+    bool startsWith(const String& prefix) const { return buffer.compare(0, prefix.buffer.size(), prefix.buffer) == 0; }
+    bool endsWith(const String& suffix) const;
+    char charAt(unsigned int index) const { return index < buffer.size() ? buffer[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& text, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const { return strtol(buffer.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(buffer.c_str(), nullptr); }
+};
+
+// Arduino devuelve StringSumHelper al concatenar; ArduinoJson lo referencia
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& text) : String(text) {}
+};
+
+StringSumHelper operator+(const StringSumHelper& left, const String& right);
+StringSumHelper operator+(const StringSumHelper& left, const char* right);
+StringSumHelper operator+(const StringSumHelper& left, char right);
+StringSumHelper operator+(const String& left, const String& right);
+StringSumHelper operator+(const String& left, const char* right);
+StringSumHelper operator+(const char* left, const String& right);
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return text != nullptr ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual void flush() {}
+
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(const char* text) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) {
+        return print(value) + println();
+    }
+    size_t println(int value, int base) { return print(value, base) + println(); }
+    size_t println(double value, int decimals) { return print(value, decimals) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+protected:
+    unsigned long timeout = 1000;
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeout = ms; }
+    unsigned long getTimeout() const { return timeout; }
+
+    // En el host no hay espera: lo que no ha llegado ya no va a llegar
+    virtual size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    String readStringUntil(char terminator);
+    bool find(const char* target);
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    int availableForWrite() { return 128; }
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Destino de Serial en el host: por defecto se descarta
+namespace HostSerial {
+    void setOutput(FILE* output);  // nullptr = descartar
+    unsigned long getBytesWritten();
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// Estado de los pines escritos con digitalWrite()
+namespace HostPins {
+    static const int COUNT = 40;
+    int getLevel(uint8_t pin);
+    unsigned long getWrites(uint8_t pin);
+
+    // Aviso en cada cambio de nivel (sólo cambios, no escrituras repetidas)
+    typedef void (*ChangeCallback)(uint8_t pin, int level, void* argument);
+    void onChange(ChangeCallback callback, void* argument);
+}
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+class EspClass {
+public:
+    void restart();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    unsigned long getRestartCount() const;
+
+private:
+    unsigned long restarts = 0;
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// Shim de la API de ficheros de Arduino-ESP32 (fs::FS / fs::File) sobre
+// ficheros reales del host. Las rutas del dispositivo ("/journal.bin") se
+// resuelven dentro del directorio raíz del sistema de ficheros que las monta
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Stream {
+private:
+    std::shared_ptr<FILE> handle;
+    std::string devicePath;
+
+public:
+    File() {}
+    File(FILE* file, const char* path);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    size_t read(uint8_t* buffer, size_t size);
+    int peek() override;
+    void flush() override;
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    const char* path() const { return devicePath.c_str(); }
+    operator bool() const { return handle != nullptr; }
+};
+
+class FS {
+protected:
+    std::string root;  // vacío = sin montar
+
+    std::string hostPath(const char* path) const;
+
+public:
+    virtual ~FS() {}
+
+    File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, const bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* pathFrom, const char* pathTo);
+};
+
+}  // namespace fs
+
+using fs::FS;
+using fs::File;
+
+#endif
@@ -0,0 +1,426 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "HostClock.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ucontext.h>
+
+// Anillo con el almacenamiento reservado al crearla, como en FreeRTOS:
+// enviar y recibir no reservan memoria
+struct HostQueue {
+    size_t length;
+    size_t itemSize;
+    std::vector<uint8_t> storage;  // length * itemSize
+    size_t head;                   // posición del primer elemento
+    size_t count;
+};
+
+struct HostTask {
+    // Las pilas del host son mucho más generosas que las del ESP32: los
+    // marcos son mayores en x86-64 y con sanitizers
+    static const size_t STACK_SIZE = 512 * 1024;
+
+    std::string name;
+    BaseType_t core;
+    UBaseType_t priority;
+    TaskFunction_t function;
+    void* parameter;
+
+    ucontext_t context;
+    std::vector<char> stack;
+    bool started;
+    bool finished;
+
+    // Motivo del bloqueo: hasta wakeUs o hasta que la cola tenga datos/hueco
+    uint64_t wakeUs;
+    HostQueue* waitQueue;
+    bool waitForSpace;
+};
+
+static std::vector<HostTask*> tasks;  // por prioridad descendente, estable
+static HostTask* current = nullptr;
+static ucontext_t schedulerContext;
+
+BaseType_t xPortGetCoreID() {
+    return current != nullptr && current->core != tskNO_AFFINITY ? current->core : 1;
+}
+
+// ---------------------------------------------------------------- Planificador
+
+static bool queueReady(const HostQueue* queue, bool forSpace) {
+    return forSpace ? queue->count < queue->length : queue->count > 0;
+}
+
+static bool runnable(const HostTask* task) {
+    if (task->finished) {
+        return false;
+    }
+    if (!task->started) {
+        return true;
+    }
+    if (task->waitQueue != nullptr && queueReady(task->waitQueue, task->waitForSpace)) {
+        return true;
+    }
+    return task->wakeUs <= HostClock::nowUs();
+}
+
+static void taskEntry() {
+    current->function(current->parameter);
+    // Una tarea de FreeRTOS no debe volver; si lo hace se da por terminada
+    current->finished = true;
+    swapcontext(&current->context, &schedulerContext);
+}
+
+// Quita la tarea de la lista y libera su pila (nunca la que está en uso)
+static void reap(HostTask* task) {
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i] == task) {
+            tasks.erase(tasks.begin() + i);
+            break;
+        }
+    }
+    delete task;
+}
+
+static void resume(HostTask* task) {
+    if (!task->started) {
+        task->started = true;
+        task->stack.resize(HostTask::STACK_SIZE);
+        getcontext(&task->context);
+        task->context.uc_stack.ss_sp = task->stack.data();
+        task->context.uc_stack.ss_size = task->stack.size();
+        task->context.uc_link = &schedulerContext;
+        makecontext(&task->context, taskEntry, 0);
+    }
+    task->waitQueue = nullptr;
+    task->wakeUs = UINT64_MAX;
+    current = task;
+    swapcontext(&schedulerContext, &task->context);
+    current = nullptr;
+    if (task->finished) {
+        reap(task);
+    }
+}
+
+// Cede el control al planificador hasta que se cumpla la condición de espera
+static void suspend(uint64_t wakeUs, HostQueue* queue, bool forSpace) {
+    HostTask* task = current;
+    task->wakeUs = wakeUs;
+    task->waitQueue = queue;
+    task->waitForSpace = forSpace;
+    swapcontext(&task->context, &schedulerContext);
+}
+
+// Ejecuta las tareas listas hasta que todas esperan
+static void runReady() {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < tasks.size(); i++) {
+            if (runnable(tasks[i])) {
+                resume(tasks[i]);
+                progress = true;
+                break;  // volver a empezar por la de más prioridad
+            }
+        }
+    }
+}
+
+void HostTasks::runUntil(uint64_t untilUs) {
+    if (current != nullptr) {
+        return;  // sólo desde el hilo principal
+    }
+
+    for (;;) {
+        runReady();
+
+        uint64_t next = HostClock::nextTimerUs();
+        for (HostTask* task : tasks) {
+            if (!task->finished && task->wakeUs < next) {
+                next = task->wakeUs;
+            }
+        }
+
+        uint64_t now = HostClock::nowUs();
+        if (next > untilUs) {
+            if (untilUs > now) {
+                HostClock::advanceUs(untilUs - now);
+            }
+            runReady();
+            return;
+        }
+        // Con next == now (timer armado con plazo 0) advanceUs(0) lo dispara
+        HostClock::advanceUs(next > now ? next - now : 0);
+    }
+}
+
+void HostTasks::runForMs(unsigned long ms) {
+    runUntil(HostClock::nowUs() + (uint64_t)ms * 1000);
+}
+
+void HostTasks::delayUs(uint64_t us) {
+    if (current == nullptr) {
+        HostClock::advanceUs(us);
+        return;
+    }
+    uint64_t wake = HostClock::nowUs() + us;
+    while (HostClock::nowUs() < wake) {
+        suspend(wake, nullptr, false);
+    }
+}
+
+bool HostTasks::inTask() {
+    return current != nullptr;
+}
+
+// Espera (desde una tarea) a que la cola tenga datos o hueco, como mucho ticksToWait
+static bool waitForQueue(HostQueue* queue, bool forSpace, TickType_t ticksToWait) {
+    if (queueReady(queue, forSpace)) {
+        return true;
+    }
+    if (ticksToWait == 0 || current == nullptr) {
+        return false;
+    }
+
+    uint64_t deadline = ticksToWait == portMAX_DELAY ? UINT64_MAX
+                                                     : HostClock::nowUs() + (uint64_t)ticksToWait * 1000;
+    while (!queueReady(queue, forSpace)) {
+        if (HostClock::nowUs() >= deadline) {
+            return false;
+        }
+        suspend(deadline, queue, forSpace);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- Tareas
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)stackSize;
+    HostTask* task = new HostTask();
+    task->name = name != nullptr ? name : "";
+    task->core = core;
+    task->priority = priority;
+    task->function = function;
+    task->parameter = parameter;
+    task->started = false;
+    task->finished = false;
+    task->wakeUs = UINT64_MAX;
+    task->waitQueue = nullptr;
+    task->waitForSpace = false;
+
+    size_t position = 0;
+    while (position < tasks.size() && tasks[position]->priority >= priority) {
+        position++;
+    }
+    tasks.insert(tasks.begin() + position, task);
+
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackSize, void* parameter,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stackSize, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr) {
+        task = current;
+    }
+    if (task == nullptr) {
+        return;
+    }
+    // Auto-borrado: la pila está en uso, resume() la libera al volver
+    if (task == current) {
+        task->finished = true;
+        swapcontext(&task->context, &schedulerContext);
+        return;
+    }
+    reap(task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    HostTasks::delayUs((uint64_t)ticks * 1000);
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+    TickType_t wake = *previousWake + period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(wake - now) > 0) {
+        HostTasks::delayUs((uint64_t)(wake - now) * 1000);
+    }
+    *previousWake = wake;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 1024;
+}
+
+void taskYIELD() {
+    if (current != nullptr) {
+        suspend(HostClock::nowUs(), nullptr, false);
+    }
+}
+
+int HostTasks::count() {
+    return (int)tasks.size();
+}
+
+const char* HostTasks::name(int index) {
+    return tasks[index]->name.c_str();
+}
+
+BaseType_t HostTasks::core(int index) {
+    return tasks[index]->core;
+}
+
+UBaseType_t HostTasks::priority(int index) {
+    return tasks[index]->priority;
+}
+
+// ---------------------------------------------------------------- Colas
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue* queue = new HostQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->storage.resize((size_t)length * itemSize);
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+static void pushItem(HostQueue* queue, const void* item, bool front) {
+    size_t slot;
+    if (front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        slot = queue->head;
+    } else {
+        slot = (queue->head + queue->count) % queue->length;
+    }
+    if (queue->itemSize > 0) {
+        memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+}
+
+static void peekItem(const HostQueue* queue, void* item) {
+    if (queue->itemSize > 0) {
+        memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    }
+}
+
+static void popItem(HostQueue* queue, void* item) {
+    peekItem(queue, item);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+static BaseType_t enqueue(QueueHandle_t queue, const void* item, bool front, TickType_t ticksToWait) {
+    if (queue == nullptr || !waitForQueue(queue, true, ticksToWait)) {
+        return pdFALSE;
+    }
+    pushItem(queue, item, front);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return enqueue(queue, item, false, ticksToWait);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return enqueue(queue, item, false, ticksToWait);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return enqueue(queue, item, true, ticksToWait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return enqueue(queue, item, false, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    queue->count = 0;
+    return enqueue(queue, item, false, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    if (queue == nullptr || !waitForQueue(queue, false, ticksToWait)) {
+        return pdFALSE;
+    }
+    popItem(queue, item);
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    if (queue == nullptr || !waitForQueue(queue, false, ticksToWait)) {
+        return pdFALSE;
+    }
+    peekItem(queue, item);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue != nullptr ? (UBaseType_t)queue->count : 0;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    return queue != nullptr ? (UBaseType_t)(queue->length - queue->count) : 0;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (queue != nullptr) {
+        queue->count = 0;
+    }
+    return pdPASS;
+}
+
+// ---------------------------------------------------------------- Semáforos (cola de longitud 1 sin datos)
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    QueueHandle_t semaphore = xQueueCreate(1, 0);
+    pushItem(semaphore, nullptr, false);
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xQueueCreate(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (semaphore == nullptr || !waitForQueue(semaphore, false, ticksToWait)) {
+        return pdFALSE;
+    }
+    popItem(semaphore, nullptr);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore == nullptr || semaphore->count > 0) {
+        return pdFALSE;
+    }
+    pushItem(semaphore, nullptr, false);
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
@@ -0,0 +1,258 @@
+#include <HTTPClient.h>
+#include <freertos/task.h>
+
+struct HostRoute {
+    std::string method;
+    std::string urlPrefix;
+    int code;
+    std::string body;
+    std::string etag;
+    bool chunked;
+};
+
+static std::vector<HostRoute> routes;
+static HostHttpHandler handler;
+static unsigned long requestCount = 0;
+static std::string lastURL;
+static std::string lastPayload;
+
+// La ruta con el prefijo más largo que encaje
+static const HostRoute* findRoute(const char* method, const char* url) {
+    const HostRoute* best = nullptr;
+    for (const HostRoute& route : routes) {
+        if (route.method == method && strncmp(url, route.urlPrefix.c_str(), route.urlPrefix.size()) == 0 &&
+            (best == nullptr || route.urlPrefix.size() > best->urlPrefix.size())) {
+            best = &route;
+        }
+    }
+    return best;
+}
+
+static std::string encodeChunked(const std::string& body) {
+    static const size_t CHUNK_SIZE = 256;
+    std::string encoded;
+    char header[16];
+    for (size_t offset = 0; offset < body.size(); offset += CHUNK_SIZE) {
+        size_t length = body.size() - offset < CHUNK_SIZE ? body.size() - offset : CHUNK_SIZE;
+        snprintf(header, sizeof(header), "%zx\r\n", length);
+        encoded += header;
+        encoded.append(body, offset, length);
+        encoded += "\r\n";
+    }
+    encoded += "0\r\n\r\n";
+    return encoded;
+}
+
+bool HTTPClient::begin(String url) {
+    return begin(ownClient, url);
+}
+
+bool HTTPClient::begin(WiFiClient& client, String url) {
+    this->client = &client;
+    this->url = url;
+    requestHeaders.clear();
+    responseHeaders.clear();
+    responseSize = -1;
+    body = String();
+    bodyDelivered = false;
+    return true;
+}
+
+void HTTPClient::end() {
+    requestHeaders.clear();
+}
+
+bool HTTPClient::connected() {
+    return client != nullptr && client->connected();
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace) {
+    (void)first;
+    for (auto& header : requestHeaders) {
+        if (header.first.equalsIgnoreCase(name)) {
+            if (replace) {
+                header.second = value;
+            }
+            return;
+        }
+    }
+    requestHeaders.push_back(std::make_pair(name, value));
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+    collectKeys.clear();
+    for (size_t i = 0; i < headerKeysCount; i++) {
+        collectKeys.push_back(String(headerKeys[i]));
+    }
+}
+
+String HTTPClient::header(const char* name) {
+    for (const auto& header : responseHeaders) {
+        if (header.first.equalsIgnoreCase(name)) {
+            return header.second;
+        }
+    }
+    return String();
+}
+
+bool HTTPClient::hasHeader(const char* name) {
+    for (const auto& header : responseHeaders) {
+        if (header.first.equalsIgnoreCase(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET");
+}
+
+int HTTPClient::POST(const String& payload) {
+    return sendRequest("POST", payload);
+}
+
+int HTTPClient::PATCH(const String& payload) {
+    return sendRequest("PATCH", payload);
+}
+
+int HTTPClient::PUT(const String& payload) {
+    return sendRequest("PUT", payload);
+}
+
+int HTTPClient::sendRequest(const char* type, String payload) {
+    return sendRequest(type, (uint8_t*)payload.c_str(), payload.length());
+}
+
+int HTTPClient::sendRequest(const char* type, uint8_t* payload, size_t size) {
+    if (client == nullptr) {
+        return HTTPC_ERROR_NOT_CONNECTED;
+    }
+
+    requestCount++;
+    lastURL = url.c_str();
+    lastPayload.assign(payload != nullptr ? (const char*)payload : "", payload != nullptr ? size : 0);
+    responseHeaders.clear();
+    bodyDelivered = false;
+
+    String ifNoneMatch;
+    for (const auto& header : requestHeaders) {
+        if (header.first.equalsIgnoreCase("If-None-Match")) {
+            ifNoneMatch = header.second;
+        }
+    }
+
+    HostHttpResponse response = {HTTP_CODE_NOT_FOUND, "", "", false, 0, ""};
+    HostHttpRequest request = {type, url.c_str(), ifNoneMatch.c_str(), (const char*)payload,
+                               payload != nullptr ? size : 0};
+    if (!handler || !handler(request, response)) {
+        const HostRoute* route = findRoute(type, url.c_str());
+        if (route != nullptr) {
+            response.code = route->code;
+            response.body = route->body;
+            response.etag = route->etag;
+            response.chunked = route->chunked;
+        }
+    }
+
+    if (response.latencyUs > 0) {
+        HostTasks::delayUs(response.latencyUs);
+    }
+
+    if (response.code < 0) {
+        client->stop();
+        return response.code;
+    }
+
+    client->hostOpen();
+
+    if (!response.etag.empty() && ifNoneMatch == response.etag.c_str()) {
+        client->hostDeliver("", 0);
+        responseSize = 0;
+        responseHeaders.push_back(std::make_pair(String("ETag"), String(response.etag)));
+        return HTTP_CODE_NOT_MODIFIED;
+    }
+
+    // Sólo se guardan las cabeceras pedidas con collectHeaders(), como en el dispositivo
+    for (const String& key : collectKeys) {
+        if (key.equalsIgnoreCase("ETag") && !response.etag.empty()) {
+            responseHeaders.push_back(std::make_pair(key, String(response.etag)));
+        } else if (key.equalsIgnoreCase("Transfer-Encoding") && response.chunked) {
+            responseHeaders.push_back(std::make_pair(key, String("chunked")));
+        } else if (key.equalsIgnoreCase("Retry-After") && !response.retryAfter.empty()) {
+            responseHeaders.push_back(std::make_pair(key, String(response.retryAfter)));
+        }
+    }
+
+    if (response.chunked) {
+        std::string encoded = encodeChunked(response.body);
+        client->hostDeliver(encoded.data(), encoded.size());
+        responseSize = -1;
+    } else {
+        client->hostDeliver(response.body.data(), response.body.size());
+        responseSize = (int)response.body.size();
+    }
+    return response.code;
+}
+
+String HTTPClient::getString() {
+    if (client == nullptr || bodyDelivered) {
+        return String();
+    }
+    bodyDelivered = true;
+    String result;
+    int c;
+    while ((c = client->read()) >= 0) {
+        result.concat((char)c);
+    }
+    return result;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED:
+            return String("connection refused");
+        case HTTPC_ERROR_CONNECTION_LOST:
+            return String("connection lost");
+        case HTTPC_ERROR_READ_TIMEOUT:
+            return String("read Timeout");
+        default:
+            return String("error ") + String(error);
+    }
+}
+
+void HostHttp::respond(const char* method, const char* urlPrefix, int code, const char* body, const char* etag,
+                       bool chunked) {
+    HostRoute route = {method, urlPrefix, code, body != nullptr ? body : "", etag != nullptr ? etag : "", chunked};
+    for (HostRoute& existing : routes) {
+        if (existing.method == route.method && existing.urlPrefix == route.urlPrefix) {
+            existing = route;
+            return;
+        }
+    }
+    routes.push_back(route);
+}
+
+void HostHttp::setHandler(HostHttpHandler newHandler) {
+    handler = newHandler;
+}
+
+void HostHttp::clear() {
+    routes.clear();
+    handler = nullptr;
+    requestCount = 0;
+    lastURL.clear();
+    lastPayload.clear();
+}
+
+unsigned long HostHttp::getRequests() {
+    return requestCount;
+}
+
+const char* HostHttp::getLastURL() {
+    return lastURL.c_str();
+}
+
+const char* HostHttp::getLastPayload() {
+    return lastPayload.c_str();
+}
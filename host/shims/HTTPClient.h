@@ -0,0 +1,116 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_CREATED 201
+#define HTTP_CODE_NO_CONTENT 204
+#define HTTP_CODE_NOT_MODIFIED 304
+#define HTTP_CODE_BAD_REQUEST 400
+#define HTTP_CODE_NOT_FOUND 404
+#define HTTP_CODE_TOO_MANY_REQUESTS 429
+#define HTTP_CODE_INTERNAL_SERVER_ERROR 500
+#define HTTP_CODE_SERVICE_UNAVAILABLE 503
+
+// Cliente HTTP del host: no abre sockets. Cada petición se resuelve contra
+// la tabla de rutas de HostHttp y la respuesta se deja en el WiFiClient para
+// que getStream() la entregue igual que en el dispositivo
+class HTTPClient {
+private:
+    WiFiClient ownClient;
+    WiFiClient* client = nullptr;
+    String url;
+    std::vector<std::pair<String, String> > requestHeaders;
+    std::vector<String> collectKeys;
+    std::vector<std::pair<String, String> > responseHeaders;
+    int responseSize = -1;
+    String body;
+    bool bodyDelivered = false;
+
+public:
+    bool begin(String url);
+    bool begin(WiFiClient& client, String url);
+    void end();
+    bool connected();
+    void setReuse(bool reuse) { (void)reuse; }
+    void useHTTP10(bool http10) { (void)http10; }
+    void setTimeout(uint16_t timeoutMs) { (void)timeoutMs; }
+    void setConnectTimeout(int32_t timeoutMs) { (void)timeoutMs; }
+
+    void addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+    String header(const char* name);
+    bool hasHeader(const char* name);
+
+    int GET();
+    int POST(const String& payload);
+    int PATCH(const String& payload);
+    int PUT(const String& payload);
+    int sendRequest(const char* type, String payload);
+    int sendRequest(const char* type, uint8_t* payload = nullptr, size_t size = 0);
+
+    int getSize() { return responseSize; }
+    String getString();
+    WiFiClient& getStream() { return *client; }
+    WiFiClient* getStreamPtr() { return client; }
+
+    static String errorToString(int error);
+};
+
+// Petición tal como la ve el servidor simulado
+struct HostHttpRequest {
+    const char* method;
+    const char* url;
+    const char* ifNoneMatch;  // "" si no se envió
+    const char* payload;
+    size_t payloadLength;
+};
+
+struct HostHttpResponse {
+    int code;            // < 0: error de conexión (HTTPC_ERROR_*)
+    std::string body;
+    std::string etag;    // con If-None-Match igual se responde 304
+    bool chunked;
+    uint64_t latencyUs;  // tiempo virtual que tarda la respuesta
+    std::string retryAfter;  // cabecera Retry-After ("" = sin ella)
+};
+
+// Devuelve false si no atiende la URL (entonces se prueban las rutas)
+typedef std::function<bool(const HostHttpRequest& request, HostHttpResponse& response)> HostHttpHandler;
+
+namespace HostHttp {
+    // Registra (o reemplaza) la respuesta para method + prefijo de URL. Con
+    // etag, una petición con If-None-Match igual recibe 304. Con chunked el
+    // cuerpo se codifica en trozos y getSize() devuelve -1. code < 0 simula
+    // un error de conexión (HTTPC_ERROR_*). Una URL sin ruta recibe 404
+    void respond(const char* method, const char* urlPrefix, int code, const char* body,
+                 const char* etag = nullptr, bool chunked = false);
+    void clear();
+
+    // Servidor dinámico (p. ej. host/replay). La latencia se espera con
+    // HostTasks::delayUs(): dentro de una tarea las demás siguen corriendo
+    void setHandler(HostHttpHandler handler);
+
+    unsigned long getRequests();
+    const char* getLastURL();
+    const char* getLastPayload();
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "HostClock.h"
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <cstdint>
+#include <vector>
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t deadline;
+    uint64_t period;  // 0 = una vez
+    bool armed;
+};
+
+static uint64_t currentUs = 0;
+static std::vector<esp_timer*> timers;
+
+uint64_t HostClock::nowUs() {
+    return currentUs;
+}
+
+void HostClock::reset() {
+    currentUs = 0;
+    for (esp_timer* timer : timers) {
+        timer->armed = false;
+    }
+}
+
+// El timer armado que vence antes (hasta limitUs incluido), o nullptr
+static esp_timer* nextDue(uint64_t limitUs) {
+    esp_timer* next = nullptr;
+    for (esp_timer* timer : timers) {
+        if (timer->armed && timer->deadline <= limitUs && (next == nullptr || timer->deadline < next->deadline)) {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+void HostClock::advanceUs(uint64_t us) {
+    uint64_t target = currentUs + us;
+    esp_timer* timer;
+    // Una callback puede rearmar timers: se busca el siguiente tras cada disparo
+    while ((timer = nextDue(target)) != nullptr) {
+        currentUs = timer->deadline > currentUs ? timer->deadline : currentUs;
+        if (timer->period > 0) {
+            timer->deadline += timer->period;
+        } else {
+            timer->armed = false;
+        }
+        timer->callback(timer->arg);
+    }
+    currentUs = target;
+}
+
+void HostClock::advanceMs(unsigned long ms) {
+    advanceUs((uint64_t)ms * 1000);
+}
+
+uint64_t HostClock::nextTimerUs() {
+    esp_timer* next = nextDue(UINT64_MAX);
+    return next != nullptr ? next->deadline : UINT64_MAX;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    if (args == nullptr || args->callback == nullptr || handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_timer* timer = new esp_timer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    timer->deadline = 0;
+    timer->period = 0;
+    timer->armed = false;
+    timers.push_back(timer);
+    *handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    if (timer == nullptr || timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline = currentUs + timeoutUs;
+    timer->period = 0;
+    timer->armed = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (timer == nullptr || timer->armed || periodUs == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline = currentUs + periodUs;
+    timer->period = periodUs;
+    timer->armed = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == nullptr || !timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < timers.size(); i++) {
+        if (timers[i] == timer) {
+            timers.erase(timers.begin() + i);
+            break;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)currentUs;
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(currentUs / 1000);
+}
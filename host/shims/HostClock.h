@@ -0,0 +1,22 @@
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <cstdint>
+
+// Reloj virtual del host: millis(), micros(), esp_timer_get_time() y los
+// ticks de FreeRTOS leen de aquí. El tiempo sólo avanza con advance*() o
+// con delay()/vTaskDelay(), así que una simulación es determinista y no
+// depende de la velocidad de la máquina.
+namespace HostClock {
+    uint64_t nowUs();
+    void reset();
+
+    // Avanza el reloj disparando en orden los esp_timer que venzan por el camino
+    void advanceUs(uint64_t us);
+    void advanceMs(unsigned long ms);
+
+    // Vencimiento del próximo esp_timer armado (UINT64_MAX si no hay ninguno)
+    uint64_t nextTimerUs();
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+private:
+    uint8_t octets[4];
+
+public:
+    IPAddress() : octets{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+
+    uint8_t operator[](int index) const { return octets[index]; }
+    operator uint32_t() const {
+        return (uint32_t)octets[0] | ((uint32_t)octets[1] << 8) | ((uint32_t)octets[2] << 16) |
+               ((uint32_t)octets[3] << 24);
+    }
+
+    String toString() const;
+};
+
+#endif
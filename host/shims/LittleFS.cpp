@@ -0,0 +1,236 @@
+#include "LittleFS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::LittleFSFS LittleFS;
+
+// Tamaño de la partición "spiffs" de la tabla por defecto de Arduino-ESP32
+static const size_t PARTITION_BYTES = 0x160000;
+
+static std::string configuredRoot;
+static std::string temporaryRoot;
+static unsigned long long bytesWritten = 0;
+
+static void removeFiles(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            unlink((directory + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+}
+
+static void removeTemporaryRoot() {
+    if (!temporaryRoot.empty()) {
+        removeFiles(temporaryRoot);
+        rmdir(temporaryRoot.c_str());
+        temporaryRoot.clear();
+    }
+}
+
+// ---------------------------------------------------------------- fs::File
+
+namespace fs {
+
+File::File(FILE* file, const char* path) : handle(file, fclose), devicePath(path) {}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!handle) {
+        return 0;
+    }
+    size_t written = fwrite(buffer, 1, size, handle.get());
+    bytesWritten += written;
+    return written;
+}
+
+int File::available() {
+    if (!handle) {
+        return 0;
+    }
+    return (int)(size() - position());
+}
+
+int File::read() {
+    if (!handle) {
+        return -1;
+    }
+    int c = fgetc(handle.get());
+    return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!handle) {
+        return 0;
+    }
+    return fread(buffer, 1, size, handle.get());
+}
+
+int File::peek() {
+    int c = read();
+    if (c >= 0) {
+        ungetc(c, handle.get());
+    }
+    return c;
+}
+
+void File::flush() {
+    if (handle) {
+        fflush(handle.get());
+    }
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+    static const int WHENCE[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    return handle && fseek(handle.get(), (long)position, WHENCE[mode]) == 0;
+}
+
+size_t File::position() const {
+    if (!handle) {
+        return 0;
+    }
+    long offset = ftell(handle.get());
+    return offset < 0 ? 0 : (size_t)offset;
+}
+
+size_t File::size() const {
+    if (!handle) {
+        return 0;
+    }
+    fflush(handle.get());
+    struct stat info;
+    if (fstat(fileno(handle.get()), &info) != 0) {
+        return 0;
+    }
+    return (size_t)info.st_size;
+}
+
+void File::close() {
+    handle.reset();
+}
+
+// ---------------------------------------------------------------- fs::FS
+
+std::string FS::hostPath(const char* path) const {
+    return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+    (void)create;
+    if (root.empty() || path == nullptr) {
+        return File();
+    }
+    // Como en el dispositivo: "r" no crea, "w" trunca y "a" añade al final
+    const char* hostMode = strcmp(mode, FILE_WRITE) == 0 ? "wb" : (strcmp(mode, FILE_APPEND) == 0 ? "ab" : "rb");
+    FILE* file = fopen(hostPath(path).c_str(), hostMode);
+    return file != nullptr ? File(file, path) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return !root.empty() && stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return !root.empty() && unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    // rename() de POSIX reemplaza el destino de forma atómica, como lfs_rename
+    return !root.empty() && ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+// ---------------------------------------------------------------- fs::LittleFSFS
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    if (!root.empty()) {
+        return true;
+    }
+    if (!configuredRoot.empty()) {
+        mkdir(configuredRoot.c_str(), 0755);
+        root = configuredRoot;
+        return true;
+    }
+    if (temporaryRoot.empty()) {
+        char directory[] = "/tmp/geoentry-littlefs-XXXXXX";
+        if (mkdtemp(directory) == nullptr) {
+            return false;
+        }
+        temporaryRoot = directory;
+        atexit(removeTemporaryRoot);
+    }
+    root = temporaryRoot;
+    return true;
+}
+
+bool LittleFSFS::format() {
+    if (root.empty()) {
+        return false;
+    }
+    removeFiles(root);
+    return true;
+}
+
+size_t LittleFSFS::totalBytes() {
+    return PARTITION_BYTES;
+}
+
+size_t LittleFSFS::usedBytes() {
+    size_t used = 0;
+    DIR* dir = root.empty() ? nullptr : opendir(root.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        struct stat info;
+        if (entry->d_name[0] != '.' && stat((root + "/" + entry->d_name).c_str(), &info) == 0) {
+            used += (size_t)info.st_size;
+        }
+    }
+    closedir(dir);
+    return used;
+}
+
+void LittleFSFS::end() {
+    root.clear();
+}
+
+}  // namespace fs
+
+// ---------------------------------------------------------------- HostFs
+
+namespace HostFs {
+
+void setRoot(const char* directory) {
+    configuredRoot = directory != nullptr ? directory : "";
+}
+
+const char* getRoot() {
+    return configuredRoot.empty() ? temporaryRoot.c_str() : configuredRoot.c_str();
+}
+
+void reset() {
+    LittleFS.end();
+    if (!configuredRoot.empty()) {
+        removeFiles(configuredRoot);
+    }
+    removeTemporaryRoot();
+}
+
+unsigned long long getBytesWritten() {
+    return bytesWritten;
+}
+
+}  // namespace HostFs
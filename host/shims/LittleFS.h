@@ -0,0 +1,33 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+// La partición es un directorio del host: HostFs::setRoot() o, si no se
+// fija, uno temporal creado en el primer begin() que se borra al salir
+class LittleFSFS : public FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+    void end();
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+namespace HostFs {
+    void setRoot(const char* directory);  // antes de LittleFS.begin()
+    const char* getRoot();
+    // Borra los ficheros de la partición (y el directorio si era temporal)
+    void reset();
+    // Bytes escritos con File::write desde el arranque
+    unsigned long long getBytesWritten();
+}
+
+#endif
@@ -0,0 +1,253 @@
+#include <WiFi.h>
+
+WiFiClass WiFi;
+
+static bool autoConnect = true;
+
+// ---------------------------------------------------------------- IPAddress
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+}
+
+// ---------------------------------------------------------------- WiFiClass
+
+void WiFiClass::raise(arduino_event_id_t event, uint8_t reason) {
+    arduino_event_info_t info = {};
+    info.wifi_sta_disconnected.reason = reason;
+    for (int i = 0; i < handlerCount; i++) {
+        handlers[i](event, info);
+    }
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password, int32_t channel, const uint8_t* bssid,
+                             bool connect) {
+    (void)ssid;
+    (void)password;
+    if (channel > 0) {
+        currentChannel = channel;
+    }
+    if (bssid != nullptr) {
+        memcpy(this->bssid, bssid, sizeof(this->bssid));
+    }
+    currentStatus = WL_DISCONNECTED;
+    if (connect && autoConnect) {
+        hostConnect();
+    }
+    return currentStatus;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAP) {
+    (void)wifiOff;
+    (void)eraseAP;
+    if (currentStatus == WL_CONNECTED) {
+        currentStatus = WL_DISCONNECTED;
+        raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+    }
+    currentStatus = WL_DISCONNECTED;
+    return true;
+}
+
+IPAddress WiFiClass::localIP() {
+    return currentStatus == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+uint8_t* WiFiClass::BSSID() {
+    return bssid;
+}
+
+String WiFiClass::BSSIDstr() {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", bssid[0], bssid[1], bssid[2], bssid[3],
+             bssid[4], bssid[5]);
+    return String(text);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb handler, arduino_event_id_t event) {
+    if (handlerCount >= MAX_HANDLERS) {
+        return 0;
+    }
+    handlers[handlerCount] = handler;
+    (void)event;
+    return ++handlerCount;
+}
+
+void WiFiClass::hostConnect() {
+    currentStatus = WL_CONNECTED;
+    raise(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    raise(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+void WiFiClass::hostDrop() {
+    currentStatus = WL_CONNECTION_LOST;
+    raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_BEACON_TIMEOUT);
+}
+
+void WiFiClass::hostFail(uint8_t reason) {
+    currentStatus = reason == WIFI_REASON_NO_AP_FOUND ? WL_NO_SSID_AVAIL : WL_CONNECT_FAILED;
+    raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, reason);
+}
+
+void WiFiClass::hostSetStatus(wl_status_t status) {
+    currentStatus = status;
+}
+
+void HostWiFi::setAutoConnect(bool enabled) {
+    autoConnect = enabled;
+}
+
+bool HostWiFi::getAutoConnect() {
+    return autoConnect;
+}
+
+void HostWiFi::connect() {
+    WiFi.hostConnect();
+}
+
+void HostWiFi::drop() {
+    WiFi.hostDrop();
+}
+
+void HostWiFi::fail(uint8_t reason) {
+    WiFi.hostFail(reason);
+}
+
+void HostWiFi::setStatus(wl_status_t status) {
+    WiFi.hostSetStatus(status);
+}
+
+// ---------------------------------------------------------------- WiFiClient
+
+static std::string listenHost;
+static uint16_t listenPort = 0;
+static WiFiClient* eventSocket = nullptr;
+static std::string eventRequest;
+static unsigned long eventConnections = 0;
+
+WiFiClient::~WiFiClient() {
+    if (eventSocket == this) {
+        eventSocket = nullptr;
+    }
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    (void)ip;
+    (void)port;
+    return 0;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    (void)timeoutMs;
+    return connect(ip, port);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    if (listenPort == 0 || port != listenPort || listenHost != host) {
+        return 0;
+    }
+    stop();
+    open = true;
+    eventSocket = this;
+    eventRequest.clear();
+    eventConnections++;
+    return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    (void)timeoutMs;
+    return connect(host, port);
+}
+
+void WiFiClient::stop() {
+    open = false;
+    rx.clear();
+    rxPosition = 0;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (!open) {
+        return 0;
+    }
+    if (eventSocket == this) {
+        eventRequest.append((const char*)buffer, size);
+    }
+    return size;
+}
+
+int WiFiClient::read() {
+    return rxPosition < rx.size() ? (uint8_t)rx[rxPosition++] : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    return (int)readBytes((char*)buffer, size);
+}
+
+int WiFiClient::peek() {
+    return rxPosition < rx.size() ? (uint8_t)rx[rxPosition] : -1;
+}
+
+size_t WiFiClient::readBytes(char* buffer, size_t length) {
+    size_t count = rx.size() - rxPosition;
+    if (count > length) {
+        count = length;
+    }
+    memcpy(buffer, rx.data() + rxPosition, count);
+    rxPosition += count;
+    return count;
+}
+
+void WiFiClient::hostDeliver(const char* data, size_t length) {
+    // Lo que quedó sin leer de la respuesta anterior se descarta, como haría
+    // HTTPClient::end() al vaciar el socket
+    rx.assign(data, length);
+    rxPosition = 0;
+}
+
+void WiFiClient::hostAppend(const char* data, size_t length) {
+    rx.append(data, length);
+}
+
+// ---------------------------------------------------------------- HostEventServer
+
+void HostEventServer::listen(const char* host, uint16_t port) {
+    listenHost = host;
+    listenPort = port;
+}
+
+void HostEventServer::clear() {
+    listenHost.clear();
+    listenPort = 0;
+    eventSocket = nullptr;
+    eventRequest.clear();
+    eventConnections = 0;
+}
+
+void HostEventServer::send(const char* data) {
+    if (eventSocket != nullptr && eventSocket->connected()) {
+        eventSocket->hostAppend(data, strlen(data));
+    }
+}
+
+void HostEventServer::close() {
+    if (eventSocket != nullptr) {
+        eventSocket->hostClose();
+    }
+}
+
+bool HostEventServer::isConnected() {
+    return eventSocket != nullptr && eventSocket->connected();
+}
+
+unsigned long HostEventServer::getConnections() {
+    return eventConnections;
+}
+
+const char* HostEventServer::getLastRequest() {
+    return eventRequest.c_str();
+}
@@ -0,0 +1,105 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <functional>
+#include <IPAddress.h>
+#include <WiFiClient.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED
+} wl_status_t;
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_STOP,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+
+// Los motivos de desconexión de esp_wifi_types.h que usa el firmware
+typedef enum {
+    WIFI_REASON_UNSPECIFIED = 1,
+    WIFI_REASON_AUTH_EXPIRE = 2,
+    WIFI_REASON_ASSOC_LEAVE = 8,
+    WIFI_REASON_BEACON_TIMEOUT = 200,
+    WIFI_REASON_NO_AP_FOUND = 201,
+    WIFI_REASON_AUTH_FAIL = 202
+} wifi_err_reason_t;
+
+typedef struct {
+    uint8_t reason;
+} wifi_event_sta_disconnected_t;
+
+typedef union {
+    wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef size_t wifi_event_id_t;
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+#define WIFI_AP 2
+
+class WiFiClass {
+private:
+    static const int MAX_HANDLERS = 4;
+
+    WiFiEventFuncCb handlers[MAX_HANDLERS];
+    int handlerCount = 0;
+    wl_status_t currentStatus = WL_IDLE_STATUS;
+    uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    int32_t currentChannel = 6;
+
+    void raise(arduino_event_id_t event, uint8_t reason = 0);
+
+public:
+    wl_status_t begin(const char* ssid, const char* password = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    bool disconnect(bool wifiOff = false, bool eraseAP = false);
+    wl_status_t status() { return currentStatus; }
+    IPAddress localIP();
+    uint8_t* BSSID();
+    String BSSIDstr();
+    int32_t channel() { return currentChannel; }
+    int8_t RSSI() { return currentStatus == WL_CONNECTED ? -55 : 0; }
+    bool mode(int mode) { (void)mode; return true; }
+    bool setAutoReconnect(bool autoReconnect) { (void)autoReconnect; return true; }
+    bool persistent(bool persistent) { (void)persistent; return true; }
+    // Los manejadores reciben todos los eventos (el filtro por evento no se usa)
+    wifi_event_id_t onEvent(WiFiEventFuncCb handler, arduino_event_id_t event = ARDUINO_EVENT_WIFI_STA_START);
+
+    // Control del host
+    void hostConnect();
+    void hostDrop();
+    void hostFail(uint8_t reason);
+    void hostSetStatus(wl_status_t status);
+};
+
+extern WiFiClass WiFi;
+
+namespace HostWiFi {
+    // true (por defecto): begin() conecta en el acto y emite CONNECTED y GOT_IP
+    void setAutoConnect(bool enabled);
+    bool getAutoConnect();
+    void connect();  // emite CONNECTED + GOT_IP
+    void drop();     // emite DISCONNECTED (pérdida de balizas)
+    // El AP rechaza el intento en curso: DISCONNECTED con ese motivo
+    void fail(uint8_t reason = WIFI_REASON_AUTH_FAIL);
+    // Cambia WiFi.status() sin emitir ningún evento (evento perdido)
+    void setStatus(wl_status_t status);
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef HOST_WIFICLIENT_H
+#define HOST_WIFICLIENT_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <string>
+
+class Client : public Stream {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual uint8_t connected() = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    using Stream::read;
+    virtual void stop() = 0;
+    virtual operator bool() { return connected(); }
+};
+
+// Socket simulado: HTTPClient deja la respuesta en el buffer de recepción.
+// Tras la primera petición queda "abierto" para que el pool cuente la
+// reutilización como en el dispositivo. connect() directo (SSE) sólo abre
+// si HostEventServer escucha en ese host y puerto
+class WiFiClient : public Client {
+private:
+    std::string rx;
+    size_t rxPosition = 0;
+    bool open = false;
+
+public:
+    virtual ~WiFiClient();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    virtual int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+    int connect(const char* host, uint16_t port) override;
+    virtual int connect(const char* host, uint16_t port, int32_t timeoutMs);
+    uint8_t connected() override { return open ? 1 : 0; }
+    void stop() override;
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return (int)(rx.size() - rxPosition); }
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    void flush() override {}
+    void setNoDelay(bool noDelay) { (void)noDelay; }
+    int setTimeout(uint32_t seconds) { (void)seconds; return 0; }
+
+    // Usados por el HTTPClient del host
+    void hostOpen() { open = true; }
+    void hostDeliver(const char* data, size_t length);
+    void hostAppend(const char* data, size_t length);
+    void hostClose() { open = false; }
+};
+
+// Servidor de eventos simulado para los connect() directos. Atiende una
+// conexión cada vez: la última que abrió es la que recibe y escribe
+namespace HostEventServer {
+    void listen(const char* host, uint16_t port);
+    void clear();
+    // Bytes que llegan al socket conectado (se acumulan a lo no leído)
+    void send(const char* data);
+    // El servidor cierra: lo ya enviado se puede seguir leyendo
+    void close();
+    bool isConnected();
+    unsigned long getConnections();
+    // Lo que escribió el cliente desde que conectó por última vez
+    const char* getLastRequest();
+}
+
+#endif
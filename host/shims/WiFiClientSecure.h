@@ -0,0 +1,21 @@
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include <WiFiClient.h>
+
+// Sin TLS en el host: mismo socket simulado que WiFiClient
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* rootCA) { (void)rootCA; }
+    void setCACertBundle(const uint8_t* bundle) { (void)bundle; }
+    void setHandshakeTimeout(unsigned long seconds) { (void)seconds; }
+    int lastError(char* buffer, const size_t size) {
+        if (size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+};
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_IDF_VERSION_H
+#define HOST_ESP_IDF_VERSION_H
+
+// El host imita la rama 4.4 (la de Arduino-ESP32 2.x)
+#define ESP_IDF_VERSION_MAJOR 4
+#define ESP_IDF_VERSION_MINOR 4
+#define ESP_IDF_VERSION_PATCH 0
+
+#endif
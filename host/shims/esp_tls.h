@@ -0,0 +1,70 @@
+#ifndef HOST_ESP_TLS_H
+#define HOST_ESP_TLS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <sys/types.h>
+#include "esp_err.h"
+
+// Superficie de esp-tls (IDF 4.4) que usa TlsClient. Sin cifrado: el
+// handshake sólo prospera contra HostTls::listen() y la conexión es un
+// socketpair, así que la caché de sesiones, la CA y la E/S de TlsClient se
+// ejecutan igual que en el dispositivo
+#define CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS 1
+
+#define ESP_TLS_ERR_SSL_WANT_READ -0x6900
+#define ESP_TLS_ERR_SSL_WANT_WRITE -0x6880
+
+typedef struct {
+    int ticket;  // número de ticket que entregó el servidor simulado
+} mbedtls_ssl_session;
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session);
+
+typedef struct esp_tls_client_session {
+    mbedtls_ssl_session saved_session;
+} esp_tls_client_session_t;
+
+typedef struct esp_tls esp_tls_t;
+
+typedef struct {
+    int timeout_ms;
+    bool use_global_ca_store;
+    bool skip_common_name;
+    const char* common_name;
+    esp_tls_client_session_t* client_session;
+} esp_tls_cfg_t;
+
+esp_tls_t* esp_tls_init();
+int esp_tls_conn_new_sync(const char* hostname, int hostlen, int port, const esp_tls_cfg_t* cfg, esp_tls_t* tls);
+int esp_tls_conn_destroy(esp_tls_t* tls);
+ssize_t esp_tls_conn_read(esp_tls_t* tls, void* data, size_t datalen);
+ssize_t esp_tls_conn_write(esp_tls_t* tls, const void* data, size_t datalen);
+ssize_t esp_tls_get_bytes_avail(esp_tls_t* tls);
+esp_err_t esp_tls_get_conn_sockfd(esp_tls_t* tls, int* sockfd);
+esp_tls_client_session_t* esp_tls_get_client_session(esp_tls_t* tls);
+
+esp_err_t esp_tls_init_global_ca_store();
+esp_err_t esp_tls_set_global_ca_store(const unsigned char* cacert_pem_buf, const unsigned int cacert_pem_bytes);
+void esp_tls_free_global_ca_store();
+
+// Servidor TLS simulado. Atiende una conexión cada vez: la última que abrió
+// es la que recibe y escribe
+namespace HostTls {
+    void listen(const char* host, uint16_t port);
+    void clear();
+    // Bytes que llegan a la conexión abierta
+    void send(const char* data);
+    // El servidor cierra: lo ya enviado se puede seguir leyendo
+    void close();
+    // Lo que escribió el cliente desde el último handshake
+    const char* getReceived();
+    unsigned long getHandshakes();
+    // Ticket que ofreció el cliente en el último handshake (0 = ninguno)
+    int getOfferedTicket();
+    // Tickets entregados que el cliente aún no ha liberado
+    int getLiveSessions();
+}
+
+#endif
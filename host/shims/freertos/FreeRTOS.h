@@ -0,0 +1,54 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// FreeRTOS en el host: un tick = 1 ms sobre el reloj virtual. Las tareas
+// sólo se ejecutan dentro de HostTasks::runUntil() (ver task.h); sin él, el
+// llamador avanza networkStep()/controlStep() a mano. Las secciones
+// críticas son un spinlock, como entre los dos núcleos del ESP32: las tareas
+// cooperativas nunca coinciden, pero las pruebas con std::thread sí
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7fffffff
+#define configMAX_PRIORITIES 25
+
+typedef struct HostQueue* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef struct HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* parameter);
+
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+inline void hostEnterCritical(portMUX_TYPE* mux) {
+    int unlocked = 0;
+    while (!__atomic_compare_exchange_n(&mux->owner, &unlocked, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        unlocked = 0;
+    }
+}
+
+inline void hostExitCritical(portMUX_TYPE* mux) {
+    __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+}
+
+#define portENTER_CRITICAL(mux) hostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) hostExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) hostEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) hostExitCritical(mux)
+
+BaseType_t xPortGetCoreID();
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackSize, void* parameter,
+                       UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period);
+TickType_t xTaskGetTickCount();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void taskYIELD();
+
+// Planificador del host. Cada tarea es una corrutina con pila propia y
+// ejecución cooperativa: corre sin que pase el tiempo hasta que se bloquea
+// (vTaskDelay, cola vacía o llena, semáforo tomado). runUntil() ejecuta por
+// prioridad todas las tareas listas y, cuando todas esperan, avanza el reloj
+// virtual hasta el siguiente despertar o esp_timer. Es determinista
+namespace HostTasks {
+    void runUntil(uint64_t untilUs);
+    void runForMs(unsigned long ms);
+
+    // Espera que deja correr a las demás tareas si se llama desde una tarea;
+    // desde el hilo principal simplemente avanza el reloj
+    void delayUs(uint64_t us);
+    bool inTask();
+
+    int count();
+    const char* name(int index);
+    BaseType_t core(int index);
+    UBaseType_t priority(int index);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <driver/ledc.h>
+
+static uint32_t duties[LEDC_CHANNEL_MAX];
+static uint32_t pendingDuties[LEDC_CHANNEL_MAX];
+static unsigned long updates[LEDC_CHANNEL_MAX];
+
+static bool validChannel(ledc_channel_t channel) {
+    return channel >= LEDC_CHANNEL_0 && channel < LEDC_CHANNEL_MAX;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* config) {
+    return config != nullptr ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+    if (config == nullptr || !validChannel(config->channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    duties[config->channel] = config->duty;
+    pendingDuties[config->channel] = config->duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int interruptFlags) {
+    (void)interruptFlags;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t targetDuty, int maxFadeTimeMs) {
+    (void)mode;
+    (void)maxFadeTimeMs;
+    if (!validChannel(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pendingDuties[channel] = targetDuty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t fadeMode) {
+    (void)fadeMode;
+    return ledc_update_duty(mode, channel);
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty) {
+    (void)mode;
+    if (!validChannel(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pendingDuties[channel] = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel) {
+    (void)mode;
+    if (!validChannel(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    duties[channel] = pendingDuties[channel];
+    updates[channel]++;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t mode, ledc_channel_t channel) {
+    (void)mode;
+    return validChannel(channel) ? duties[channel] : 0;
+}
+
+uint32_t HostLedc::getDuty(int channel) {
+    return ledc_get_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel);
+}
+
+unsigned long HostLedc::getUpdates(int channel) {
+    return validChannel((ledc_channel_t)channel) ? updates[channel] : 0;
+}
@@ -0,0 +1,130 @@
+#include <mqtt_client.h>
+#include <cstring>
+
+struct esp_mqtt_client {
+    esp_event_handler_t handler;
+    void* handlerArgs;
+    bool started;
+};
+
+static esp_mqtt_client hostClient = {nullptr, nullptr, false};
+static std::vector<HostMqttMessage> sentMessages;
+static bool outboxFull = false;
+static int nextMsgId = 1;
+
+static void raise(esp_mqtt_event_t& event) {
+    esp_mqtt_client_handle_t client = &hostClient;
+    if (client->handler == nullptr || !client->started) {
+        return;
+    }
+    event.client = client;
+    client->handler(client->handlerArgs, "MQTT_EVENTS", event.event_id, &event);
+}
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t* config) {
+    (void)config;
+    hostClient = {nullptr, nullptr, false};
+    return &hostClient;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client) {
+    if (client == nullptr) {
+        return ESP_FAIL;
+    }
+    client->started = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client) {
+    if (client == nullptr) {
+        return ESP_FAIL;
+    }
+    client->started = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client) {
+    if (client == nullptr) {
+        return ESP_FAIL;
+    }
+    *client = {nullptr, nullptr, false};
+    return ESP_OK;
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char* topic, int qos) {
+    (void)topic;
+    (void)qos;
+    return client != nullptr ? nextMsgId++ : -1;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char* topic, const char* data, int length,
+                            int qos, int retain) {
+    (void)qos;
+    (void)retain;
+    if (client == nullptr || outboxFull) {
+        return -1;
+    }
+    HostMqttMessage message;
+    message.msgId = nextMsgId++;
+    message.topic = topic;
+    message.payload.assign(data, length > 0 ? (size_t)length : strlen(data));
+    sentMessages.push_back(message);
+    return message.msgId;
+}
+
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char* topic, const char* data, int length,
+                            int qos, int retain, bool store) {
+    (void)store;
+    return esp_mqtt_client_publish(client, topic, data, length, qos, retain);
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void* handlerArgs) {
+    (void)event;
+    if (client == nullptr) {
+        return ESP_FAIL;
+    }
+    client->handler = handler;
+    client->handlerArgs = handlerArgs;
+    return ESP_OK;
+}
+
+void HostMqtt::connect() {
+    esp_mqtt_event_t event = {};
+    event.event_id = MQTT_EVENT_CONNECTED;
+    raise(event);
+}
+
+void HostMqtt::disconnect() {
+    esp_mqtt_event_t event = {};
+    event.event_id = MQTT_EVENT_DISCONNECTED;
+    raise(event);
+}
+
+void HostMqtt::puback(int msgId) {
+    esp_mqtt_event_t event = {};
+    event.event_id = MQTT_EVENT_PUBLISHED;
+    event.msg_id = msgId;
+    raise(event);
+}
+
+void HostMqtt::deliver(const char* topic, const char* payload) {
+    std::string topicCopy(topic);
+    std::string payloadCopy(payload);
+    esp_mqtt_event_t event = {};
+    event.event_id = MQTT_EVENT_DATA;
+    event.topic = &topicCopy[0];
+    event.topic_len = (int)topicCopy.size();
+    event.data = &payloadCopy[0];
+    event.data_len = (int)payloadCopy.size();
+    event.total_data_len = event.data_len;
+    raise(event);
+}
+
+void HostMqtt::setOutboxFull(bool full) {
+    outboxFull = full;
+}
+
+const std::vector<HostMqttMessage>& HostMqtt::sent() {
+    return sentMessages;
+}
@@ -0,0 +1,91 @@
+#ifndef HOST_MQTT_CLIENT_H
+#define HOST_MQTT_CLIENT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "esp_err.h"
+#include "esp_idf_version.h"
+
+// esp-mqtt en el host: un solo cliente sin broker. Se queda desconectado
+// hasta que una prueba emite los eventos con HostMqtt, que se entregan en el
+// acto desde el hilo que los llama (no hay tarea de esp-mqtt)
+typedef const char* esp_event_base_t;
+typedef void (*esp_event_handler_t)(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData);
+
+#define ESP_EVENT_ANY_ID -1
+
+typedef enum {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT
+} esp_mqtt_event_id_t;
+
+struct esp_mqtt_client;
+typedef struct esp_mqtt_client* esp_mqtt_client_handle_t;
+
+typedef struct {
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    char* data;
+    int data_len;
+    int total_data_len;
+    int current_data_offset;
+    char* topic;
+    int topic_len;
+    int msg_id;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t* esp_mqtt_event_handle_t;
+
+// Configuración plana de IDF 4.x
+typedef struct {
+    const char* uri;
+    const char* client_id;
+    const char* username;
+    const char* password;
+    const char* lwt_topic;
+    const char* lwt_msg;
+    int lwt_qos;
+    int lwt_retain;
+    int lwt_msg_len;
+    int keepalive;
+    bool disable_clean_session;
+} esp_mqtt_client_config_t;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t* config);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client);
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char* topic, int qos);
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char* topic, const char* data, int length,
+                            int qos, int retain);
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char* topic, const char* data, int length,
+                            int qos, int retain, bool store);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void* handlerArgs);
+
+struct HostMqttMessage {
+    int msgId;
+    std::string topic;
+    std::string payload;
+};
+
+namespace HostMqtt {
+    void connect();     // MQTT_EVENT_CONNECTED
+    void disconnect();  // MQTT_EVENT_DISCONNECTED
+    void puback(int msgId);  // MQTT_EVENT_PUBLISHED
+    void deliver(const char* topic, const char* payload);  // MQTT_EVENT_DATA
+    // Con la cola llena publish() y enqueue() devuelven -1
+    void setOutboxFull(bool full);
+    // Publicaciones desde el arranque (suscripciones aparte)
+    const std::vector<HostMqttMessage>& sent();
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "TestHarness.h"
+#include <LittleFS.h>
+#include <string>
+#include "ActuationJournal.h"
+
+static void sensorId(char* out, size_t size, int index) {
+    snprintf(out, size, "0b5e2d6c-1f3a-4c8e-9d2b-%012d", index);
+}
+
+TEST(ActuationJournal, KeepsOneCommandPerRegistrySensor) {
+    CHECK(LittleFS.begin(true));
+    char id[40];
+    {
+        ActuationJournal journal("/journal.bin");
+        journal.begin(LittleFS);
+        // Varias rondas para forzar la compactación con todo vigente
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < SensorRegistry::MAX_SENSORS; i++) {
+                sensorId(id, sizeof(id), i);
+                journal.recordFailure(id, "air_conditioner", round & 1);
+            }
+        }
+        journal.flush();
+        CHECK_EQ(journal.getPendingCount(), SensorRegistry::MAX_SENSORS);
+        CHECK(journal.getFileSize() <= ActuationJournal::MAX_FILE_SIZE);
+    }
+
+    // Tras un reinicio se recupera la última orden de cada sensor
+    ActuationJournal reloaded("/journal.bin");
+    reloaded.begin(LittleFS);
+    CHECK_EQ(reloaded.getPendingCount(), SensorRegistry::MAX_SENSORS);
+    JournalCommand command;
+    int taken = 0;
+    while (reloaded.takeCommand(command)) {
+        CHECK(command.targetState);
+        taken++;
+    }
+    CHECK_EQ(taken, SensorRegistry::MAX_SENSORS);
+}
+
+// Un "todos" del que no salió ninguna orden (cola llena) se cierra con 0,
+// pero los fallos registrados antes siguen pendientes por sensor
+TEST(ActuationJournal, NotQueuedCommandsOutliveActuateAll) {
+    ActuationJournal journal("/not-queued.bin");
+    char id[40];
+    sensorId(id, sizeof(id), 1);
+    journal.recordActuateAll(true);
+    journal.recordFailure(id, "led_tv", true);
+    journal.actuateAllSent(0);
+
+    bool targetState;
+    CHECK(!journal.takeActuateAll(targetState));
+    CHECK(journal.hasPending());
+    CHECK_EQ(journal.getPendingCount(), 1);
+    JournalCommand command;
+    CHECK(journal.takeCommand(command));
+    CHECK_STREQ(command.sensorId, id);
+    CHECK(command.targetState);
+}
+
+// Un id que no cabe no se guarda recortado: al reenviarlo iría a otro sensor
+TEST(ActuationJournal, OverlongSensorIdIsNotRecorded) {
+    ActuationJournal journal("/overlong.bin");
+    std::string longId(sizeof(JournalCommand::sensorId), 'a');
+    journal.recordFailure(longId.c_str(), "led_tv", true);
+    CHECK_EQ(journal.getPendingCount(), 0);
+    CHECK(!journal.hasPending());
+}
@@ -0,0 +1,123 @@
+#include "TestHarness.h"
+#include "AdaptivePolling.h"
+
+// Valores por defecto: mínimo 2 s, borde 10 s, máximo 30 s, radio 100 m con
+// banda de 50 m, 60 s de asentamiento y 10 min de memoria del borde
+static const unsigned long MIN_MS = 2000;
+static const unsigned long EDGE_MS = 10000;
+static const unsigned long MAX_MS = 30000;
+
+TEST(AdaptivePolling, BackoffDoublesUpToMaxWithoutChanges) {
+    AdaptivePolling polling;
+    unsigned long now = 1000;
+    static const unsigned long EXPECTED[] = {4000, 8000, 16000, MAX_MS, MAX_MS};
+    for (unsigned long expected : EXPECTED) {
+        CHECK_EQ(polling.onPoll(now), expected);
+        now += expected;
+    }
+}
+
+// Tras un enter/exit el intervalo se queda en el mínimo durante settleMs y
+// lejos del borde vuelve a crecer hasta el máximo
+TEST(AdaptivePolling, StateChangeHoldsMinimumWhileSettling) {
+    AdaptivePolling polling;
+    unsigned long now = 5000;
+    polling.onPoll(now);
+    polling.onStateChange(500.0f, now);
+    CHECK(!polling.isNearEdge());
+
+    unsigned long settledAt = now + polling.getConfig().settleMs;
+    while (now < settledAt) {
+        CHECK_EQ(polling.onPoll(now), MIN_MS);
+        now += MIN_MS;
+    }
+    CHECK_EQ(polling.onPoll(now), 2 * MIN_MS);
+    unsigned long interval = 0;
+    for (int i = 0; i < 6; i++) {
+        interval = polling.onPoll(now);
+    }
+    CHECK_EQ(interval, MAX_MS);
+}
+
+// Cerca del borde el techo es edgeIntervalMs hasta que pasa edgeHoldMs
+TEST(AdaptivePolling, NearEdgeCapsAtEdgeIntervalUntilHoldExpires) {
+    AdaptivePolling polling;
+    unsigned long now = 0;
+    polling.onStateChange(130.0f, now);  // 30 m fuera del radio: dentro de la banda
+    CHECK(polling.isNearEdge());
+
+    now += polling.getConfig().settleMs;
+    unsigned long interval = 0;
+    for (int i = 0; i < 8; i++) {
+        interval = polling.onPoll(now);
+        now += interval;
+    }
+    CHECK_EQ(interval, EDGE_MS);
+
+    now = polling.getConfig().edgeHoldMs;
+    for (int i = 0; i < 8; i++) {
+        interval = polling.onPoll(now);
+    }
+    CHECK_EQ(interval, MAX_MS);
+}
+
+// Retry-After manda sobre cualquier techo; entre varios gana el que pide
+// esperar más y un valor absurdo se limita
+TEST(AdaptivePolling, RetryAfterTakesPrecedenceAndKeepsTheLongest) {
+    AdaptivePolling polling;
+    unsigned long now = 1000;
+    polling.onStateChange(0.0f, now);  // asentando: techo al mínimo
+    polling.onRetryAfter(45000, now);
+    CHECK_EQ(polling.onPoll(now), 45000ul);
+
+    polling.onRetryAfter(5000, now + 1000);  // más corto: no acorta la espera
+    CHECK_EQ(polling.retryRemaining(now + 1000), 44000ul);
+    polling.onRetryAfter(50000, now + 1000);
+    CHECK_EQ(polling.retryRemaining(now + 1000), 50000ul);
+
+    // Vencido, vuelve el techo de asentamiento
+    CHECK_EQ(polling.retryRemaining(now + 51000), 0ul);
+    CHECK_EQ(polling.onPoll(now + 51000), MIN_MS);
+
+    polling.onRetryAfter(AdaptivePolling::MAX_RETRY_AFTER_MS * 10, now);
+    CHECK_EQ(polling.retryRemaining(now), AdaptivePolling::MAX_RETRY_AFTER_MS);
+}
+
+// millis() da la vuelta (cada 49 días en el ESP32): las ventanas siguen
+// midiéndose por diferencia
+TEST(AdaptivePolling, WindowsSurviveMillisWraparound) {
+    AdaptivePolling polling;
+    unsigned long before = (unsigned long)-1 - 1000;
+    polling.onStateChange(500.0f, before);
+    polling.onRetryAfter(10000, before);
+
+    unsigned long after = before + 5000;  // ya dio la vuelta
+    CHECK(after < before);
+    CHECK_EQ(polling.retryRemaining(after), 5000ul);
+    CHECK_EQ(polling.onPoll(after), 5000ul);
+    CHECK_EQ(polling.onPoll(after + 5000), MIN_MS);  // sigue asentando
+    CHECK_EQ(polling.onPoll(before + polling.getConfig().settleMs), 2 * MIN_MS);
+}
+
+TEST(AdaptivePolling, ConfigureClampsTheLimits) {
+    AdaptivePolling polling;
+    AdaptivePollingConfig config;
+    config.minIntervalMs = 0;
+    config.edgeIntervalMs = 0;
+    config.maxIntervalMs = 0;
+    polling.configure(config);
+    CHECK_EQ(polling.getConfig().minIntervalMs, 1ul);
+    CHECK_EQ(polling.getConfig().edgeIntervalMs, 1ul);
+    CHECK_EQ(polling.getConfig().maxIntervalMs, 1ul);
+
+    config.minIntervalMs = 5000;
+    config.edgeIntervalMs = 60000;
+    config.maxIntervalMs = 20000;
+    polling.configure(config);
+    CHECK_EQ(polling.getConfig().edgeIntervalMs, 20000ul);
+    CHECK_EQ(polling.getInterval(), 5000ul);
+
+    config.edgeIntervalMs = 1000;
+    polling.configure(config);
+    CHECK_EQ(polling.getConfig().edgeIntervalMs, 5000ul);
+}
@@ -0,0 +1,176 @@
+#include "TestHarness.h"
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <HostClock.h>
+#include <WiFi.h>
+#include <freertos/task.h>
+#include <vector>
+#include "CircuitBreaker.h"
+#include "RestTransport.h"
+
+// Abre el circuito con threshold fallos seguidos en el instante actual
+static void trip(CircuitBreaker& breaker, int threshold) {
+    for (int i = 0; i < threshold; i++) {
+        CHECK(breaker.allow(millis()));
+        breaker.record(500, millis());
+    }
+}
+
+TEST(CircuitBreaker, OpensAfterThresholdAndRejectsWithoutProbing) {
+    CircuitBreaker breaker("test");
+    breaker.configure(3, 1000, 8000);
+    breaker.record(500, millis());
+    breaker.record(-1, millis());
+    CHECK_EQ(breaker.getState(), CIRCUIT_CLOSED);
+
+    breaker.record(503, millis());
+    CHECK_EQ(breaker.getState(), CIRCUIT_OPEN);
+    unsigned long retryIn = breaker.getRetryIn(millis());
+    CHECK(retryIn >= 500 && retryIn <= 1000);
+
+    // Abierto: se rechaza sin sonda hasta que vence la espera
+    CHECK(!breaker.allow(millis()));
+    HostClock::advanceMs(retryIn - 1);
+    CHECK(!breaker.allow(millis()));
+    CircuitBreakerStats stats = breaker.getStats();
+    CHECK_EQ(stats.failures, 3ul);
+    CHECK_EQ(stats.rejected, 2ul);
+    CHECK_EQ(stats.opened, 1ul);
+    CHECK_EQ(stats.probes, 0ul);
+}
+
+TEST(CircuitBreaker, SuccessResetsTheFailureCount) {
+    CircuitBreaker breaker("test");
+    breaker.configure(3, 1000, 8000);
+    breaker.record(500, millis());
+    breaker.record(500, millis());
+    breaker.record(200, millis());
+    breaker.record(500, millis());
+    breaker.record(500, millis());
+    CHECK_EQ(breaker.getState(), CIRCUIT_CLOSED);
+
+    // 4xx distintos de 429 son del cliente: no cuentan
+    CHECK(!CircuitBreaker::isFailure(404));
+    CHECK(!CircuitBreaker::isFailure(304));
+    CHECK(CircuitBreaker::isFailure(429));
+    CHECK(CircuitBreaker::isFailure(502));
+    CHECK(CircuitBreaker::isFailure(-1));
+}
+
+// Al vencer la espera pasa una única sonda; su resultado cierra el circuito
+TEST(CircuitBreaker, HalfOpenLetsOneProbeThroughAndClosesOnSuccess) {
+    CircuitBreaker breaker("test");
+    breaker.configure(1, 1000, 8000);
+    trip(breaker, 1);
+    HostClock::advanceMs(breaker.getRetryIn(millis()));
+
+    CHECK(breaker.allow(millis()));
+    CHECK_EQ(breaker.getState(), CIRCUIT_HALF_OPEN);
+    CHECK(!breaker.allow(millis()));
+    CHECK(!breaker.allow(millis()));
+    CHECK_EQ(breaker.getStats().probes, 1ul);
+
+    breaker.record(200, millis());
+    CHECK_EQ(breaker.getState(), CIRCUIT_CLOSED);
+    CHECK(breaker.allow(millis()));
+    CHECK(breaker.allow(millis()));
+}
+
+// Una sonda que nunca informa no deja el circuito cerrado para siempre
+TEST(CircuitBreaker, AbandonedProbeIsReplacedAfterTimeout) {
+    CircuitBreaker breaker("test");
+    breaker.configure(1, 1000, 8000);
+    trip(breaker, 1);
+    HostClock::advanceMs(breaker.getRetryIn(millis()));
+    CHECK(breaker.allow(millis()));
+
+    HostClock::advanceMs(CircuitBreaker::PROBE_TIMEOUT - 1);
+    CHECK(!breaker.allow(millis()));
+    HostClock::advanceMs(1);
+    CHECK(breaker.allow(millis()));
+    CHECK_EQ(breaker.getStats().probes, 2ul);
+}
+
+// Cada sonda fallida duplica la espera hasta el máximo; el jitter la deja
+// siempre entre la mitad y la espera completa
+TEST(CircuitBreaker, FailedProbesDoubleTheJitteredBackoff) {
+    static const unsigned long MIN_BACKOFF = 1000;
+    static const unsigned long MAX_BACKOFF = 8000;
+    for (unsigned long seed = 1; seed <= 50; seed++) {
+        randomSeed(seed);
+        CircuitBreaker breaker("test");
+        breaker.configure(1, MIN_BACKOFF, MAX_BACKOFF);
+        trip(breaker, 1);
+
+        unsigned long backoff = MIN_BACKOFF;
+        for (int probe = 0; probe < 6; probe++) {
+            unsigned long retryIn = breaker.getRetryIn(millis());
+            CHECK(retryIn >= backoff / 2 && retryIn <= backoff);
+            HostClock::advanceMs(retryIn);
+            CHECK(breaker.allow(millis()));
+            breaker.record(503, millis());
+            CHECK_EQ(breaker.getState(), CIRCUIT_OPEN);
+            backoff = backoff * 2 < MAX_BACKOFF ? backoff * 2 : MAX_BACKOFF;
+        }
+    }
+}
+
+// Un Retry-After abre sin esperar al umbral y la espera no baja de él,
+// con un tope para cabeceras absurdas
+TEST(CircuitBreaker, RetryAfterOpensAtOnceAndFloorsTheWait) {
+    CircuitBreaker breaker("test");
+    breaker.configure(3, 1000, 8000);
+    CHECK(breaker.allow(millis()));
+    breaker.record(429, millis(), 20000);
+    CHECK_EQ(breaker.getState(), CIRCUIT_OPEN);
+    CHECK_EQ(breaker.getRetryIn(millis()), 20000ul);
+
+    HostClock::advanceMs(20000);
+    CHECK(breaker.allow(millis()));
+    breaker.record(503, millis(), CircuitBreaker::MAX_RETRY_AFTER * 2);
+    CHECK_EQ(breaker.getRetryIn(millis()), CircuitBreaker::MAX_RETRY_AFTER);
+}
+
+struct RejectLog : public TransportListener {
+    std::vector<ActuationResult> results;
+
+    void onProximityEvent(JsonObject event) override {}
+    void onSensorStatesBegin() override {}
+    void onSensorState(JsonObject sensor) override {}
+    void onSensorStatesEnd(bool complete) override {}
+    void onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) override {
+        results.push_back(result);
+    }
+    void onRequestResult(bool success) override {}
+    void onRetryAfter(unsigned long delayMs) override {}
+    void onTransportConnected() override {}
+};
+
+// Con el circuito abierto ni los sondeos ni los PATCH salen a la red, y el
+// PATCH se entrega al momento como REJECTED
+TEST(CircuitBreaker, OpenCircuitShortCircuitsPollsAndPatches) {
+    RejectLog log;
+    RestTransport rest("http://api.geoentry.local/api/v1/", "http://api.geoentry.local/", "dev-1", "user-1");
+    rest.setCircuitBreaker(1, 60000, 60000);
+    rest.begin(&log);
+    WiFi.begin("test-ssid", "");
+    HostHttp::respond("GET", "http://api.geoentry.local/sensors/", 503, "");
+    HostHttp::respond("PATCH", "http://api.geoentry.local/sensors/", 500, "");
+
+    unsigned long requests = HostHttp::getRequests();
+    rest.pollSensors();
+    rest.pollSensors();
+    CHECK_EQ(HostHttp::getRequests(), requests + 1);
+
+    CHECK(rest.actuate("s-01", "led_tv", true));
+    HostTasks::runForMs(500);
+    rest.update(millis(), true);
+    CHECK(rest.actuate("s-01", "led_tv", true));
+    HostTasks::runForMs(500);
+    rest.update(millis(), true);
+
+    CHECK_EQ(HostHttp::getRequests(), requests + 2);
+    CHECK_EQ(log.results.size(), (size_t)2);
+    CHECK_EQ(log.results[0].httpResponseCode, 500);
+    CHECK_EQ(log.results[1].httpResponseCode, CircuitBreaker::REJECTED);
+}
@@ -0,0 +1,85 @@
+#include "TestHarness.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "EventBus.h"
+
+TEST(EventBus, MpscQueueIsFifoAndCountsOverflows) {
+    MpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++) {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(4));
+    CHECK_EQ(queue.getOverflows(), 1u);
+
+    int value;
+    for (int i = 0; i < 4; i++) {
+        CHECK(queue.pop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(!queue.pop(value));
+
+    // Tras dar varias vueltas al anillo sigue en orden
+    for (int i = 0; i < 1000; i++) {
+        CHECK(queue.push(i));
+        CHECK(queue.pop(value));
+        CHECK_EQ(value, i);
+    }
+}
+
+// Cuatro productores en hilos reales contra un consumidor: no se pierde ni
+// se duplica nada y cada productor conserva su orden
+TEST(EventBus, MpscQueueFourProducerStress) {
+    static const int PRODUCERS = 4;
+    static const uint32_t PER_PRODUCER = 50000;
+    static MpscQueue<uint32_t, 64> queue;
+
+    std::atomic<int> ready(0);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([p, &ready]() {
+            ready.fetch_add(1);
+            while (ready.load() < PRODUCERS) {
+                std::this_thread::yield();
+            }
+            for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                // Llena: reintentar (cuenta como desbordamiento)
+                while (!queue.push(((uint32_t)p << 24) | i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    uint32_t next[PRODUCERS] = {};
+    uint64_t received = 0;
+    bool ordered = true;
+    while (received < (uint64_t)PRODUCERS * PER_PRODUCER) {
+        uint32_t value;
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Se sigue vaciando aunque algo falle, para que los productores terminen
+        uint32_t producer = value >> 24;
+        uint32_t sequence = value & 0xFFFFFF;
+        received++;
+        if (producer >= PRODUCERS) {
+            ordered = false;
+            continue;
+        }
+        ordered &= sequence == next[producer];
+        next[producer] = sequence + 1;
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    CHECK(ordered);
+    CHECK_EQ(received, (uint64_t)PRODUCERS * PER_PRODUCER);
+    for (int p = 0; p < PRODUCERS; p++) {
+        CHECK_EQ(next[p], PER_PRODUCER);
+    }
+    uint32_t value;
+    CHECK(!queue.pop(value));
+}
@@ -0,0 +1,173 @@
+#include "TestHarness.h"
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <string>
+#include <vector>
+#include "EventStreamClient.h"
+
+static const char* STREAM_URL = "http://push.geoentry.local:8080/api/v1/stream";
+static const char* OK_HEADERS = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+struct PushLog : public PushEventHandler {
+    std::vector<std::string> events;
+    int subscribed = 0;
+
+    void onPushEvent(const char* data) override { events.push_back(data); }
+    void onPushSubscribed() override { subscribed++; }
+};
+
+// Conecta y deja la suscripción aceptada con la respuesta 200
+static void subscribe(EventStreamClient& stream, unsigned long now) {
+    HostEventServer::listen("push.geoentry.local", 8080);
+    CHECK(stream.begin(STREAM_URL));
+    stream.update(now, true);
+    CHECK_EQ(stream.getState(), EventStreamClient::READING_HEADERS);
+    HostEventServer::send(OK_HEADERS);
+    stream.update(now, true);
+    CHECK(stream.isSubscribed());
+}
+
+TEST(EventStreamClient, SubscribesWithAnEventStreamRequest) {
+    PushLog log;
+    EventStreamClient stream(&log);
+    HostEventServer::listen("push.geoentry.local", 8080);
+    CHECK(stream.begin(STREAM_URL));
+    stream.update(millis(), true);
+
+    std::string request = HostEventServer::getLastRequest();
+    CHECK_EQ(request.rfind("GET /api/v1/stream HTTP/1.0\r\n", 0), (size_t)0);
+    CHECK(request.find("Host: push.geoentry.local\r\n") != std::string::npos);
+    CHECK(request.find("Accept: text/event-stream\r\n") != std::string::npos);
+    CHECK(request.find("Last-Event-ID") == std::string::npos);
+    CHECK_EQ(request.substr(request.size() - 4), std::string("\r\n\r\n"));
+
+    // Las cabeceras pueden llegar a trozos; sólo la línea vacía suscribe
+    HostEventServer::send("HTTP/1.1 200 OK\r\nContent-Ty");
+    stream.update(millis(), true);
+    CHECK_EQ(log.subscribed, 0);
+    HostEventServer::send("pe: text/event-stream\r\n\r\n");
+    stream.update(millis(), true);
+    CHECK_EQ(log.subscribed, 1);
+    CHECK(stream.isSubscribed());
+}
+
+// Formato SSE: data en varias líneas se une con \n, el espacio tras los dos
+// puntos es opcional, los comentarios no son eventos, CRLF o LF indistinto y
+// una línea puede llegar partida entre dos lecturas
+TEST(EventStreamClient, ParsesEventLines) {
+    PushLog log;
+    EventStreamClient stream(&log);
+    unsigned long now = millis();
+    subscribe(stream, now);
+
+    HostEventServer::send("id: evt-1\ndata: {\"event_type\":\"enter\"}\n\n");
+    HostEventServer::send(": heartbeat\r\n\r\n");
+    HostEventServer::send("event: proximity\r\ndata: primera\r\ndata:segunda\r\n\r\n");
+    HostEventServer::send("data: part");
+    stream.update(now, true);
+    HostEventServer::send("ida\n\n");
+    HostEventServer::send("data\n\nid: sin-datos\n\n");
+    stream.update(now, true);
+
+    CHECK_EQ(log.events.size(), (size_t)3);
+    CHECK_EQ(log.events[0], std::string("{\"event_type\":\"enter\"}"));
+    CHECK_EQ(log.events[1], std::string("primera\nsegunda"));
+    CHECK_EQ(log.events[2], std::string("partida"));
+    CHECK_EQ(stream.getEventsReceived(), 3ul);
+}
+
+// Una línea que no cabe en MAX_LINE se descarta entera y no corrompe el
+// evento siguiente; cada update() lee como mucho MAX_BYTES_PER_UPDATE
+TEST(EventStreamClient, OverlongLinesAndReadBudget) {
+    PushLog log;
+    EventStreamClient stream(&log);
+    unsigned long now = millis();
+    subscribe(stream, now);
+
+    std::string overlong = "data: " + std::string(EventStreamClient::MAX_LINE, 'x') + "\n\n";
+    HostEventServer::send(overlong.c_str());
+    HostEventServer::send("data: corta\n\n");
+    stream.update(now, true);
+    CHECK_EQ(log.events.size(), (size_t)0);
+    stream.update(now, true);
+    CHECK_EQ(log.events.size(), (size_t)1);
+    CHECK_EQ(log.events[0], std::string("corta"));
+}
+
+// Al cerrarse la conexión vuelve a suscribirse tras el backoff con
+// Last-Event-ID; el backoff se duplica hasta una suscripción aceptada
+TEST(EventStreamClient, ResubscribesWithLastEventIdAndBackoff) {
+    PushLog log;
+    EventStreamClient stream(&log);
+    unsigned long now = millis();
+    subscribe(stream, now);
+    HostEventServer::send("id: evt-7\ndata: x\n\n");
+    HostEventServer::close();
+    stream.update(now, true);
+    CHECK_EQ(log.events.size(), (size_t)1);
+    CHECK_EQ(stream.getState(), EventStreamClient::WAITING);
+    CHECK_EQ(stream.getResubscriptions(), 1ul);
+
+    // Primer reintento entre MIN_RETRY_DELAY y 1,5 veces MIN_RETRY_DELAY
+    stream.update(now + EventStreamClient::MIN_RETRY_DELAY - 1, true);
+    CHECK_EQ(HostEventServer::getConnections(), 1ul);
+    stream.update(now + EventStreamClient::MIN_RETRY_DELAY * 3 / 2, true);
+    CHECK_EQ(HostEventServer::getConnections(), 2ul);
+    CHECK(std::string(HostEventServer::getLastRequest()).find("Last-Event-ID: evt-7\r\n") != std::string::npos);
+
+    // Un estado distinto de 200 no suscribe y el siguiente intento espera el doble
+    now += EventStreamClient::MIN_RETRY_DELAY * 3 / 2;
+    HostEventServer::send("HTTP/1.1 503 Service Unavailable\r\n\r\n");
+    stream.update(now, true);
+    CHECK_EQ(stream.getState(), EventStreamClient::WAITING);
+    CHECK_EQ(log.subscribed, 1);
+    stream.update(now + 2 * EventStreamClient::MIN_RETRY_DELAY - 1, true);
+    CHECK_EQ(HostEventServer::getConnections(), 2ul);
+    stream.update(now + 3 * EventStreamClient::MIN_RETRY_DELAY, true);
+    CHECK_EQ(HostEventServer::getConnections(), 3ul);
+}
+
+// Sin datos durante HEARTBEAT_TIMEOUT la conexión se da por muerta aunque
+// el socket siga abierto; un comentario basta para mantenerla
+TEST(EventStreamClient, HeartbeatTimeoutResubscribes) {
+    PushLog log;
+    EventStreamClient stream(&log);
+    unsigned long now = millis();
+    subscribe(stream, now);
+
+    now += EventStreamClient::HEARTBEAT_TIMEOUT - 1;
+    HostEventServer::send(":\n");
+    stream.update(now, true);
+    CHECK(stream.isSubscribed());
+
+    stream.update(now + EventStreamClient::HEARTBEAT_TIMEOUT - 1, true);
+    CHECK(stream.isSubscribed());
+    stream.update(now + EventStreamClient::HEARTBEAT_TIMEOUT, true);
+    CHECK_EQ(stream.getState(), EventStreamClient::WAITING);
+    CHECK(!HostEventServer::isConnected());
+}
+
+// retry: del servidor cambia la espera dentro de los límites; sin red se
+// cierra y al volver se reintenta en el acto
+TEST(EventStreamClient, RetryFieldAndNetworkLoss) {
+    PushLog log;
+    EventStreamClient stream(&log);
+    unsigned long now = millis();
+    subscribe(stream, now);
+    HostEventServer::send("retry: 10\n\nretry: 20000\n\n");
+    HostEventServer::close();
+    stream.update(now, true);
+    stream.update(now + 19999, true);
+    CHECK_EQ(HostEventServer::getConnections(), 1ul);
+    stream.update(now + 30000, true);
+    CHECK_EQ(HostEventServer::getConnections(), 2ul);
+
+    HostEventServer::send(OK_HEADERS);
+    stream.update(now + 30000, true);
+    CHECK(stream.isSubscribed());
+    stream.update(now + 31000, false);
+    CHECK_EQ(stream.getState(), EventStreamClient::WAITING);
+    CHECK(!HostEventServer::isConnected());
+    stream.update(now + 40000, true);
+    CHECK_EQ(HostEventServer::getConnections(), 3ul);
+}
@@ -0,0 +1,118 @@
+#include "TestHarness.h"
+#include <HTTPClient.h>
+#include <HostClock.h>
+#include <atomic>
+#include <freertos/task.h>
+#include <thread>
+#include "GeoEntryDevice.h"
+
+static const char* API_URL = "http://api.geoentry.local/api/v1/";
+static const char* EDGE_URL = "http://api.geoentry.local/";
+static const char* DEVICE_ID = "7b4cdbcd-2bf0-4047-9355-05e33babf2c9";
+static const char* USER_ID = "dd380cd7-852b-4855-9c68-c45f71b62521";
+
+// Servidor sin eventos ni sensores que cuenta los sondeos de proximidad
+static unsigned long proximityPolls;
+
+static void installEmptyServer() {
+    proximityPolls = 0;
+    HostHttp::setHandler([](const HostHttpRequest& request, HostHttpResponse& response) {
+        if (strstr(request.url, "/proximity-events/") != nullptr) {
+            proximityPolls++;
+        }
+        response.code = 200;
+        response.body = "[]";
+        return true;
+    });
+}
+
+// Los ajustes pedidos desde otro hilo tras init() no tocan el planificador:
+// los aplica la tarea de red al recibir APPLY_SETTINGS
+TEST(GeoEntryDevice, SettersFromAnotherThreadApplyOnNetworkTask) {
+    installEmptyServer();
+    GeoEntryDevice device("test-ssid", "", API_URL, DEVICE_ID, USER_ID);
+    device.setEdgeAPIConfiguration(EDGE_URL);
+    device.setActuationJournal(false);
+    device.setCheckInterval(200);
+    device.init();
+    HostTasks::runForMs(2000);
+
+    std::thread caller([&device]() {
+        device.setStatusInterval(0);
+        device.setSensorCheckInterval(60000);
+        AdaptivePollingConfig polling;
+        device.setAdaptivePolling(polling);
+        device.setCheckInterval(1000);  // el último modo pedido gana
+    });
+    HostTasks::runForMs(1000);
+    caller.join();
+    HostTasks::runForMs(100);
+
+    unsigned long before = proximityPolls;
+    HostTasks::runForMs(10000);
+    unsigned long polls = proximityPolls - before;
+    CHECK(polls >= 9 && polls <= 11);
+}
+
+// Las estadísticas de la tarea de control se leen desde otro hilo mientras
+// el control las publica: cada copia es coherente y no retrocede
+TEST(GeoEntryDevice, ControlLoopStatsReadFromAnotherThread) {
+    installEmptyServer();
+    GeoEntryDevice device("test-ssid", "", API_URL, DEVICE_ID, USER_ID);
+    device.setEdgeAPIConfiguration(EDGE_URL);
+    device.setActuationJournal(false);
+    device.init();
+
+    std::atomic<bool> done(false);
+    std::atomic<unsigned long> inconsistent(0);
+    std::thread reader([&]() {
+        unsigned long lastTicks = 0;
+        while (!done.load()) {
+            ControlLoopStats stats = device.getControlLoopStats();
+            if (stats.ticks < lastTicks || stats.lastJitterUs > stats.maxJitterUs ||
+                stats.overruns > stats.ticks ||
+                stats.totalJitterUs > (unsigned long long)stats.maxJitterUs * stats.ticks) {
+                inconsistent.fetch_add(1);
+            }
+            lastTicks = stats.ticks;
+            std::this_thread::yield();
+        }
+    });
+    HostTasks::runForMs(5000);
+    done.store(true);
+    reader.join();
+
+    CHECK_EQ(inconsistent.load(), 0ul);
+    ControlLoopStats stats = device.getControlLoopStats();
+    CHECK(stats.ticks >= 490 && stats.ticks <= 500);
+}
+
+// Las asignaciones y los patrones de los LEDs pedidos desde otro hilo tras
+// init() los aplica la tarea de red y llegan al control por el snapshot
+TEST(GeoEntryDevice, LedSettersFromAnotherThreadApplyOnNetworkTask) {
+    HostHttp::setHandler([](const HostHttpRequest& request, HostHttpResponse& response) {
+        response.code = 200;
+        response.body = strstr(request.url, "/sensors/user/") != nullptr
+                            ? "[{\"id\":\"s-01\",\"sensor_type\":\"heater\",\"isActive\":true}]"
+                            : "[]";
+        return true;
+    });
+    GeoEntryDevice device("test-ssid", "", API_URL, DEVICE_ID, USER_ID);
+    device.setEdgeAPIConfiguration(EDGE_URL);
+    device.setActuationJournal(false);
+    device.init();
+    HostTasks::runForMs(2000);
+    CHECK_EQ(device.getSmartLedPattern(1), (uint8_t)LED_PATTERN_OFF);
+
+    std::thread caller([&device]() {
+        CHECK(device.setLedChannelMapping(1, "heater", "fan", "Calefactor", "Ventilador"));
+        CHECK(!device.setLedChannelMapping(GeoEntryDevice::SMART_LED_CHANNELS, "heater", "fan", "", ""));
+        device.setSmartLedPattern(0, LED_PATTERN_SOLID);
+    });
+    HostTasks::runForMs(500);
+    caller.join();
+    HostTasks::runForMs(50);
+
+    CHECK_EQ(device.getSmartLedPattern(0), (uint8_t)LED_PATTERN_SOLID);
+    CHECK_EQ(device.getSmartLedPattern(1), (uint8_t)LED_PATTERN_SLOW_BLINK);
+}
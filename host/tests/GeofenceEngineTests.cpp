@@ -0,0 +1,209 @@
+#include "TestHarness.h"
+#include <math.h>
+#include <random>
+#include "GeofenceEngine.h"
+
+static const double EARTH_RADIUS_M = 6371008.8;
+static const double RAD_PER_E6 = M_PI / 180.0 / 1e6;
+
+// Haversine en double, la referencia de la versión en punto fijo
+static double haversineMeters(const GeoPoint& a, const GeoPoint& b) {
+    double lat1 = a.latE6 * RAD_PER_E6;
+    double lat2 = b.latE6 * RAD_PER_E6;
+    double dLat = lat2 - lat1;
+    double dLon = (b.lonE6 - (double)a.lonE6) * RAD_PER_E6;
+    double h = sin(dLat / 2) * sin(dLat / 2) + cos(lat1) * cos(lat2) * sin(dLon / 2) * sin(dLon / 2);
+    return 2 * EARTH_RADIUS_M * asin(sqrt(h));
+}
+
+// Punto a northM metros al norte y eastM al este de origin (plano local)
+static GeoPoint offset(const GeoPoint& origin, double northM, double eastM) {
+    double metersPerE6 = EARTH_RADIUS_M * RAD_PER_E6;
+    GeoPoint point;
+    point.latE6 = origin.latE6 + (int32_t)lround(northM / metersPerE6);
+    point.lonE6 = origin.lonE6 + (int32_t)lround(eastM / (metersPerE6 * cos(origin.latE6 * RAD_PER_E6)));
+    return point;
+}
+
+// Recorre de fromM a toM metros al este de origin en pasos de 1 m y anota
+// en qué desplazamiento hubo cada transición de la geovalla fence
+struct Walk {
+    int transitions;
+    double firstAtM;
+    double lastAtM;
+};
+
+static Walk walkEast(GeofenceEngine& engine, int fence, const GeoPoint& origin, double northM, double fromM,
+                     double toM) {
+    Walk walk = {0, 0, 0};
+    double step = toM > fromM ? 1 : -1;
+    for (double east = fromM; step > 0 ? east <= toM : east >= toM; east += step) {
+        GeofenceTransition transitions[4];
+        int count = engine.update(offset(origin, northM, east), 5, transitions, 4);
+        for (int i = 0; i < count; i++) {
+            if (transitions[i].fence == fence) {
+                walk.firstAtM = walk.transitions == 0 ? east : walk.firstAtM;
+                walk.lastAtM = east;
+                walk.transitions++;
+            }
+        }
+    }
+    return walk;
+}
+
+// Distancias de 1 m a 100 km a latitudes de los dos hemisferios: el punto
+// fijo queda a menos de 5 cm + 1e-6 relativo de la versión double (el
+// redondeo de Q30 da unos centímetros a cualquier distancia)
+TEST(GeofenceEngine, FixedPointHaversineMatchesDouble) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int32_t> latitude(-80000000, 80000000);
+    std::uniform_int_distribution<int32_t> longitude(-180000000, 180000000);
+    std::uniform_real_distribution<double> logDistance(0, 5);
+    std::uniform_real_distribution<double> bearing(0, 2 * M_PI);
+    double worst = 0;
+    for (int i = 0; i < 2000; i++) {
+        GeoPoint a = {latitude(rng), longitude(rng)};
+        double meters = pow(10, logDistance(rng));
+        double angle = bearing(rng);
+        GeoPoint b = offset(a, meters * cos(angle), meters * sin(angle));
+        if (b.lonE6 > 180000000 || b.lonE6 < -180000000) {
+            continue;
+        }
+        double expected = haversineMeters(a, b);
+        double actual = GeofenceEngine::havToMeters(GeofenceEngine::haversineQ60(
+            a, GeofenceEngine::cosLatQ30(a.latE6), b, GeofenceEngine::cosLatQ30(b.latE6)));
+        double error = fabs(actual - expected) - 1e-6 * expected;
+        worst = error > worst ? error : worst;
+    }
+    CHECK(worst < 0.05);
+
+    for (int32_t lat = -89000000; lat <= 89000000; lat += 1000000) {
+        double expected = cos(lat * RAD_PER_E6);
+        CHECK(fabs(GeofenceEngine::cosLatQ30(lat) / (double)(1 << 30) - expected) < 1e-6);
+    }
+}
+
+// Cruzando un círculo se entra a radio - h y se sale a radio + h, una vez
+// cada una; oscilar ±(h - 1) m alrededor del borde no cambia nada
+TEST(GeofenceEngine, CircleHysteresisDoesNotFlap) {
+    GeofenceEngine engine(4, 0);
+    GeoPoint center = {40416800, -3703800};
+    int fence = engine.addCircle("casa", center, 100);
+    uint16_t h = engine.getConfig().hysteresisM;
+
+    Walk in = walkEast(engine, fence, center, 0, -200, 0);
+    CHECK_EQ(in.transitions, 1);
+    CHECK(fabs(in.firstAtM - -(100.0 - h)) <= 1.5);
+    CHECK(engine.isInside(fence));
+
+    Walk out = walkEast(engine, fence, center, 0, 0, 200);
+    CHECK_EQ(out.transitions, 1);
+    CHECK(fabs(out.firstAtM - (100.0 + h)) <= 1.5);
+    CHECK(!engine.isInside(fence));
+
+    walkEast(engine, fence, center, 0, 200, 0);
+    CHECK(engine.isInside(fence));
+    int flaps = 0;
+    for (int i = 0; i < 200; i++) {
+        GeofenceTransition transitions[4];
+        double east = 100 + ((i & 1) ? (h - 1) : -(h - 1));
+        flaps += engine.update(offset(center, 0, east), 5, transitions, 4);
+    }
+    CHECK_EQ(flaps, 0);
+}
+
+// Polígono cóncavo (una L) en el hemisferio sur y oeste: el rayo deja fuera
+// la muesca, y cruzar una arista respeta la histéresis
+TEST(GeofenceEngine, PolygonRayCastAndEdgeHysteresis) {
+    GeofenceEngine engine(4, 16);
+    GeoPoint origin = {-33448900, -70669300};
+    // L de 200 x 200 m sin el cuadrante noreste (100 x 100 m)
+    GeoPoint points[] = {offset(origin, 0, 0),     offset(origin, 0, 200),   offset(origin, 100, 200),
+                         offset(origin, 100, 100), offset(origin, 200, 100), offset(origin, 200, 0)};
+    int fence = engine.addPolygon("parcela", points, 6);
+    CHECK(fence >= 0);
+    uint16_t h = engine.getConfig().hysteresisM;
+
+    GeofenceTransition transitions[4];
+    CHECK_EQ(engine.update(offset(origin, 150, 150), 5, transitions, 4), 0);  // muesca
+    CHECK(!engine.isInside(fence));
+    CHECK_EQ(engine.update(offset(origin, 150, 50), 5, transitions, 4), 1);
+    CHECK(transitions[0].entered);
+    CHECK_EQ(engine.update(offset(origin, 50, 150), 5, transitions, 4), 0);
+    CHECK(engine.isInside(fence));
+    CHECK_EQ(engine.update(offset(origin, 150, 150), 5, transitions, 4), 1);
+    CHECK(!transitions[0].entered);
+
+    // Arista oeste (este = 0) a media altura: de fuera hacia dentro y vuelta
+    Walk in = walkEast(engine, fence, origin, 50, -60, 60);
+    CHECK_EQ(in.transitions, 1);
+    CHECK(fabs(in.firstAtM - h) <= 1.5);
+    Walk out = walkEast(engine, fence, origin, 50, 60, -60);
+    CHECK_EQ(out.transitions, 1);
+    CHECK(fabs(out.firstAtM - -(double)h) <= 1.5);
+
+    int flaps = 0;
+    for (int i = 0; i < 200; i++) {
+        double east = (i & 1) ? (h - 2) : -(h - 2);
+        flaps += engine.update(offset(origin, 50, east), 5, transitions, 4);
+    }
+    CHECK_EQ(flaps, 0);
+}
+
+// Un círculo centrado en 0,0 ocupa celdas de índice negativo y positivo en
+// los dos ejes: se entra y se sale desde los cuatro cuadrantes
+TEST(GeofenceEngine, CellsAcrossZeroInAllQuadrants) {
+    GeofenceEngine engine(4, 0);
+    GeofenceConfig config;
+    config.cellSizeE6 = 1000;  // unos 110 m: el círculo cubre varias celdas a cada lado
+    engine.configure(config);
+    GeoPoint zero = {0, 0};
+    int fence = engine.addCircle("cero", zero, 300);
+
+    static const double DIRECTIONS[][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    for (const double* direction : DIRECTIONS) {
+        GeofenceTransition transitions[4];
+        CHECK_EQ(engine.update(offset(zero, direction[0] * 500, direction[1] * 500), 5, transitions, 4), 0);
+        CHECK_EQ(engine.update(offset(zero, direction[0] * 150, direction[1] * 150), 5, transitions, 4), 1);
+        CHECK(engine.isInside(fence));
+        CHECK_EQ(engine.update(offset(zero, direction[0] * 500, direction[1] * 500), 5, transitions, 4), 1);
+        CHECK(!engine.isInside(fence));
+    }
+}
+
+// Con MAX_ACTIVE geovallas ocupadas la siguiente no entra (no se podría
+// detectar su salida), y entra en cuanto queda un hueco
+TEST(GeofenceEngine, ActiveOverflowIsBoundedAndRecovers) {
+    static const int FENCES = GeofenceEngine::MAX_ACTIVE + 1;
+    GeofenceEngine engine(FENCES, 0);
+    GeoPoint center = {48856600, 2352200};
+    for (int i = 0; i < FENCES; i++) {
+        CHECK_EQ(engine.addCircle("anillo", center, 100 + 10 * i), i);
+    }
+
+    GeofenceTransition transitions[FENCES];
+    CHECK_EQ(engine.update(center, 5, transitions, FENCES), GeofenceEngine::MAX_ACTIVE);
+    CHECK_EQ(engine.getInsideCount(), GeofenceEngine::MAX_ACTIVE);
+    CHECK(!engine.isInside(FENCES - 1));
+
+    // A 120 m se sale del anillo más pequeño y el hueco lo ocupa el último
+    CHECK_EQ(engine.update(offset(center, 120, 0), 5, transitions, FENCES), 2);
+    CHECK(!transitions[0].entered);
+    CHECK_EQ(transitions[0].fence, 0);
+    CHECK(transitions[1].entered);
+    CHECK_EQ(transitions[1].fence, FENCES - 1);
+    CHECK_EQ(engine.getInsideCount(), GeofenceEngine::MAX_ACTIVE);
+    CHECK(!engine.isInside(0));
+}
+
+TEST(GeofenceEngine, InaccurateFixesAreIgnored) {
+    GeofenceEngine engine(1, 0);
+    GeoPoint center = {40416800, -3703800};
+    int fence = engine.addCircle("casa", center, 100);
+    GeofenceTransition transitions[1];
+    CHECK_EQ(engine.update(center, engine.getConfig().maxAccuracyM + 1, transitions, 1), 0);
+    CHECK(!engine.isInside(fence));
+    CHECK_EQ(engine.getStats().ignored, 1ul);
+    CHECK_EQ(engine.update(center, engine.getConfig().maxAccuracyM, transitions, 1), 1);
+    CHECK(engine.isInside(fence));
+}
@@ -0,0 +1,116 @@
+#include "TestHarness.h"
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <string>
+#include "HttpBodyStream.h"
+
+static const char* BODY_URL = "http://api.geoentry.local/body";
+
+// Respuesta a medida: la ruta fija Content-Length o Transfer-Encoding y el
+// socket recibe después los bytes tal cual, con el encuadre que haga falta
+// y lo que venga detrás en la conexión keep-alive
+static void receive(HTTPClient& http, const char* declaredBody, bool chunked, const std::string& raw) {
+    static const char* COLLECTED[] = {"Transfer-Encoding"};
+    HostHttp::respond("GET", BODY_URL, 200, declaredBody, nullptr, chunked);
+    http.begin(BODY_URL);
+    http.collectHeaders(COLLECTED, 1);
+    CHECK_EQ(http.GET(), 200);
+    http.getStream().hostDeliver(raw.data(), raw.size());
+}
+
+static std::string readAll(HttpBodyStream& body) {
+    std::string text;
+    int c;
+    while ((c = body.read()) >= 0) {
+        text += (char)c;
+    }
+    return text;
+}
+
+// Content-Length: se entrega justo el cuerpo y lo siguiente de la conexión
+// queda sin leer
+TEST(HttpBodyStream, ContentLengthStopsAtTheDeclaredSize) {
+    HTTPClient http;
+    receive(http, "hola", false, "holaHTTP/1.1 200 OK");
+    HttpBodyStream body(http);
+    CHECK_EQ(body.available(), 4);
+    CHECK_EQ(body.peek(), (int)'h');
+    CHECK_EQ(body.peek(), (int)'h');
+    CHECK_EQ(readAll(body), std::string("hola"));
+    CHECK_EQ(body.available(), 0);
+    CHECK_EQ(body.getBytesRead(), 4ul);
+    CHECK_EQ(http.getStream().peek(), (int)'H');
+}
+
+TEST(HttpBodyStream, EmptyAndTruncatedBodiesEnd) {
+    HTTPClient http;
+    receive(http, "", false, "HTTP/1.1");
+    HttpBodyStream empty(http);
+    CHECK_EQ(empty.read(), -1);
+    CHECK_EQ(empty.getBytesRead(), 0ul);
+
+    // La conexión se corta antes de Content-Length: termina sin colgarse
+    HTTPClient cut;
+    receive(cut, "0123456789", false, "0123");
+    HttpBodyStream truncated(cut);
+    CHECK_EQ(readAll(truncated), std::string("0123"));
+    CHECK_EQ(truncated.read(), -1);
+}
+
+// Tamaños en hexadecimal de los dos tipos de letra, extensiones, CRLF
+// dentro de los datos y trailers tras el último chunk
+TEST(HttpBodyStream, ChunkedFramingIsDecoded) {
+    HTTPClient http;
+    receive(http, "", true,
+            "4;name=value\r\nWiki\r\n"
+            "5\r\npedia\r\n"
+            "E\r\n in\r\n\r\nchunks.\r\n"
+            "0\r\nX-Checksum: abc\r\nX-Other: 1\r\n\r\n"
+            "NEXT");
+    HttpBodyStream body(http);
+    CHECK_EQ(readAll(body), std::string("Wikipedia in\r\n\r\nchunks."));
+    CHECK_EQ(body.getBytesRead(), 23ul);
+    CHECK_EQ(body.read(), -1);
+    CHECK_EQ(http.getStream().peek(), (int)'N');
+
+    // available() no pasa del chunk en curso
+    HTTPClient bounded;
+    receive(bounded, "", true, "3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n");
+    HttpBodyStream limited(bounded);
+    CHECK_EQ(limited.read(), (int)'a');
+    CHECK_EQ(limited.available(), 2);
+}
+
+TEST(HttpBodyStream, DrainLeavesTheConnectionAtTheNextResponse) {
+    HTTPClient http;
+    receive(http, "", true, "a\r\n0123456789\r\n1A\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\n\r\nNEXT");
+    HttpBodyStream body(http);
+    CHECK_EQ(body.read(), (int)'0');
+    body.drain();
+    CHECK_EQ(body.getBytesRead(), 36ul);
+    CHECK_EQ(http.getStream().peek(), (int)'N');
+}
+
+// ArduinoJson lee directamente del cuerpo aunque los chunks partan
+// nombres, cadenas y números
+TEST(HttpBodyStream, JsonSplitAcrossOneByteChunks) {
+    const char* json = "{\"id\":\"s-01\",\"isActive\":true,\"distance\":123.5}";
+    std::string framed;
+    for (const char* c = json; *c != '\0'; c++) {
+        framed += "1\r\n";
+        framed += *c;
+        framed += "\r\n";
+    }
+    framed += "0\r\n\r\n";
+
+    HTTPClient http;
+    receive(http, "", true, framed);
+    HttpBodyStream body(http);
+    StaticJsonDocument<128> doc;
+    CHECK(!deserializeJson(doc, body));
+    CHECK_STREQ(doc["id"] | "", "s-01");
+    CHECK(doc["isActive"] | false);
+    CHECK_EQ(doc["distance"] | 0.0f, 123.5f);
+    body.drain();
+    CHECK_EQ(body.getBytesRead(), (unsigned long)strlen(json));
+}
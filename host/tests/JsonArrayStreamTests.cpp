@@ -0,0 +1,121 @@
+#include "TestHarness.h"
+#include <ArduinoJson.h>
+#include <string>
+#include "JsonArrayStream.h"
+
+// Cuerpo en memoria, sin pasar por HTTP
+class JsonTextStream : public Stream {
+private:
+    std::string text;
+    size_t position = 0;
+
+public:
+    explicit JsonTextStream(const std::string& text) : text(text) {}
+
+    int available() override { return (int)(text.size() - position); }
+    int read() override { return position < text.size() ? (uint8_t)text[position++] : -1; }
+    int peek() override { return position < text.size() ? (uint8_t)text[position] : -1; }
+    size_t write(uint8_t) override { return 0; }
+};
+
+static void sensorFilter(JsonDocument& filter) {
+    filter["id"] = true;
+    filter["isActive"] = true;
+}
+
+// Array en la raíz: un elemento por next() y sin los campos filtrados; la
+// lista ocupa unos 60 KB y cada elemento cabe en el documento de 192 bytes
+TEST(JsonArrayStream, RootArrayStreamsElementByElement) {
+    std::string json = " [\n";
+    for (int i = 0; i < 200; i++) {
+        json += i == 0 ? "" : ",\r\n\t";
+        json += "{\"id\":\"s-" + std::to_string(i) + "\",\"isActive\":" + (i % 2 ? "true" : "false") +
+                ",\"description\":\"" + std::string(300, 'x') + "\"}";
+    }
+    json += " ]";
+    JsonTextStream stream(json);
+    StaticJsonDocument<192> item;
+    StaticJsonDocument<96> filter;
+    sensorFilter(filter);
+
+    JsonArrayStream sensors(stream, item, filter);
+    JsonObject sensor;
+    int active = 0;
+    while (sensors.next(sensor)) {
+        CHECK(sensor["description"].isNull());
+        active += sensor["isActive"].as<bool>() ? 1 : 0;
+    }
+    CHECK(!sensors.getError());
+    CHECK_EQ(sensors.getCount(), 200);
+    CHECK_EQ(active, 100);
+    CHECK(!sensors.next(sensor));
+}
+
+// Leer sólo el primero no consume el resto de la lista
+TEST(JsonArrayStream, FirstElementLeavesTheRestUnread) {
+    JsonTextStream stream("[{\"id\":\"evt-9\"},{\"id\":\"evt-8\"}]");
+    StaticJsonDocument<192> item;
+    StaticJsonDocument<96> filter;
+    sensorFilter(filter);
+    JsonArrayStream events(stream, item, filter);
+    JsonObject event;
+    CHECK(events.next(event));
+    CHECK_STREQ(event["id"] | "", "evt-9");
+    CHECK_EQ(stream.peek(), (int)',');
+}
+
+TEST(JsonArrayStream, WrappedDataAndSingleObject) {
+    StaticJsonDocument<192> item;
+    StaticJsonDocument<96> filter;
+    sensorFilter(filter);
+    JsonObject sensor;
+
+    JsonTextStream wrappedBody("{\"total\":2,\"data\":[{\"id\":\"a\",\"isActive\":true},{\"id\":\"b\"}]}");
+    JsonArrayStream wrapped(wrappedBody, item, filter);
+    CHECK(wrapped.next(sensor));
+    CHECK_STREQ(sensor["id"] | "", "a");
+    CHECK(wrapped.next(sensor));
+    CHECK_STREQ(sensor["id"] | "", "b");
+    CHECK(!wrapped.next(sensor));
+    CHECK_EQ(wrapped.getCount(), 2);
+
+    JsonTextStream singleBody("{\"id\":\"solo\",\"isActive\":true,\"extra\":1}");
+    JsonArrayStream single(singleBody, item, filter);
+    CHECK(single.next(sensor));
+    CHECK_STREQ(sensor["id"] | "", "solo");
+    CHECK(sensor["extra"].isNull());
+    CHECK(!single.next(sensor));
+    CHECK_EQ(single.getCount(), 1);
+}
+
+TEST(JsonArrayStream, EmptyAndMalformedInput) {
+    StaticJsonDocument<192> item;
+    StaticJsonDocument<96> filter;
+    sensorFilter(filter);
+    JsonObject sensor;
+
+    JsonTextStream emptyArray(" [ ] ");
+    JsonArrayStream none(emptyArray, item, filter);
+    CHECK(!none.next(sensor));
+    CHECK(!none.getError());
+    CHECK_EQ(none.getCount(), 0);
+
+    JsonTextStream emptyBody("  ");
+    JsonArrayStream empty(emptyBody, item, filter);
+    CHECK(!empty.next(sensor));
+    CHECK(empty.getError() == DeserializationError::EmptyInput);
+
+    JsonTextStream notJson("<html>");
+    JsonArrayStream html(notJson, item, filter);
+    CHECK(!html.next(sensor));
+    CHECK(html.getError() == DeserializationError::InvalidInput);
+
+    // Un elemento roto corta la lista con error; los anteriores ya salieron
+    JsonTextStream broken("[{\"id\":\"a\"},{\"id\":]");
+    JsonArrayStream partial(broken, item, filter);
+    CHECK(partial.next(sensor));
+    CHECK(!partial.next(sensor));
+    CHECK(partial.getError());
+    CHECK(!partial.next(sensor));
+    CHECK_EQ(partial.getCount(), 1);
+}
@@ -0,0 +1,123 @@
+#include "TestHarness.h"
+#include <HostClock.h>
+#include <driver/ledc.h>
+#include "LedPatternEngine.h"
+
+static const uint32_t ON = (1u << LedPatternEngine::PWM_RESOLUTION) - 1;
+
+// Avanza el reloj virtual hasta el instante absoluto ms (disparando los
+// esp_timer vencidos) y devuelve el duty del canal
+static uint32_t dutyAt(int channel, uint64_t ms) {
+    HostClock::advanceUs(ms * 1000 - HostClock::nowUs());
+    return HostLedc::getDuty(channel);
+}
+
+TEST(LedPatternEngine, SlowBlinkTogglesOnPeriodBoundaries) {
+    LedPatternEngine engine;
+    int channel = engine.addChannel(2);
+    engine.setPattern(channel, LED_PATTERN_SLOW_BLINK);
+
+    CHECK_EQ(dutyAt(channel, 0), ON);
+    CHECK_EQ(dutyAt(channel, 999), ON);
+    CHECK_EQ(dutyAt(channel, 1000), 0u);
+    CHECK_EQ(dutyAt(channel, 1999), 0u);
+    CHECK_EQ(dutyAt(channel, 2000), ON);
+    CHECK_EQ(dutyAt(channel, 2999), ON);
+    CHECK_EQ(dutyAt(channel, 3000), 0u);
+}
+
+TEST(LedPatternEngine, DoublePulseFollowsEachStep) {
+    LedPatternEngine engine;
+    int channel = engine.addChannel(2);
+    engine.setPattern(channel, LED_PATTERN_DOUBLE_PULSE);
+
+    // 120 ms encendido, 180 apagado, 120 encendido y 1080 apagado: 1500 ms
+    for (uint64_t period = 0; period < 3; period++) {
+        uint64_t base = period * 1500;
+        CHECK_EQ(dutyAt(channel, base), ON);
+        CHECK_EQ(dutyAt(channel, base + 119), ON);
+        CHECK_EQ(dutyAt(channel, base + 120), 0u);
+        CHECK_EQ(dutyAt(channel, base + 299), 0u);
+        CHECK_EQ(dutyAt(channel, base + 300), ON);
+        CHECK_EQ(dutyAt(channel, base + 419), ON);
+        CHECK_EQ(dutyAt(channel, base + 420), 0u);
+        CHECK_EQ(dutyAt(channel, base + 1499), 0u);
+    }
+}
+
+TEST(LedPatternEngine, FastBlinkDoesNotDrift) {
+    LedPatternEngine engine;
+    int channel = engine.addChannel(2);
+    engine.setPattern(channel, LED_PATTERN_FAST_BLINK);
+    dutyAt(channel, 0);
+    unsigned long updatesBefore = HostLedc::getUpdates(channel);
+
+    // 1000 periodos de 600 ms: el flanco sigue cayendo en el milisegundo exacto
+    CHECK_EQ(dutyAt(channel, 600000 - 1), 0u);
+    CHECK_EQ(dutyAt(channel, 600000), ON);
+    CHECK_EQ(dutyAt(channel, 600300 - 1), ON);
+    CHECK_EQ(dutyAt(channel, 600300), 0u);
+    CHECK_EQ(HostLedc::getUpdates(channel) - updatesBefore, 2001ul);
+}
+
+TEST(LedPatternEngine, FlashThenRestartsPattern) {
+    LedPatternEngine engine;
+    int channel = engine.addChannel(2);
+    engine.setPattern(channel, LED_PATTERN_SLOW_BLINK);
+    dutyAt(channel, 500);
+
+    // Dos destellos de 100 ms a mitad del encendido y el patrón desde el principio
+    engine.flash(channel, 2, 100);
+    CHECK_EQ(dutyAt(channel, 500), ON);
+    CHECK_EQ(dutyAt(channel, 600), 0u);
+    CHECK_EQ(dutyAt(channel, 700), ON);
+    CHECK_EQ(dutyAt(channel, 800), 0u);
+    CHECK_EQ(dutyAt(channel, 899), 0u);
+    CHECK_EQ(dutyAt(channel, 900), ON);
+    CHECK_EQ(dutyAt(channel, 1899), ON);
+    CHECK_EQ(dutyAt(channel, 1900), 0u);
+}
+
+TEST(LedPatternEngine, BreathingFadesEachHalfPeriod) {
+    LedPatternEngine engine;
+    int channel = engine.addChannel(2);
+    engine.setPattern(channel, LED_PATTERN_BREATHING);
+
+    // La rampa la hace el LEDC; el shim deja el duty en el destino
+    CHECK_EQ(dutyAt(channel, 0), ON);
+    CHECK_EQ(dutyAt(channel, 1499), ON);
+    CHECK_EQ(dutyAt(channel, 1500), 0u);
+    CHECK_EQ(dutyAt(channel, 2999), 0u);
+    CHECK_EQ(dutyAt(channel, 3000), ON);
+}
+
+TEST(LedPatternEngine, SolidHoldsWithoutTimer) {
+    LedPatternEngine engine;
+    int channel = engine.addChannel(2);
+    engine.setPattern(channel, LED_PATTERN_SOLID);
+    CHECK_EQ(dutyAt(channel, 0), ON);
+    unsigned long updates = HostLedc::getUpdates(channel);
+
+    CHECK_EQ(dutyAt(channel, 60000), ON);
+    CHECK_EQ(HostLedc::getUpdates(channel), updates);
+    CHECK_EQ(HostClock::nextTimerUs(), UINT64_MAX);
+}
+
+TEST(LedPatternEngine, WaveformKeepsAbsoluteDeadlines) {
+    LedWaveform waveform;
+    uint8_t level;
+    uint16_t fadeMs;
+    waveform.start(LED_PATTERN_FAST_BLINK, 0);
+    CHECK(waveform.advance(0, level, fadeMs));
+    CHECK_EQ(level, 255);
+    CHECK_EQ(waveform.deadlineUs, (int64_t)300000);
+
+    // Un callback 50 ms tarde no corre el siguiente flanco
+    CHECK(waveform.advance(350000, level, fadeMs));
+    CHECK_EQ(level, 0);
+    CHECK_EQ(waveform.deadlineUs, (int64_t)600000);
+
+    // Con más de un paso de retraso se resincroniza sin ráfagas
+    CHECK(waveform.advance(2000000, level, fadeMs));
+    CHECK_EQ(waveform.deadlineUs, (int64_t)2300000);
+}
@@ -0,0 +1,122 @@
+#include "TestHarness.h"
+#include <Arduino.h>
+#include <HostClock.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+
+// Cada valor cae en el cubo cuyo rango lo contiene, los cubos son
+// contiguos y ninguno es más ancho que un 25 % de su límite inferior
+TEST(Metrics, BucketsCoverTheRangeWithBoundedError) {
+    int previous = 0;
+    uint32_t last = LatencyHistogram::bucketLimit(LatencyHistogram::BUCKETS - 2);
+    for (uint32_t us = 0; us < last; us += us < (1u << 16) ? 1 : 97) {
+        int bucket = LatencyHistogram::bucketFor(us);
+        CHECK(bucket == previous || bucket == previous + 1);
+        CHECK(us < LatencyHistogram::bucketLimit(bucket));
+        CHECK(bucket == 0 || us >= LatencyHistogram::bucketLimit(bucket - 1));
+        previous = bucket;
+    }
+    for (int bucket = LatencyHistogram::SUB_BUCKETS; bucket < LatencyHistogram::BUCKETS; bucket++) {
+        uint32_t low = LatencyHistogram::bucketLimit(bucket - 1);
+        CHECK((LatencyHistogram::bucketLimit(bucket) - low) * 4 <= low);
+    }
+
+    // Lo que supera el rango (unos 15 s) va al último cubo
+    CHECK_EQ(LatencyHistogram::bucketFor(last), LatencyHistogram::BUCKETS - 1);
+    CHECK_EQ(LatencyHistogram::bucketFor(0xFFFFFFFFu), LatencyHistogram::BUCKETS - 1);
+}
+
+// El percentil del histograma nunca queda por debajo del exacto ni más de un
+// 25 % por encima, y no pasa del máximo registrado
+TEST(Metrics, PercentilesBoundTheExactOnes) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> logUs(0, 7);
+    LatencyHistogram histogram;
+    std::vector<uint32_t> samples;
+    for (int i = 0; i < 20000; i++) {
+        uint32_t us = (uint32_t)pow(10, logUs(rng));
+        samples.push_back(us);
+        histogram.record(us);
+    }
+    std::sort(samples.begin(), samples.end());
+    CHECK_EQ(histogram.getCount(), (uint32_t)samples.size());
+    CHECK_EQ(histogram.getMax(), samples.back());
+
+    static const float PERCENTILES[] = {0.01f, 0.5f, 0.9f, 0.99f, 0.999f, 1.0f};
+    for (float p : PERCENTILES) {
+        // Rango por redondeo hacia arriba, como percentile()
+        size_t rank = std::max<size_t>(1, (size_t)(p * samples.size() + 0.999f));
+        uint32_t exact = samples[rank - 1];
+        uint32_t reported = histogram.percentile(p);
+        CHECK(reported >= exact);
+        CHECK(reported <= exact + exact / 4 + 1);
+        CHECK(reported <= histogram.getMax());
+    }
+    CHECK_EQ(histogram.percentile(1.0f), samples.back());
+
+    histogram.reset();
+    CHECK_EQ(histogram.getCount(), 0u);
+    CHECK_EQ(histogram.percentile(0.5f), 0u);
+}
+
+TEST(Metrics, RecordFromSeveralThreads) {
+    static const int THREADS = 4;
+    static const uint32_t PER_THREAD = 20000;
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&histogram, t]() {
+            for (uint32_t i = 0; i < PER_THREAD; i++) {
+                histogram.record(i * THREADS + t);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK_EQ(histogram.getCount(), THREADS * PER_THREAD);
+    CHECK_EQ(histogram.getMax(), THREADS * PER_THREAD - 1);
+    CHECK_EQ(histogram.percentile(1.0f), THREADS * PER_THREAD - 1);
+}
+
+struct MetricsText : public Print {
+    std::string text;
+
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+};
+
+// METRIC_SCOPE mide en el reloj del dispositivo; write() sólo lista las
+// etapas con muestras
+TEST(Metrics, StageScopeAndMetricsText) {
+    Metrics::reset();
+    for (int i = 1; i <= 4; i++) {
+        METRIC_SCOPE(PATCH);
+        HostClock::advanceUs(i * 1000);
+    }
+    const LatencyHistogram& patch = Metrics::get(METRIC_PATCH);
+    CHECK_EQ(patch.getCount(), 4u);
+    CHECK_EQ(patch.getMax(), 4000u);
+    CHECK_STREQ(Metrics::getName(METRIC_PATCH), "patch");
+    CHECK_STREQ(Metrics::getName(METRIC_STAGE_COUNT), "?");
+
+    MetricsText out;
+    Metrics::write(out);
+    CHECK_EQ(out.text.rfind("uptime_ms ", 0), (size_t)0);
+    CHECK(out.text.find("\nheap_free ") != std::string::npos);
+    CHECK(out.text.find("\n# etapa n p50_us p90_us p99_us max_us\n") != std::string::npos);
+    char line[64];
+    snprintf(line, sizeof(line), "\npatch 4 %lu %lu %lu 4000\n", (unsigned long)patch.percentile(0.5f),
+             (unsigned long)patch.percentile(0.9f), (unsigned long)patch.percentile(0.99f));
+    CHECK(out.text.find(line) != std::string::npos);
+    CHECK(out.text.find("json_parse") == std::string::npos);
+
+    Metrics::reset();
+    CHECK_EQ(Metrics::get(METRIC_PATCH).getCount(), 0u);
+}
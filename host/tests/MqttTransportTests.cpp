@@ -0,0 +1,174 @@
+#include "TestHarness.h"
+#include <Arduino.h>
+#include <HostClock.h>
+#include <mqtt_client.h>
+#include <string>
+#include <vector>
+#include "MqttTransport.h"
+
+static const char* SENSOR_TOPIC = "geoentry/users/user-1/sensors/s-01";
+
+struct ResultLog : public TransportListener {
+    std::vector<ActuationResult> results;
+
+    void onProximityEvent(JsonObject event) override {}
+    void onSensorStatesBegin() override {}
+    void onSensorState(JsonObject sensor) override {}
+    void onSensorStatesEnd(bool complete) override {}
+    void onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) override {
+        results.push_back(result);
+    }
+    void onRequestResult(bool success) override {}
+    void onRetryAfter(unsigned long delayMs) override {}
+    void onTransportConnected() override {}
+};
+
+// Conectado y con s-01 apagado en la caché
+static void connect(MqttTransport& mqtt, ResultLog& log) {
+    mqtt.begin(&log);
+    mqtt.update(millis(), true);
+    HostMqtt::connect();
+    HostMqtt::deliver(SENSOR_TOPIC, "{\"sensor_type\":\"smart_light\",\"isActive\":false}");
+    mqtt.update(millis(), true);
+}
+
+// msgId del último comando publicado en .../set
+static int lastCommand() {
+    const std::vector<HostMqttMessage>& sent = HostMqtt::sent();
+    for (size_t i = sent.size(); i > 0; i--) {
+        const std::string& topic = sent[i - 1].topic;
+        if (topic.size() > 4 && topic.compare(topic.size() - 4, 4, "/set") == 0) {
+            return sent[i - 1].msgId;
+        }
+    }
+    return -1;
+}
+
+TEST(MqttTransport, PublishesCommandOnSetTopic) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    CHECK(mqtt.isConnected());
+
+    CHECK_EQ(mqtt.actuateAll(true), 1);
+    CHECK(lastCommand() > 0);
+    CHECK_STREQ(HostMqtt::sent().back().topic.c_str(), "geoentry/users/user-1/sensors/s-01/set");
+    CHECK_STREQ(HostMqtt::sent().back().payload.c_str(), "{\"isActive\": true}");
+}
+
+TEST(MqttTransport, PubackAloneIsNotConfirmation) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    mqtt.actuateAll(true);
+
+    HostMqtt::puback(lastCommand());
+    mqtt.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)0);
+
+    // El estado retenido con el valor pedido cierra la actuación
+    HostClock::advanceMs(300);
+    HostMqtt::deliver(SENSOR_TOPIC, "{\"sensor_type\":\"smart_light\",\"isActive\":true}");
+    mqtt.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)1);
+    CHECK_EQ(log.results[0].httpResponseCode, 200);
+    CHECK_EQ(log.results[0].durationMs, 300UL);
+    CHECK(log.results[0].batchComplete);
+}
+
+TEST(MqttTransport, StateBeforePubackConfirms) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    mqtt.actuateAll(true);
+    int msgId = lastCommand();
+
+    HostMqtt::deliver(SENSOR_TOPIC, "{\"sensor_type\":\"smart_light\",\"isActive\":true}");
+    HostMqtt::puback(msgId);
+    mqtt.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)1);
+    CHECK_EQ(log.results[0].httpResponseCode, 200);
+}
+
+TEST(MqttTransport, OtherStateDoesNotConfirm) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    mqtt.actuateAll(true);
+    HostMqtt::puback(lastCommand());
+
+    // Un retenido con el valor anterior no confirma nada
+    HostMqtt::deliver(SENSOR_TOPIC, "{\"sensor_type\":\"smart_light\",\"isActive\":false}");
+    HostMqtt::deliver("geoentry/users/user-1/sensors/s-02", "{\"sensor_type\":\"led_tv\",\"isActive\":true}");
+    mqtt.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)0);
+}
+
+TEST(MqttTransport, PubackWithoutStateTimesOutUnconfirmed) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    mqtt.actuateAll(true);
+    HostMqtt::puback(lastCommand());
+    mqtt.update(millis(), true);
+
+    HostClock::advanceMs(MqttTransport::ACK_TIMEOUT);
+    mqtt.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)1);
+    CHECK_EQ(log.results[0].httpResponseCode, ActuationResult::UNCONFIRMED);
+    CHECK(log.results[0].batchComplete);
+}
+
+TEST(MqttTransport, NoPubackTimesOutFailed) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    mqtt.actuateAll(false);  // ya estaba apagado: nada que publicar
+    CHECK_EQ(lastCommand(), -1);
+
+    mqtt.actuateAll(true);
+    HostClock::advanceMs(MqttTransport::ACK_TIMEOUT);
+    mqtt.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)1);
+    CHECK_EQ(log.results[0].httpResponseCode, -1);
+}
+
+TEST(MqttTransport, RefusesTopicThatDoesNotFit) {
+    ResultLog log;
+    std::string userId(MqttTransport::MAX_TOPIC - 30, 'u');
+    MqttTransport mqtt("mqtt://broker", "dev-1", userId.c_str());
+    connect(mqtt, log);
+    size_t sentBefore = HostMqtt::sent().size();
+
+    CHECK(!mqtt.actuate("sensor-con-un-id-bastante-largo", "smart_light", true));
+    CHECK_EQ(HostMqtt::sent().size(), sentBefore);
+}
+
+// Con el outbox lleno la orden no sale: se entrega al momento como fallida
+// para que el diario la guarde aunque el "todos" se cierre con 0
+TEST(MqttTransport, FullOutboxReportsNotQueued) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    HostMqtt::setOutboxFull(true);
+
+    CHECK_EQ(mqtt.actuateAll(true), 0);
+    HostMqtt::setOutboxFull(false);
+    CHECK_EQ(log.results.size(), (size_t)1);
+    CHECK_STREQ(log.results[0].sensorId, "s-01");
+    CHECK_STREQ(log.results[0].sensorType, "smart_light");
+    CHECK(log.results[0].targetState);
+    CHECK_EQ(log.results[0].httpResponseCode, ActuationResult::NOT_QUEUED);
+    CHECK(!log.results[0].batchComplete);
+}
+
+TEST(MqttTransport, RefusesOverlongSensorId) {
+    ResultLog log;
+    MqttTransport mqtt("mqtt://broker", "dev-1", "user-1");
+    connect(mqtt, log);
+    size_t sentBefore = HostMqtt::sent().size();
+
+    std::string longId(40, 's');
+    CHECK(!mqtt.actuate(longId.c_str(), "smart_light", true));
+    CHECK_EQ(HostMqtt::sent().size(), sentBefore);
+}
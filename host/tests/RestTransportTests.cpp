@@ -0,0 +1,332 @@
+#include "TestHarness.h"
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <HostClock.h>
+#include <WiFi.h>
+#include <freertos/task.h>
+#include <string>
+#include <vector>
+#include "RestTransport.h"
+
+static const char* API_URL = "http://api.geoentry.local/api/v1/";
+static const char* EDGE_URL = "http://api.geoentry.local/";
+static const char* PROXIMITY_PREFIX = "http://api.geoentry.local/api/v1/proximity-events/";
+static const char* SENSORS_PREFIX = "http://api.geoentry.local/sensors/";
+static const char* PROXIMITY_URL = "http://api.geoentry.local/api/v1/proximity-events/device/dev-1?since=evt-0005";
+static const char* SENSORS_URL = "http://api.geoentry.local/sensors/user/user-1";
+static const char* SENSOR_ID = "0b7e4f52-93c1-4d7a-a8e6-5f2c19d03b7e";  // como los del API, sin SSO
+static const char* PATCH_URL = "http://api.geoentry.local/sensors/0b7e4f52-93c1-4d7a-a8e6-5f2c19d03b7e/status";
+
+struct NullListener : public TransportListener {
+    void onProximityEvent(JsonObject event) override {}
+    void onSensorStatesBegin() override {}
+    void onSensorState(JsonObject sensor) override {}
+    void onSensorStatesEnd(bool complete) override {}
+    void onActuationResult(const ActuationResult& result, unsigned long batchDurationMs) override {}
+    void onRequestResult(bool success) override {}
+    void onRetryAfter(unsigned long delayMs) override {}
+    void onTransportConnected() override {}
+};
+
+// Reservas de la misma petición hecha directamente con el shim de
+// HTTPClient, con las llamadas de HttpConnectionPool: begin() copia la URL
+// en un String, addHeader() crea y guarda el String del Content-Type,
+// collectHeaders() copia los nombres y la tabla de rutas copia la respuesta
+// simulada. En el ESP32 HTTPClient también guarda URL y cabeceras en String
+static unsigned long long shimRequestAllocs(const char* method, const char* url, const char* payload,
+                                            const char* ifNoneMatch) {
+    static const char* COLLECTED[] = {"Transfer-Encoding", "ETag", "Retry-After"};
+    WiFiClient client;
+    HTTPClient http;
+    http.setReuse(true);
+    unsigned long long total = 0;
+    for (int i = 0; i < 2; i++) {  // la primera vuelta sólo calienta el shim
+        unsigned long long before = TestAllocs::count();
+        http.begin(client, url);
+        http.addHeader("Content-Type", "application/json");
+        if (ifNoneMatch != nullptr) {
+            http.addHeader("If-None-Match", ifNoneMatch);
+        }
+        http.collectHeaders(COLLECTED, 3);
+        http.sendRequest(method, (uint8_t*)payload, payload != nullptr ? strlen(payload) : 0);
+        http.end();
+        total = TestAllocs::count() - before;
+    }
+    return total;
+}
+
+// GET condicionales en régimen: la URL con cursor, el ETag, las
+// estadísticas y el cortacircuitos no reservan nada; lo único que queda es
+// lo que reserva el propio shim de HTTPClient
+TEST(RestTransport, ConditionalPollsAllocateOnlyInHttpShim) {
+    NullListener listener;
+    RestTransport rest(API_URL, EDGE_URL, "dev-1", "user-1");
+    rest.begin(&listener);
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, "[]", "\"prox-v5\"");
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, "[]", "\"sens-v1\"");
+    for (int i = 0; i < 3; i++) {
+        rest.pollProximity("evt-0005");
+        rest.pollSensors();
+    }
+    CHECK_EQ(rest.getProximityPollStats().notModified, 2ul);
+
+    unsigned long long before = TestAllocs::count();
+    rest.pollProximity("evt-0005");
+    unsigned long long proximity = TestAllocs::count() - before;
+    before = TestAllocs::count();
+    rest.pollSensors();
+    unsigned long long sensors = TestAllocs::count() - before;
+
+    CHECK_EQ(rest.getProximityPollStats().notModified, 3ul);
+    CHECK_EQ(rest.getSensorPollStats().notModified, 3ul);
+    CHECK_EQ(proximity, shimRequestAllocs("GET", PROXIMITY_URL, nullptr, "\"prox-v5\""));
+    CHECK_EQ(sensors, shimRequestAllocs("GET", SENSORS_URL, nullptr, "\"sens-v1\""));
+}
+
+// Camino del PATCH en régimen: actuateAll() y enqueue() no reservan nada,
+// el trabajador sólo lo del shim de HTTPClient y la entrega del resultado
+// sólo lo que cueste notify() con el ArduinoJson del build (nada con
+// StaticJsonDocument)
+TEST(RestTransport, ActuationAllocatesOnlyInHttpShim) {
+    NullListener listener;
+    RestTransport rest(API_URL, EDGE_URL, "dev-1", "user-1");
+    rest.begin(&listener);
+    WiFi.begin("test-ssid", "");
+    std::string sensors = std::string("[{\"id\":\"") + SENSOR_ID + "\",\"sensor_type\":\"led_tv\",\"isActive\":false}]";
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, sensors.c_str());
+    HostHttp::respond("PATCH", SENSORS_PREFIX, 200, "{}");
+    rest.pollSensors();
+
+    bool targetState = true;
+    unsigned long long enqueue = 0;
+    unsigned long long worker = 0;
+    unsigned long long results = 0;
+    for (int round = 0; round < 3; round++) {
+        unsigned long long before = TestAllocs::count();
+        CHECK_EQ(rest.actuateAll(targetState), 1);
+        enqueue = TestAllocs::count() - before;
+        before = TestAllocs::count();
+        HostTasks::runForMs(500);
+        worker = TestAllocs::count() - before;
+        before = TestAllocs::count();
+        rest.update(millis(), true);
+        results = TestAllocs::count() - before;
+        targetState = !targetState;
+    }
+
+    std::string payload = HostHttp::getLastPayload();
+    CHECK_STREQ(HostHttp::getLastURL(), PATCH_URL);
+    CHECK_EQ(enqueue, 0ull);
+    CHECK_EQ(worker, shimRequestAllocs("PATCH", PATCH_URL, payload.c_str(), nullptr));
+    unsigned long long before = TestAllocs::count();
+    rest.getSensorCache().notify(&listener);
+    CHECK_EQ(results, TestAllocs::count() - before);
+}
+
+// Una URL que no cabe se descarta y se cuenta en vez de enviarse truncada
+TEST(RestTransport, OverlongURLIsRejected) {
+    NullListener listener;
+    RestTransport rest(API_URL, EDGE_URL, "dev-1", "user-1");
+    rest.begin(&listener);
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, "[]");
+
+    std::string cursor(HttpConnectionPool::MAX_URL, 'x');
+    unsigned long requests = HostHttp::getRequests();
+    rest.pollProximity(cursor.c_str());
+    CHECK_EQ(HostHttp::getRequests(), requests);
+    CHECK_EQ(rest.getRejectedURLs(), 1ul);
+    CHECK_EQ(rest.getProximityPollStats().polls, 0ul);
+
+    rest.pollProximity("evt-0005");
+    CHECK_EQ(HostHttp::getRequests(), requests + 1);
+    CHECK_STREQ(HostHttp::getLastURL(), PROXIMITY_URL);
+}
+
+// Un deviceId o userId que no caben dejan la URL fija truncada: ningún
+// sondeo sale, con o sin cursor, y todos cuentan como descartados
+TEST(RestTransport, OverlongFixedURLsAreNeverPolled) {
+    NullListener listener;
+    std::string longId(HttpConnectionPool::MAX_URL_PREFIX, 'd');
+    RestTransport rest(API_URL, EDGE_URL, longId.c_str(), longId.c_str());
+    rest.begin(&listener);
+    HostHttp::respond("GET", PROXIMITY_PREFIX, 200, "[]");
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, "[]");
+
+    unsigned long requests = HostHttp::getRequests();
+    rest.pollProximity("");
+    rest.pollProximity("evt-0005");
+    rest.pollSensors();
+    rest.enablePushEvents(true);
+    CHECK_EQ(HostHttp::getRequests(), requests);
+    CHECK_EQ(rest.getRejectedURLs(), 4ul);
+
+    // Al corregir la configuración vuelven a salir
+    rest.setAPIConfiguration(API_URL, "dev-1");
+    rest.setUserConfiguration("user-1");
+    rest.pollProximity("evt-0005");
+    CHECK_STREQ(HostHttp::getLastURL(), PROXIMITY_URL);
+    rest.pollSensors();
+    CHECK_STREQ(HostHttp::getLastURL(), SENSORS_URL);
+    CHECK_EQ(HostHttp::getRequests(), requests + 2);
+}
+
+struct ActuationLog : public NullListener {
+    std::vector<ActuationResult> results;
+    unsigned long batchDurationMs = 0;
+
+    void onActuationResult(const ActuationResult& result, unsigned long batchMs) override {
+        results.push_back(result);
+        if (result.batchComplete) {
+            batchDurationMs = batchMs;
+        }
+    }
+};
+
+// Más sensores que huecos en la cola de actuación: los que no caben se
+// entregan enseguida como NOT_QUEUED y el resto sale con normalidad
+TEST(RestTransport, FullActuationQueueReportsNotQueued) {
+    static const int SENSORS = ActuationPipeline::QUEUE_LENGTH + 8;
+    ActuationLog log;
+    RestTransport rest(API_URL, EDGE_URL, "dev-1", "user-1");
+    rest.begin(&log);
+    WiFi.begin("test-ssid", "");
+    std::string sensors = "[";
+    for (int i = 0; i < SENSORS; i++) {
+        char sensor[96];
+        snprintf(sensor, sizeof(sensor), "%s{\"id\":\"s-%02d\",\"sensor_type\":\"led_tv\",\"isActive\":false}",
+                 i > 0 ? "," : "", i);
+        sensors += sensor;
+    }
+    sensors += "]";
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, sensors.c_str());
+    HostHttp::respond("PATCH", SENSORS_PREFIX, 200, "{}");
+    rest.pollSensors();
+
+    CHECK_EQ(rest.actuateAll(true), ActuationPipeline::QUEUE_LENGTH);
+    CHECK_EQ(log.results.size(), (size_t)(SENSORS - ActuationPipeline::QUEUE_LENGTH));
+    for (const ActuationResult& result : log.results) {
+        CHECK_EQ(result.httpResponseCode, ActuationResult::NOT_QUEUED);
+        CHECK(result.targetState);
+        CHECK(!result.batchComplete);
+    }
+
+    log.results.clear();
+    HostTasks::runForMs(5000);
+    rest.update(millis(), true);
+    CHECK_EQ(log.results.size(), (size_t)ActuationPipeline::QUEUE_LENGTH);
+    CHECK(log.results.back().batchComplete);
+}
+
+// N sensores con PATCH de latencia fija y maxInFlight trabajadores: el lote
+// dura en tiempo virtual lo que ceil(N / maxInFlight) PATCH, no N, y nunca
+// hay más de maxInFlight peticiones a la vez en el servidor
+struct ConcurrencyRun {
+    unsigned long batchMs;
+    int maxConcurrent;
+    int results;
+};
+
+static ConcurrencyRun runConcurrentBatch(int sensorCount, int maxInFlight, uint64_t latencyUs) {
+    static std::vector<uint64_t> arrivals;
+    arrivals.clear();
+    HostHttp::clear();
+    HostHttp::setHandler([latencyUs](const HostHttpRequest& request, HostHttpResponse& response) {
+        if (strcmp(request.method, "PATCH") != 0) {
+            return false;
+        }
+        arrivals.push_back(HostClock::nowUs());
+        response.code = 200;
+        response.body = "{}";
+        response.latencyUs = latencyUs;
+        return true;
+    });
+    std::string sensors = "[";
+    for (int i = 0; i < sensorCount; i++) {
+        char sensor[96];
+        snprintf(sensor, sizeof(sensor), "%s{\"id\":\"s-%02d\",\"sensor_type\":\"led_tv\",\"isActive\":false}",
+                 i > 0 ? "," : "", i);
+        sensors += sensor;
+    }
+    sensors += "]";
+    HostHttp::respond("GET", SENSORS_PREFIX, 200, sensors.c_str());
+
+    ActuationLog log;
+    RestTransport rest(API_URL, EDGE_URL, "dev-1", "user-1");
+    rest.setActuationLimits(maxInFlight, 0);  // sin límite de ritmo: sólo cuenta la concurrencia
+    rest.begin(&log);
+    WiFi.begin("test-ssid", "");
+    rest.pollSensors();
+
+    ConcurrencyRun run = {0, 0, 0};
+    rest.actuateAll(true);
+    for (int step = 0; step < 2000 && (log.results.empty() || !log.results.back().batchComplete); step++) {
+        HostTasks::runForMs(5);
+        rest.update(millis(), true);
+    }
+    run.batchMs = log.batchDurationMs;
+    run.results = (int)log.results.size();
+    for (size_t i = 0; i < arrivals.size(); i++) {
+        int concurrent = 0;
+        for (size_t j = 0; j < arrivals.size(); j++) {
+            if (arrivals[j] <= arrivals[i] && arrivals[j] + latencyUs > arrivals[i]) {
+                concurrent++;
+            }
+        }
+        run.maxConcurrent = concurrent > run.maxConcurrent ? concurrent : run.maxConcurrent;
+    }
+    HostHttp::clear();
+    return run;
+}
+
+TEST(RestTransport, ConcurrentPatchesTakeCeilNOverMaxInFlightLatencies) {
+    static const int SENSORS = 12;
+    static const unsigned long LATENCY_MS = 400;
+    static const unsigned long STEP_MS = 5;  // resolución de rest.update() en el bucle
+    for (int maxInFlight = 1; maxInFlight <= ActuationPipeline::MAX_WORKERS; maxInFlight++) {
+        ConcurrencyRun run = runConcurrentBatch(SENSORS, maxInFlight, LATENCY_MS * 1000);
+        unsigned long expected = (unsigned long)((SENSORS + maxInFlight - 1) / maxInFlight) * LATENCY_MS;
+        CHECK_EQ(run.results, SENSORS);
+        CHECK_EQ(run.maxConcurrent, maxInFlight);
+        CHECK(run.batchMs >= expected && run.batchMs <= expected + STEP_MS);
+    }
+}
+
+// Una base de actuación que no cabe deja el prefijo truncado: cada PATCH
+// falla sin salir a la red en vez de ir a otro recurso
+TEST(RestTransport, OverlongActuationPrefixFailsEveryPatch) {
+    ActuationLog log;
+    std::string edgeURL = std::string(EDGE_URL) + std::string(HttpConnectionPool::MAX_URL_PREFIX, 'e') + "/";
+    RestTransport rest(API_URL, edgeURL.c_str(), "dev-1", "user-1");
+    rest.begin(&log);
+    WiFi.begin("test-ssid", "");
+    HostHttp::respond("PATCH", EDGE_URL, 200, "{}");
+
+    unsigned long requests = HostHttp::getRequests();
+    CHECK(rest.actuate(SENSOR_ID, "led_tv", true));
+    CHECK(rest.actuate(SENSOR_ID, "led_tv", false));
+    HostTasks::runForMs(500);
+    rest.update(millis(), true);
+
+    CHECK_EQ(HostHttp::getRequests(), requests);
+    CHECK_EQ(log.results.size(), (size_t)2);
+    CHECK_EQ(log.results[0].httpResponseCode, ActuationResult::URL_TOO_LONG);
+    CHECK_EQ(rest.getRejectedURLs(), 2ul);
+}
+
+// Un id que no cabe en el trabajo no se recorta (sería otro sensor): la
+// orden se rechaza y no sale ningún PATCH
+TEST(RestTransport, OverlongSensorIdIsNotEnqueued) {
+    ActuationLog log;
+    RestTransport rest(API_URL, EDGE_URL, "dev-1", "user-1");
+    rest.begin(&log);
+    WiFi.begin("test-ssid", "");
+    HostHttp::respond("PATCH", SENSORS_PREFIX, 200, "{}");
+
+    std::string longId = std::string(SENSOR_ID) + "-extra";
+    unsigned long requests = HostHttp::getRequests();
+    CHECK(!rest.actuate(longId.c_str(), "led_tv", true));
+    HostTasks::runForMs(500);
+    rest.update(millis(), true);
+    CHECK_EQ(HostHttp::getRequests(), requests);
+    CHECK_EQ(log.results.size(), (size_t)0);
+}
@@ -0,0 +1,136 @@
+#include "TestHarness.h"
+#include <map>
+#include <random>
+#include <vector>
+#include "Scheduler.h"
+
+struct CommandTrace : public CommandHandler {
+    std::vector<int> commands;
+
+    void handle(Command command) override { commands.push_back(command.id); }
+};
+
+TEST(Scheduler, RunsDueTasksInDeadlineOrder) {
+    Scheduler scheduler;
+    CommandTrace trace;
+    static const unsigned long DELAYS[] = {50, 10, 40, 0, 30, 20};
+    for (int i = 0; i < 6; i++) {
+        CHECK(scheduler.schedule(&trace, Command(i), 1000, DELAYS[i]) != Scheduler::INVALID_TASK);
+    }
+    CHECK_EQ(scheduler.timeUntilNext(1000), 0ul);
+    CHECK_EQ(scheduler.run(1025, 10), 3);
+    CHECK_EQ(scheduler.timeUntilNext(1025), 5ul);
+
+    // maxTasks acota lo que se ejecuta por llamada aunque haya más vencidas
+    CHECK_EQ(scheduler.run(2000, 2), 2);
+    CHECK_EQ(scheduler.run(2000, 2), 1);
+    CHECK_EQ(scheduler.getTaskCount(), 0);
+    static const int EXPECTED[] = {3, 1, 5, 4, 2, 0};
+    CHECK(trace.commands == std::vector<int>(EXPECTED, EXPECTED + 6));
+}
+
+// Un periodo se cuenta desde el deadline previsto, no desde cuándo se
+// ejecutó; con mucho retraso se saltan los periodos perdidos
+TEST(Scheduler, PeriodicTasksDoNotDrift) {
+    Scheduler scheduler;
+    CommandTrace trace;
+    scheduler.schedule(&trace, Command(1), 0, 100, 100);
+    CHECK_EQ(scheduler.run(130), 1);
+    CHECK_EQ(scheduler.timeUntilNext(130), 70ul);
+    CHECK_EQ(scheduler.run(199), 0);
+    CHECK_EQ(scheduler.run(200), 1);
+
+    CHECK_EQ(scheduler.run(1050), 1);
+    CHECK_EQ(scheduler.timeUntilNext(1050), 100ul);
+    CHECK_EQ(scheduler.run(1100), 0);
+    CHECK_EQ(scheduler.getTaskCount(), 1);
+}
+
+TEST(Scheduler, CancelSetPeriodAndReschedule) {
+    Scheduler scheduler;
+    CommandTrace trace;
+    int once = scheduler.schedule(&trace, Command(1), 0, 100);
+    int periodic = scheduler.schedule(&trace, Command(2), 0, 50, 50);
+    int other = scheduler.schedule(&trace, Command(3), 0, 70);
+
+    CHECK(scheduler.cancel(other));
+    CHECK(!scheduler.cancel(other));
+    CHECK(!scheduler.cancel(Scheduler::INVALID_TASK));
+
+    // El nuevo periodo cuenta desde now
+    CHECK(scheduler.setPeriod(periodic, 10, 500));
+    CHECK(scheduler.reschedule(once, 20));
+    CHECK_EQ(scheduler.run(20), 1);
+    CHECK_EQ(scheduler.run(509), 0);
+    CHECK_EQ(scheduler.run(510), 1);
+    CHECK(!scheduler.reschedule(once, 0));  // de una vez: ya no existe
+    CHECK(trace.commands == std::vector<int>({1, 2}));
+}
+
+TEST(Scheduler, RejectsWhenFullOrWithoutHandler) {
+    Scheduler scheduler;
+    CommandTrace trace;
+    CHECK_EQ(scheduler.schedule(nullptr, Command(0), 0, 0), Scheduler::INVALID_TASK);
+    int first = Scheduler::INVALID_TASK;
+    for (int i = 0; i < Scheduler::MAX_TASKS; i++) {
+        int id = scheduler.schedule(&trace, Command(i), 0, 10);
+        first = i == 0 ? id : first;
+        CHECK(id != Scheduler::INVALID_TASK);
+    }
+    CHECK_EQ(scheduler.schedule(&trace, Command(99), 0, 10), Scheduler::INVALID_TASK);
+    CHECK(scheduler.cancel(first));
+    CHECK(scheduler.schedule(&trace, Command(99), 0, 10) != Scheduler::INVALID_TASK);
+}
+
+// millis() da la vuelta cada 49 días: los deadlines se comparan por diferencia
+TEST(Scheduler, DeadlinesSurviveMillisWraparound) {
+    Scheduler scheduler;
+    CommandTrace trace;
+    unsigned long now = (unsigned long)-50;
+    scheduler.schedule(&trace, Command(1), now, 100, 100);
+    scheduler.schedule(&trace, Command(2), now, 20);
+    CHECK_EQ(scheduler.timeUntilNext(now), 20ul);
+    CHECK_EQ(scheduler.run(now + 20), 1);
+    CHECK_EQ(scheduler.run(now + 99), 0);
+    CHECK(now + 100 < now);
+    CHECK_EQ(scheduler.run(now + 100), 1);
+    CHECK_EQ(scheduler.timeUntilNext(now + 100), 100ul);
+}
+
+// Altas, bajas y cambios al azar frente a un modelo ordenado: el heap
+// entrega siempre la tarea de deadline más temprano
+TEST(Scheduler, HeapMatchesAnOrderedModel) {
+    std::mt19937 rng(11);
+    Scheduler scheduler;
+    CommandTrace trace;
+    std::map<int, unsigned long> model;  // id (y comando) -> deadline
+    int nextId = 0;
+    unsigned long now = 0;
+    for (int step = 0; step < 5000; step++) {
+        int action = rng() % 4;
+        if (action == 0 && (int)model.size() < Scheduler::MAX_TASKS) {
+            unsigned long delay = rng() % 1000;
+            CHECK_EQ(scheduler.schedule(&trace, Command(nextId), now, delay), nextId);
+            model[nextId++] = now + delay;
+        } else if (action == 1 && !model.empty()) {
+            auto victim = std::next(model.begin(), rng() % model.size());
+            CHECK(scheduler.cancel(victim->first));
+            model.erase(victim);
+        } else if (action == 2 && !model.empty()) {
+            auto moved = std::next(model.begin(), rng() % model.size());
+            moved->second = now + rng() % 1000;
+            CHECK(scheduler.reschedule(moved->first, moved->second));
+        } else if (!model.empty()) {
+            unsigned long earliest = (unsigned long)-1;
+            for (const auto& task : model) {
+                earliest = task.second < earliest ? task.second : earliest;
+            }
+            CHECK_EQ(scheduler.timeUntilNext(now), earliest > now ? earliest - now : 0);
+            now = earliest > now ? earliest : now;
+            CHECK_EQ(scheduler.run(now, 1), 1);
+            CHECK_EQ(model[trace.commands.back()], earliest);
+            model.erase(trace.commands.back());
+        }
+        CHECK_EQ(scheduler.getTaskCount(), (int)model.size());
+    }
+}
@@ -0,0 +1,49 @@
+#include "TestHarness.h"
+#include "SensorCache.h"
+
+// Ids de 36 caracteres, como los UUID del API
+static void sensorId(char* out, size_t size, int index) {
+    snprintf(out, size, "0b5e2d6c-1f3a-4c8e-9d2b-%012d", index);
+}
+
+TEST(SensorCache, HoldsAsManySensorsAsTheRegistry) {
+    CHECK_EQ(SensorCache::MAX_SENSORS, SensorRegistry::MAX_SENSORS);
+
+    SensorCache cache;
+    char id[40];
+    cache.beginSync();
+    for (int i = 0; i < SensorRegistry::MAX_SENSORS; i++) {
+        sensorId(id, sizeof(id), i);
+        CHECK(cache.apply(id, "smart_light", i & 1, 0));
+    }
+    cache.endSync(true, 0);
+    CHECK_EQ(cache.size(), SensorRegistry::MAX_SENSORS);
+
+    // El último sigue siendo actuable
+    sensorId(id, sizeof(id), SensorRegistry::MAX_SENSORS - 1);
+    CHECK(cache.setState(id, false, 10));
+
+    // Uno más no cabe, y no desplaza a ninguno
+    sensorId(id, sizeof(id), SensorRegistry::MAX_SENSORS);
+    CHECK(!cache.apply(id, "smart_light", true, 20));
+    CHECK_EQ(cache.size(), SensorRegistry::MAX_SENSORS);
+}
+
+TEST(SensorCache, FullSnapshotRemovesMissing) {
+    SensorCache cache;
+    char id[40];
+    cache.beginSync();
+    for (int i = 0; i < 40; i++) {
+        sensorId(id, sizeof(id), i);
+        cache.apply(id, "smart_light", false, 0);
+    }
+    cache.endSync(true, 0);
+
+    cache.beginSync();
+    for (int i = 0; i < 30; i++) {
+        sensorId(id, sizeof(id), i);
+        cache.apply(id, "smart_light", false, 100);
+    }
+    CHECK_EQ(cache.endSync(true, 100), 10);
+    CHECK_EQ(cache.size(), 30);
+}
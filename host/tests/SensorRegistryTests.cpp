@@ -0,0 +1,78 @@
+#include "TestHarness.h"
+#include <string>
+#include "SensorRegistry.h"
+
+// Dos ids con el mismo FNV-1a de 32 bits (0x827d4ac2)
+static const char* COLLIDING_A = "sensor-539599";
+static const char* COLLIDING_B = "sensor-722382";
+
+TEST(SensorRegistry, CollidingIdsStayTwoSensors) {
+    SensorRegistry registry;
+    CHECK(registry.set(COLLIDING_A, "led_tv", true));
+    CHECK(registry.set(COLLIDING_B, "air_conditioner", false));
+    CHECK_EQ(registry.getSensorCount(), (uint8_t)2);
+    CHECK(registry.isActive(COLLIDING_A));
+    CHECK(!registry.isActive(COLLIDING_B));
+
+    // Actuar sobre uno no toca al otro
+    CHECK(registry.set(COLLIDING_B, "air_conditioner", true));
+    CHECK(registry.set(COLLIDING_A, "led_tv", false));
+    CHECK(!registry.isActive(COLLIDING_A));
+    CHECK(registry.isActive(COLLIDING_B));
+    CHECK_EQ(registry.countActive(registry.findType("led_tv")), (uint8_t)0);
+    CHECK_EQ(registry.countActive(registry.findType("air_conditioner")), (uint8_t)1);
+}
+
+TEST(SensorRegistry, CountsActiveSensorsPerType) {
+    SensorRegistry registry;
+    registry.set("s-1", "led_tv", true);
+    registry.set("s-2", "led_tv", true);
+    registry.set("s-3", "smart_light", false);
+    uint8_t tv = registry.findType("led_tv");
+    uint8_t light = registry.findType("smart_light");
+    CHECK_EQ(registry.countActive(tv), (uint8_t)2);
+    CHECK(!registry.isTypeActive(light));
+
+    // Cambiar de tipo o de estado mueve la cuenta, no la duplica
+    registry.set("s-2", "smart_light", true);
+    registry.set("s-2", "smart_light", true);
+    CHECK_EQ(registry.countActive(tv), (uint8_t)1);
+    CHECK_EQ(registry.countActive(light), (uint8_t)1);
+    CHECK_EQ(registry.getSensorCount(), (uint8_t)3);
+
+    registry.setAllInactive();
+    CHECK(!registry.isTypeActive(tv));
+    CHECK(!registry.isActive("s-1"));
+
+    // clear() vacía los sensores pero conserva los tipos internados
+    registry.clear();
+    CHECK_EQ(registry.getSensorCount(), (uint8_t)0);
+    CHECK_EQ(registry.findType("led_tv"), tv);
+    CHECK_STREQ(registry.getTypeName(light), "smart_light");
+}
+
+TEST(SensorRegistry, RejectsWhatDoesNotFit) {
+    SensorRegistry registry;
+    std::string longId(SensorRegistry::MAX_ID, 'x');
+    CHECK(!registry.set(longId.c_str(), "led_tv", true));
+    CHECK(!registry.set("", "led_tv", true));
+    CHECK(!registry.isActive(longId.c_str()));
+
+    char id[16];
+    for (int i = 0; i < SensorRegistry::MAX_SENSORS; i++) {
+        snprintf(id, sizeof(id), "s-%02d", i);
+        CHECK(registry.set(id, "led_tv", true));
+    }
+    CHECK(!registry.set("s-extra", "led_tv", true));
+    CHECK(registry.set("s-00", "led_tv", false));  // actualizar sigue funcionando
+    CHECK_EQ(registry.countActive(registry.findType("led_tv")), (uint8_t)(SensorRegistry::MAX_SENSORS - 1));
+
+    for (int i = 0; i < SensorRegistry::MAX_TYPES; i++) {
+        snprintf(id, sizeof(id), "tipo-%d", i);
+        registry.intern(id);
+    }
+    CHECK_EQ(registry.getTypeCount(), (uint8_t)SensorRegistry::MAX_TYPES);
+    CHECK_EQ(registry.intern("otro_tipo"), SensorRegistry::NO_TYPE);
+    std::string longType(SensorRegistry::MAX_TYPE_NAME, 't');
+    CHECK_EQ(registry.intern(longType.c_str()), SensorRegistry::NO_TYPE);
+}
@@ -0,0 +1,94 @@
+#include "TestHarness.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "StateSnapshot.h"
+
+// Campos de anchos distintos (el de 64 bits como totalJitterUs) derivados
+// del mismo contador: una copia mezclada de dos escrituras no cuadra
+struct SnapshotSample {
+    uint32_t counter;
+    uint8_t low;
+    uint16_t doubled;
+    uint64_t squared;
+    uint32_t check;
+};
+
+static SnapshotSample sampleFor(uint32_t counter) {
+    SnapshotSample sample;
+    sample.counter = counter;
+    sample.low = (uint8_t)counter;
+    sample.doubled = (uint16_t)(counter * 2);
+    sample.squared = (uint64_t)counter * counter;
+    sample.check = ~counter;
+    return sample;
+}
+
+TEST(StateSnapshot, VersionIsEvenAndAdvancesPerPublish) {
+    StateSnapshot<SnapshotSample> snapshot;
+    SnapshotSample sample;
+    CHECK_EQ(snapshot.read(sample), 0u);
+    CHECK_EQ(sample.counter, 0u);
+    CHECK_EQ(sample.squared, 0ull);
+
+    snapshot.publish(sampleFor(7));
+    CHECK_EQ(snapshot.getVersion(), 2u);
+    CHECK_EQ(snapshot.read(sample), 2u);
+    CHECK_EQ(sample.squared, 49ull);
+    CHECK_EQ(sample.check, ~7u);
+}
+
+// Un escritor y dos lectores en hilos reales: cada copia leída es una
+// publicación completa y las versiones no retroceden
+TEST(StateSnapshot, ReadersSeeCoherentCopiesUnderThreads) {
+    static const int READERS = 2;
+    static const uint32_t PUBLISHES = 200000;
+    static StateSnapshot<SnapshotSample> snapshot;
+    snapshot.publish(sampleFor(0));
+
+    std::atomic<bool> done(false);
+    std::atomic<int> ready(0);
+    std::atomic<unsigned long> torn(0);
+    std::atomic<unsigned long> reads(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&]() {
+            uint32_t lastVersion = 0;
+            uint32_t lastCounter = 0;
+            ready.fetch_add(1);
+            while (!done.load()) {
+                SnapshotSample sample;
+                uint32_t version = snapshot.read(sample);
+                SnapshotSample expected = sampleFor(sample.counter);
+                bool coherent = sample.low == expected.low && sample.doubled == expected.doubled &&
+                                sample.squared == expected.squared && sample.check == expected.check;
+                if (!coherent || (version & 1) || version < lastVersion || sample.counter < lastCounter) {
+                    torn.fetch_add(1);
+                }
+                lastVersion = version;
+                lastCounter = sample.counter;
+                reads.fetch_add(1);
+            }
+        });
+    }
+    while (ready.load() < READERS) {
+        std::this_thread::yield();
+    }
+
+    for (uint32_t i = 1; i <= PUBLISHES; i++) {
+        snapshot.publish(sampleFor(i));
+        if ((i & 1023) == 0) {
+            std::this_thread::yield();  // con un solo núcleo los lectores también corren
+        }
+    }
+    done.store(true);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    CHECK_EQ(torn.load(), 0ul);
+    CHECK(reads.load() > 0);
+    SnapshotSample last;
+    CHECK_EQ(snapshot.read(last), (PUBLISHES + 1) * 2);
+    CHECK_EQ(last.counter, PUBLISHES);
+}
@@ -0,0 +1,120 @@
+#include "TestHarness.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Una prueba colgada (p. ej. un bloqueo entre hilos) no debe parar ctest
+static const unsigned TEST_TIMEOUT_S = 60;
+
+static std::atomic<unsigned long long> allocations(0);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+unsigned long long TestAllocs::count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+struct TestCase {
+    const char* name;
+    TestBody body;
+};
+
+// Se construye en el primer add(): los registradores son estáticos de otros ficheros
+static std::vector<TestCase>& tests() {
+    static std::vector<TestCase> registered;
+    return registered;
+}
+
+static int failures = 0;
+
+void TestRegistry::add(const char* name, TestBody body) {
+    tests().push_back({name, body});
+}
+
+void TestRegistry::list(FILE* out) {
+    for (const TestCase& test : tests()) {
+        fprintf(out, "%s\n", test.name);
+    }
+}
+
+void TestRegistry::fail(const char* file, int line, const std::string& message) {
+    failures++;
+    fprintf(stderr, "    %s:%d: %s\n", file, line, message.c_str());
+}
+
+int TestRegistry::run(const char* filter) {
+    size_t prefixLength = filter != nullptr ? strlen(filter) : 0;
+    int ran = 0;
+    int failed = 0;
+
+    for (const TestCase& test : tests()) {
+        if (prefixLength > 0 && strncmp(test.name, filter, prefixLength) != 0) {
+            continue;
+        }
+        ran++;
+        fflush(nullptr);
+
+        pid_t child = fork();
+        if (child < 0) {
+            perror("fork");
+            return failed + 1;
+        }
+        if (child == 0) {
+            alarm(TEST_TIMEOUT_S);
+            test.body();
+            fflush(nullptr);
+            _exit(failures > 0 ? 1 : 0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (passed) {
+            fprintf(stderr, "[  OK  ] %s\n", test.name);
+        } else if (WIFSIGNALED(status)) {
+            fprintf(stderr, "[ FALLA] %s (señal %d)\n", test.name, WTERMSIG(status));
+        } else {
+            fprintf(stderr, "[ FALLA] %s\n", test.name);
+        }
+        if (!passed) {
+            failed++;
+        }
+    }
+
+    fprintf(stderr, "%d pruebas, %d fallidas\n", ran, failed);
+    if (ran == 0) {
+        fprintf(stderr, "Ninguna prueba coincide con \"%s\"\n", filter != nullptr ? filter : "");
+        return 1;
+    }
+    return failed;
+}
@@ -0,0 +1,70 @@
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+// Reservas de memoria dinámica desde el arranque (operator new global)
+namespace TestAllocs {
+    unsigned long long count();
+}
+
+typedef void (*TestBody)();
+
+// Pruebas registradas con TEST(suite, nombre). Cada una corre en su propio
+// proceso: los shims (reloj virtual, WiFi, HTTP, LittleFS) son globales y
+// así una prueba no hereda el estado de la anterior ni la tumba si revienta
+class TestRegistry {
+public:
+    static void add(const char* name, TestBody body);
+    static void list(FILE* out);
+    // Ejecuta las pruebas cuyo nombre empieza por filter; devuelve los fallos
+    static int run(const char* filter);
+    static void fail(const char* file, int line, const std::string& message);
+};
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, TestBody body) {
+        TestRegistry::add(name, body);
+    }
+};
+
+#define TEST(suite, name)                                                                         \
+    static void test_##suite##_##name();                                                          \
+    static TestRegistrar registrar_##suite##_##name(#suite "/" #name, test_##suite##_##name);     \
+    static void test_##suite##_##name()
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            TestRegistry::fail(__FILE__, __LINE__, "CHECK(" #condition ")");    \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                          \
+    do {                                                                                    \
+        auto actualValue = (actual);                                                        \
+        auto expectedValue = (expected);                                                    \
+        if (!(actualValue == expectedValue)) {                                              \
+            std::ostringstream message;                                                     \
+            message << "CHECK_EQ(" #actual ", " #expected "): " << actualValue << " != "    \
+                    << expectedValue;                                                       \
+            TestRegistry::fail(__FILE__, __LINE__, message.str());                          \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_STREQ(actual, expected)                                                       \
+    do {                                                                                    \
+        const char* actualText = (actual);                                                  \
+        const char* expectedText = (expected);                                              \
+        if (strcmp(actualText, expectedText) != 0) {                                        \
+            std::ostringstream message;                                                     \
+            message << "CHECK_STREQ(" #actual ", " #expected "): \"" << actualText          \
+                    << "\" != \"" << expectedText << "\"";                                  \
+            TestRegistry::fail(__FILE__, __LINE__, message.str());                          \
+        }                                                                                   \
+    } while (0)
+
+#endif
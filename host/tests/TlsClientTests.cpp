@@ -0,0 +1,134 @@
+#include "TestHarness.h"
+#include <Arduino.h>
+#include <HostClock.h>
+#include <esp_tls.h>
+#include <string>
+#include "TlsClient.h"
+
+static const char* CA_PEM = "-----BEGIN CERTIFICATE-----\nMIIB\n-----END CERTIFICATE-----\n";
+static const char* API_HOST = "api.geoentry.local";
+
+TEST(TlsClient, WithoutTrustAnchorFallsBackToWiFiClientSecure) {
+    CHECK(!TlsClient::setTrustAnchor(""));
+    CHECK(!TlsClient::isTrustConfigured());
+    WiFiClient* insecure = TlsClient::createSecureClient();
+    CHECK(dynamic_cast<TlsClient*>(insecure) == nullptr);
+    CHECK(dynamic_cast<WiFiClientSecure*>(insecure) != nullptr);
+    delete insecure;
+
+    CHECK(TlsClient::setTrustAnchor(CA_PEM));
+    WiFiClient* verified = TlsClient::createSecureClient();
+    CHECK(dynamic_cast<TlsClient*>(verified) != nullptr);
+    delete verified;
+}
+
+// Sólo el primer handshake con un host es completo: los siguientes ofrecen
+// el último ticket y cada ticket nuevo sustituye (y libera) al anterior
+TEST(TlsClient, ResumesWithTheLatestTicket) {
+    CHECK(TlsClient::setTrustAnchor(CA_PEM));
+    HostTls::listen(API_HOST, 443);
+    TlsClient client;
+
+    CHECK(client.connect(API_HOST, 443));
+    CHECK_EQ(HostTls::getOfferedTicket(), 0);
+    client.stop();
+    CHECK(client.connect(API_HOST, 443));
+    CHECK_EQ(HostTls::getOfferedTicket(), 1);
+
+    // Otro cliente (otra tarea) reanuda la misma sesión
+    TlsClient worker;
+    CHECK(worker.connect(API_HOST, 443, 2000));
+    CHECK_EQ(HostTls::getOfferedTicket(), 2);
+    CHECK_EQ(HostTls::getLiveSessions(), 1);
+
+    const TlsStats& stats = TlsClient::getStats();
+    CHECK_EQ(stats.handshakes, 1ul);
+    CHECK_EQ(stats.resumptions, 2ul);
+    CHECK_EQ(stats.sessionsSaved, 3ul);
+    CHECK_EQ(stats.failures, 0ul);
+
+    TlsClient::forgetSessions();
+    CHECK_EQ(HostTls::getLiveSessions(), 0);
+    CHECK(client.connect(API_HOST, 443));
+    CHECK_EQ(HostTls::getOfferedTicket(), 0);
+}
+
+// MAX_SESSIONS hosts: el tercero desplaza al usado hace más tiempo
+TEST(TlsClient, EvictsTheLeastRecentlyUsedHost) {
+    CHECK(TlsClient::setTrustAnchor(CA_PEM));
+    TlsClient client;
+    static const char* HOSTS[] = {"a.geoentry.local", "b.geoentry.local", "c.geoentry.local"};
+    for (const char* host : HOSTS) {
+        HostTls::listen(host, 443);
+        CHECK(client.connect(host, 443));
+        HostClock::advanceMs(1000);
+    }
+    CHECK_EQ(HostTls::getLiveSessions(), TlsClient::MAX_SESSIONS);
+
+    HostTls::listen(HOSTS[1], 443);
+    CHECK(client.connect(HOSTS[1], 443));
+    CHECK(HostTls::getOfferedTicket() != 0);
+    HostTls::listen(HOSTS[0], 443);
+    CHECK(client.connect(HOSTS[0], 443));
+    CHECK_EQ(HostTls::getOfferedTicket(), 0);
+    CHECK_EQ(HostTls::getLiveSessions(), TlsClient::MAX_SESSIONS);
+}
+
+// Un handshake fallido descarta el ticket ofrecido; sin CA, con un host
+// demasiado largo o por IP no se intenta
+TEST(TlsClient, FailedHandshakeDropsTheTicket) {
+    TlsClient client;
+    HostTls::listen(API_HOST, 443);
+    CHECK(!client.connect(API_HOST, 443));
+    CHECK_EQ(HostTls::getHandshakes(), 0ul);
+
+    CHECK(TlsClient::setTrustAnchor(CA_PEM));
+    CHECK(client.connect(API_HOST, 443));
+    HostTls::listen(API_HOST, 8443);
+    CHECK(!client.connect(API_HOST, 443));
+    CHECK_EQ(TlsClient::getStats().failures, 1ul);
+    CHECK_EQ(HostTls::getLiveSessions(), 0);
+    CHECK(!client.connected());
+
+    HostTls::listen(API_HOST, 443);
+    CHECK(client.connect(API_HOST, 443));
+    CHECK_EQ(HostTls::getOfferedTicket(), 0);
+
+    std::string longHost(TlsClient::MAX_HOST, 'h');
+    HostTls::listen(longHost.c_str(), 443);
+    CHECK(!client.connect(longHost.c_str(), 443));
+    CHECK(!client.connect(IPAddress(10, 0, 0, 1), 443));
+    CHECK_EQ(HostTls::getHandshakes(), 2ul);
+}
+
+// E/S a través del buffer de recepción: lectura, peek, escritura y cierre
+// del servidor con datos aún sin leer
+TEST(TlsClient, ReadsWritesAndSeesThePeerClose) {
+    CHECK(TlsClient::setTrustAnchor(CA_PEM));
+    HostTls::listen(API_HOST, 443);
+    TlsClient client;
+    CHECK(client.connect(API_HOST, 443));
+    CHECK(client.connected());
+    CHECK_EQ(client.available(), 0);
+    CHECK_EQ(client.read(), -1);
+
+    CHECK_EQ(client.print("GET / HTTP/1.1\r\n\r\n"), (size_t)18);
+    CHECK_STREQ(HostTls::getReceived(), "GET / HTTP/1.1\r\n\r\n");
+
+    std::string large(TlsClient::RX_BUFFER_SIZE + 100, 'x');
+    HostTls::send("HTTP/1.1 200 OK\r\n");
+    HostTls::send(large.c_str());
+    CHECK(client.available() > 0);
+    CHECK_EQ(client.peek(), (int)'H');
+    char status[18] = {};
+    CHECK_EQ(client.read((uint8_t*)status, 17), 17);
+    CHECK_STREQ(status, "HTTP/1.1 200 OK\r\n");
+
+    HostTls::close();
+    CHECK(client.connected());  // quedan datos sin leer
+    uint8_t body[1024];
+    CHECK_EQ(client.read(body, sizeof(body)), (int)large.size());
+    CHECK(!client.connected());
+    CHECK_EQ(client.read(), -1);
+    CHECK_EQ(client.write((uint8_t)'x'), (size_t)0);
+}
@@ -0,0 +1,134 @@
+#include "TestHarness.h"
+#include <WiFi.h>
+#include "WiFiConnection.h"
+
+static const Event CONNECTED(1);
+static const Event DISCONNECTED(2);
+
+struct EventLog : public EventHandler {
+    int connected = 0;
+    int disconnected = 0;
+
+    void on(Event event) override {
+        if (event == CONNECTED) {
+            connected++;
+        } else if (event == DISCONNECTED) {
+            disconnected++;
+        }
+    }
+};
+
+// Conexión manual: begin() deja el intento en CONNECTING hasta que la prueba
+// emite los eventos del driver
+static void beginManual(WiFiConnection& wifi, unsigned long now) {
+    HostWiFi::setAutoConnect(false);
+    wifi.begin(now);
+}
+
+TEST(WiFiConnection, ConnectsOnGotIp) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+
+    HostWiFi::connect();
+    wifi.update(100);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTED);
+    CHECK_EQ(log.connected, 1);
+}
+
+TEST(WiFiConnection, DropBetweenGotIpAndUpdateIsNotConnected) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+
+    // GOT_IP y DISCONNECTED antes de update(): el último manda
+    HostWiFi::connect();
+    HostWiFi::drop();
+    wifi.update(100);
+    CHECK(wifi.getState() != WiFiConnection::CONNECTED);
+    CHECK_EQ(log.connected, 0);
+}
+
+TEST(WiFiConnection, DropAfterStaleDisconnectStillConnects) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+
+    // Una caída anterior al GOT_IP no anula la conexión
+    HostWiFi::fail(WIFI_REASON_BEACON_TIMEOUT);
+    HostWiFi::connect();
+    wifi.update(100);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTED);
+}
+
+TEST(WiFiConnection, AuthFailureFailsImmediately) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "mala", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+
+    HostWiFi::fail(WIFI_REASON_AUTH_FAIL);
+    wifi.update(50);
+    CHECK_EQ(wifi.getState(), WiFiConnection::BACKOFF);
+
+    // Y tras el backoff lo vuelve a intentar
+    wifi.update(50 + WiFiConnection::MIN_BACKOFF);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+}
+
+TEST(WiFiConnection, AuthFailureWithCachedApRescans) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+    HostWiFi::connect();
+    wifi.update(10);
+    HostWiFi::drop();
+    wifi.update(20);
+    CHECK_EQ(log.disconnected, 1);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+
+    // El AP cacheado rechaza: se olvida y se escanea en el acto, sin backoff
+    HostWiFi::fail(WIFI_REASON_NO_AP_FOUND);
+    wifi.update(30);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+    HostWiFi::connect();
+    wifi.update(40);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTED);
+    CHECK_EQ(log.connected, 2);
+}
+
+TEST(WiFiConnection, OwnDisconnectIsIgnoredWhileConnecting) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+
+    HostWiFi::fail(WIFI_REASON_ASSOC_LEAVE);
+    wifi.update(50);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+}
+
+TEST(WiFiConnection, ConnectTimeoutEntersBackoff) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+
+    wifi.update(WiFiConnection::CONNECT_TIMEOUT - 1);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+    wifi.update(WiFiConnection::CONNECT_TIMEOUT);
+    CHECK_EQ(wifi.getState(), WiFiConnection::BACKOFF);
+}
+
+TEST(WiFiConnection, LostLinkWithoutEventIsDetected) {
+    EventLog log;
+    WiFiConnection wifi("ssid", "clave", CONNECTED, DISCONNECTED, &log);
+    beginManual(wifi, 0);
+    HostWiFi::connect();
+    wifi.update(10);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTED);
+
+    // El driver perdió el enlace y el evento no llegó
+    HostWiFi::setStatus(WL_CONNECTION_LOST);
+    wifi.update(20);
+    CHECK_EQ(log.disconnected, 1);
+    CHECK_EQ(wifi.getState(), WiFiConnection::CONNECTING);
+}
@@ -0,0 +1,28 @@
+#include "TestHarness.h"
+#include <cstring>
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Uso: %s [--filter prefijo] [--list]\n"
+            "  --filter  sólo las pruebas cuyo nombre (suite/prueba) empiece por el prefijo\n"
+            "  --list    muestra las pruebas registradas\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            TestRegistry::list(stdout);
+            return 0;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    return TestRegistry::run(filter) == 0 ? 0 : 1;
+}
@@ -32,6 +32,7 @@
  */
 
 #include "GeoEntryDevice.h"
+#include "MqttTransport.h"
 
 // Configuración de red y API
 const String WIFI_SSID = "Wokwi-GUEST";
@@ -42,6 +43,10 @@ const String API_URL = "https://geoentry-edge-api.onrender.com/api/v1/";
 const String DEVICE_ID = "7b4cdbcd-2bf0-4047-9355-05e33babf2c9";
 const String USER_ID = "dd380cd7-852b-4855-9c68-c45f71b62521";
 
+// Transporte MQTT opcional (vacío = REST). En Wokwi el broker local es
+// mqtt://host.wokwi.internal:1883
+const String MQTT_BROKER = "";
+
 // Instancia del dispositivo
 GeoEntryDevice* device;
 
@@ -53,6 +58,9 @@ void setup() {
     
     // Crear e inicializar el dispositivo
     device = new GeoEntryDevice(WIFI_SSID, WIFI_PASSWORD, API_URL, DEVICE_ID, USER_ID);
+    if (!MQTT_BROKER.isEmpty()) {
+        device->setTransport(new MqttTransport(MQTT_BROKER, DEVICE_ID, USER_ID));
+    }
     device->init();
     
     Serial.println("\n📱 Configuración:");
@@ -0,0 +1,318 @@
+#!/usr/bin/env python3
+"""Servidor local que imita el Edge API de GeoEntry para pruebas del firmware.
+
+Endpoints que usa el dispositivo:
+  GET   /api/v1/proximity-events/device/{id}[?since={eventId}]  (ETag / 304)
+  GET   /api/v1/proximity-events/device/{id}/stream             (Server-Sent Events)
+  GET   /sensors/user/{id}                                      (ETag / 304)
+  PATCH /sensors/{id}/status                                    {"isActive": bool}
+
+Endpoints de control:
+  POST  /admin/events    {"event_type": "enter"|"exit", "distance": 12.5}
+  GET   /admin/latency   latencia evento -> primer / último PATCH (ms)
+
+Carga: --latency-ms/--jitter-ms retrasan cada respuesta del API, --error-rate
+devuelve 503 a esa fracción de peticiones (con --retry-after añaden la
+cabecera Retry-After en segundos), --history y --pad-bytes agrandan
+las listas de eventos. --record guarda los eventos recibidos como líneas JSON
+({"t_ms", "event_type", "distance"}) y --replay las vuelve a crear con la
+misma cadencia; es el formato que lee host/replay (geoentry_replay).
+
+Uso:
+  python3 tools/geoentry_stand_in.py --port 8080 --sensors 4
+  curl -X POST localhost:8080/admin/events -d '{"event_type": "enter"}'
+  curl localhost:8080/admin/latency
+  python3 tools/geoentry_stand_in.py --latency-ms 80 --jitter-ms 40 --replay host/replay/commute.jsonl
+"""
+
+import argparse
+import hashlib
+import json
+import random
+import re
+import threading
+import time
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+SENSOR_TYPES = ["led_tv", "smart_light", "air_conditioner", "coffee_maker"]
+HEARTBEAT_SECONDS = 15
+
+
+class State:
+    def __init__(self, args):
+        self.lock = threading.Condition()
+        self.events = []  # más reciente primero
+        self.sensors = {}
+        self.latency = {}  # event_id -> {"created": t, "patches": [t, ...]}
+        self.args = args
+        self.random = random.Random(args.seed)
+        self.record_file = open(args.record, "a") if args.record else None
+        self.record_start = None
+        for i in range(args.sensors):
+            sensor_id = str(uuid.uuid4())
+            self.sensors[sensor_id] = {
+                "id": sensor_id,
+                "name": "Sensor %d" % (i + 1),
+                "sensor_type": SENSOR_TYPES[i % len(SENSOR_TYPES)],
+                "isActive": False,
+            }
+        # Historial previo: sin latencias asociadas
+        for i in range(args.history):
+            self.events.insert(0, self.make_event("enter" if i % 2 == 0 else "exit", 8.0 if i % 2 == 0 else 250.0))
+
+    def make_event(self, event_type, distance):
+        event = {
+            "event_id": str(uuid.uuid4()),
+            "event_type": event_type,
+            "distance": distance,
+            "home_location_name": "Casa",
+            "created_at": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        }
+        if self.args.pad_bytes > 0:
+            event["notes"] = "x" * self.args.pad_bytes
+        return event
+
+    def add_event(self, event_type, distance):
+        with self.lock:
+            event = self.make_event(event_type, distance)
+            self.events.insert(0, event)
+            self.latency[event["event_id"]] = {"created": time.monotonic(), "patches": []}
+            self.record(event)
+            self.lock.notify_all()
+            return event
+
+    def record(self, event):
+        if self.record_file is None:
+            return
+        now = time.monotonic()
+        if self.record_start is None:
+            self.record_start = now
+        line = {"t_ms": int((now - self.record_start) * 1000), "event_type": event["event_type"],
+                "distance": event["distance"]}
+        self.record_file.write(json.dumps(line) + "\n")
+        self.record_file.flush()
+
+    def response_delay(self):
+        """Latencia simulada y si la petición debe fallar con 503."""
+        with self.lock:
+            delay_ms = self.args.latency_ms + self.random.uniform(0, self.args.jitter_ms)
+            fail = self.random.random() < self.args.error_rate
+        return delay_ms / 1000.0, fail
+
+    def events_since(self, since):
+        with self.lock:
+            if not since:
+                return list(self.events)
+            for index, event in enumerate(self.events):
+                if event["event_id"] == since:
+                    return self.events[:index]
+            return list(self.events)
+
+    def record_patch(self, sensor_id, is_active):
+        with self.lock:
+            if sensor_id not in self.sensors:
+                return False
+            self.sensors[sensor_id]["isActive"] = is_active
+            entry = self.latency.get(self.events[0]["event_id"]) if self.events else None
+            if entry is not None:
+                entry["patches"].append(time.monotonic())
+            return True
+
+    def latency_report(self):
+        with self.lock:
+            first, last, rows = [], [], []
+            for event in reversed(self.events):
+                entry = self.latency.get(event["event_id"])
+                if entry is None or not entry["patches"]:
+                    continue
+                first_ms = (entry["patches"][0] - entry["created"]) * 1000
+                last_ms = (entry["patches"][-1] - entry["created"]) * 1000
+                first.append(first_ms)
+                last.append(last_ms)
+                rows.append({
+                    "event_id": event["event_id"],
+                    "event_type": event["event_type"],
+                    "first_patch_ms": round(first_ms, 1),
+                    "last_patch_ms": round(last_ms, 1),
+                    "patches": len(entry["patches"]),
+                })
+            return {
+                "events": rows,
+                "first_patch_ms": percentiles(first),
+                "last_patch_ms": percentiles(last),
+            }
+
+
+def percentiles(values):
+    if not values:
+        return {}
+    ordered = sorted(values)
+
+    def pick(p):
+        return round(ordered[min(len(ordered) - 1, int(p * len(ordered)))], 1)
+
+    return {"p50": pick(0.50), "p99": pick(0.99), "max": round(ordered[-1], 1), "n": len(ordered)}
+
+
+def replay(state, path, speed):
+    """Crea los eventos grabados en path respetando sus instantes (t_ms / speed)."""
+    with open(path) as source:
+        lines = [json.loads(line) for line in source if line.strip() and not line.lstrip().startswith("#")]
+    start = time.monotonic()
+    for line in lines:
+        wait = start + line["t_ms"] / 1000.0 / speed - time.monotonic()
+        if wait > 0:
+            time.sleep(wait)
+        event = state.add_event(line["event_type"], line.get("distance", 0))
+        print("replay: %s %s" % (event["event_type"], event["event_id"]))
+    print("replay: %d eventos; latencias en /admin/latency" % len(lines))
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive para el pool de conexiones
+    state = None
+
+    def log_message(self, fmt, *args):
+        print("%s %s" % (self.address_string(), fmt % args))
+
+    def send_json(self, payload, status=200, retry_after=0):
+        body = json.dumps(payload).encode()
+        etag = '"%s"' % hashlib.sha1(body).hexdigest()[:16]
+        if status == 200 and self.headers.get("If-None-Match") == etag:
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("ETag", etag)
+        if retry_after > 0:
+            self.send_header("Retry-After", str(retry_after))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def simulate_load(self):
+        """Aplica latencia y errores simulados; True si ya se respondió con 503."""
+        delay, fail = self.state.response_delay()
+        if delay > 0:
+            time.sleep(delay)
+        if fail:
+            self.read_json()  # consumir el cuerpo para no romper el keep-alive
+            self.send_json({"error": "unavailable"}, 503, self.state.args.retry_after)
+        return fail
+
+    def read_json(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        raw = self.rfile.read(length) if length else b"{}"
+        try:
+            return json.loads(raw or b"{}")
+        except ValueError:
+            return None
+
+    def do_GET(self):
+        path, _, query = self.path.partition("?")
+        params = dict(p.split("=", 1) for p in query.split("&") if "=" in p)
+
+        if path.startswith("/admin/"):
+            pass
+        elif not path.endswith("/stream") and self.simulate_load():
+            return
+
+        if re.fullmatch(r"/api/v1/proximity-events/device/[^/]+/stream", path):
+            self.stream_events()
+        elif re.fullmatch(r"/api/v1/proximity-events/device/[^/]+", path):
+            self.send_json(self.state.events_since(params.get("since")))
+        elif re.fullmatch(r"/sensors/user/[^/]+", path):
+            with self.state.lock:
+                sensors = [dict(s) for s in self.state.sensors.values()]
+            self.send_json(sensors)
+        elif path == "/admin/latency":
+            self.send_json(self.state.latency_report())
+        else:
+            self.send_json({"error": "not found"}, 404)
+
+    def do_PATCH(self):
+        if self.simulate_load():
+            return
+        match = re.fullmatch(r"/sensors/([^/]+)/status", self.path)
+        payload = self.read_json()
+        if not match or payload is None or "isActive" not in payload:
+            self.send_json({"error": "bad request"}, 400)
+        elif self.state.record_patch(match.group(1), bool(payload["isActive"])):
+            self.send_json({"id": match.group(1), "isActive": bool(payload["isActive"])})
+        else:
+            self.send_json({"error": "not found"}, 404)
+
+    def do_POST(self):
+        payload = self.read_json()
+        if self.path != "/admin/events" or payload is None:
+            self.send_json({"error": "bad request"}, 400)
+            return
+        event = self.state.add_event(payload.get("event_type", "enter"), payload.get("distance", 0))
+        self.send_json(event, 201)
+
+    def stream_events(self):
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream")
+        self.send_header("Cache-Control", "no-cache")
+        self.send_header("Connection", "close")
+        self.end_headers()
+        self.close_connection = True
+
+        pending = self.state.events_since(self.headers.get("Last-Event-ID"))
+        last_seen = pending[0]["event_id"] if pending else (
+            self.state.events[0]["event_id"] if self.state.events else None)
+        try:
+            if self.headers.get("Last-Event-ID"):
+                for event in reversed(pending):
+                    self.write_event(event)
+            while True:
+                with self.state.lock:
+                    self.state.lock.wait(HEARTBEAT_SECONDS)
+                    fresh = self.state.events_since(last_seen) if last_seen else list(self.state.events)
+                if fresh:
+                    for event in reversed(fresh):
+                        self.write_event(event)
+                    last_seen = fresh[0]["event_id"]
+                else:
+                    self.wfile.write(b": ping\n\n")
+                    self.wfile.flush()
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+
+    def write_event(self, event):
+        self.wfile.write(("id: %s\ndata: %s\n\n" % (event["event_id"], json.dumps(event))).encode())
+        self.wfile.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--sensors", type=int, default=4)
+    parser.add_argument("--latency-ms", type=float, default=0, help="latencia base de cada respuesta")
+    parser.add_argument("--jitter-ms", type=float, default=0, help="+ uniforme en [0, jitter]")
+    parser.add_argument("--error-rate", type=float, default=0, help="fracción de peticiones con 503")
+    parser.add_argument("--retry-after", type=int, default=0, help="segundos de Retry-After en los 503")
+    parser.add_argument("--history", type=int, default=0, help="eventos antiguos al arrancar")
+    parser.add_argument("--pad-bytes", type=int, default=0, help="relleno por evento (campo notes)")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--record", metavar="FICHERO", help="añade los eventos recibidos como JSON lines")
+    parser.add_argument("--replay", metavar="FICHERO", help="crea los eventos grabados en su instante")
+    parser.add_argument("--speed", type=float, default=1.0, help="factor de velocidad de --replay")
+    args = parser.parse_args()
+
+    Handler.state = State(args)
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.daemon_threads = True
+    print("GeoEntry stand-in escuchando en http://%s:%d/ (%d sensores)" % (args.host, args.port, args.sensors))
+    if args.replay:
+        threading.Thread(target=replay, args=(Handler.state, args.replay, args.speed), daemon=True).start()
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Imita el backend de GeoEntry sobre un broker MQTT local (p. ej. mosquitto).
+#
+# Publica como retenidos los sensores del usuario (todos apagados) y aplica
+# cada comando .../set que publica el dispositivo, volviendo a publicar el
+# estado retenido del sensor como haría el backend.
+#
+# Uso:
+#   mosquitto -v &
+#   tools/mqtt_stand_in.sh [-h host] [-p puerto] [-u userId] [-d deviceId]
+#
+# Evento de proximidad (retenido, igual que el del backend):
+#   mosquitto_pub -r -t geoentry/devices/<deviceId>/proximity \
+#       -m '{"id": "e1", "event_type": "enter", "home_location_name": "Casa"}'
+
+HOST=localhost
+PORT=1883
+PREFIX=geoentry/
+USER_ID=dd380cd7-852b-4855-9c68-c45f71b62521
+DEVICE_ID=7b4cdbcd-2bf0-4047-9355-05e33babf2c9
+SENSOR_TYPES="led_tv smart_light air_conditioner coffee_maker"
+
+while getopts "h:p:u:d:" opt; do
+    case "$opt" in
+        h) HOST=$OPTARG ;;
+        p) PORT=$OPTARG ;;
+        u) USER_ID=$OPTARG ;;
+        d) DEVICE_ID=$OPTARG ;;
+        *) exit 2 ;;
+    esac
+done
+
+SENSORS="${PREFIX}users/${USER_ID}/sensors"
+
+publish_state() {
+    # $1 = tipo de sensor (el id es "sensor-<tipo>"), $2 = true | false
+    mosquitto_pub -h "$HOST" -p "$PORT" -q 1 -r -t "$SENSORS/sensor-$1" \
+        -m "{\"id\": \"sensor-$1\", \"sensor_type\": \"$1\", \"isActive\": $2}"
+}
+
+for type in $SENSOR_TYPES; do
+    publish_state "$type" false
+done
+echo "Sensores publicados en $SENSORS/+ ($SENSOR_TYPES)"
+echo "Estado del dispositivo: ${PREFIX}devices/${DEVICE_ID}/status"
+
+mosquitto_sub -h "$HOST" -p "$PORT" -q 1 -v -t "$SENSORS/+/set" | while read -r topic payload; do
+    sensor=${topic%/set}
+    type=${sensor##*/sensor-}
+    case "$payload" in
+        *true*) state=true ;;
+        *) state=false ;;
+    esac
+    echo "$(date +%T) $type -> $state"
+    publish_state "$type" "$state"
+done